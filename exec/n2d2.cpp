@@ -52,6 +52,7 @@
 #include "DrawNet.hpp"
 #include "CEnvironment.hpp"
 #include "Environment.hpp"
+#include "GradientCheck.hpp"
 #include "Histogram.hpp"
 #include "NodeEnv.hpp"
 #include "RangeStats.hpp"
@@ -235,6 +236,10 @@ public:
         testId =      opts.parse("-test-id", -1, "test a single specific stimulus ID (takes"
                                                  " precedence over -test-index)");
         check =       opts.parse("-check", "enable gradient computation checking");
+        checkSampling = opts.parse("-check-sampling", 0.0, "with -check, only check "
+                                                    "a random sample of the gradients, large "
+                                                    "enough to detect this fraction of wrong "
+                                                    "gradients with 99% confidence (0 = all)");
         logOutputs =  opts.parse("-log-outputs", 0U, "log layers outputs for the n-th "
                                                      "stimulus (0 = no log)");
         logJSON =     opts.parse("-log-json", "log JSON annotations");
@@ -266,8 +271,10 @@ public:
         load =        opts.parse("-l", std::string(), "start with a previously saved state from a "
                                                       "specified location");
         weights =     opts.parse("-w", std::string(), "start with weights imported from a specified "
-                                                      "location (even when loading a previously "
-                                                      "saved state)");
+                                                      "location or .ckpt checkpoint file (even when "
+                                                      "loading a previously saved state)");
+        checkpoint =  opts.parse("-checkpoint", "also save the best validation weights in "
+                                                "the weights_validation.ckpt checkpoint file");
         exportNoUnsigned =   opts.parse("-no-unsigned", "disable the use of unsigned data type in "
                                                         "integer exports");
         exportNbStimuliMax = opts.parse("-db-export", -1, "max. number of stimuli to export "
@@ -315,6 +322,7 @@ public:
     int testIndex;
     int testId;
     bool check;
+    double checkSampling;
     unsigned int logOutputs;
     bool logJSON;
     bool logDbStats;
@@ -331,6 +339,7 @@ public:
     std::string saveTestSet;
     std::string load;
     std::string weights;
+    bool checkpoint;
     int exportNbStimuliMax;
     bool version;
     std::string iniConfig;
@@ -558,7 +567,9 @@ bool generateExport(const Options& opt, std::shared_ptr<DeepNet>& deepNet) {
     bool afterCalibration = false;
     try {
         if (!opt.weights.empty()) {
-            if (opt.weights != "/dev/null")
+            if (Utils::fileExtension(opt.weights) == "ckpt")
+                deepNet->loadNetworkCheckpoint(opt.weights);
+            else if (opt.weights != "/dev/null")
                 deepNet->importNetworkFreeParameters(opt.weights);
         }
         else if (opt.load.empty()) {
@@ -1143,6 +1154,12 @@ void learn(const Options& opt, std::shared_ptr<DeepNet>& deepNet) {
                             deepNet->log("validation", Database::Validation);
                             deepNet->exportNetworkFreeParameters(
                                 "weights_validation");
+
+                            if (opt.checkpoint) {
+                                deepNet->saveNetworkCheckpoint(
+                                    "weights_validation.ckpt");
+                            }
+
                             deepNet->save("net_state_validation");
                         }
                         else {
@@ -1223,6 +1240,12 @@ void learn(const Options& opt, std::shared_ptr<DeepNet>& deepNet) {
                             deepNet->log("validation", Database::Validation);
                             deepNet->exportNetworkFreeParameters(
                                 "weights_validation");
+
+                            if (opt.checkpoint) {
+                                deepNet->saveNetworkCheckpoint(
+                                    "weights_validation.ckpt");
+                            }
+
                             deepNet->save("net_state_validation");
                         }
                         else {
@@ -1616,12 +1639,15 @@ void logStats(const Options& opt, std::shared_ptr<DeepNet>& deepNet) {
     deepNet->logLabelsLegend("labels_legend.png");
 
     if (!opt.weights.empty()) {
-        if (opt.weights != "/dev/null")
+        if (Utils::fileExtension(opt.weights) == "ckpt")
+            deepNet->loadNetworkCheckpoint(opt.weights, true);
+        else if (opt.weights != "/dev/null")
             deepNet->importNetworkFreeParameters(opt.weights, true);
     }
 
     if (opt.check) {
         std::cout << "Checking gradient computation..." << std::endl;
+        GradientCheckBase::setSampling(opt.checkSampling);
         deepNet->checkGradient(1.0e-3, 1.0e-3);
     }
 
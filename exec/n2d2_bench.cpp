@@ -0,0 +1,882 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Scaling benchmark for the Frame (CPU) kernels.
+ *
+ * Each cell is timed on propagate() + backPropagate(), each solver on
+ * update() and the spiking Xcell on an event-driven simulation (with and
+ * without STDP learning), for a sweep of OpenMP thread counts (1, 2, 4... up
+ * to -threads).
+ * The reported GFLOP/s and GB/s are derived from analytic operation and
+ * compulsory memory traffic counts (cache reuse is ignored), and the scaling
+ * efficiency is t(1) / (n * t(n)).
+ *
+ * Results are written as a JSON file that can be fed back with -baseline to
+ * detect performance regressions: the program returns a non-zero exit code
+ * if any benchmark is slower than its baseline by more than -tolerance.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/BatchNormCell_Frame.hpp"
+#include "Cell/ConvCell_Frame.hpp"
+#include "Cell/DeconvCell_Frame.hpp"
+#include "Cell/FMPCell_Frame.hpp"
+#include "Cell/FcCell_Frame.hpp"
+#include "Cell/LRNCell_Frame.hpp"
+#include "Cell/PoolCell_Frame.hpp"
+#include "Cell/ResizeCell_Frame.hpp"
+#include "Cell/SoftmaxCell_Frame.hpp"
+#include "Solver/AdamSolver_Frame.hpp"
+#include "Solver/SGDSolver_Frame.hpp"
+#include "containers/Tensor.hpp"
+#include "DeepNet.hpp"
+#include "Environment.hpp"
+#include "Network.hpp"
+#include "NodeEnv.hpp"
+#include "NodeNeuron_Behavioral.hpp"
+#include "Xcell.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Random.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace N2D2;
+
+namespace {
+struct Benchmark {
+    std::string name;
+    std::string shape;
+    /// One iteration of the benchmarked workload
+    std::function<void()> run;
+    /// Floating point operations per iteration
+    double flops;
+    /// Bytes moved per iteration
+    double bytes;
+};
+
+struct Result {
+    std::string name;
+    std::string shape;
+    int threads;
+    double timeMs;
+    double gflops;
+    double gbytes;
+    double efficiency;
+};
+
+// Pooling is usually one-to-one (channel-wise) in networks, whereas the
+// default mapping for a tensor input is full
+class PoolCell_Frame_Bench : public PoolCell_Frame<Float_T> {
+public:
+    PoolCell_Frame_Bench(const DeepNet& deepNet,
+                         const std::string& name,
+                         const std::vector<unsigned int>& poolDims,
+                         unsigned int nbOutputs,
+                         const std::vector<unsigned int>& strideDims,
+                         const std::vector<unsigned int>& paddingDims,
+                         Pooling pooling)
+        : Cell(deepNet, name, nbOutputs),
+          PoolCell(deepNet, name, poolDims, nbOutputs, strideDims,
+                   paddingDims, pooling),
+          PoolCell_Frame<Float_T>(deepNet, name, poolDims, nbOutputs,
+                                  strideDims, paddingDims, pooling)
+    {
+    }
+
+    void setOneToOneMapping()
+    {
+        for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+            for (unsigned int channel = 0; channel < getNbChannels();
+                ++channel)
+            {
+                mMapping(output, channel) = (output == channel);
+            }
+        }
+    }
+};
+
+class FMPCell_Frame_Bench : public FMPCell_Frame {
+public:
+    FMPCell_Frame_Bench(const DeepNet& deepNet,
+                        const std::string& name,
+                        double scalingRatio,
+                        unsigned int nbOutputs)
+        : Cell(deepNet, name, nbOutputs),
+          FMPCell(deepNet, name, scalingRatio, nbOutputs),
+          FMPCell_Frame(deepNet, name, scalingRatio, nbOutputs)
+    {
+    }
+
+    void setOneToOneMapping()
+    {
+        for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+            for (unsigned int channel = 0; channel < getNbChannels();
+                ++channel)
+            {
+                mMapping(output, channel) = (output == channel);
+            }
+        }
+    }
+};
+
+std::string shapeStr(const std::vector<size_t>& dims)
+{
+    std::ostringstream str;
+
+    for (size_t i = 0; i < dims.size(); ++i) {
+        if (i > 0)
+            str << "x";
+
+        str << dims[i];
+    }
+
+    return str.str();
+}
+
+/// Connect @p cell to random inputs and return a propagate() +
+/// backPropagate() runner (propagate() only if @p forwardOnly is true). The
+/// input tensors are owned by the runner.
+std::function<void()> cellRunner(const std::shared_ptr<Cell>& cell,
+                                 const std::vector<size_t>& inputsDims,
+                                 bool oneToOne = false,
+                                 bool forwardOnly = false)
+{
+    std::shared_ptr<Tensor<Float_T> > inputs
+        = std::make_shared<Tensor<Float_T> >(inputsDims);
+    std::shared_ptr<Tensor<Float_T> > diffOutputs
+        = std::make_shared<Tensor<Float_T> >(inputsDims);
+
+    for (unsigned int index = 0; index < inputs->size(); ++index)
+        (*inputs)(index) = Random::randUniform(-1.0, 1.0);
+
+    std::shared_ptr<Cell_Frame<Float_T> > cellFrame
+        = std::dynamic_pointer_cast<Cell_Frame<Float_T> >(cell);
+
+    cellFrame->addInput(*inputs, *diffOutputs);
+
+    if (oneToOne) {
+        const std::shared_ptr<PoolCell_Frame_Bench> poolCell
+            = std::dynamic_pointer_cast<PoolCell_Frame_Bench>(cell);
+
+        if (poolCell)
+            poolCell->setOneToOneMapping();
+        else {
+            std::dynamic_pointer_cast<FMPCell_Frame_Bench>(cell)
+                ->setOneToOneMapping();
+        }
+    }
+
+    cellFrame->initialize();
+
+    Tensor<Float_T>& diffInputs
+        = dynamic_cast<Tensor<Float_T>&>(cellFrame->getDiffInputs());
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = Random::randUniform(-1.0, 1.0);
+
+    if (forwardOnly) {
+        return [cellFrame, inputs, diffOutputs]() {
+            cellFrame->propagate(true);
+        };
+    }
+
+    return [cellFrame, inputs, diffOutputs]() {
+        cellFrame->propagate();
+        cellFrame->getDiffInputs().setValid();
+        cellFrame->backPropagate();
+    };
+}
+
+/// Compulsory traffic for propagate() + backPropagate(): inputs are read
+/// twice (data and weights gradient) and diffOutputs written, outputs are
+/// written and read back with diffInputs, weights are read twice and their
+/// gradient written.
+double cellBytes(double inputsSize, double outputsSize, double weightsSize)
+{
+    return sizeof(Float_T)
+        * (3.0 * inputsSize + 3.0 * outputsSize + 3.0 * weightsSize);
+}
+
+void addConv(std::vector<Benchmark>& benchmarks,
+             const DeepNet& deepNet,
+             unsigned int size,
+             unsigned int nbChannels,
+             unsigned int batchSize,
+             unsigned int kernel,
+             unsigned int nbOutputs)
+{
+    const int padding = kernel / 2;
+    std::shared_ptr<Cell> cell = std::make_shared<ConvCell_Frame<Float_T> >(
+        deepNet, "conv", std::vector<unsigned int>(2, kernel), nbOutputs,
+        std::vector<unsigned int>(2, 1U), std::vector<unsigned int>(2, 1U),
+        std::vector<int>(2, padding), std::vector<unsigned int>(2, 1U),
+        std::shared_ptr<Activation>());
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    Benchmark bench;
+    bench.name = "ConvCell_Frame";
+    bench.run = cellRunner(cell, inputsDims);
+
+    const double inputsSize = (double)size * size * nbChannels * batchSize;
+    const double outputsSize = (double)cell->getOutputsWidth()
+        * cell->getOutputsHeight() * nbOutputs * batchSize;
+    const double weightsSize = (double)nbOutputs * nbChannels
+        * kernel * kernel + nbOutputs;
+    const double macs = outputsSize * nbChannels * kernel * kernel;
+
+    std::ostringstream shape;
+    shape << shapeStr(inputsDims) << "-k" << kernel << "-o" << nbOutputs;
+    bench.shape = shape.str();
+    // Forward, backward data and backward weights
+    bench.flops = 3.0 * 2.0 * macs;
+    bench.bytes = cellBytes(inputsSize, outputsSize, weightsSize);
+    benchmarks.push_back(bench);
+}
+
+void addDeconv(std::vector<Benchmark>& benchmarks,
+               const DeepNet& deepNet,
+               unsigned int size,
+               unsigned int nbChannels,
+               unsigned int batchSize,
+               unsigned int kernel,
+               unsigned int stride,
+               unsigned int nbOutputs)
+{
+    std::shared_ptr<Cell> cell = std::make_shared<DeconvCell_Frame<Float_T> >(
+        deepNet, "deconv", std::vector<unsigned int>(2, kernel), nbOutputs,
+        std::vector<unsigned int>(2, stride), std::vector<int>(2, 0),
+        std::vector<unsigned int>(2, 1U), std::shared_ptr<Activation>());
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    Benchmark bench;
+    bench.name = "DeconvCell_Frame";
+    bench.run = cellRunner(cell, inputsDims);
+
+    const double inputsSize = (double)size * size * nbChannels * batchSize;
+    const double outputsSize = (double)cell->getOutputsWidth()
+        * cell->getOutputsHeight() * nbOutputs * batchSize;
+    const double weightsSize = (double)nbOutputs * nbChannels
+        * kernel * kernel + nbOutputs;
+    const double macs = inputsSize * nbOutputs * kernel * kernel;
+
+    std::ostringstream shape;
+    shape << shapeStr(inputsDims) << "-k" << kernel << "-s" << stride
+        << "-o" << nbOutputs;
+    bench.shape = shape.str();
+    bench.flops = 3.0 * 2.0 * macs;
+    bench.bytes = cellBytes(inputsSize, outputsSize, weightsSize);
+    benchmarks.push_back(bench);
+}
+
+void addFc(std::vector<Benchmark>& benchmarks,
+           const DeepNet& deepNet,
+           unsigned int size,
+           unsigned int nbChannels,
+           unsigned int batchSize,
+           unsigned int nbOutputs)
+{
+    std::shared_ptr<Cell> cell = std::make_shared<FcCell_Frame<Float_T> >(
+        deepNet, "fc", nbOutputs, std::shared_ptr<Activation>());
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    Benchmark bench;
+    bench.name = "FcCell_Frame";
+    bench.run = cellRunner(cell, inputsDims);
+
+    const double nbInputs = (double)size * size * nbChannels;
+    const double weightsSize = nbInputs * nbOutputs + nbOutputs;
+    const double macs = nbInputs * nbOutputs * batchSize;
+
+    std::ostringstream shape;
+    shape << shapeStr(inputsDims) << "-o" << nbOutputs;
+    bench.shape = shape.str();
+    bench.flops = 3.0 * 2.0 * macs;
+    bench.bytes = cellBytes(nbInputs * batchSize,
+                            (double)nbOutputs * batchSize, weightsSize);
+    benchmarks.push_back(bench);
+}
+
+void addPool(std::vector<Benchmark>& benchmarks,
+             const DeepNet& deepNet,
+             unsigned int size,
+             unsigned int nbChannels,
+             unsigned int batchSize,
+             unsigned int pool,
+             unsigned int stride,
+             PoolCell::Pooling pooling)
+{
+    std::shared_ptr<Cell> cell = std::make_shared<PoolCell_Frame_Bench>(
+        deepNet, "pool", std::vector<unsigned int>(2, pool), nbChannels,
+        std::vector<unsigned int>(2, stride), std::vector<unsigned int>(2, 0),
+        pooling);
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    Benchmark bench;
+    bench.name = "PoolCell_Frame";
+    bench.run = cellRunner(cell, inputsDims, true);
+
+    const double inputsSize = (double)size * size * nbChannels * batchSize;
+    const double outputsSize = (double)cell->getOutputsWidth()
+        * cell->getOutputsHeight() * nbChannels * batchSize;
+
+    std::ostringstream shape;
+    shape << shapeStr(inputsDims) << "-p" << pool << "-s" << stride
+        << ((pooling == PoolCell::Max) ? "-max" : "-avg");
+    bench.shape = shape.str();
+    // One comparison (or addition) per pooled input and one operation per
+    // output for the backward pass
+    bench.flops = outputsSize * (pool * pool + 1.0);
+    bench.bytes = cellBytes(inputsSize, outputsSize, 0.0);
+    benchmarks.push_back(bench);
+}
+
+void addFMP(std::vector<Benchmark>& benchmarks,
+            const DeepNet& deepNet,
+            unsigned int size,
+            unsigned int nbChannels,
+            unsigned int batchSize,
+            double scalingRatio)
+{
+    std::shared_ptr<Cell> cell = std::make_shared<FMPCell_Frame_Bench>(
+        deepNet, "fmp", scalingRatio, nbChannels);
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    Benchmark bench;
+    bench.name = "FMPCell_Frame";
+    bench.run = cellRunner(cell, inputsDims, true);
+
+    const double inputsSize = (double)size * size * nbChannels * batchSize;
+    const double outputsSize = (double)cell->getOutputsWidth()
+        * cell->getOutputsHeight() * nbChannels * batchSize;
+
+    std::ostringstream shape;
+    shape << shapeStr(inputsDims) << "-r" << scalingRatio;
+    bench.shape = shape.str();
+    // Each input is compared about once in the (overlapping) pooling
+    // regions and one operation per output for the backward pass
+    bench.flops = inputsSize + outputsSize;
+    bench.bytes = cellBytes(inputsSize, outputsSize, 0.0);
+    benchmarks.push_back(bench);
+}
+
+/// Benchmark for element-wise cells (same inputs and outputs dimensions),
+/// with @p flopsPerElement the approximate number of operations per element
+/// for propagate() + backPropagate(), or propagate() alone if @p forwardOnly
+void addElementWise(std::vector<Benchmark>& benchmarks,
+                    const std::string& name,
+                    const std::shared_ptr<Cell>& cell,
+                    const std::vector<size_t>& inputsDims,
+                    double flopsPerElement,
+                    double weightsSize = 0.0,
+                    bool forwardOnly = false)
+{
+    Benchmark bench;
+    bench.name = name;
+    bench.shape = shapeStr(inputsDims) + ((forwardOnly) ? "-fwd" : "");
+    bench.run = cellRunner(cell, inputsDims, false, forwardOnly);
+
+    double size = 1.0;
+
+    for (size_t i = 0; i < inputsDims.size(); ++i)
+        size *= inputsDims[i];
+
+    bench.flops = flopsPerElement * size;
+    bench.bytes = (forwardOnly)
+        ? sizeof(Float_T) * (2.0 * size + weightsSize)
+        : cellBytes(size, size, weightsSize);
+    benchmarks.push_back(bench);
+}
+
+void addResize(std::vector<Benchmark>& benchmarks,
+               const DeepNet& deepNet,
+               unsigned int size,
+               unsigned int nbChannels,
+               unsigned int batchSize,
+               ResizeCell::ResizeMode resizeMode)
+{
+    std::shared_ptr<Cell> cell = std::make_shared<ResizeCell_Frame>(
+        deepNet, "resize", 2 * size, 2 * size, nbChannels, resizeMode);
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    Benchmark bench;
+    bench.name = "ResizeCell_Frame";
+    bench.run = cellRunner(cell, inputsDims);
+
+    const double inputsSize = (double)size * size * nbChannels * batchSize;
+    const double outputsSize = 4.0 * inputsSize;
+
+    std::ostringstream shape;
+    shape << shapeStr(inputsDims) << "-x2"
+        << ((resizeMode == ResizeCell::NearestNeighbor) ? "-nn" : "-bilinear");
+    bench.shape = shape.str();
+    // Bilinear: 4 multiply-adds per output, forward and backward
+    bench.flops = (resizeMode == ResizeCell::NearestNeighbor)
+        ? 2.0 * outputsSize : 16.0 * outputsSize;
+    bench.bytes = cellBytes(inputsSize, outputsSize, 0.0);
+    benchmarks.push_back(bench);
+}
+
+void addSolver(std::vector<Benchmark>& benchmarks,
+               const std::string& name,
+               const std::shared_ptr<Solver>& solver,
+               size_t size,
+               unsigned int batchSize,
+               double flopsPerElement,
+               double accessesPerElement)
+{
+    std::shared_ptr<Tensor<Float_T> > data
+        = std::make_shared<Tensor<Float_T> >(std::vector<size_t>(1, size));
+    std::shared_ptr<Tensor<Float_T> > diffData
+        = std::make_shared<Tensor<Float_T> >(std::vector<size_t>(1, size));
+
+    for (unsigned int index = 0; index < size; ++index) {
+        (*data)(index) = Random::randUniform(-1.0, 1.0);
+        (*diffData)(index) = Random::randUniform(-1.0, 1.0);
+    }
+
+    Benchmark bench;
+    bench.name = name;
+    bench.shape = shapeStr(std::vector<size_t>(1, size));
+    bench.run = [solver, data, diffData, batchSize]() {
+        solver->update(*data, *diffData, batchSize);
+    };
+    bench.flops = flopsPerElement * size;
+    bench.bytes = sizeof(Float_T) * accessesPerElement * size;
+    benchmarks.push_back(bench);
+}
+
+/// Event-driven simulation of an Xcell of behavioral neurons fully connected
+/// to a 2 channels (ON/OFF) input, as in the aer_cars example: each input
+/// event is integrated by every neuron, through its synapse lookup
+void addXcell(std::vector<Benchmark>& benchmarks,
+              Network& net,
+              unsigned int size,
+              unsigned int nbNeurons,
+              unsigned int nbEvents)
+{
+    std::shared_ptr<Environment> env = std::make_shared<Environment>(net,
+        EmptyDatabase, std::vector<size_t>({size, size, 2}));
+    std::shared_ptr<Xcell> xcell = std::make_shared<Xcell>(net);
+    xcell->populate<NodeNeuron_Behavioral>(nbNeurons);
+    // No output spike: only the input events are processed
+    xcell->setNeuronsParameter("Threshold", 1000000.0);
+    xcell->addInput(*env, 0, 0, size, size);
+
+    const std::vector<NodeEnv*> nodes = env->getNodes();
+    std::vector<Node*> events(nbEvents);
+
+    for (unsigned int i = 0; i < nbEvents; ++i)
+        events[i] = nodes[Random::randUniform(0, nodes.size() - 1)];
+
+    Benchmark bench;
+    bench.name = "Xcell";
+
+    std::ostringstream shape;
+    shape << size << "x" << size << "x2-n" << nbNeurons << "-e" << nbEvents;
+    bench.shape = shape.str();
+    bench.run = [&net, env, xcell, events]() {
+        const Time_T start = net.getLastEvent();
+
+        for (unsigned int i = 0; i < events.size(); ++i)
+            events[i]->incomingSpike(NULL, start + (i + 1) * TimeUs);
+
+        net.run();
+    };
+    // One synaptic integration per event and per neuron, reading and
+    // updating the synapse and the neuron state
+    bench.flops = (double)nbEvents * nbNeurons;
+    bench.bytes = 4.0 * sizeof(Float_T) * nbEvents * nbNeurons;
+    benchmarks.push_back(bench);
+}
+
+/// Event-driven simulation with STDP learning, with the pair-based (one
+/// check per synapse on each post-synaptic spike) or the trace-based rule
+void addStdp(std::vector<Benchmark>& benchmarks,
+             Network& net,
+             unsigned int size,
+             unsigned int nbNeurons,
+             unsigned int nbEvents,
+             unsigned int orderStdp,
+             bool traceStdp)
+{
+    std::shared_ptr<Environment> env = std::make_shared<Environment>(net,
+        EmptyDatabase, std::vector<size_t>({size, size, 2}));
+    std::shared_ptr<Xcell> xcell = std::make_shared<Xcell>(net);
+    xcell->populate<NodeNeuron_Behavioral>(nbNeurons);
+    xcell->setNeuronsParameter<Weight_T>("WeightIncrement", 5.0);
+    xcell->setNeuronsParameter<Weight_T>("WeightDecrement", 3.0);
+    xcell->setNeuronsParameter("Threshold", 40.0 * size);
+    xcell->setNeuronsParameter("StdpLtp", 2 * TimeMs);
+    xcell->setNeuronsParameter("StdpLtd", 2 * TimeMs);
+    xcell->setNeuronsParameter("Refractory", 1 * TimeMs);
+    xcell->setNeuronsParameter("InhibitRefractory", 1 * TimeMs);
+    xcell->setNeuronsParameter("OrderStdp", orderStdp);
+    xcell->setNeuronsParameter<Weight_T>("WeightBias", -0.5);
+    xcell->setNeuronsParameter("TraceStdp", traceStdp);
+    xcell->addInput(*env, 0, 0, size, size);
+
+    const std::vector<NodeEnv*> nodes = env->getNodes();
+    std::vector<std::pair<Node*, Time_T> > events(nbEvents);
+    Time_T time = 0;
+
+    for (unsigned int i = 0; i < nbEvents; ++i) {
+        time += (Time_T)Random::randExponential(10.0 * TimeUs) + 1;
+        events[i] = std::make_pair(
+            nodes[Random::randUniform(0, nodes.size() - 1)], time);
+    }
+
+    Benchmark bench;
+    bench.name = (traceStdp) ? "Xcell_StdpTrace" : "Xcell_StdpPair";
+
+    std::ostringstream shape;
+    shape << size << "x" << size << "x2-n" << nbNeurons << "-e" << nbEvents
+        << "-o" << orderStdp;
+    bench.shape = shape.str();
+    bench.run = [&net, env, xcell, events]() {
+        const Time_T start = net.getLastEvent();
+
+        for (unsigned int i = 0; i < events.size(); ++i) {
+            events[i].first->incomingSpike(NULL,
+                                           start + events[i].second);
+        }
+
+        net.run();
+    };
+    // Synaptic integration as for the Xcell benchmark, the cost of the
+    // learning depends on the number of output spikes
+    bench.flops = (double)nbEvents * nbNeurons;
+    bench.bytes = 4.0 * sizeof(Float_T) * nbEvents * nbNeurons;
+    benchmarks.push_back(bench);
+}
+
+std::string resultKey(const std::string& name,
+                      const std::string& shape,
+                      int threads)
+{
+    std::ostringstream key;
+    key << name << "/" << shape << "/" << threads;
+    return key.str();
+}
+
+/// Minimal reader for the one-object-per-line JSON written by this program
+std::string jsonValue(const std::string& line, const std::string& key)
+{
+    const std::string pattern = "\"" + key + "\":";
+    std::string::size_type pos = line.find(pattern);
+
+    if (pos == std::string::npos)
+        return std::string();
+
+    pos = line.find_first_not_of(" ", pos + pattern.size());
+
+    if (pos == std::string::npos)
+        return std::string();
+
+    if (line[pos] == '"') {
+        const std::string::size_type end = line.find('"', pos + 1);
+        return line.substr(pos + 1, end - pos - 1);
+    }
+
+    const std::string::size_type end = line.find_first_of(",}", pos);
+    return line.substr(pos, end - pos);
+}
+
+std::map<std::string, double> loadBaseline(const std::string& fileName)
+{
+    std::ifstream data(fileName.c_str());
+
+    if (!data.good())
+        throw std::runtime_error("Could not open baseline file: " + fileName);
+
+    std::map<std::string, double> baseline;
+    std::string line;
+
+    while (std::getline(data, line)) {
+        const std::string name = jsonValue(line, "name");
+
+        if (name.empty())
+            continue;
+
+        const int threads = std::atoi(jsonValue(line, "threads").c_str());
+        const double timeMs = std::atof(jsonValue(line, "time_ms").c_str());
+
+        baseline[resultKey(name, jsonValue(line, "shape"), threads)] = timeMs;
+    }
+
+    return baseline;
+}
+
+void saveResults(const std::string& fileName,
+                 const std::vector<Result>& results,
+                 unsigned int nbIterations)
+{
+    std::ofstream data(fileName.c_str());
+
+    if (!data.good())
+        throw std::runtime_error("Could not create results file: " + fileName);
+
+    data << "{\n"
+        "\"float_bytes\": " << sizeof(Float_T) << ",\n"
+        "\"iterations\": " << nbIterations << ",\n"
+        "\"benchmarks\": [\n";
+
+    for (std::vector<Result>::const_iterator it = results.begin(),
+        itBegin = results.begin(), itEnd = results.end(); it != itEnd; ++it)
+    {
+        if (it != itBegin)
+            data << ",\n";
+
+        data << "{\"name\": \"" << (*it).name << "\", "
+            "\"shape\": \"" << (*it).shape << "\", "
+            "\"threads\": " << (*it).threads << ", "
+            "\"time_ms\": " << (*it).timeMs << ", "
+            "\"gflops\": " << (*it).gflops << ", "
+            "\"gbytes_per_s\": " << (*it).gbytes << ", "
+            "\"efficiency\": " << (*it).efficiency << "}";
+    }
+
+    data << "\n]\n}" << std::endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const unsigned int size
+        = opts.parse("-size", 32U, "input width and height");
+    const unsigned int nbChannels
+        = opts.parse("-channels", 32U, "number of input channels");
+    const unsigned int batchSize = opts.parse("-batch", 16U, "batch size");
+    const unsigned int nbIterations
+        = opts.parse("-iter", 5U, 1U, "number of timed iterations");
+#ifdef _OPENMP
+    const int maxThreads = opts.parse("-threads", omp_get_max_threads(), 1,
+                                      "maximum number of threads");
+#else
+    const int maxThreads = 1;
+#endif
+    const std::string filter = opts.parse<std::string>(
+        "-filter", "", "only run benchmarks whose name contains this string");
+    const std::string outputFile = opts.parse<std::string>(
+        "-o", "bench.json", "JSON results file");
+    const std::string baselineFile = opts.parse<std::string>(
+        "-baseline", "", "JSON baseline file to check for regressions");
+    const double tolerance = opts.parse("-tolerance", 0.1, 0.0,
+        "relative slowdown against the baseline considered a regression");
+    opts.done();
+
+    Network net(1);
+    DeepNet deepNet(net);
+
+    Random::mtSeed(0);
+
+    std::vector<Benchmark> benchmarks;
+
+    addConv(benchmarks, deepNet, size, nbChannels, batchSize, 3,
+            nbChannels);
+    addConv(benchmarks, deepNet, size, nbChannels, batchSize, 1,
+            2 * nbChannels);
+    addDeconv(benchmarks, deepNet, size / 2, nbChannels, batchSize, 3, 1,
+              nbChannels);
+    addDeconv(benchmarks, deepNet, size / 2, nbChannels, batchSize, 4, 2,
+              nbChannels);
+    addFc(benchmarks, deepNet, size / 4, nbChannels, batchSize, 256);
+    addPool(benchmarks, deepNet, size, nbChannels, batchSize, 2, 2,
+            PoolCell::Max);
+    addPool(benchmarks, deepNet, size, nbChannels, batchSize, 3, 2,
+            PoolCell::Max);
+    addPool(benchmarks, deepNet, size, nbChannels, batchSize, 3, 1,
+            PoolCell::Average);
+    addFMP(benchmarks, deepNet, 2 * size, nbChannels, batchSize, 1.414);
+
+    const std::vector<size_t> inputsDims({size, size, nbChannels, batchSize});
+
+    // Mean, variance, normalization and scale forward, twice as much backward
+    addElementWise(benchmarks, "BatchNormCell_Frame",
+        std::make_shared<BatchNormCell_Frame<Float_T> >(deepNet, "bn",
+            nbChannels, std::shared_ptr<Activation>()),
+        inputsDims, 21.0, 4.0 * nbChannels);
+    // Max, exp, sum and division forward, dot product and scale backward
+    addElementWise(benchmarks, "SoftmaxCell_Frame",
+        std::make_shared<SoftmaxCell_Frame<Float_T> >(deepNet, "softmax",
+            nbChannels),
+        inputsDims, 9.0);
+
+    std::shared_ptr<LRNCell_Frame<Float_T> > lrn
+        = std::make_shared<LRNCell_Frame<Float_T> >(deepNet, "lrn",
+                                                     nbChannels);
+    const double lrnN = lrn->getParameter<unsigned int>("N");
+    // Sum of squares over the window and power (no backward implementation)
+    addElementWise(benchmarks, "LRNCell_Frame", lrn, inputsDims,
+                   2.0 * lrnN + 5.0, 0.0, true);
+
+    addResize(benchmarks, deepNet, size, nbChannels, batchSize,
+              ResizeCell::BilinearTF);
+    addResize(benchmarks, deepNet, size, nbChannels, batchSize,
+              ResizeCell::NearestNeighbor);
+
+    const size_t nbParameters = (size_t)9 * nbChannels * nbChannels * 64;
+
+    std::shared_ptr<SGDSolver_Frame<Float_T> > sgd
+        = std::make_shared<SGDSolver_Frame<Float_T> >();
+    sgd->setParameter("Momentum", 0.9);
+    sgd->setParameter("Decay", 0.0005);
+    // Decay, momentum and update; data, diff and momentum read, data and
+    // momentum written
+    addSolver(benchmarks, "SGDSolver_Frame", sgd, nbParameters, batchSize,
+              6.0, 5.0);
+    // First and second moments, square root, division and update; data,
+    // diff and both moments read, data and moments written
+    addSolver(benchmarks, "AdamSolver_Frame",
+              std::make_shared<AdamSolver_Frame<Float_T> >(), nbParameters,
+              batchSize, 13.0, 7.0);
+
+    addXcell(benchmarks, net, 128, 20, 100000);
+    addStdp(benchmarks, net, 64, 20, 200000, 0, false);
+    addStdp(benchmarks, net, 64, 20, 200000, 0, true);
+    addStdp(benchmarks, net, 64, 20, 200000, 10, false);
+    addStdp(benchmarks, net, 64, 20, 200000, 10, true);
+
+    const std::map<std::string, double> baseline = (!baselineFile.empty())
+        ? loadBaseline(baselineFile) : std::map<std::string, double>();
+
+    std::vector<Result> results;
+    unsigned int nbRegressions = 0;
+
+    std::cout << std::left << std::setw(20) << "benchmark"
+        << std::setw(28) << "shape" << std::right
+        << std::setw(8) << "threads" << std::setw(12) << "time [ms]"
+        << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+        << std::setw(8) << "eff." << std::setw(12) << "baseline"
+        << std::endl;
+
+    for (std::vector<Benchmark>::const_iterator it = benchmarks.begin(),
+        itEnd = benchmarks.end(); it != itEnd; ++it)
+    {
+        if (!filter.empty() && (*it).name.find(filter) == std::string::npos)
+            continue;
+
+        double time1 = 0.0;
+
+        for (int nbThreads = 1; nbThreads <= maxThreads;
+            nbThreads = std::min(2 * nbThreads, maxThreads))
+        {
+#ifdef _OPENMP
+            omp_set_num_threads(nbThreads);
+#endif
+            // Warm-up (memory allocations, caches)
+            (*it).run();
+
+            const std::chrono::high_resolution_clock::time_point start
+                = std::chrono::high_resolution_clock::now();
+
+            for (unsigned int i = 0; i < nbIterations; ++i)
+                (*it).run();
+
+            const std::chrono::high_resolution_clock::time_point end
+                = std::chrono::high_resolution_clock::now();
+
+            const double time = std::chrono::duration_cast
+                <std::chrono::duration<double> >(end - start).count()
+                    / nbIterations;
+
+            if (nbThreads == 1)
+                time1 = time;
+
+            Result result;
+            result.name = (*it).name;
+            result.shape = (*it).shape;
+            result.threads = nbThreads;
+            result.timeMs = 1.0e3 * time;
+            result.gflops = (*it).flops / time / 1.0e9;
+            result.gbytes = (*it).bytes / time / 1.0e9;
+            result.efficiency = time1 / (nbThreads * time);
+            results.push_back(result);
+
+            std::cout << std::left << std::setw(20) << result.name
+                << std::setw(28) << result.shape << std::right
+                << std::setw(8) << result.threads
+                << std::fixed << std::setprecision(3)
+                << std::setw(12) << result.timeMs
+                << std::setprecision(2)
+                << std::setw(10) << result.gflops
+                << std::setw(10) << result.gbytes
+                << std::setw(8) << result.efficiency;
+
+            const std::map<std::string, double>::const_iterator itBaseline
+                = baseline.find(resultKey(result.name, result.shape,
+                                          result.threads));
+
+            if (itBaseline != baseline.end()) {
+                std::cout << std::setprecision(3) << std::setw(12)
+                    << (*itBaseline).second;
+
+                if (result.timeMs > (*itBaseline).second * (1.0 + tolerance))
+                {
+                    std::cout << "  REGRESSION";
+                    ++nbRegressions;
+                }
+            }
+
+            std::cout.unsetf(std::ios::floatfield);
+            std::cout << std::endl;
+
+            if (nbThreads == maxThreads)
+                break;
+        }
+    }
+
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+
+    saveResults(outputFile, results, nbIterations);
+    std::cout << "Results saved in " << outputFile << std::endl;
+
+    if (!baseline.empty()) {
+        std::cout << nbRegressions << " regression(s) against "
+            << baselineFile << " (tolerance " << 100.0 * tolerance << "%)"
+            << std::endl;
+    }
+
+    return (nbRegressions > 0) ? 1 : 0;
+}
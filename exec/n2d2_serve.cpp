@@ -0,0 +1,147 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Local inference server with dynamic batching (see InferenceServer).
+ *
+ * Requests are encoded images sent on a Unix domain socket. Pending requests
+ * are coalesced into batches of up to the network batch size, within the
+ * -latency budget, and the estimated labels of the network target are sent
+ * back to each client. Batching metrics are printed every -metrics seconds.
+ * Requests larger than -max-request MB are answered with an error.
+*/
+
+#include <atomic>
+#include <signal.h>
+
+#include "N2D2.hpp"
+
+#include "DeepNet.hpp"
+#include "InferenceServer.hpp"
+#include "StimuliProvider.hpp"
+#include "Generator/DeepNetGenerator.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Utils.hpp"
+
+#ifdef CUDA
+#include "CudaContext.hpp"
+#endif
+
+using namespace N2D2;
+
+std::atomic<bool> quit(false);    // signal flag
+
+void signalHandler(int) {
+    quit = true;
+}
+
+void monitor(InferenceServer& server, double metricsInterval) {
+    std::chrono::steady_clock::time_point lastLog
+        = std::chrono::steady_clock::now();
+
+    while (!quit) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const std::chrono::steady_clock::time_point now
+            = std::chrono::steady_clock::now();
+
+        if (metricsInterval > 0.0 && std::chrono::duration_cast
+            <std::chrono::duration<double> >(now - lastLog).count()
+                >= metricsInterval)
+        {
+            server.logMetrics(std::cout);
+            lastLog = now;
+        }
+    }
+
+    server.stop();
+}
+
+int main(int argc, char* argv[]) {
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+#ifdef CUDA
+    const int cudaDevice
+        = opts.parse("-dev", 0,              "CUDA device ID");
+#endif
+    const std::string socketPath
+        = opts.parse<std::string>("-socket",
+                                  "n2d2.sock",
+                                  "Unix domain socket path");
+    const double latency
+        = opts.parse("-latency", 10.0, "maximum batching latency (ms)");
+    const unsigned int maxRequest
+        = opts.parse("-max-request", 64U, "maximum request size (MB)");
+    const double metricsInterval
+        = opts.parse("-metrics", 10.0, "metrics logging interval (s), "
+                                       "0 to disable");
+    const std::string importedWeights
+        = opts.parse<std::string>("-w",
+                                  "weights_validation",
+                                  "weights directory or .ckpt checkpoint "
+                                  "file");
+    const std::string iniConfig
+        = opts.grab<std::string>("<net>",
+                                 "network config file (INI)");
+    opts.done();
+
+#ifdef CUDA
+    CudaContext::setDevice(cudaDevice);
+#endif
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet
+        = DeepNetGenerator::generate(net, iniConfig);
+
+    deepNet->initialize();
+
+    if (Utils::fileExtension(importedWeights) == "ckpt")
+        deepNet->loadNetworkCheckpoint(importedWeights);
+    else
+        deepNet->importNetworkFreeParameters(importedWeights);
+
+    InferenceServer server(deepNet, latency / 1.0e3, 0,
+                           (size_t)maxRequest * 1024 * 1024);
+
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    std::thread monitorThread(monitor, std::ref(server), metricsInterval);
+
+    std::cout << "Serving on " << socketPath << " (batch size: "
+        << deepNet->getStimuliProvider()->getBatchSize()
+        << ", max. latency: " << latency << " ms)" << std::endl;
+
+    int status = 0;
+
+    try {
+        server.listen(socketPath);
+    }
+    catch (const std::exception& e) {
+        std::cout << Utils::cwarning << e.what() << Utils::cdef << std::endl;
+        status = 1;
+    }
+
+    quit = true;
+    monitorThread.join();
+    server.logMetrics(std::cout);
+
+    return status;
+}
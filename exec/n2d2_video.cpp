@@ -0,0 +1,266 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Pipelined classification of a video stream (see VideoPipeline).
+ *
+ * The capture, preprocess (transformations), infer (DeepNet::test()) and
+ * postprocess (drawing) stages run concurrently on consecutive frames. The
+ * input can be a camera index, a video file, a printf-style image sequence
+ * or a directory of images, so that the pipeline can be run without camera.
+ * Per-stage latency statistics and the end-to-end FPS are reported at the
+ * end.
+ *
+ * HighGUI is not thread-safe: the postprocessed frames are handed over to the
+ * main thread, which displays them while the pipeline runs in its own thread.
+*/
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <signal.h>
+#include <thread>
+
+#include "N2D2.hpp"
+
+#include "DeepNet.hpp"
+#include "StimuliProvider.hpp"
+#include "VideoPipeline.hpp"
+#include "Generator/DeepNetGenerator.hpp"
+#include "Target/Target.hpp"
+#include "utils/Key.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Utils.hpp"
+
+#ifdef CUDA
+#include "CudaContext.hpp"
+#endif
+
+using namespace N2D2;
+
+VideoPipeline* pipelineInstance = NULL;
+
+void signalHandler(int) {
+    if (pipelineInstance != NULL)
+        pipelineInstance->stop();
+}
+
+int main(int argc, char* argv[]) {
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+#ifdef CUDA
+    const int cudaDevice
+        = opts.parse("-dev", 0,              "CUDA device ID");
+#endif
+    const std::string input
+        = opts.parse<std::string>("-input",
+                                  "0",
+                                  "camera index, video file, image sequence "
+                                  "or directory of images");
+    const unsigned int queueSize
+        = opts.parse("-queue", 2U, "size of the stages input queues");
+    const bool dropFrames
+        = opts.parse("-drop", "drop the oldest frames when the pipeline is "
+                              "late (default for a camera)");
+    const bool noDisplay
+        = opts.parse("-no-display",
+                     "disable display and visual feedbacks");
+    const std::string importedWeights
+        = opts.parse<std::string>("-w",
+                                  "weights_validation",
+                                  "weights directory or .ckpt checkpoint "
+                                  "file");
+    const std::string logDir
+        = opts.parse<std::string>("-log",
+                                  "video_pipeline",
+                                  "latency histograms directory");
+    const std::string iniConfig
+        = opts.grab<std::string>("<net>",
+                                 "network config file (INI)");
+    opts.done();
+
+#ifdef CUDA
+    CudaContext::setDevice(cudaDevice);
+#endif
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet
+        = DeepNetGenerator::generate(net, iniConfig);
+
+    deepNet->initialize();
+
+    if (Utils::fileExtension(importedWeights) == "ckpt")
+        deepNet->loadNetworkCheckpoint(importedWeights);
+    else
+        deepNet->importNetworkFreeParameters(importedWeights);
+
+    std::shared_ptr<StimuliProvider> sp = deepNet->getStimuliProvider();
+    std::shared_ptr<Target> target = deepNet->getTarget();
+    std::shared_ptr<Database> database = deepNet->getDatabase();
+
+    const bool camera
+        = (input.find_first_not_of("0123456789") == std::string::npos);
+
+    VideoPipeline pipeline(VideoPipeline::createSource(input),
+                           queueSize,
+                           (dropFrames || camera) ? VideoPipeline::DropOldest
+                                                  : VideoPipeline::Block);
+
+    // Only touches the frame: runs concurrently with the inference of the
+    // previous frame
+    pipeline.addStage("preprocess", [&sp](VideoPipeline::Frame& frame) {
+        frame.data = sp->transformStimulus(frame.image, Database::Test);
+    });
+
+    pipeline.addStage("infer", [&](VideoPipeline::Frame& frame) {
+        sp->streamStimulus(frame.data);
+        deepNet->test(Database::Test);
+
+        const Tensor<int> labels = target->getEstimatedLabels()[0];
+        const Tensor<Float_T> values = target->getEstimatedLabelsValue()[0];
+
+        frame.estimatedLabels.resize(labels.dims());
+        frame.estimatedLabels = labels;
+        frame.estimatedLabelsValue.resize(values.dims());
+        frame.estimatedLabelsValue = values;
+    });
+
+    // Postprocessed frames to be displayed by the main thread. Only the
+    // latest one is kept: display must not slow down the pipeline
+    std::deque<cv::Mat> displayQueue;
+    bool pipelineDone = false;
+    std::mutex displayMutex;
+    std::condition_variable displayCondition;
+
+    pipeline.addStage("postprocess", [&](VideoPipeline::Frame& frame) {
+        frame.output = frame.image.clone();
+
+        if (frame.estimatedLabels.empty())
+            return;
+
+        const int label = frame.estimatedLabels(0);
+        const Float_T value = frame.estimatedLabelsValue(0);
+
+        std::stringstream labelStr;
+        labelStr << ((database) ? database->getLabelName(label)
+                                : std::to_string(label))
+            << ": " << std::fixed << std::setprecision(2)
+            << (100.0 * value) << "%";
+
+        if (noDisplay) {
+            std::cout << "#" << frame.index << " " << labelStr.str()
+                << std::endl;
+            return;
+        }
+
+        cv::putText(frame.output,
+                    labelStr.str(),
+                    cv::Point(10, 30),
+                    cv::FONT_HERSHEY_SIMPLEX,
+                    0.7,
+                    cv::Scalar(0, 0, 255),
+                    2);
+
+        {
+            std::lock_guard<std::mutex> lock(displayMutex);
+            displayQueue.clear();
+            displayQueue.push_back(frame.output);
+        }
+
+        displayCondition.notify_one();
+    });
+
+    pipelineInstance = &pipeline;
+    signal(SIGINT, signalHandler);
+
+    int status = 0;
+
+    if (noDisplay)
+        pipeline.run();
+    else {
+        // An exception escaping the thread would call std::terminate(): it
+        // is reported by the main thread instead
+        std::exception_ptr pipelineError;
+
+        std::thread pipelineThread([&]() {
+            try {
+                pipeline.run();
+            }
+            catch (...) {
+                pipelineError = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(displayMutex);
+                pipelineDone = true;
+            }
+
+            displayCondition.notify_one();
+        });
+
+        while (true) {
+            cv::Mat output;
+
+            {
+                std::unique_lock<std::mutex> lock(displayMutex);
+
+                // Timeout to keep the HighGUI event loop alive
+                displayCondition.wait_for(lock,
+                                          std::chrono::milliseconds(10),
+                    [&]() { return (!displayQueue.empty() || pipelineDone); });
+
+                if (displayQueue.empty() && pipelineDone)
+                    break;
+
+                if (!displayQueue.empty()) {
+                    output = displayQueue.front();
+                    displayQueue.pop_front();
+                }
+            }
+
+            if (!output.empty())
+                cv::imshow("N2D2 video", output);
+
+            if (cv::waitKey(1) == KEY_ESC)
+                pipeline.stop();
+        }
+
+        pipelineThread.join();
+
+        if (pipelineError) {
+            try {
+                std::rethrow_exception(pipelineError);
+            }
+            catch (const std::exception& e) {
+                std::cout << Utils::cwarning << e.what() << Utils::cdef
+                    << std::endl;
+                status = 1;
+            }
+        }
+    }
+
+    pipelineInstance = NULL;
+
+    pipeline.logStats(std::cout);
+    pipeline.logLatencyHistograms(logDir);
+
+    return status;
+}
@@ -153,6 +153,8 @@ public:
     void saveFreeParameters(const std::string& fileName) const;
     void loadFreeParameters(const std::string& fileName,
                             bool ignoreNotExists = false);
+    std::vector<std::pair<std::string, BaseTensor*> >
+        getFreeParametersTensors();
     virtual ~BatchNormCell_Frame();
 
 protected:
@@ -295,6 +295,17 @@ public:
     virtual void loadFreeParameters(const std::string& /*fileName*/,
                                     bool /*ignoreNotExists*/ = false) {};
 
+    /**
+     * Get the named list of tensors holding the cell free parameters, in the
+     *same order as saveFreeParameters(). Used by the binary network
+     *checkpoint (see DeepNet::saveNetworkCheckpoint()).
+    */
+    virtual std::vector<std::pair<std::string, BaseTensor*> >
+    getFreeParametersTensors()
+    {
+        return std::vector<std::pair<std::string, BaseTensor*> >();
+    };
+
     /**
      * Export cell free parameters to a file, in ASCII format compatible between
      *the different cell models
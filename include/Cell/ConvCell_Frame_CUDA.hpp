@@ -114,6 +114,8 @@ public:
     void saveFreeParameters(const std::string& fileName) const;
     void loadFreeParameters(const std::string& fileName,
                             bool ignoreNotExists = false);
+    std::vector<std::pair<std::string, BaseTensor*> >
+        getFreeParametersTensors();
     void exportFreeParameters(const std::string& fileName) const;
     void importFreeParameters(const std::string& fileName,
                               bool ignoreNotExists = false);
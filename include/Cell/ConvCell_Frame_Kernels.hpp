@@ -82,6 +82,48 @@ namespace ConvCell_Frame_Kernels {
                       const Tensor<T>& diffInputs,
                       const T* beta,
                       Tensor<T>& diffBias);
+
+    // Half-precision specializations: data is stored in 16-bit but the
+    // computation is done in float, after a bulk conversion
+    template <>
+    void forward<half_float::half>(const half_float::half* alpha,
+                                   const Tensor<half_float::half>& inputs,
+                                   const Tensor<half_float::half>& sharedSynapses,
+                                   const Descriptor& desc,
+                                   const half_float::half* beta,
+                                   Tensor<half_float::half>& outputs,
+                                   const Tensor<bool>& maps);
+    template <>
+    void forwardBias<half_float::half>(const half_float::half* alpha,
+                                       const Tensor<half_float::half>& bias,
+                                       const half_float::half* beta,
+                                       Tensor<half_float::half>& outputs);
+    template <>
+    void backwardData<half_float::half>(const half_float::half* alpha,
+                                        const Tensor<half_float::half>&
+                                            sharedSynapses,
+                                        const Tensor<half_float::half>&
+                                            diffInputs,
+                                        const Descriptor& desc,
+                                        const half_float::half* beta,
+                                        Tensor<half_float::half>& diffOutputs,
+                                        const Tensor<bool>& maps);
+    template <>
+    void backwardFilter<half_float::half>(const half_float::half* alpha,
+                                          const Tensor<half_float::half>& inputs,
+                                          const Tensor<half_float::half>&
+                                            diffInputs,
+                                          const Descriptor& desc,
+                                          const half_float::half* beta,
+                                          Tensor<half_float::half>&
+                                            diffSharedSynapses,
+                                          const Tensor<bool>& maps);
+    template <>
+    void backwardBias<half_float::half>(const half_float::half* alpha,
+                                        const Tensor<half_float::half>&
+                                            diffInputs,
+                                        const half_float::half* beta,
+                                        Tensor<half_float::half>& diffBias);
 }
 }
 
@@ -23,6 +23,7 @@
 
 #include "Cell_Frame.hpp"
 #include "ConvCell_Frame_Kernels.hpp"
+#include "DeconvCell_Frame_Kernels.hpp"
 #include "DeconvCell.hpp"
 #include "DeepNet.hpp"
 #include "Activation/TanhActivation_Frame.hpp"
@@ -114,6 +115,8 @@ public:
     void saveFreeParameters(const std::string& fileName) const;
     void loadFreeParameters(const std::string& fileName,
                             bool ignoreNotExists = false);
+    std::vector<std::pair<std::string, BaseTensor*> >
+        getFreeParametersTensors();
     virtual ~DeconvCell_Frame();
 
 protected:
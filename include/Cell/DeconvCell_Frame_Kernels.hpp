@@ -0,0 +1,104 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_DECONVCELL_FRAME_KERNELS_H
+#define N2D2_DECONVCELL_FRAME_KERNELS_H
+
+#include <vector>
+#include "Cell/ConvCell_Frame_Kernels.hpp"
+#include "containers/Tensor.hpp"
+
+namespace N2D2 {
+
+/**
+ * Transposed convolution kernels for DeconvCell_Frame.
+ *
+ * Shared synapses dims are {kernelX, kernelY, nbOutputs, nbChannels} and the
+ * optional @p maps is the cell mapping, with maps(output, channel).
+ * The forward pass is computed, for each output map, as a GEMM of the
+ * weights with a block of input rows followed by a col2im scatter. For
+ * stride 2, the output is instead decomposed in its 4 sub-pixel phases, each
+ * one being a dense stride-1 convolution with the matching subset of the
+ * kernel taps.
+*/
+namespace DeconvCell_Frame_Kernels {
+    typedef ConvCell_Frame_Kernels::Descriptor Descriptor;
+
+    // Forward
+    template <class T>
+    void forward(const T* alpha,
+                 const Tensor<T>& inputs,
+                 const Tensor<T>& sharedSynapses,
+                 const Descriptor& desc,
+                 const T* beta,
+                 Tensor<T>& outputs,
+                 const Tensor<bool>& maps = Tensor<bool>());
+
+    // Backward
+    template <class T>
+    void backwardData(const T* alpha,
+                      const Tensor<T>& sharedSynapses,
+                      const Tensor<T>& diffInputs,
+                      const Descriptor& desc,
+                      const T* beta,
+                      Tensor<T>& diffOutputs,
+                      const Tensor<bool>& maps = Tensor<bool>());
+    template <class T>
+    void backwardFilter(const T* alpha,
+                        const Tensor<T>& inputs,
+                        const Tensor<T>& diffInputs,
+                        const Descriptor& desc,
+                        const T* beta,
+                        Tensor<T>& diffSharedSynapses,
+                        const Tensor<bool>& maps = Tensor<bool>());
+
+    // Half-precision specializations: computation is done in float
+    template <>
+    void forward<half_float::half>(const half_float::half* alpha,
+                                   const Tensor<half_float::half>& inputs,
+                                   const Tensor<half_float::half>& sharedSynapses,
+                                   const Descriptor& desc,
+                                   const half_float::half* beta,
+                                   Tensor<half_float::half>& outputs,
+                                   const Tensor<bool>& maps);
+    template <>
+    void backwardData<half_float::half>(const half_float::half* alpha,
+                                        const Tensor<half_float::half>&
+                                            sharedSynapses,
+                                        const Tensor<half_float::half>&
+                                            diffInputs,
+                                        const Descriptor& desc,
+                                        const half_float::half* beta,
+                                        Tensor<half_float::half>& diffOutputs,
+                                        const Tensor<bool>& maps);
+    template <>
+    void backwardFilter<half_float::half>(const half_float::half* alpha,
+                                          const Tensor<half_float::half>& inputs,
+                                          const Tensor<half_float::half>&
+                                            diffInputs,
+                                          const Descriptor& desc,
+                                          const half_float::half* beta,
+                                          Tensor<half_float::half>&
+                                            diffSharedSynapses,
+                                          const Tensor<bool>& maps);
+}
+}
+
+#endif // N2D2_DECONVCELL_FRAME_KERNELS_H
@@ -56,7 +56,13 @@ public:
     virtual ~DropoutCell_Frame();
 
 protected:
-    Tensor<char> mMask;
+    void applyMask(const T* input,
+                   T* output,
+                   unsigned int size,
+                   unsigned int maskOffset) const;
+
+    /// Dropout mask, packed as a bitset (one bit per output)
+    Tensor<unsigned long long> mMask;
 
 private:
     static Registrar<DropoutCell> mRegistrar;
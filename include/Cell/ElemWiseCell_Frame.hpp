@@ -26,8 +26,14 @@
 #include "ElemWiseCell.hpp"
 
 namespace N2D2 {
-class ElemWiseCell_Frame : public virtual ElemWiseCell, public Cell_Frame<Float_T> {
+template <class T>
+class ElemWiseCell_Frame : public virtual ElemWiseCell, public Cell_Frame<T> {
 public:
+    using Cell_Frame<T>::mInputs;
+    using Cell_Frame<T>::mOutputs;
+    using Cell_Frame<T>::mDiffInputs;
+    using Cell_Frame<T>::mDiffOutputs;
+
     ElemWiseCell_Frame(const DeepNet& deepNet, const std::string& name,
                    unsigned int nbOutputs,
                    Operation operation = Sum,
@@ -61,11 +67,40 @@ public:
     virtual void backPropagate();
     virtual void update();
     void checkGradient(double epsilon = 1.0e-4, double maxError = 1.0e-6);
+    bool isInPlace(bool inference = false) const
+    {
+        return (mInPlaceInput && inference);
+    };
     virtual ~ElemWiseCell_Frame();
 
 protected:
-    Tensor<Float_T> mInterTerm;
+    void sum(const std::vector<const T*>& inputs,
+             T* outputs,
+             unsigned int size) const;
+    void absSum(const std::vector<const T*>& inputs,
+                T* outputs,
+                unsigned int size) const;
+    void euclideanSum(const std::vector<const T*>& inputs,
+                      T* outputs,
+                      unsigned int size);
+    void prod(const std::vector<const T*>& inputs,
+              T* outputs,
+              unsigned int size) const;
+    void max(const std::vector<const T*>& inputs,
+             T* outputs,
+             unsigned int size);
+
+    /// If true, the Sum operation accumulates directly in the first input
+    /// buffer, which is then swapped with the outputs buffer. This is only
+    /// effective in inference, if the first input is the whole outputs of a
+    /// Frame cell of the same type that has no other child. The parent
+    /// outputs are overwritten, so that in training they would no longer be
+    /// available to its back-propagation.
+    Parameter<bool> mInPlace;
+
+    Tensor<T> mInterTerm;
     Tensor<unsigned int> mArgMax;
+    bool mInPlaceInput;
 
 private:
     static Registrar<ElemWiseCell> mRegistrar;
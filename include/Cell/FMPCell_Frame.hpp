@@ -24,6 +24,7 @@
 #include "Cell_Frame.hpp"
 #include "DeepNet.hpp"
 #include "FMPCell.hpp"
+#include "PoolCell_Frame_Kernels_struct.hpp"
 
 namespace N2D2 {
 class FMPCell_Frame : public virtual FMPCell, public Cell_Frame<Float_T> {
@@ -58,13 +59,26 @@ protected:
     void generateRegions(std::vector<unsigned int>& grid,
                          unsigned int sizeIn,
                          unsigned int sizeOut);
+    void computeRegionsBounds(const std::vector<unsigned int>& grid,
+                              unsigned int sizeIn,
+                              std::vector<unsigned int>& start,
+                              std::vector<unsigned int>& stop) const;
 
     std::vector<unsigned int> mGridX;
     std::vector<unsigned int> mGridY;
 
-    // mInputsBackProp (ix, iy, channel, batchPos)
-    // list of the output node(s) to backpropagate from] (for Max pooling)
-    Tensor<std::vector<unsigned int> > mInputsBackProp;
+    // Pooling regions bounds [start, stop] for each output, computed once
+    // per batch from mGridX and mGridY and shared by all the threads
+    std::vector<unsigned int> mRegionsStartX;
+    std::vector<unsigned int> mRegionsStopX;
+    std::vector<unsigned int> mRegionsStartY;
+    std::vector<unsigned int> mRegionsStopY;
+
+    // mArgMax (ox, oy, output, batchPos)
+    // input node from which each output was taken (for backpropagation)
+    Tensor<PoolCell_Frame_Kernels::ArgMax> mArgMax;
+    // Outputs connected to each channel, for the backpropagation
+    std::vector<std::vector<unsigned int> > mChannelsOutputs;
     bool mLockRandom;
 
 private:
@@ -53,10 +53,31 @@ public:
     virtual void initialize();
     virtual void propagate(bool inference = false);
     virtual void backPropagate();
+    virtual double setOutputTarget(const Tensor<int>& targets,
+                                   double targetVal = 1.0,
+                                   double defaultVal = 0.0);
+    virtual double setOutputTargets(const Tensor<int>& targets,
+                                    double targetVal = 1.0,
+                                    double defaultVal = 0.0);
+    using Cell_Frame<T>::setOutputTargets;
     virtual void update();
     void checkGradient(double epsilon = 1.0e-4, double maxError = 1.0e-6);
     virtual ~SoftmaxCell_Frame() {};
 
+protected:
+    double setOutputTargetsFused(const Tensor<int>& targets,
+                                 double targetVal,
+                                 double defaultVal,
+                                 bool balanced);
+
+    /// If true (requires WithLoss), the error and the cross-entropy loss are
+    /// computed together in a single pass by setOutputTarget(s)(), using the
+    /// log-sum-exp stored during propagation
+    Parameter<bool> mFusedLoss;
+
+    // Log-sum-exp of the inputs, for each position (only when mFusedLoss)
+    Tensor<T> mLogSumExp;
+
 private:
     static Registrar<SoftmaxCell> mRegistrar;
 };
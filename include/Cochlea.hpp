@@ -28,9 +28,13 @@
 #include <vector>
 
 #include "utils/Parameterizable.hpp"
+#include "Aer.hpp"
 #include "Network.hpp"
+#include "Sound.hpp"
 
 namespace N2D2 {
+class Environment;
+
 class Cochlea : public Parameterizable {
 public:
     enum FilterSpace {
@@ -80,11 +84,133 @@ public:
                       double minBw = 24.7,
                       double start = 0.0,
                       double end = 0.0);
+
+    /**
+     * Same as load(), but the audio file is read and processed by blocks of
+     *@p blockSize samples with the streaming engine (see initializeStream()),
+     *so that the memory usage does not depend on the duration of the audio
+     *file. The events are appended to the AER file as they are generated.
+     *
+     * @return The total number of events generated.
+    */
+    unsigned int loadStream(const std::string& fileName,
+                            unsigned int order,
+                            double lowFreq,
+                            double upFreq,
+                            double threshold,
+                            Time_T leak = 1 * TimeMs,
+                            Time_T refractory = 5 * TimeMs,
+                            FilterSpace filterSpace = ErbSpace,
+                            double earQ = 9.26449,
+                            double minBw = 24.7,
+                            double start = 0.0,
+                            double end = 0.0,
+                            unsigned int blockSize = 4096);
+
+    /**
+     * Initialize the streaming engine, which processes an audio signal block
+     *by block with processBlock(). The parameters are the same as for load().
+     * The filters of all the channels are evaluated together, sample by
+     *sample, in a bank where the coefficients and the state of each filter
+     *are stored channel-major.
+     *
+     * @param samplingFrequency Sampling frequency of the audio signal
+    */
+    void initializeStream(unsigned int samplingFrequency,
+                          unsigned int order,
+                          double lowFreq,
+                          double upFreq,
+                          double threshold,
+                          Time_T leak = 1 * TimeMs,
+                          Time_T refractory = 5 * TimeMs,
+                          FilterSpace filterSpace = ErbSpace,
+                          double earQ = 9.26449,
+                          double minBw = 24.7);
+
+    /**
+     * Reset the state of the streaming engine (filters, neurons and time).
+    */
+    void resetStream();
+
+    /**
+     * Process the next block of the audio signal. The state of the filters
+     *and the neurons is kept between calls.
+     *
+     * @param samples       Audio samples of the block
+     * @param events        Vector to append the generated events to, sorted
+     *by timestamp
+     * @return The number of events generated for this block.
+    */
+    unsigned int processBlock(const std::vector<double>& samples,
+                              Aer::AerData_T& events);
+
+    /**
+     * Process the next block of the audio signal and add the generated events
+     *to the event queue of the simulator, for the nodes of the first channel
+     *of @p env (node i for the i-th filter).
+     *
+     * @param samples       Audio samples of the block
+     * @param env           Environment to emit the events into
+     * @param offset        Offset to add to the timestamp of the events
+     * @return The number of events generated for this block.
+    */
+    unsigned int processBlock(const std::vector<double>& samples,
+                              Environment& env,
+                              Time_T offset = 0);
     virtual ~Cochlea() {};
 
 private:
+    /// Bank of IIR filters of the same order, one per channel. Coefficients
+    /// and states are stored channel-major ([tap][channel]) so that
+    /// consecutive channels are processed in SIMD lanes.
+    struct FilterBank {
+        FilterBank(unsigned int nbChannels_ = 0,
+                   unsigned int nbB_ = 0,
+                   unsigned int nbA_ = 0);
+        void setFilter(unsigned int channel, const Sound::Filter_T& filter);
+        void reset();
+        /// Filter in place the sample @p n of channels [@p first, @p last[,
+        /// @p signal pointing to channel @p first
+        void apply(double* signal,
+                   unsigned int first,
+                   unsigned int last,
+                   unsigned long long int n);
+
+        unsigned int nbChannels;
+        unsigned int nbB;
+        unsigned int nbA;
+        std::vector<double> b;
+        std::vector<double> a;
+        std::vector<double> invGain;
+        /// Last nbB inputs, sample m being stored at row m % nbB
+        std::vector<double> x;
+        /// Last nbA outputs, sample m being stored at row m % nbA
+        std::vector<double> y;
+    };
+
+    double centerFrequency(unsigned int channel,
+                           double lowFreq,
+                           double upFreq,
+                           FilterSpace filterSpace,
+                           double earQ,
+                           double minBw) const;
+
     unsigned int mNbChannels;
 
+    // Streaming engine
+    std::vector<FilterBank> mStreamFilters;
+    FilterBank mStreamLowPass;
+    std::vector<double> mStreamThresholds;
+    double mStreamExpLeak;
+    double mStreamSamplingPeriod;
+    Time_T mStreamDt;
+    Time_T mStreamRefractory;
+    bool mStreamStochastic;
+    /// Number of samples processed since the last reset
+    unsigned long long int mStreamSample;
+    std::vector<double> mStreamIntegration;
+    std::vector<Time_T> mStreamRefractoryEnd;
+
     // Parameters
     Parameter<bool> mNormalize;
 };
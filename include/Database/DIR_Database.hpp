@@ -21,6 +21,8 @@
 #ifndef N2D2_DIR_DATABASE_H
 #define N2D2_DIR_DATABASE_H
 
+#include <map>
+
 #include "Database/Database.hpp"
 
 namespace N2D2 {
@@ -58,10 +60,35 @@ public:
     virtual ~DIR_Database() {};
 
 protected:
+    /// Raw content of a directory, before masks and extensions filtering
+    struct DirEntry {
+        /// Modification time of the directory (-1 if it must be rescanned)
+        long long int mtime;
+        std::vector<std::string> files;
+        std::vector<std::string> subDirs;
+
+        DirEntry() : mtime(-1) {}
+    };
+
     virtual void loadFile(const std::string& fileName, int label);
+    void scanDirs(const std::string& dirPath, int depth);
+    static void scanDir(const std::string& dirPath, DirEntry& entry);
+    void addDir(const std::string& dirPath,
+                int depth,
+                const std::string& labelName,
+                int labelDepth);
+    bool isMasked(const std::string& filePath, bool notice = true) const;
+    void loadManifest(const std::string& fileName);
+    void saveManifest(const std::string& fileName) const;
+
+    /// If not empty, the directories content is saved in this file and only
+    /// the directories modified since are rescanned on the next load
+    Parameter<std::string> mManifestFile;
 
     std::vector<std::string> mIgnoreMasks;
     std::vector<std::string> mValidExtensions;
+    std::map<std::string, DirEntry> mDirs;
+    bool mManifestLoaded;
 };
 }
 
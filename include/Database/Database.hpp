@@ -47,6 +47,7 @@
 #endif
 
 #include "Transformation/CompositeTransformation.hpp"
+#include "utils/MemoryMappedFile.hpp"
 #include "utils/Parameterizable.hpp"
 #include "utils/Utils.hpp"
 
@@ -73,6 +74,30 @@ public:
     /// partitioning.
     typedef unsigned int StimulusID;
 
+    /**
+     * Location of a stimulus stored raw in a packed dataset file (like CIFAR
+     * or IDX), which is memory-mapped instead of being converted to
+     * individual image files.
+    */
+    struct StimulusBlob {
+        std::shared_ptr<MemoryMappedFile> file;
+        size_t offset;
+        int rows;
+        int cols;
+        int channels;
+        /// OpenCV depth of the data (CV_8U, ...)
+        int depth;
+        /// If true, the channels are stored one after the other, in RGB
+        /// order. Otherwise, the data is interleaved, in OpenCV order.
+        bool planar;
+
+        StimulusBlob()
+            : offset(0), rows(0), cols(0), channels(0), depth(CV_8U),
+              planar(false)
+        {
+        }
+    };
+
     /**
      * The Stimulus object contains the in-memory fields associated to each
      * stimulus.
@@ -87,6 +112,9 @@ public:
         /// ROIs associated to the stimulus
         std::vector<ROI*> ROIs;
         ROI* slice;
+        /// If the stimulus data is in a packed dataset file (file is NULL
+        /// otherwise). The name is then a virtual file name.
+        StimulusBlob blob;
 
         Stimulus(const std::string& name_,
                  int label_ = -1,
@@ -318,6 +346,8 @@ protected:
     getRelPathStimuli(const std::string& fileName, const std::string& relPath);
     int labelID(const std::string& labelName);
     cv::Mat loadStimulusData(StimulusID id);
+    cv::Mat readStimulus(StimulusID id) const;
+    static cv::Mat readStimulusBlob(const StimulusBlob& blob);
     cv::Mat loadStimulusLabelsData(StimulusID id) const;
     virtual cv::Mat loadStimulusTargetData(StimulusID /*id*/)
         { return cv::Mat(); };
@@ -67,6 +67,9 @@ public:
                                      bool ignoreNotExists = false);
     void importNetworkFreeParameters(const std::string& dirName, const std::string& weightName);
     void importNetworkSolverParameters(const std::string& dirName);
+    void saveNetworkCheckpoint(const std::string& fileName) const;
+    void loadNetworkCheckpoint(const std::string& fileName,
+                               bool ignoreNotExists = false);
     void checkGradient(double epsilon = 1.0e-4, double maxError = 1.0e-6);
     void initialize();
     void learn(std::vector<std::pair<std::string, double> >* timings = NULL);
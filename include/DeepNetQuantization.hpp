@@ -68,9 +68,9 @@ private:
     static void quantizeFreeParemeters(Cell& cell, std::size_t nbBits);
 
     static double getCellThreshold(const std::string& cellName,
-                                   const std::unordered_map<std::string, Histogram>& outputsHistogram,
+                                   const std::unordered_map<std::string, double>& outputsThreshold,
                                    const std::unordered_map<std::string, RangeStats>& outputsRange,
-                                   std::size_t nbBits, ClippingMode actClippingMode);
+                                   ClippingMode actClippingMode);
     
     static void rescaleActivationOutputs(const Cell& cell, Activation& activation,
                                          double scalingFactor, double prevScalingFactor);
@@ -23,6 +23,7 @@
 
 #include <functional>
 #include <string>
+#include <vector>
 
 #include "FloatT.hpp"
 #include "controler/Interface.hpp"
@@ -33,8 +34,40 @@ class BaseTensor;
 template<typename T>
 class Tensor;
 
+/// Settings common to all the gradient checks
+class GradientCheckBase {
+public:
+    /**
+     * Check a random sample of the elements of each tensor instead of all of
+     * them. The sample size is chosen so that a tensor in which at least a
+     * fraction @p errorRate of the gradients are wrong fails the check with
+     * probability @p confidence.
+     *
+     * @param errorRate     Fraction of wrong gradients to detect (0 = check
+     *all the elements)
+     * @param confidence    Detection probability
+    */
+    static void setSampling(double errorRate, double confidence = 0.99)
+    {
+        mErrorRate = errorRate;
+        mConfidence = confidence;
+    };
+    /// Number of elements checked in a tensor of @p size elements
+    static size_t getNbSamples(size_t size);
+
+protected:
+    static double mErrorRate;
+    static double mConfidence;
+};
+
+/**
+ * Finite-difference gradient check. When the perturbed tensor is a cell input
+ * (one slice per batch sample) and the cell processes the batch samples
+ * independently, one element of each sample is perturbed for each forward
+ * pass and the cost is evaluated per sample.
+*/
 template <class T>
-class GradientCheck {
+class GradientCheck : public GradientCheckBase {
 public:
     typedef std::function<void(bool)> PropagateType;
     typedef std::function<void(void)> BackPropagateType;
@@ -46,17 +79,27 @@ public:
                     PropagateType propagate,
                     BackPropagateType backPropagate,
                     bool avoidDiscontinuity = false);
+    /**
+     * @param cellInput     The tensor is a cell input, whose last dimension
+     *                      is the batch: its batch samples are perturbed
+     *                      together if the cell is found to be batch
+     *                      independent
+    */
     template <class U>
     void check(const std::string& tensorName,
                Tensor<U>& inputs,
-               Tensor<U>& diffOutputs);
+               Tensor<U>& diffOutputs,
+               bool cellInput = false);
     void check(const std::string& tensorName,
                BaseTensor& inputs,
-               BaseTensor& diffOutputs);
+               BaseTensor& diffOutputs,
+               bool cellInput = false);
     virtual ~GradientCheck();
 
 private:
-    double cost() const;
+    template <class U>
+    bool isBatchIndependent(Tensor<U>& tensor, unsigned int& nbPropagates);
+    void costs(std::vector<double>& batchCosts) const;
 
     double mEpsilon;
     double mMaxError;
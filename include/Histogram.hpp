@@ -22,7 +22,9 @@
 #ifndef N2D2_HISTOGRAM_H
 #define N2D2_HISTOGRAM_H
 
+#include <algorithm>
 #include <iosfwd>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -88,6 +90,16 @@ public:
 
     double calibrateMSE(std::size_t nbBits) const;
     double calibrateKLDivergence(std::size_t nbBits) const;
+
+    /**
+     * Calibrate the threshold of every histogram of @p outputsHistogram with
+     * @p clippingMode. The candidate thresholds of all the histograms are
+     * evaluated in a single parallel loop. The thresholds are the same as
+     * the ones returned by calibrateMSE() or calibrateKLDivergence().
+     */
+    static std::unordered_map<std::string, double> calibrateOutputsHistogram(
+                    const std::unordered_map<std::string, Histogram>& outputsHistogram,
+                    std::size_t nbBits, ClippingMode clippingMode);
     
     void save(std::ostream& state) const;
     void load(std::istream& state);
@@ -105,6 +117,42 @@ public:
                     std::size_t nbBits, ClippingMode clippingMode);
 
 private:
+    /**
+     * Threshold search state. Each candidate threshold is first evaluated
+     * in O(target bins) from cumulative bin sums. Only the candidates close
+     * to the minimum are then evaluated again with the reference
+     * MSE() or KLDivergence(), so that the selected threshold is exactly
+     * the same.
+     */
+    struct Calibration {
+        // Candidate thresholds, in decreasing order
+        std::vector<double> thresholds;
+        // Approximated MSE or KL divergence for each threshold
+        std::vector<double> criterion;
+        // Cumulative sums of count, count*value and count*value^2 over the
+        // bins (getNbBins() + 1 elements, first one is 0)
+        std::vector<std::size_t> cumCounts;
+        std::vector<double> cumMoment1;
+        std::vector<double> cumMoment2;
+        // Sum of p*log(p) over the bins (KL divergence)
+        double pLogP;
+        // Upper bound of the approximation error on the criterion
+        double tolerance;
+    };
+
+    static std::size_t binIdx(double value, double minVal, double maxVal,
+                              std::size_t nbBins);
+
+    double calibrate(std::size_t nbBits, ClippingMode clippingMode) const;
+    Calibration prepareCalibration(ClippingMode clippingMode) const;
+    double calibrationCriterion(const Calibration& calibration,
+                                double threshold,
+                                std::size_t nbBits,
+                                ClippingMode clippingMode) const;
+    double selectThreshold(const Calibration& calibration,
+                           std::size_t nbBits,
+                           ClippingMode clippingMode) const;
+
     static double KLDivergence(const Histogram& ref, const Histogram& quant);
 
     double MSE(double threshold, std::size_t nbBits) const;
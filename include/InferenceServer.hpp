@@ -0,0 +1,175 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_INFERENCESERVER_H
+#define N2D2_INFERENCESERVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "containers/Tensor.hpp"
+#include "FloatT.hpp"
+
+namespace N2D2 {
+
+class DeepNet;
+class Target;
+
+/**
+ * Dynamic batching inference server. Requests (single stimuli) are queued and
+ * coalesced into batches of up to the StimuliProvider batch size: a batch is
+ * run as soon as it is full, or when the oldest pending request has waited for
+ * the maximum batching latency. Each request is streamed in its own batch
+ * position (StimuliProvider::streamStimulus()), the batch is processed with
+ * DeepNet::test() and the target estimated labels are scattered back.
+ *
+ * Requests can be submitted in-process with submit(), or through a Unix
+ * domain socket with listen(). Socket protocol, native byte order:
+ * - request: uint32 size, followed by @p size bytes of an encoded image (any
+ *   format supported by cv::imdecode()). The payload of a request larger
+ *   than the maximum request size is discarded without being stored, and an
+ *   error is returned;
+ * - response: int32 status (0 on success), uint32 number of values N,
+ *   followed by N x (int32 estimated label, float32 estimated value). On
+ *   error, the status is -1 and N is the size of the error message that
+ *   follows.
+*/
+class InferenceServer {
+public:
+    struct Result {
+        /// Estimated labels for the request, dims (X, Y, nbTargets)
+        Tensor<int> estimatedLabels;
+        /// Estimated labels values for the request, dims (X, Y, nbTargets)
+        Tensor<Float_T> estimatedLabelsValue;
+    };
+
+    struct Metrics {
+        Metrics()
+            : nbRequests(0),
+              nbBatches(0),
+              queueLatency(0.0),
+              maxQueueLatency(0.0),
+              batchTime(0.0),
+              elapsed(0.0) {};
+
+        /// Average number of requests per batch
+        double batchSize() const
+        {
+            return (nbBatches > 0) ? nbRequests / (double)nbBatches : 0.0;
+        };
+        /// Requests processed per second, since the first request
+        double throughput() const
+        {
+            return (elapsed > 0.0) ? nbRequests / elapsed : 0.0;
+        };
+
+        unsigned long long nbRequests;
+        unsigned long long nbBatches;
+        /// Average time spent in the queue by a request (s)
+        double queueLatency;
+        double maxQueueLatency;
+        /// Average processing time of a batch (s)
+        double batchTime;
+        double elapsed;
+    };
+
+    /**
+     * @param deepNet       Initialized network, its StimuliProvider batch
+     *                      size is the maximum batch size
+     * @param maxLatency    Maximum time (s) a request can wait for the batch
+     *                      to fill up
+     * @param targetIndex   Index of the target whose estimated labels are
+     *                      returned
+     * @param maxRequestSize Maximum size (bytes) of a socket request. The
+     *                      default of 64 MB accepts encoded frames much larger
+     *                      than the network input, which are resized by the
+     *                      StimuliProvider
+    */
+    InferenceServer(const std::shared_ptr<DeepNet>& deepNet,
+                    double maxLatency = 0.01,
+                    unsigned int targetIndex = 0,
+                    size_t maxRequestSize = 64 * 1024 * 1024);
+    std::future<Result> submit(const cv::Mat& mat);
+    Result process(const cv::Mat& mat)
+    {
+        return submit(mat).get();
+    };
+
+    /**
+     * Serve requests on a Unix domain socket (blocking, one thread per
+     * client), until stop() is called.
+     *
+     * @param socketPath    Socket file path (removed first if it exists)
+    */
+    void listen(const std::string& socketPath);
+    void stop();
+    Metrics getMetrics() const;
+    void resetMetrics();
+    void logMetrics(std::ostream& os) const;
+    virtual ~InferenceServer();
+
+private:
+    typedef std::chrono::steady_clock Clock_T;
+
+    struct Request {
+        cv::Mat mat;
+        std::promise<Result> result;
+        Clock_T::time_point arrival;
+    };
+
+    void run();
+    void processBatch(std::vector<Request>& batch);
+    void serveClient(int fd);
+
+    const std::shared_ptr<DeepNet> mDeepNet;
+    const std::shared_ptr<Target> mTarget;
+    const unsigned int mBatchSize;
+    const Clock_T::duration mMaxLatency;
+    const size_t mMaxRequestSize;
+
+    std::deque<Request> mQueue;
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop;
+    std::thread mWorker;
+
+    // Socket server
+    int mListenFd;
+    std::set<int> mClientFds;
+    std::vector<std::thread> mClients;
+    /// Client threads that returned, to be joined on the next connection
+    std::set<std::thread::id> mFinishedClients;
+
+    // Metrics
+    Metrics mMetrics;
+    bool mFirstRequest;
+    Clock_T::time_point mStartTime;
+};
+}
+
+#endif // N2D2_INFERENCESERVER_H
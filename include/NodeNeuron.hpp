@@ -159,6 +159,14 @@ public:
         return mLinks.size();
     };
 
+    /**
+     * Freeze the synaptic links into contiguous arrays, sorted by input node
+     *ID, with a direct ID to synapse lookup table when the input node IDs are
+     *dense enough. This is done automatically when the network is initialized
+     *and again if a link is added afterwards.
+    */
+    void compileLinks();
+
     /// Destructor.
     virtual ~NodeNeuron();
 
@@ -177,6 +185,8 @@ protected:
     virtual void finalize() {};
 
     virtual Synapse* newSynapse() const = 0;
+    inline Synapse* getLink(Node* origin) const;
+    inline unsigned int getLinkPosition(Node* origin) const;
     virtual void saveInternal(std::ofstream& /*dataFile*/) const {};
     virtual void loadInternal(std::ifstream& /*dataFile*/) {};
     virtual void logStatePlot() = 0;
@@ -195,6 +205,18 @@ protected:
     /// Map containing the synapses of the neuron, associated to their input
     /// neurons
     std::unordered_map<Node*, Synapse*> mLinks;
+    /// Input nodes of the compiled links, sorted by node ID
+    std::vector<Node*> mLinkNodes;
+    /// Synapses of the compiled links, in the same order as mLinkNodes
+    std::vector<Synapse*> mLinkSynapses;
+    /// Position in mLinkSynapses for each input node ID, starting at
+    /// mLinkIdOffset (-1 if not connected). Empty if the IDs are too sparse.
+    std::vector<int> mLinkIndex;
+    /// Position in mLinkSynapses for each input node, only used when
+    /// mLinkIndex is empty
+    std::unordered_map<Node*, unsigned int> mLinkPositions;
+    NodeId_T mLinkIdOffset;
+    bool mLinksCompiled;
     /// File stream to store the state of the neuron
     std::ofstream mStateLog; // Note: using fstream makes this class
     // automatically non-copyable
@@ -208,4 +230,41 @@ protected:
 };
 }
 
+N2D2::Synapse* N2D2::NodeNeuron::getLink(Node* origin) const
+{
+    if (!mLinkIndex.empty()) {
+        // Unsigned wrap-around takes care of IDs below the offset
+        const NodeId_T pos = origin->getId() - mLinkIdOffset;
+
+        if (pos < mLinkIndex.size() && mLinkIndex[pos] >= 0)
+            return mLinkSynapses[mLinkIndex[pos]];
+    } else {
+        const std::unordered_map<Node*, Synapse*>::const_iterator it
+            = mLinks.find(origin);
+
+        if (it != mLinks.end())
+            return (*it).second;
+    }
+
+    throw std::logic_error("Synaptic link does not exist!");
+}
+
+unsigned int N2D2::NodeNeuron::getLinkPosition(Node* origin) const
+{
+    if (!mLinkIndex.empty()) {
+        const NodeId_T pos = origin->getId() - mLinkIdOffset;
+
+        if (pos < mLinkIndex.size() && mLinkIndex[pos] >= 0)
+            return mLinkIndex[pos];
+    } else {
+        const std::unordered_map<Node*, unsigned int>::const_iterator it
+            = mLinkPositions.find(origin);
+
+        if (it != mLinkPositions.end())
+            return (*it).second;
+    }
+
+    throw std::logic_error("Synaptic link does not exist!");
+}
+
 #endif // N2D2_NODENEURON_H
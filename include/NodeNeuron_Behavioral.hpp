@@ -27,6 +27,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "NodeNeuron.hpp"
 #include "Synapse_Behavioral.hpp"
@@ -102,6 +103,7 @@ private:
     };
 
     void initialize();
+    void finalize();
     virtual Synapse* newSynapse() const;
     virtual void saveInternal(std::ofstream& dataFile) const;
     virtual void loadInternal(std::ifstream& dataFile);
@@ -112,6 +114,10 @@ private:
                         double weightIncrement) const;
     void decreaseWeight(Synapse_Behavioral* synapse,
                         double weightDecrement) const;
+    void initializeTrace();
+    void traceLtpFifo(unsigned int pos);
+    void traceStdp(Time_T timestamp);
+    void flushTrace(unsigned int pos);
 
     // Parameters
     /// Synaptic incoming delay \f$w_{delay}\f$
@@ -156,6 +162,12 @@ private:
     Parameter<Weight_T> mWeightBias;
     Parameter<Time_T> mStdpLtd;
     Parameter<bool> mBiologicalStdp;
+    /// If true, use the trace-based STDP engine: on a post-synaptic spike,
+    /// only the synapses active in the STDP window are updated, the default
+    /// update of the others (LTD) being deferred until their weight is needed.
+    /// The resulting weights are the same as with the default engine. Must be
+    /// set before the first run.
+    Parameter<bool> mTraceStdp;
 
     // Internal variables
     /// Neuron's integration, or membrane potential
@@ -175,6 +187,24 @@ private:
     Time_T mRefractoryEnd;
     Time_T mLastStdp;
     std::deque<Synapse_Behavioral*> mLtpFifo;
+
+    // Trace-based STDP, indexed by link position (see
+    // NodeNeuron::compileLinks())
+    /// Last pre-synaptic spike time of each link
+    std::vector<Time_T> mTracePreTime;
+    /// Number of post-synaptic STDP events already applied to each link
+    std::vector<unsigned int> mTraceStdpDone;
+    /// Number of post-synaptic STDP events since the beginning
+    unsigned int mTraceStdpCnt;
+    /// Pre-synaptic spikes (time, link position) that may still be in the
+    /// STDP window, in time order
+    std::deque<std::pair<Time_T, unsigned int> > mTraceActive;
+    /// LTP FIFO (OrderStdp > 0): last access stamp of each link (0 if not in
+    /// the FIFO) and access history (link position, stamp)
+    std::vector<unsigned long long int> mTraceFifoStamp;
+    std::deque<std::pair<unsigned int, unsigned long long int> > mTraceFifo;
+    unsigned int mTraceFifoSize;
+    unsigned long long int mTraceFifoCnt;
 };
 }
 
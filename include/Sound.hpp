@@ -32,6 +32,7 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -86,6 +87,28 @@ public:
     }
     void
     load(const std::string& fileName, double start = 0.0, double end = 0.0);
+
+    /**
+     * Open a WAV file to read it block by block with readBlock(), instead of
+     *loading it entirely in memory with load(). Only the header is read.
+     *
+     * @param fileName      Audio file name (must be in the WAV format)
+     * @param start         Read the audio file starting from this time
+     * @param end           Stop reading the audio file after this time (only
+     *if > 0)
+    */
+    void openStream(const std::string& fileName,
+                    double start = 0.0,
+                    double end = 0.0);
+
+    /**
+     * Read the next block of at most @p nbSamples samples per channel from the
+     *file opened with openStream(). The block replaces the current audio data.
+     *
+     * @param nbSamples     Maximum number of samples per channel to read
+     * @return Number of samples read per channel (0 at the end of the stream)
+    */
+    unsigned int readBlock(unsigned int nbSamples);
     void loadSignal(const std::string& fileName,
                     unsigned int samplingFrequency = 0);
     void normalize(unsigned int channel, double value = 0.0);
@@ -298,10 +321,16 @@ private:
     template <typename T1, typename T2>
     static std::complex<T1> evaluatePolynomial(const std::vector<T2>& poly,
                                                const std::complex<T1>& z);
+    unsigned int readHeader(std::istream& data, const std::string& fileName);
+    int readSample(std::istream& data) const;
 
     unsigned int mSamplingFrequency;
     unsigned short mBitPerSample;
     std::vector<std::vector<double> > mData;
+    /// File opened with openStream()
+    std::shared_ptr<std::ifstream> mStream;
+    /// Number of samples per channel left to read in mStream
+    unsigned int mStreamRemaining;
 };
 }
 
@@ -318,7 +347,7 @@ template <class InputIterator>
 N2D2::Sound::Sound(InputIterator first,
                    InputIterator last,
                    unsigned int samplingFrequency)
-    : mData(1, std::vector<double>(first, last))
+    : mData(1, std::vector<double>(first, last)), mStreamRemaining(0)
 {
     if (samplingFrequency > 0)
         mSamplingFrequency = samplingFrequency;
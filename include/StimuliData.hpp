@@ -23,11 +23,13 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "FloatT.hpp"
+#include "containers/Tensor.hpp"
 #include "Database/Database.hpp"
 #include "utils/Parameterizable.hpp"
 
@@ -63,6 +65,44 @@ public:
         double stdDev;
     };
 
+    /// Half-width of the 95% confidence interval of the global mean and std.
+    /// dev., when they are estimated on a sample of the stimuli (see the
+    /// SampleRatio parameter)
+    struct Confidence {
+        Confidence(double mean_ = 0.0, double stdDev_ = 0.0)
+            : mean(mean_), stdDev(stdDev_)
+        {
+        }
+        double mean;
+        double stdDev;
+    };
+
+    /// Running count, mean, sum of squared deviations (M2), min and max of a
+    /// series of values (Welford's method). Two accumulators computed on
+    /// disjoint subsets can be merged with Chan et al. parallel formula.
+    struct Accumulator {
+        Accumulator()
+            : count(0),
+              mean(0.0),
+              M2(0.0),
+              minVal(std::numeric_limits<double>::max()),
+              maxVal(-std::numeric_limits<double>::max())
+        {
+        }
+        inline void push(double x);
+        inline void merge(const Accumulator& acc);
+        double variance(bool unbiased = true) const
+        {
+            return (count > 1) ? M2 / ((unbiased) ? count - 1 : count) : 0.0;
+        }
+
+        unsigned long long int count;
+        double mean;
+        double M2;
+        double minVal;
+        double maxVal;
+    };
+
     StimuliData(const std::string& name, StimuliProvider& provider);
     StimuliData(const StimuliData& stimuliData);
     unsigned int generate(Database::StimuliSetMask setMask = Database::All,
@@ -84,6 +124,16 @@ public:
     {
         return mGlobalValue;
     }
+    const Confidence& getGlobalValueConfidence() const
+    {
+        return mGlobalValueConfidence;
+    }
+    /// Total number of stimuli in the analysed sets (the number of stimuli
+    /// actually processed is lower when SampleRatio < 1)
+    unsigned int getNbStimuliPopulation() const
+    {
+        return mNbStimuliPopulation;
+    }
 
     // Log
     void logSizeRange() const;
@@ -95,6 +145,34 @@ public:
 private:
     bool loadDataCache(const std::string& fileName);
     void saveDataCache(const std::string& fileName) const;
+    void computeConfidence();
+
+    struct DataAccumulator {
+        DataAccumulator() : count(0) {}
+        void push(const Tensor<Float_T>& data);
+        void merge(const DataAccumulator& acc);
+
+        unsigned long long int count;
+        std::vector<size_t> dims;
+        std::vector<double> mean;
+        std::vector<double> M2;
+    };
+
+    typedef std::vector<std::pair<Database::StimuliSet, unsigned int> >
+        StimuliList_T;
+
+    bool loadPartial(const std::string& fileName,
+                     const StimuliList_T& stimuli,
+                     unsigned int& loaded,
+                     Accumulator& globalAcc,
+                     DataAccumulator& dataAcc,
+                     bool& dataMismatch);
+    void savePartial(const std::string& fileName,
+                     const StimuliList_T& stimuli,
+                     unsigned int loaded,
+                     const Accumulator& globalAcc,
+                     const DataAccumulator& dataAcc,
+                     bool dataMismatch) const;
 
     const std::string mName;
     StimuliProvider& mProvider;
@@ -102,6 +180,12 @@ private:
     // Parameters
     Parameter<bool> mMeanData;
     Parameter<bool> mStdDevData;
+    /// If < 1.0, only a random subset of each set is analysed and the global
+    /// mean and std. dev. are estimated with a confidence interval
+    Parameter<double> mSampleRatio;
+    /// Save the partial statistics every CheckpointInterval stimuli, so that
+    /// an interrupted analysis resumes where it stopped (0 = disabled)
+    Parameter<unsigned int> mCheckpointInterval;
 
     // Per-stimulus size
     std::vector<Size> mSize;
@@ -113,7 +197,48 @@ private:
     std::vector<Value> mValue;
     // Global value stats
     Value mGlobalValue;
+    Confidence mGlobalValueConfidence;
+    unsigned int mNbStimuliPopulation;
 };
 }
 
+void N2D2::StimuliData::Accumulator::push(double x)
+{
+    ++count;
+    const double delta = (x - mean);
+    mean += delta / count;
+    const double delta2 = (x - mean);
+    M2 += delta * delta2;
+
+    if (x < minVal)
+        minVal = x;
+
+    if (x > maxVal)
+        maxVal = x;
+}
+
+void N2D2::StimuliData::Accumulator::merge(const Accumulator& acc)
+{
+    if (acc.count == 0)
+        return;
+
+    if (count == 0) {
+        *this = acc;
+        return;
+    }
+
+    const double n = (double)count + (double)acc.count;
+    const double delta = (acc.mean - mean);
+
+    mean += delta * acc.count / n;
+    M2 += acc.M2 + delta * delta * ((double)count * acc.count / n);
+    count += acc.count;
+
+    if (acc.minVal < minVal)
+        minVal = acc.minVal;
+
+    if (acc.maxVal > maxVal)
+        maxVal = acc.maxVal;
+}
+
 #endif // N2D2_STIMULIDATA_H
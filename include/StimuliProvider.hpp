@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "Database/Database.hpp"
+#include "Transformation/BatchAugmentation.hpp"
 #include "Transformation/CompositeTransformation.hpp"
 #ifdef CUDA
 #include "containers/CudaTensor.hpp"
@@ -45,6 +46,9 @@ public:
     struct Transformations {
         CompositeTransformation cacheable;
         CompositeTransformation onTheFly;
+        /// Applied on the whole batch, after readBatch() and
+        /// readRandomBatch()
+        std::vector<std::shared_ptr<BatchAugmentation> > batch;
     };
 
     struct TransformationsSets {
@@ -142,6 +146,13 @@ public:
                                            Database::StimuliSetMask setMask
                                            = Database::All);
 
+    /// Add a BATCH augmentation, applied on the whole data tensor after
+    /// each readBatch() and readRandomBatch(), after all the transformations
+    void addBatchAugmentation(const std::shared_ptr<BatchAugmentation>
+                              & augmentation,
+                              Database::StimuliSetMask setMask
+                              = Database::All);
+
     void logTransformations(const std::string& fileName) const;
 
     void future();
@@ -207,6 +218,17 @@ public:
     void streamStimulus(const cv::Mat& mat,
                         Database::StimuliSet set,
                         unsigned int batchPos = 0);
+
+    /// Put a stimulus already transformed with transformStimulus() at batch
+    /// position @p batchPos in mData
+    void streamStimulus(const Tensor<Float_T>& data,
+                        unsigned int batchPos = 0);
+
+    /// Apply the transformations of StimuliSet @p set to @p mat and return
+    /// the result, without modifying mData. This allows to transform the next
+    /// stimulus concurrently with the processing of the current one.
+    Tensor<Float_T> transformStimulus(const cv::Mat& mat,
+                                      Database::StimuliSet set);
     void reverseLabels(const cv::Mat& mat,
                        Database::StimuliSet set,
                        Tensor<int>& labels,
@@ -334,6 +356,8 @@ protected:
     std::vector<cv::Mat> loadDataCache(const std::string& fileName) const;
     void saveDataCache(const std::string& fileName,
                        const std::vector<cv::Mat>& data) const;
+    void applyBatchAugmentations(Database::StimuliSet set,
+                                 unsigned int batchSize);
 
 protected:
     /// Map unsigned integer range to signed before convertion to Float_T
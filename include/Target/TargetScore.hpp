@@ -135,6 +135,21 @@ public:
     void clearScore(Database::StimuliSet set);
     void computeScore(Database::StimuliSet set);
 
+    /**
+     * Accumulate the (target, estimated) label pairs of a plane into a flat
+     * nbTargets x nbTargets @p histogram, and count the number of labels and
+     * hits per target. Pairs with an ignored target (< 0) are counted in an
+     * extra last bin, so @p histogram must have nbTargets * nbTargets + 1
+     * entries and @p nbLabels and @p nbHits nbTargets + 1 entries.
+    */
+    static void labelPairHistogram(const int* target,
+                                   const int* estimated,
+                                   size_t size,
+                                   unsigned int nbTargets,
+                                   unsigned long long int* histogram,
+                                   unsigned int* nbLabels,
+                                   unsigned int* nbHits);
+
     virtual void process(Database::StimuliSet set);
     virtual void log(const std::string& fileName, Database::StimuliSet set);
     virtual void clear(Database::StimuliSet set);
@@ -142,6 +157,9 @@ public:
 protected:
     void correctLastBatch(std::vector<double>& batchSuccess,
                           const std::deque<double>& success);
+    std::vector<unsigned long long int>& getConfusionShard(size_t size);
+    void reduceConfusionShards(
+        ConfusionMatrix<unsigned long long int>& confusionMatrix);
 
     Parameter<double> mConfusionRangeMin;
     Parameter<double> mConfusionRangeMax;
@@ -156,6 +174,8 @@ protected:
     double mMaxValidationTopNScore; // top-N accuracy
     std::map<Database::StimuliSet, Score> mScoreSet;
     std::map<Database::StimuliSet, Score> mScoreTopNSet; // top-N accuracy
+    // Per-thread flat confusion matrices, reduced once per batch
+    std::vector<std::vector<unsigned long long int> > mConfusionShards;
 
 private:
     static Registrar<Target> mRegistrar;
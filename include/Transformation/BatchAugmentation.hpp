@@ -0,0 +1,88 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_BATCHAUGMENTATION_H
+#define N2D2_BATCHAUGMENTATION_H
+
+#include "FloatT.hpp"
+#include "containers/Tensor.hpp"
+#include "utils/Parameterizable.hpp"
+
+namespace N2D2 {
+/**
+ * Random data augmentation applied on a whole batch, after its assembly in
+ * the StimuliProvider data tensor ({x, y, channels..., batch}).
+ * The random parameters of every stimulus are drawn at once, before the
+ * batch is processed in parallel, one (stimulus, channel) plane per task.
+ * When the labels tensor has the same spatial size as the data, the
+ * geometric augmentations (flips and shift) are applied to the labels too.
+*/
+class BatchAugmentation : public Parameterizable {
+public:
+    BatchAugmentation();
+
+    /**
+     * Apply the augmentations to the @p batchSize first stimuli of @p data
+     * (all of them if 0) and @p labels.
+    */
+    void apply(Tensor<Float_T>& data,
+               Tensor<int>& labels,
+               unsigned int batchSize = 0) const;
+    virtual ~BatchAugmentation() {};
+
+private:
+    struct SampleParams {
+        bool horizontalFlip;
+        bool verticalFlip;
+        int shiftX;
+        int shiftY;
+        Float_T contrast;
+        Float_T brightness;
+        int cutoutX;
+        int cutoutY;
+        bool cutout;
+    };
+
+    template <class T>
+    void applyGeometric(T* plane,
+                        unsigned int dimX,
+                        unsigned int dimY,
+                        const SampleParams& params,
+                        T fillValue) const;
+
+    /// Random horizontal flip, with a probability of 0.5
+    Parameter<bool> mRandomHorizontalFlip;
+    /// Random vertical flip, with a probability of 0.5
+    Parameter<bool> mRandomVerticalFlip;
+    /// Maximum random shift, in pixels, in each direction (zero padding)
+    Parameter<unsigned int> mRandomShift;
+    /// Random brightness offset, drawn in [-Brightness, Brightness]
+    Parameter<double> mBrightness;
+    /// Random contrast factor, drawn in [1 - Contrast, 1 + Contrast], around
+    /// the mean of each channel
+    Parameter<double> mContrast;
+    /// Size of the square set to 0 at a random position (cutout)
+    Parameter<unsigned int> mCutoutSize;
+    /// Probability to apply the cutout to a stimulus
+    Parameter<double> mCutoutProbability;
+};
+}
+
+#endif // N2D2_BATCHAUGMENTATION_H
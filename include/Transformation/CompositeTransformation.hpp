@@ -64,7 +64,14 @@ public:
 private:
     inline virtual CompositeTransformation* doClone() const;
 
+    /// Build mCompiledSet from mTransformationSet, where consecutive
+    /// RangeAffineTransformation, optionally preceded by a Blue, Green or Red
+    /// ChannelExtractionTransformation, are fused into a single step
+    void compile();
+
     std::vector<std::shared_ptr<Transformation> > mTransformationSet;
+    /// Transformations actually applied by apply()
+    std::vector<std::shared_ptr<Transformation> > mCompiledSet;
 };
 }
 
@@ -72,6 +79,7 @@ template <class T>
 N2D2::CompositeTransformation::CompositeTransformation(const T& transformation)
 {
     mTransformationSet.push_back(std::make_shared<T>(transformation));
+    compile();
 }
 
 template <class T>
@@ -79,6 +87,7 @@ N2D2::CompositeTransformation::CompositeTransformation(const std::shared_ptr
                                                        <T>& transformation)
 {
     mTransformationSet.push_back(transformation);
+    compile();
 }
 
 void N2D2::CompositeTransformation::apply(cv::Mat& frame,
@@ -88,8 +97,8 @@ void N2D2::CompositeTransformation::apply(cv::Mat& frame,
                                           int id)
 {
     for (std::vector<std::shared_ptr<Transformation> >::const_iterator it
-         = mTransformationSet.begin(),
-         itEnd = mTransformationSet.end();
+         = mCompiledSet.begin(),
+         itEnd = mCompiledSet.end();
          it != itEnd;
          ++it) {
         (*it)->apply(frame, labels, labelsROI, id);
@@ -122,6 +131,7 @@ template <class T>
 void N2D2::CompositeTransformation::push_back(const T& transformation)
 {
     mTransformationSet.push_back(std::make_shared<T>(transformation));
+    compile();
 }
 
 template <class T>
@@ -129,6 +139,7 @@ void N2D2::CompositeTransformation::push_back(const std::shared_ptr
                                               <T>& transformation)
 {
     mTransformationSet.push_back(transformation);
+    compile();
 }
 
 void N2D2::CompositeTransformation::push_back(const CompositeTransformation
@@ -137,6 +148,7 @@ void N2D2::CompositeTransformation::push_back(const CompositeTransformation
     mTransformationSet.insert(mTransformationSet.end(),
                               transformation.mTransformationSet.begin(),
                               transformation.mTransformationSet.end());
+    compile();
 }
 
 bool N2D2::CompositeTransformation::empty() const
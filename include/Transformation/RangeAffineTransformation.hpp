@@ -63,6 +63,14 @@ public:
     {
         return std::make_pair(width, height);
     };
+
+    /**
+     * Return the equivalent affine transformation y = scale * x + shift.
+     * @p scale and @p shift have either one value for all the channels, or
+     * one value per channel.
+    */
+    void getAffine(std::vector<double>& scale,
+                   std::vector<double>& shift) const;
     virtual ~RangeAffineTransformation() {};
 
 private:
@@ -73,6 +81,10 @@ private:
     void applyOperator(cv::Mat& mat,
                        const Operator& op,
                        double value) const;
+    static void applyOperator(double& scale,
+                              double& shift,
+                              const Operator& op,
+                              double value);
 
     const Operator mFirstOperator;
     const std::vector<double> mFirstValue;
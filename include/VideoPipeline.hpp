@@ -0,0 +1,168 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_VIDEOPIPELINE_H
+#define N2D2_VIDEOPIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Histogram.hpp"
+#include "containers/Tensor.hpp"
+#include "FloatT.hpp"
+
+namespace N2D2 {
+/**
+ * Staged video processing pipeline. Consecutive frames are processed
+ * concurrently by a chain of stages (typically capture, preprocess, infer
+ * and postprocess), each stage running in its own thread and connected to
+ * the next one with a bounded queue. The throughput is therefore limited by
+ * the slowest stage instead of the sum of the stages latencies.
+ *
+ * When a stage input queue is full, the frame is either waited for (Block,
+ * for files: no frame is lost) or the oldest pending frame is dropped
+ * (DropOldest, for live sources: the latest frame is always processed).
+ *
+ * The latency of each stage and the end-to-end latency (from capture to the
+ * end of the last stage) are accumulated in histograms.
+*/
+class VideoPipeline {
+public:
+    typedef std::chrono::steady_clock Clock_T;
+
+    enum DropPolicy {
+        Block,
+        DropOldest
+    };
+
+    struct Frame {
+        unsigned long long index;
+        Clock_T::time_point captureTime;
+        /// Captured image
+        cv::Mat image;
+        /// Transformed stimulus (see StimuliProvider::transformStimulus())
+        Tensor<Float_T> data;
+        Tensor<int> estimatedLabels;
+        Tensor<Float_T> estimatedLabelsValue;
+        /// Postprocessed image (drawing)
+        cv::Mat output;
+    };
+
+    /// Return false at the end of the stream
+    typedef std::function<bool(cv::Mat&)> Source_T;
+    typedef std::function<void(Frame&)> Stage_T;
+
+    struct StageStats {
+        StageStats()
+            : nbFrames(0),
+              nbDropped(0),
+              latency(0.0, 0.1, 1000),
+              latencySum(0.0) {};
+
+        double getLatencyPercentile(double percentile) const;
+
+        std::string name;
+        unsigned long long nbFrames;
+        /// Frames dropped in the stage input queue
+        unsigned long long nbDropped;
+        /// Latency histogram (s), 0.1 ms bins, enlarged as needed
+        Histogram latency;
+        double latencySum;
+    };
+
+    VideoPipeline(const Source_T& source,
+                  std::size_t queueSize = 2,
+                  DropPolicy dropPolicy = Block);
+    void addStage(const std::string& name, const Stage_T& stage);
+
+    /// Run the pipeline until the end of the source or stop()
+    void run();
+    void stop();
+
+    std::vector<StageStats> getStats() const;
+    StageStats getEndToEndStats() const;
+    /// Frames per second processed by the whole pipeline
+    double getFps() const;
+    void logStats(std::ostream& os) const;
+    void logLatencyHistograms(const std::string& dirName) const;
+
+    /// Source reading a video file, a printf-style image sequence or a camera
+    static Source_T videoSource(const std::shared_ptr<cv::VideoCapture>&
+                                video);
+    /// Source reading a list of image files
+    static Source_T imagesSource(const std::vector<std::string>& fileNames);
+    /// Source reading @p name: a directory of images, a camera index or a
+    /// file name supported by cv::VideoCapture
+    static Source_T createSource(const std::string& name);
+    virtual ~VideoPipeline();
+
+private:
+    class FrameQueue {
+    public:
+        FrameQueue(std::size_t capacity, DropPolicy dropPolicy)
+            : mCapacity(capacity),
+              mDropPolicy(dropPolicy),
+              mClosed(false) {};
+        /// Return the number of dropped frames (0 or 1)
+        unsigned int push(const std::shared_ptr<Frame>& frame);
+        /// Return an empty pointer when the queue is closed and empty
+        std::shared_ptr<Frame> pop();
+        void close();
+
+    private:
+        const std::size_t mCapacity;
+        const DropPolicy mDropPolicy;
+        std::deque<std::shared_ptr<Frame> > mFrames;
+        bool mClosed;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+    };
+
+    void capture();
+    void runStage(std::size_t index);
+    void recordLatency(StageStats& stats,
+                       const Clock_T::time_point& start,
+                       const Clock_T::time_point& end);
+
+    const Source_T mSource;
+    const std::size_t mQueueSize;
+    const DropPolicy mDropPolicy;
+    std::vector<std::pair<std::string, Stage_T> > mStages;
+    std::vector<std::shared_ptr<FrameQueue> > mQueues;
+    std::atomic<bool> mStop;
+
+    mutable std::mutex mStatsMutex;
+    std::vector<StageStats> mStats;
+    StageStats mEndToEndStats;
+    Clock_T::time_point mStartTime;
+    Clock_T::time_point mEndTime;
+};
+}
+
+#endif // N2D2_VIDEOPIPELINE_H
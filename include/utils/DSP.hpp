@@ -29,6 +29,7 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
@@ -43,8 +44,115 @@
 
 namespace N2D2 {
 namespace DSP {
+    /**
+     * Complex FFT plan for a given size. The factorization and the twiddle
+     * factors are computed once, in the constructor. The transform is a mixed
+     * radix (4, 2 and generic odd radices) decimation in time Cooley-Tukey
+     * algorithm, so that any size is supported.
+     * A plan is never modified after its construction and can be used by
+     * several threads at the same time.
+    */
+    template <typename T> class FftPlan {
+    public:
+        explicit FftPlan(unsigned int size);
+
+        /**
+         * Return the plan for @p size from the plans cache, creating it if
+         * necessary.
+        */
+        static const FftPlan<T>& get(unsigned int size);
+        unsigned int size() const
+        {
+            return mSize;
+        };
+
+        /**
+         * Out-of-place transform of @p x into @p y (@p x and @p y must not
+         * overlap). The inverse transform is not normalized.
+        */
+        void transform(const std::complex<T>* x,
+                       std::complex<T>* y,
+                       bool inverse = false) const;
+
+        /**
+         * Transform @p batchSize contiguous signals, in parallel.
+        */
+        void transform(const std::complex<T>* x,
+                       std::complex<T>* y,
+                       unsigned int batchSize,
+                       bool inverse) const;
+
+    private:
+        void work(std::complex<T>* y,
+                  const std::complex<T>* x,
+                  unsigned int fStride,
+                  const unsigned int* factors,
+                  bool inverse) const;
+        void butterfly2(std::complex<T>* y,
+                        unsigned int fStride,
+                        unsigned int m,
+                        const std::complex<T>* twiddles) const;
+        void butterfly4(std::complex<T>* y,
+                        unsigned int fStride,
+                        unsigned int m,
+                        const std::complex<T>* twiddles,
+                        bool inverse) const;
+        void butterflyGeneric(std::complex<T>* y,
+                              unsigned int fStride,
+                              unsigned int m,
+                              unsigned int p,
+                              const std::complex<T>* twiddles) const;
+
+        unsigned int mSize;
+        /// Pairs (radix, remaining size)
+        std::vector<unsigned int> mFactors;
+        std::vector<std::complex<T> > mTwiddles;
+        std::vector<std::complex<T> > mInvTwiddles;
+    };
+
+    /**
+     * Real-input FFT plan for a given size. Only the size / 2 + 1 first bins
+     * of the spectrum are computed, the others being their complex
+     * conjugates. For an even size, the transform is computed with a complex
+     * FFT of half the size.
+    */
+    template <typename T> class RealFftPlan {
+    public:
+        explicit RealFftPlan(unsigned int size);
+        static const RealFftPlan<T>& get(unsigned int size);
+        unsigned int size() const
+        {
+            return mSize;
+        };
+
+        /**
+         * Transform the real signal @p x into the size / 2 + 1 first bins of
+         * its spectrum @p y.
+        */
+        void forward(const T* x, std::complex<T>* y) const;
+
+        /**
+         * Transform the size / 2 + 1 first bins of a spectrum @p y into the
+         * real signal @p x. The transform is not normalized.
+        */
+        void inverse(const std::complex<T>* y, T* x) const;
+
+        /**
+         * Transform @p batchSize contiguous real signals of size() samples
+         * into @p batchSize contiguous spectrums of size() / 2 + 1 bins, in
+         * parallel.
+        */
+        void forward(const T* x, std::complex<T>* y, unsigned int batchSize)
+            const;
+
+    private:
+        unsigned int mSize;
+        const FftPlan<T>* mPlan;
+        /// exp(-2*pi*i*k/size), for k in [0, size/4]
+        std::vector<std::complex<T> > mTwiddles;
+    };
+
     namespace internal {
-        inline int bitReverse(int n, int bits);
         template <typename T, bool INV>
         void fft_(std::vector<std::complex<T> >& x);
     }
@@ -57,8 +165,7 @@ namespace DSP {
     std::vector<T> imag(const std::vector<std::complex<T> >& x);
 
     /**
-     * Implementation of the radix-2 DIT case form of the Cooley-Tukey FFT
-     * algorithm.
+     * FFT using the cached plan of the size of x (see FftPlan).
      * If necessary, x is zero-padded so that its size is a power of two.
     */
     template <typename T> void fft(std::vector<std::complex<T> >& x)
@@ -71,6 +178,14 @@ namespace DSP {
     }
     template <typename T> void hilbert(std::vector<std::complex<T> >& x);
 
+    /**
+     * Full linear convolution of @p x with @p h (size(x) + size(h) - 1
+     * samples), computed with real FFTs by the overlap-add method.
+     * The blocks are transformed in parallel.
+    */
+    template <typename T>
+    std::vector<T> convolve(const std::vector<T>& x, const std::vector<T>& h);
+
     /**
      * Short-time Fourier transform (STFT).
      *
@@ -107,19 +222,311 @@ namespace DSP {
 }
 }
 
-int N2D2::DSP::internal::bitReverse(int n, int bits)
+template <typename T>
+N2D2::DSP::FftPlan<T>::FftPlan(unsigned int size)
+    : mSize(size)
+{
+    if (size == 0)
+        throw std::runtime_error("FftPlan: size must be > 0");
+
+    // Factorization, radix 4 first, then 2, then odd radices
+    unsigned int n = size;
+    unsigned int p = 4;
+
+    while (n > 1) {
+        while (n % p != 0) {
+            p = (p == 4) ? 2 : (p == 2) ? 3 : p + 2;
+
+            if (p * p > n)
+                p = n;
+        }
+
+        n /= p;
+        mFactors.push_back(p);
+        mFactors.push_back(n);
+    }
+
+    mTwiddles.reserve(size);
+    mInvTwiddles.reserve(size);
+
+    for (unsigned int k = 0; k < size; ++k) {
+        const double phase = (-2.0 * M_PI * k) / (double)size;
+        mTwiddles.push_back(std::complex<T>((T)std::cos(phase),
+                                            (T)std::sin(phase)));
+        mInvTwiddles.push_back(std::conj(mTwiddles.back()));
+    }
+}
+
+template <typename T>
+const N2D2::DSP::FftPlan<T>& N2D2::DSP::FftPlan<T>::get(unsigned int size)
+{
+    static std::map<unsigned int, std::shared_ptr<FftPlan<T> > > plans;
+    const FftPlan<T>* plan;
+
+#pragma omp critical(DSP__FftPlan_get)
+    {
+        std::shared_ptr<FftPlan<T> >& cached = plans[size];
+
+        if (!cached)
+            cached = std::make_shared<FftPlan<T> >(size);
+
+        plan = cached.get();
+    }
+
+    return *plan;
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::transform(const std::complex<T>* x,
+                                      std::complex<T>* y,
+                                      bool inverse) const
+{
+    if (mSize == 1)
+        y[0] = x[0];
+    else
+        work(y, x, 1, &mFactors[0], inverse);
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::transform(const std::complex<T>* x,
+                                      std::complex<T>* y,
+                                      unsigned int batchSize,
+                                      bool inverse) const
+{
+#pragma omp parallel for if (batchSize > 1 && mSize * batchSize > 4096)
+    for (int batchPos = 0; batchPos < (int)batchSize; ++batchPos)
+        transform(x + batchPos * mSize, y + batchPos * mSize, inverse);
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::work(std::complex<T>* y,
+                                 const std::complex<T>* x,
+                                 unsigned int fStride,
+                                 const unsigned int* factors,
+                                 bool inverse) const
+{
+    const unsigned int p = factors[0];
+    const unsigned int m = factors[1];
+
+    // Decimation in time: the p sub-sequences x[q*fStride + k*p*fStride]
+    // are transformed into y[q*m .. (q+1)*m[
+    if (m == 1) {
+        for (unsigned int q = 0; q < p; ++q)
+            y[q] = x[q * fStride];
+    } else {
+        for (unsigned int q = 0; q < p; ++q)
+            work(y + q * m, x + q * fStride, fStride * p, factors + 2, inverse);
+    }
+
+    const std::complex<T>* twiddles = (inverse) ? &mInvTwiddles[0]
+                                                : &mTwiddles[0];
+
+    if (p == 2)
+        butterfly2(y, fStride, m, twiddles);
+    else if (p == 4)
+        butterfly4(y, fStride, m, twiddles, inverse);
+    else
+        butterflyGeneric(y, fStride, m, p, twiddles);
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::butterfly2(std::complex<T>* y,
+                                       unsigned int fStride,
+                                       unsigned int m,
+                                       const std::complex<T>* twiddles) const
+{
+    std::complex<T>* y2 = y + m;
+
+    for (unsigned int k = 0; k < m; ++k) {
+        const std::complex<T> t = y2[k] * twiddles[k * fStride];
+        y2[k] = y[k] - t;
+        y[k] += t;
+    }
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::butterfly4(std::complex<T>* y,
+                                       unsigned int fStride,
+                                       unsigned int m,
+                                       const std::complex<T>* twiddles,
+                                       bool inverse) const
+{
+    for (unsigned int k = 0; k < m; ++k) {
+        const std::complex<T> s0 = y[k + m] * twiddles[k * fStride];
+        const std::complex<T> s1 = y[k + 2 * m] * twiddles[2 * k * fStride];
+        const std::complex<T> s2 = y[k + 3 * m] * twiddles[3 * k * fStride];
+
+        const std::complex<T> s3 = s0 + s2;
+        const std::complex<T> s4 = s0 - s2;
+        const std::complex<T> s5 = y[k] - s1;
+        const std::complex<T> s6 = y[k] + s1;
+
+        // -i * s4 (forward) or i * s4 (inverse)
+        const std::complex<T> s4r = (inverse)
+            ? std::complex<T>(-s4.imag(), s4.real())
+            : std::complex<T>(s4.imag(), -s4.real());
+
+        y[k] = s6 + s3;
+        y[k + m] = s5 + s4r;
+        y[k + 2 * m] = s6 - s3;
+        y[k + 3 * m] = s5 - s4r;
+    }
+}
+
+template <typename T>
+void N2D2::DSP::FftPlan<T>::butterflyGeneric(std::complex<T>* y,
+                                             unsigned int fStride,
+                                             unsigned int m,
+                                             unsigned int p,
+                                             const std::complex<T>* twiddles)
+    const
+{
+    std::vector<std::complex<T> > scratch(p);
+
+    for (unsigned int u = 0; u < m; ++u) {
+        for (unsigned int q = 0; q < p; ++q)
+            scratch[q] = y[u + q * m];
+
+        for (unsigned int q = 0; q < p; ++q) {
+            const unsigned int k = u + q * m;
+            std::complex<T> sum = scratch[0];
+            unsigned int twIndex = 0;
+
+            for (unsigned int r = 1; r < p; ++r) {
+                twIndex += fStride * k;
+
+                if (twIndex >= mSize)
+                    twIndex %= mSize;
+
+                sum += scratch[r] * twiddles[twIndex];
+            }
+
+            y[k] = sum;
+        }
+    }
+}
+
+template <typename T>
+N2D2::DSP::RealFftPlan<T>::RealFftPlan(unsigned int size)
+    : mSize(size),
+      mPlan(&FftPlan<T>::get((size % 2 == 0) ? size / 2 : size))
+{
+    if (size % 2 == 0) {
+        mTwiddles.reserve(size / 4 + 1);
+
+        for (unsigned int k = 0; k <= size / 4; ++k) {
+            const double phase = (-2.0 * M_PI * k) / (double)size;
+            mTwiddles.push_back(std::complex<T>((T)std::cos(phase),
+                                                (T)std::sin(phase)));
+        }
+    }
+}
+
+template <typename T>
+const N2D2::DSP::RealFftPlan<T>&
+N2D2::DSP::RealFftPlan<T>::get(unsigned int size)
 {
-    int reversedN = n;
-    int count = bits - 1;
-
-    n >>= 1;
-    while (n > 0) {
-        reversedN = (reversedN << 1) | (n & 1);
-        count--;
-        n >>= 1;
+    static std::map<unsigned int, std::shared_ptr<RealFftPlan<T> > > plans;
+    const RealFftPlan<T>* plan;
+
+#pragma omp critical(DSP__RealFftPlan_get)
+    {
+        std::shared_ptr<RealFftPlan<T> >& cached = plans[size];
+
+        if (!cached)
+            cached = std::make_shared<RealFftPlan<T> >(size);
+
+        plan = cached.get();
     }
 
-    return ((reversedN << count) & ((1 << bits) - 1));
+    return *plan;
+}
+
+template <typename T>
+void N2D2::DSP::RealFftPlan<T>::forward(const T* x, std::complex<T>* y) const
+{
+    if (mSize % 2 != 0) {
+        // Odd size: complex FFT of the full size
+        std::vector<std::complex<T> > xc(x, x + mSize);
+        std::vector<std::complex<T> > yc(mSize);
+        mPlan->transform(&xc[0], &yc[0]);
+        std::copy(yc.begin(), yc.begin() + mSize / 2 + 1, y);
+        return;
+    }
+
+    // Even samples in the real part, odd samples in the imaginary part
+    const unsigned int half = mSize / 2;
+    std::vector<std::complex<T> > z(half);
+    mPlan->transform(reinterpret_cast<const std::complex<T>*>(x), &z[0]);
+
+    y[0] = std::complex<T>(z[0].real() + z[0].imag(), 0.0);
+    y[half] = std::complex<T>(z[0].real() - z[0].imag(), 0.0);
+
+    for (unsigned int k = 1; k <= half / 2; ++k) {
+        // Spectrums of the even (fe) and odd (fo) samples
+        const std::complex<T> zk = z[k];
+        const std::complex<T> zn = std::conj(z[half - k]);
+        const std::complex<T> fe = (T)0.5 * (zk + zn);
+        const std::complex<T> fo = std::complex<T>(0.0, -0.5) * (zk - zn);
+        // exp(-2*pi*i*(half - k)/size) = -conj(exp(-2*pi*i*k/size))
+        const std::complex<T> tw = mTwiddles[k];
+
+        y[k] = fe + tw * fo;
+        y[half - k] = std::conj(fe - tw * fo);
+    }
+}
+
+template <typename T>
+void N2D2::DSP::RealFftPlan<T>::inverse(const std::complex<T>* y, T* x) const
+{
+    if (mSize % 2 != 0) {
+        std::vector<std::complex<T> > yc(mSize);
+        std::copy(y, y + mSize / 2 + 1, yc.begin());
+
+        for (unsigned int k = mSize / 2 + 1; k < mSize; ++k)
+            yc[k] = std::conj(y[mSize - k]);
+
+        std::vector<std::complex<T> > xc(mSize);
+        mPlan->transform(&yc[0], &xc[0], true);
+
+        for (unsigned int k = 0; k < mSize; ++k)
+            x[k] = xc[k].real();
+
+        return;
+    }
+
+    const unsigned int half = mSize / 2;
+    std::vector<std::complex<T> > z(half);
+
+    for (unsigned int k = 0; k <= half / 2; ++k) {
+        const std::complex<T> yk = y[k];
+        const std::complex<T> yn = std::conj(y[half - k]);
+        const std::complex<T> fe = yk + yn;
+        const std::complex<T> fo = (yk - yn) * std::conj(mTwiddles[k]);
+
+        z[k] = fe + std::complex<T>(0.0, 1.0) * fo;
+
+        if (k > 0 && k < half - k) {
+            // Symmetric bin: same computation with k -> half - k
+            const std::complex<T> fe2 = std::conj(fe);
+            const std::complex<T> fo2 = std::conj(fo);
+            z[half - k] = fe2 + std::complex<T>(0.0, 1.0) * fo2;
+        }
+    }
+
+    mPlan->transform(&z[0], reinterpret_cast<std::complex<T>*>(x), true);
+}
+
+template <typename T>
+void N2D2::DSP::RealFftPlan<T>::forward(const T* x,
+                                        std::complex<T>* y,
+                                        unsigned int batchSize) const
+{
+    const unsigned int outputSize = mSize / 2 + 1;
+
+#pragma omp parallel for if (batchSize > 1 && mSize * batchSize > 4096)
+    for (int batchPos = 0; batchPos < (int)batchSize; ++batchPos)
+        forward(x + batchPos * mSize, y + batchPos * outputSize);
 }
 
 template <typename T, bool INV>
@@ -127,6 +534,9 @@ void N2D2::DSP::internal::fft_(std::vector<std::complex<T> >& x)
 {
     unsigned int size = x.size();
 
+    if (size == 0)
+        return;
+
     if ((size & (size - 1))
         != 0) { // Standard bit hack to check if size is a power of 2
         // If not, perform zero-padding.
@@ -134,29 +544,9 @@ void N2D2::DSP::internal::fft_(std::vector<std::complex<T> >& x)
         x.resize(size, 0.0);
     }
 
-    const int bits = (int)(std::log((double)size) / std::log(2.0));
-    for (unsigned int j = 1; j < size / 2; j++) {
-        const int swapPos = internal::bitReverse(j, bits);
-        std::swap(x[j], x[swapPos]);
-    }
-
-    for (unsigned int N = 2; N <= size; N <<= 1) {
-        for (unsigned int i = 0; i < size; i += N) {
-            for (unsigned int k = 0; k < N / 2; k++) {
-                const int evenIndex = i + k;
-                const int oddIndex = i + k + (N / 2);
-                const std::complex<T> even = x[evenIndex];
-                const std::complex<T> odd = x[oddIndex];
-
-                const double term = (-2.0 * M_PI * k) / (double)N;
-                const std::complex<T> twiddle
-                    = std::polar(1.0, (INV) ? -term : term) * odd;
-
-                x[evenIndex] = even + twiddle;
-                x[oddIndex] = even - twiddle;
-            }
-        }
-    }
+    std::vector<std::complex<T> > y(size);
+    FftPlan<T>::get(size).transform(&x[0], &y[0], INV);
+    x.swap(y);
 
     if (INV) {
         std::transform(x.begin(),
@@ -266,10 +656,10 @@ N2D2::DSP::stft(const std::vector<T>& x,
     std::vector<std::vector<std::complex<T> > > y(
         nFft, std::vector<std::complex<T> >(nFrames, 0.0));
 
+    const RealFftPlan<T>& plan = RealFftPlan<T>::get(nFft);
+
     std::vector<T> xt;
     std::vector<std::complex<T> > yt;
-    xt.reserve(nFft);
-    yt.reserve(nFft);
 
 #pragma omp parallel for private(xt, yt) if (nFrames > 4)
     for (int t = 0; t < nFrames; ++t) {
@@ -293,14 +683,15 @@ N2D2::DSP::stft(const std::vector<T>& x,
         std::rotate(xt.begin(), xt.begin() + wSize / 2, xt.end());
         xt.insert(xt.begin() + wSize / 2, nFft - wSize, 0.0);
 
-        yt = toComplex(xt);
-        fft(yt);
+        // Real FFT, the upper half of the spectrum is its complex conjugate
+        yt.resize(nFft / 2 + 1);
+        plan.forward(&xt[0], &yt[0]);
 
-#pragma omp critical(DSP__stft)
-        {
-            for (unsigned int f = 0; f < nFft; ++f)
-                y[f][t] = yt[f];
-        }
+        for (unsigned int f = 0; f <= nFft / 2; ++f)
+            y[f][t] = yt[f];
+
+        for (unsigned int f = nFft / 2 + 1; f < nFft; ++f)
+            y[f][t] = std::conj(yt[nFft - f]);
     }
 
     return y;
@@ -350,4 +741,69 @@ std::vector<std::vector<T> > N2D2::DSP::spectrogram(const std::vector<T>& x,
     return yMag;
 }
 
+template <typename T>
+std::vector<T> N2D2::DSP::convolve(const std::vector<T>& x,
+                                   const std::vector<T>& h)
+{
+    if (x.empty() || h.empty())
+        return std::vector<T>();
+
+    const unsigned int outputSize = x.size() + h.size() - 1;
+
+    // FFT size: power of 2, at least 4 times the filter size to limit the
+    // overhead of the overlap, but not larger than needed for the output
+    unsigned int nFft = 1;
+
+    while (nFft < 4 * h.size() && nFft < outputSize)
+        nFft <<= 1;
+
+    const unsigned int blockSize = nFft - h.size() + 1;
+    const int nbBlocks = (x.size() + blockSize - 1) / blockSize;
+    const unsigned int nbBins = nFft / 2 + 1;
+    const RealFftPlan<T>& plan = RealFftPlan<T>::get(nFft);
+
+    // Spectrum of the filter
+    std::vector<T> ht(nFft, 0.0);
+    std::copy(h.begin(), h.end(), ht.begin());
+    std::vector<std::complex<T> > hf(nbBins);
+    plan.forward(&ht[0], &hf[0]);
+
+    // Convolution of each block
+    std::vector<T> yBlocks(nbBlocks * nFft);
+
+#pragma omp parallel for if (nbBlocks > 4)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int size = std::min<unsigned int>(blockSize,
+                                                         x.size() - offset);
+
+        std::vector<T> xt(nFft, 0.0);
+        std::copy(x.begin() + offset, x.begin() + offset + size, xt.begin());
+
+        std::vector<std::complex<T> > xf(nbBins);
+        plan.forward(&xt[0], &xf[0]);
+
+        for (unsigned int f = 0; f < nbBins; ++f)
+            xf[f] *= hf[f] / (T)nFft;
+
+        plan.inverse(&xf[0], &yBlocks[block * nFft]);
+    }
+
+    // Overlap-add
+    std::vector<T> y(outputSize, 0.0);
+
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int size = std::min(nFft, outputSize - offset);
+
+        std::transform(y.begin() + offset,
+                       y.begin() + offset + size,
+                       yBlocks.begin() + block * nFft,
+                       y.begin() + offset,
+                       std::plus<T>());
+    }
+
+    return y;
+}
+
 #endif // N2D2_DSP_H
@@ -0,0 +1,116 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_HALF_H
+#define N2D2_HALF_H
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+#include "third_party/half.hpp"
+
+namespace N2D2 {
+/**
+ * 16-bit brain floating point storage type (1 sign bit, 8 exponent bits,
+ * 7 mantissa bits). Arithmetic is done in float: this type is only meant to
+ * store data, conversion to and from float is lossless for the exponent range.
+*/
+struct bfloat16 {
+    uint16_t data;
+
+    bfloat16() : data(0) {}
+    bfloat16(float value) : data(fromFloat(value)) {}
+    operator float() const
+    {
+        return toFloat(data);
+    }
+
+    static inline float toFloat(uint16_t value)
+    {
+        const uint32_t bits = static_cast<uint32_t>(value) << 16;
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    static inline uint16_t fromFloat(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        // NaN must stay a NaN after truncation (force a quiet NaN)
+        if ((bits & 0x7FFFFFFFU) > 0x7F800000U)
+            return static_cast<uint16_t>((bits >> 16) | 0x0040U);
+
+        // Round to nearest even
+        bits += 0x7FFFU + ((bits >> 16) & 1U);
+        return static_cast<uint16_t>(bits >> 16);
+    }
+};
+
+namespace Half {
+    /**
+     * Bulk conversion of @p size half-precision values to single precision.
+     * Uses the F16C instruction set when available (-march=native), otherwise
+     * falls back to the half_float software conversion.
+    */
+    void toFloat(const half_float::half* src, float* dst, size_t size);
+
+    /**
+     * Bulk conversion of @p size single precision values to half-precision,
+     * with round to nearest even.
+    */
+    void fromFloat(const float* src, half_float::half* dst, size_t size);
+
+    void toFloat(const bfloat16* src, float* dst, size_t size);
+    void fromFloat(const float* src, bfloat16* dst, size_t size);
+
+    // Identity conversions, for generic code
+    void toFloat(const float* src, float* dst, size_t size);
+    void fromFloat(const float* src, float* dst, size_t size);
+
+    template <class T>
+    void toFloat(const std::vector<T>& src, std::vector<float>& dst);
+    template <class T>
+    void fromFloat(const std::vector<float>& src, std::vector<T>& dst);
+}
+}
+
+template <class T>
+void N2D2::Half::toFloat(const std::vector<T>& src, std::vector<float>& dst)
+{
+    dst.resize(src.size());
+
+    if (!src.empty())
+        toFloat(&src[0], &dst[0], src.size());
+}
+
+template <class T>
+void N2D2::Half::fromFloat(const std::vector<float>& src, std::vector<T>& dst)
+{
+    dst.resize(src.size());
+
+    if (!src.empty())
+        fromFloat(&src[0], &dst[0], src.size());
+}
+
+#endif // N2D2_HALF_H
@@ -105,6 +105,26 @@ namespace Random {
      * @return 1 with probability p and 0 with probability 1-p
     */
     bool randBernoulli(double p = 0.5);
+
+    /**
+     * Counter-based pseudorandom 64-bit integer generator (SplitMix64
+     *finalizer).
+     * Unlike mtRand(), it is stateless and thread-safe: the same (seed,
+     *counter) pair always gives the same number, whatever the number of
+     *threads used to generate a sequence in parallel.
+     *
+     * @param seed          Seed of the sequence, e.g. drawn from mtRand()
+     * @param counter       Position in the sequence
+     * @return Random number in the closed interval [0, (2^64)-1]
+    */
+    inline unsigned long long counterRand(unsigned long long seed,
+                                          unsigned long long counter)
+    {
+        unsigned long long z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
 }
 }
 
@@ -24,6 +24,110 @@
 #include "Solver/SGDSolver_Frame.hpp"
 #include "third_party/half.hpp"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+/// Number of batch chunks per channel for the (channel, batch chunk)
+/// reductions, so that narrow layers still provide work to every thread
+unsigned int getNbChunks(unsigned int nbChannels, unsigned int batchSize)
+{
+#ifdef _OPENMP
+    const unsigned int nbThreads = omp_get_max_threads();
+#else
+    const unsigned int nbThreads = 1;
+#endif
+    // At least 4 work items per thread to balance the load
+    const unsigned int nbChunks = (4 * nbThreads + nbChannels - 1)
+                                    / nbChannels;
+
+    return std::max(1U, std::min(nbChunks, batchSize));
+}
+
+/// Partial mean and sum of squared deviations (M2), merged with the
+/// parallel formula of Chan et al.
+template <class U>
+struct Moments {
+    Moments(): count(0), mean(0.0), m2(0.0) {}
+
+    template <class T>
+    void push(const T* data, unsigned int size)
+    {
+        if (size == 0)
+            return;
+
+        // Welford update with a whole plane: two passes over the plane,
+        // which stays in cache
+        U sum(0.0);
+
+        for (unsigned int i = 0; i < size; ++i)
+            sum += (U)data[i];
+
+        Moments<U> plane;
+        plane.count = size;
+        plane.mean = sum / (U)size;
+
+        for (unsigned int i = 0; i < size; ++i) {
+            const U zeroed = (U)data[i] - plane.mean;
+            plane.m2 += zeroed * zeroed;
+        }
+
+        merge(plane);
+    }
+
+    void merge(const Moments<U>& other)
+    {
+        if (other.count == 0)
+            return;
+
+        const unsigned int newCount = count + other.count;
+        const U delta = other.mean - mean;
+
+        mean += delta * (U)other.count / (U)newCount;
+        m2 += other.m2
+            + delta * delta * (U)count * (U)other.count / (U)newCount;
+        count = newCount;
+    }
+
+    unsigned int count;
+    U mean;
+    U m2;
+};
+
+/// Gradient sums of a channel: sum(dy), sum(dy * (x - mean)) and
+/// sum(x - mean)
+template <class U>
+struct GradientSums {
+    GradientSums(): diff(0.0), diffZeroed(0.0), zeroed(0.0) {}
+
+    void merge(const GradientSums<U>& other)
+    {
+        diff += other.diff;
+        diffZeroed += other.diffZeroed;
+        zeroed += other.zeroed;
+    }
+
+    U diff;
+    U diffZeroed;
+    U zeroed;
+};
+
+/// Pairwise (tree) reduction of the nbChunks partial results of a channel
+template <class Partial>
+Partial reduceChunks(std::vector<Partial>& partials,
+                     unsigned int offset,
+                     unsigned int nbChunks)
+{
+    for (unsigned int stride = 1; stride < nbChunks; stride *= 2) {
+        for (unsigned int i = 0; i + stride < nbChunks; i += 2 * stride)
+            partials[offset + i].merge(partials[offset + i + stride]);
+    }
+
+    return partials[offset];
+}
+}
+
 template <>
 N2D2::Registrar<N2D2::BatchNormCell>
 N2D2::BatchNormCell_Frame<half_float::half>::mRegistrar("Frame",
@@ -189,41 +293,54 @@ void N2D2::BatchNormCell_Frame<T>::propagate(bool inference)
                 }
             }
         } else {
-            const unsigned int size = input.dimX() * input.dimY()
-                                      * mInputs.dimB();
-
-#pragma omp parallel for if (input.dimZ() > 16)
-            for (int channel = 0; channel < (int)input.dimZ(); ++channel) {
-                const unsigned int output = outputOffset + channel;
-                ParamT sum(0.0);
-
-                for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox)
-                            sum += input(ox, oy, channel, batchPos);
-                    }
+            const unsigned int nbChannels = input.dimZ();
+            const unsigned int batchSize = mInputs.dimB();
+            const unsigned int planeSize = input.dimX() * input.dimY();
+            const unsigned int nbChunks = getNbChunks(nbChannels, batchSize);
+            const int nbItems = nbChannels * nbChunks;
+
+            // Mean and variance in a single pass over the inputs, in
+            // parallel over (channel, batch chunk)
+            std::vector<Moments<ParamT> > moments(nbItems);
+
+#pragma omp parallel for schedule(dynamic) if (nbItems > 1 && input.size() > 1024)
+            for (int item = 0; item < nbItems; ++item) {
+                const unsigned int channel = item / nbChunks;
+                const unsigned int chunk = item % nbChunks;
+
+                for (unsigned int batchPos = chunk * batchSize / nbChunks,
+                    batchEnd = (chunk + 1) * batchSize / nbChunks;
+                    batchPos < batchEnd; ++batchPos)
+                {
+                    moments[item].push(&input(0, 0, channel, batchPos),
+                                       planeSize);
                 }
+            }
 
-                mSavedMean(output) = sum / (ParamT)size;
-
-                sum = 0.0;
+            std::vector<T> normScale(nbChannels);
+            std::vector<T> normShift(nbChannels);
 
-                for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T zeroed = input(ox, oy, channel, batchPos)
-                                                   - ((T)mSavedMean(output));
-                            sum += (ParamT) (zeroed * zeroed);
-                        }
-                    }
-                }
+            for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+                const unsigned int output = outputOffset + channel;
+                const Moments<ParamT> channelMoments
+                    = reduceChunks(moments, channel * nbChunks, nbChunks);
 
-                mSavedVariance(output) = sum / (ParamT)size;
+                mSavedMean(output) = channelMoments.mean;
+                mSavedVariance(output) = channelMoments.m2
+                                            / (ParamT)channelMoments.count;
 
                 (*mMean)(output) = mSavedMean(output) * mMovingAverageMomentum
                                 + (*mMean)(output) * (1.0 - mMovingAverageMomentum);
                 (*mVariance)(output) = mSavedVariance(output) * mMovingAverageMomentum
                                     + (*mVariance)(output) * (1.0 - mMovingAverageMomentum);
+
+                // Normalize, scale and shift as a single affine transform
+                const ParamT scale = (*mScale)(output)
+                    / std::sqrt(mSavedVariance(output) + (ParamT)mEpsilon);
+
+                normScale[channel] = T(scale);
+                normShift[channel] = T((*mBias)(output)
+                                       - mSavedMean(output) * scale);
             }
 
 #if defined(_OPENMP) && _OPENMP >= 200805
@@ -234,17 +351,13 @@ void N2D2::BatchNormCell_Frame<T>::propagate(bool inference)
             for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
                 for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
                     const unsigned int output = outputOffset + channel;
-                    const T var(std::sqrt( (T)mSavedVariance(output) + mEpsilon));
+                    const T* inputPlane = &input(0, 0, channel, batchPos);
+                    T* outputPlane = &mOutputs(0, 0, output, batchPos);
+                    const T scale = normScale[channel];
+                    const T shift = normShift[channel];
 
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T normalized
-                                = (input(ox, oy, channel, batchPos)
-                                   - ( (T) mSavedMean(output)) ) / var;
-                            mOutputs(ox, oy, output, batchPos)
-                                = (T) (*mScale)(output) * normalized + (T) (*mBias)(output);
-                        }
-                    }
+                    for (unsigned int i = 0; i < planeSize; ++i)
+                        outputPlane[i] = scale * inputPlane[i] + shift;
                 }
             }
 
@@ -271,49 +384,78 @@ void N2D2::BatchNormCell_Frame<T>::backPropagate()
         const Tensor<T>& input = tensor_cast_nocopy<T>(mInputs[k]);
         const unsigned int size = input.dimX() * input.dimY() * mInputs.dimB();
 
-#pragma omp parallel for if (input.dimZ() > 16)
-        for (int channel = 0; channel < (int)input.dimZ(); ++channel) {
-            const unsigned int output = outputOffset + channel;
-            const T var(std::sqrt((T) mSavedVariance(output) + mEpsilon));
+        const unsigned int nbChannels = input.dimZ();
+        const unsigned int batchSize = mInputs.dimB();
+        const unsigned int planeSize = input.dimX() * input.dimY();
+        const unsigned int nbChunks = getNbChunks(nbChannels, batchSize);
+        const int nbItems = nbChannels * nbChunks;
 
-            ParamT sumScale(0.0);
-            ParamT sumBias(0.0);
-            ParamT sumMean1(0.0);
-            ParamT sumMean2(0.0);
-            ParamT sumVariance(0.0);
+        // Gradient sums in a single pass, in parallel over
+        // (channel, batch chunk)
+        std::vector<GradientSums<ParamT> > sums(nbItems);
 
-            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                    for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                        const T normalized((input(ox, oy, channel, batchPos)
-                               - (T)mSavedMean(output)) / var);
-                        const T diffNormalized(
-                            mDiffInputs(ox, oy, output, batchPos)
-                              * (T)(*mScale)(output));
-
-                        sumScale += (ParamT) (mDiffInputs(ox, oy, output, batchPos)
-                                    * normalized);
-                        sumBias += (ParamT) (mDiffInputs(ox, oy, output, batchPos));
-
-                        sumMean1 += (ParamT)diffNormalized;
-                        sumMean2 += (ParamT) (-2.0 * (input(ox, oy, channel, batchPos)
-                                            - mSavedMean(output)));
-                        sumVariance += (ParamT) (diffNormalized
-                                       * (input(ox, oy, channel, batchPos)
-                                          - mSavedMean(output)) );
-                    }
+#pragma omp parallel for schedule(dynamic) if (nbItems > 1 && input.size() > 1024)
+        for (int item = 0; item < nbItems; ++item) {
+            const unsigned int channel = item / nbChunks;
+            const unsigned int chunk = item % nbChunks;
+            const unsigned int output = outputOffset + channel;
+            const ParamT mean = mSavedMean(output);
+            GradientSums<ParamT> itemSums;
+
+            for (unsigned int batchPos = chunk * batchSize / nbChunks,
+                batchEnd = (chunk + 1) * batchSize / nbChunks;
+                batchPos < batchEnd; ++batchPos)
+            {
+                const T* inputPlane = &input(0, 0, channel, batchPos);
+                const T* diffInputPlane = &mDiffInputs(0, 0, output, batchPos);
+
+                for (unsigned int i = 0; i < planeSize; ++i) {
+                    const ParamT zeroed = (ParamT)inputPlane[i] - mean;
+                    const ParamT diff = (ParamT)diffInputPlane[i];
+
+                    itemSums.diff += diff;
+                    itemSums.diffZeroed += diff * zeroed;
+                    itemSums.zeroed += zeroed;
                 }
             }
 
+            sums[item] = itemSums;
+        }
+
+        // diffOutput = diffScale * diffInput + diffInputScale * input
+        //              + diffShift
+        std::vector<T> diffScale(nbChannels);
+        std::vector<T> diffInputScale(nbChannels);
+        std::vector<T> diffShift(nbChannels);
+
+        for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+            const unsigned int output = outputOffset + channel;
+            const GradientSums<ParamT> channelSums
+                = reduceChunks(sums, channel * nbChunks, nbChunks);
+            const ParamT var = std::sqrt(mSavedVariance(output)
+                                         + (ParamT)mEpsilon);
+            const ParamT scale = (*mScale)(output);
+
             mDiffSavedVariance(output)
-                = sumVariance * (-1.0 / 2.0)
+                = scale * channelSums.diffZeroed * (-1.0 / 2.0)
                   * std::pow(mSavedVariance(output) + mEpsilon, -3.0 / 2.0);
-            mDiffSavedMean(output) = sumMean1 * (-1.0 / (ParamT)var)
-                                     + mDiffSavedVariance(output) * sumMean2
+            mDiffSavedMean(output) = scale * channelSums.diff * (-1.0 / var)
+                                     + mDiffSavedVariance(output)
+                                       * (-2.0 * channelSums.zeroed)
                                        / (ParamT)size;
 
-            mDiffScale(output) = sumScale + betaScale * mDiffScale(output);
-            mDiffBias(output) = sumBias + betaBias * mDiffBias(output);
+            mDiffScale(output) = channelSums.diffZeroed / var
+                                    + betaScale * mDiffScale(output);
+            mDiffBias(output) = channelSums.diff
+                                    + betaBias * mDiffBias(output);
+
+            const ParamT diffVarianceScale = 2.0 * mDiffSavedVariance(output)
+                                                / (ParamT)size;
+
+            diffScale[channel] = T(scale / var);
+            diffInputScale[channel] = T(diffVarianceScale);
+            diffShift[channel] = T(mDiffSavedMean(output) / (ParamT)size
+                                   - diffVarianceScale * mSavedMean(output));
         }
 
         if (!mDiffOutputs.empty()) {
@@ -333,23 +475,19 @@ void N2D2::BatchNormCell_Frame<T>::backPropagate()
                     ++channel)
                 {
                     const unsigned int output = outputOffset + channel;
-                    const T var(std::sqrt( (T)mSavedVariance(output) + mEpsilon));
-
-                    for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
-                        for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
-                            const T diffNormalized(
-                                mDiffInputs(ox, oy, output, batchPos)
-                                  * (T)(*mScale)(output));
-                            const T gradient( diffNormalized / var
-                                  + (T)mDiffSavedVariance(output) * 2.0
-                                    * (input(ox, oy, channel, batchPos)
-                                       -(T) mSavedMean(output)) / (T)size
-                                  + (T)mDiffSavedMean(output) / (T)size);
-
-                            diffOutput(ox, oy, channel, batchPos)
-                                = (gradient
-                                + isValid * diffOutput(ox, oy, channel, batchPos));
-                        }
+                    const T* inputPlane = &input(0, 0, channel, batchPos);
+                    const T* diffInputPlane
+                        = &mDiffInputs(0, 0, output, batchPos);
+                    T* diffOutputPlane = &diffOutput(0, 0, channel, batchPos);
+
+                    for (unsigned int i = 0; i < planeSize; ++i) {
+                        const T gradient = diffScale[channel]
+                                                * diffInputPlane[i]
+                            + diffInputScale[channel] * inputPlane[i]
+                            + diffShift[channel];
+
+                        diffOutputPlane[i] = (isValid)
+                            ? T(gradient + diffOutputPlane[i]) : gradient;
                     }
                 }
             }
@@ -396,7 +534,7 @@ void N2D2::BatchNormCell_Frame<T>::checkGradient(double epsilon, double maxError
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << in << "]";
 
-            gc.check(name.str(), mInputs[in], mDiffOutputs[in]);
+            gc.check(name.str(), mInputs[in], mDiffOutputs[in], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -424,6 +562,18 @@ void N2D2::BatchNormCell_Frame<T>::saveFreeParameters(const std::string
         throw std::runtime_error("Error writing parameter file: " + fileName);
 }
 
+template <class T>
+std::vector<std::pair<std::string, N2D2::BaseTensor*> >
+N2D2::BatchNormCell_Frame<T>::getFreeParametersTensors()
+{
+    std::vector<std::pair<std::string, BaseTensor*> > tensors;
+    tensors.push_back(std::make_pair("scales", mScale.get()));
+    tensors.push_back(std::make_pair("biases", mBias.get()));
+    tensors.push_back(std::make_pair("means", mMean.get()));
+    tensors.push_back(std::make_pair("variances", mVariance.get()));
+    return tensors;
+}
+
 template <class T>
 void N2D2::BatchNormCell_Frame<T>::loadFreeParameters(const std::string& fileName,
                                                    bool ignoreNotExists)
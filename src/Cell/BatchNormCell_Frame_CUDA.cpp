@@ -371,7 +371,7 @@ void N2D2::BatchNormCell_Frame_CUDA<T>::checkGradient(double epsilon,
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << in << "]";
 
-            gc.check(name.str(), mInputs[in], mDiffOutputs[in]);
+            gc.check(name.str(), mInputs[in], mDiffOutputs[in], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -403,6 +403,18 @@ void N2D2::BatchNormCell_Frame_CUDA<T>::saveFreeParameters(const std::string
         throw std::runtime_error("Error writing parameter file: " + fileName);
 }
 
+template <class T>
+std::vector<std::pair<std::string, N2D2::BaseTensor*> >
+N2D2::BatchNormCell_Frame_CUDA<T>::getFreeParametersTensors()
+{
+    std::vector<std::pair<std::string, BaseTensor*> > tensors;
+    tensors.push_back(std::make_pair("scales", mScale.get()));
+    tensors.push_back(std::make_pair("biases", mBias.get()));
+    tensors.push_back(std::make_pair("means", mMean.get()));
+    tensors.push_back(std::make_pair("variances", mVariance.get()));
+    return tensors;
+}
+
 template <class T>
 void N2D2::BatchNormCell_Frame_CUDA<T>::loadFreeParameters(const std::string
                                                         & fileName,
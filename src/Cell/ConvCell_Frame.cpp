@@ -353,7 +353,7 @@ void N2D2::ConvCell_Frame<T>::checkGradient(double epsilon, double maxError)
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << k << "]";
 
-            gc.check(name.str(), mInputs[k], mDiffOutputs[k]);
+            gc.check(name.str(), mInputs[k], mDiffOutputs[k], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -381,6 +381,23 @@ void N2D2::ConvCell_Frame<T>::saveFreeParameters(const std::string& fileName) co
         throw std::runtime_error("Error writing synaptic file: " + fileName);
 }
 
+template <class T>
+std::vector<std::pair<std::string, N2D2::BaseTensor*> >
+N2D2::ConvCell_Frame<T>::getFreeParametersTensors()
+{
+    std::vector<std::pair<std::string, BaseTensor*> > tensors;
+
+    for (unsigned int k = 0; k < mSharedSynapses.size(); ++k) {
+        tensors.push_back(std::make_pair("weights" + std::to_string(k),
+                                         &mSharedSynapses[k]));
+    }
+
+    if (!mNoBias)
+        tensors.push_back(std::make_pair("biases", mBias.get()));
+
+    return tensors;
+}
+
 template <class T>
 void N2D2::ConvCell_Frame<T>::loadFreeParameters(const std::string& fileName,
                                               bool ignoreNotExists)
@@ -838,7 +838,7 @@ void N2D2::ConvCell_Frame_CUDA<T>::checkGradient(double epsilon, double maxError
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << k << "]";
 
-            gc.check(name.str(), mInputs[k], mDiffOutputs[k]);
+            gc.check(name.str(), mInputs[k], mDiffOutputs[k], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -914,6 +914,23 @@ void N2D2::ConvCell_Frame_CUDA<T>::saveFreeParameters(const std::string
         throw std::runtime_error("Error writing synaptic file: " + fileName);
 }
 
+template <class T>
+std::vector<std::pair<std::string, N2D2::BaseTensor*> >
+N2D2::ConvCell_Frame_CUDA<T>::getFreeParametersTensors()
+{
+    std::vector<std::pair<std::string, BaseTensor*> > tensors;
+
+    for (unsigned int k = 0; k < mSharedSynapses.size(); ++k) {
+        tensors.push_back(std::make_pair("weights" + std::to_string(k),
+                                         &mSharedSynapses[k]));
+    }
+
+    if (!mNoBias)
+        tensors.push_back(std::make_pair("biases", mBias.get()));
+
+    return tensors;
+}
+
 template <class T>
 void N2D2::ConvCell_Frame_CUDA<T>::loadFreeParameters(const std::string& fileName,
                                                    bool ignoreNotExists)
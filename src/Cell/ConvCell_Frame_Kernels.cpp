@@ -21,6 +21,7 @@
 #include "Cell/ConvCell_Frame_Kernels.hpp"
 #include "containers/Tensor.hpp"
 #include "third_party/half.hpp"
+#include "utils/Half.hpp"
 #include "utils/Utils.hpp"
 
 template <class T>
@@ -431,15 +432,168 @@ void N2D2::ConvCell_Frame_Kernels::backwardBias(const T* alpha,
     }
 }
 
+namespace {
+// Half-precision tensors are converted in bulk to float for computation.
+// This is much faster than the half_float software arithmetic, which
+// converts each operand to float and back for every single operation.
+// The float tensors are kept across calls (one set per thread), so that no
+// allocation is made once the largest layer has been processed.
+enum FloatBuffer {
+    Src0Buffer,
+    Src1Buffer,
+    DstBuffer,
+    NbFloatBuffers
+};
+
+N2D2::Tensor<float>& toFloatTensor(
+    const N2D2::Tensor<half_float::half>& tensor,
+    FloatBuffer buffer,
+    bool copyData = true)
+{
+    static thread_local std::vector<N2D2::Tensor<float> >
+        floatTensors(NbFloatBuffers);
+
+    N2D2::Tensor<float>& floatTensor = floatTensors[buffer];
+    floatTensor.resize(tensor.dims());
+
+    if (tensor.empty())
+        return floatTensor;
+
+    if (copyData) {
+        N2D2::Half::toFloat(&(*tensor.begin()), &(*floatTensor.begin()),
+                            tensor.size());
+    }
+    else {
+        // The kernels scale the previous values with beta = 0: they must be
+        // finite
+        floatTensor.fill(0.0f);
+    }
+
+    return floatTensor;
+}
+
+void fromFloatTensor(const N2D2::Tensor<float>& floatTensor,
+                     N2D2::Tensor<half_float::half>& tensor)
+{
+    if (!tensor.empty()) {
+        N2D2::Half::fromFloat(&(*floatTensor.begin()), &(*tensor.begin()),
+                              tensor.size());
+    }
+}
+}
+
+namespace N2D2 {
+template <>
+void ConvCell_Frame_Kernels::forward<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Tensor<half_float::half>& sharedSynapses,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs,
+    const Tensor<bool>& maps)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& outputsF = toFloatTensor(outputs, DstBuffer,
+                                            betaF != 0.0f);
+    forward<float>(&alphaF,
+                   toFloatTensor(inputs, Src0Buffer),
+                   toFloatTensor(sharedSynapses, Src1Buffer),
+                   desc,
+                   &betaF,
+                   outputsF,
+                   maps);
+    fromFloatTensor(outputsF, outputs);
+}
+
+template <>
+void ConvCell_Frame_Kernels::forwardBias<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& bias,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& outputsF = toFloatTensor(outputs, DstBuffer,
+                                            betaF != 0.0f);
+    forwardBias<float>(&alphaF, toFloatTensor(bias, Src0Buffer), &betaF,
+                       outputsF);
+    fromFloatTensor(outputsF, outputs);
+}
+
+template <>
+void ConvCell_Frame_Kernels::backwardData<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& sharedSynapses,
+    const Tensor<half_float::half>& diffInputs,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& diffOutputs,
+    const Tensor<bool>& maps)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& diffOutputsF = toFloatTensor(diffOutputs, DstBuffer,
+                                                betaF != 0.0f);
+    backwardData<float>(&alphaF,
+                        toFloatTensor(sharedSynapses, Src0Buffer),
+                        toFloatTensor(diffInputs, Src1Buffer),
+                        desc,
+                        &betaF,
+                        diffOutputsF,
+                        maps);
+    fromFloatTensor(diffOutputsF, diffOutputs);
+}
+
+template <>
+void ConvCell_Frame_Kernels::backwardFilter<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Tensor<half_float::half>& diffInputs,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& diffSharedSynapses,
+    const Tensor<bool>& maps)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& diffSharedSynapsesF
+        = toFloatTensor(diffSharedSynapses, DstBuffer, betaF != 0.0f);
+    backwardFilter<float>(&alphaF,
+                          toFloatTensor(inputs, Src0Buffer),
+                          toFloatTensor(diffInputs, Src1Buffer),
+                          desc,
+                          &betaF,
+                          diffSharedSynapsesF,
+                          maps);
+    fromFloatTensor(diffSharedSynapsesF, diffSharedSynapses);
+}
+
+template <>
+void ConvCell_Frame_Kernels::backwardBias<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& diffInputs,
+    const half_float::half* beta,
+    Tensor<half_float::half>& diffBias)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& diffBiasF = toFloatTensor(diffBias, DstBuffer,
+                                             betaF != 0.0f);
+    backwardBias<float>(&alphaF, toFloatTensor(diffInputs, Src0Buffer),
+                        &betaF, diffBiasF);
+    fromFloatTensor(diffBiasF, diffBias);
+}
+}
+
 namespace N2D2 {
-    template void ConvCell_Frame_Kernels::forward<half_float::half>(const half_float::half* alpha,
-                                           const Tensor<half_float::half>& inputs,
-                                           const Tensor
-                                           <half_float::half>& sharedSynapses,
-                                           const Descriptor& desc,
-                                           const half_float::half* beta,
-                                           Tensor<half_float::half>& outputs,
-                                           const Tensor<bool>& maps);
     template void ConvCell_Frame_Kernels::forward<float>(const float* alpha,
                                            const Tensor<float>& inputs,
                                            const Tensor
@@ -457,10 +611,6 @@ namespace N2D2 {
                                            Tensor<double>& outputs,
                                            const Tensor<bool>& maps);
 
-    template void ConvCell_Frame_Kernels::forwardBias<half_float::half>(const half_float::half* alpha,
-                                               const Tensor<half_float::half>& bias,
-                                               const half_float::half* beta,
-                                               Tensor<half_float::half>& outputs);
     template void ConvCell_Frame_Kernels::forwardBias<float>(const float* alpha,
                                                const Tensor<float>& bias,
                                                const float* beta,
@@ -470,15 +620,6 @@ namespace N2D2 {
                                                const double* beta,
                                                Tensor<double>& outputs);
 
-    template void ConvCell_Frame_Kernels::backwardData<half_float::half>(const half_float::half* alpha,
-                                                const Tensor
-                                                <half_float::half>& sharedSynapses,
-                                                const Tensor
-                                                <half_float::half>& diffInputs,
-                                                const Descriptor& desc,
-                                                const half_float::half* beta,
-                                                Tensor<half_float::half>& diffOutputs,
-                                                const Tensor<bool>& maps);
     template void ConvCell_Frame_Kernels::backwardData<float>(const float* alpha,
                                                 const Tensor
                                                 <float>& sharedSynapses,
@@ -498,16 +639,6 @@ namespace N2D2 {
                                                 Tensor<double>& diffOutputs,
                                                 const Tensor<bool>& maps);
 
-    template void ConvCell_Frame_Kernels::backwardFilter<half_float::half>(const half_float::half* alpha,
-                                                  const Tensor
-                                                  <half_float::half>& inputs,
-                                                  const Tensor
-                                                  <half_float::half>& diffInputs,
-                                                  const Descriptor& desc,
-                                                  const half_float::half* beta,
-                                                  Tensor
-                                                  <half_float::half>& diffSharedSynapses,
-                                                  const Tensor<bool>& maps);
     template void ConvCell_Frame_Kernels::backwardFilter<float>(const float* alpha,
                                                   const Tensor
                                                   <float>& inputs,
@@ -529,11 +660,6 @@ namespace N2D2 {
                                                   <double>& diffSharedSynapses,
                                                   const Tensor<bool>& maps);
 
-    template void ConvCell_Frame_Kernels::backwardBias<half_float::half>(const half_float::half* alpha,
-                                                const Tensor
-                                                <half_float::half>& diffInputs,
-                                                const half_float::half* beta,
-                                                Tensor<half_float::half>& diffBias);
     template void ConvCell_Frame_Kernels::backwardBias<float>(const float* alpha,
                                                 const Tensor
                                                 <float>& diffInputs,
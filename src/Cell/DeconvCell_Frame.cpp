@@ -186,9 +186,9 @@ void N2D2::DeconvCell_Frame<T>::propagate(bool inference)
 
         const Tensor<T>& input = tensor_cast<T>(mInputs[k]);
 
-        ConvCell_Frame_Kernels::backwardData<T>(&alpha,
-                                             mSharedSynapses[k],
+        DeconvCell_Frame_Kernels::forward<T>(&alpha,
                                              input,
+                                             mSharedSynapses[k],
                                              mConvDesc,
                                              &beta,
                                              mOutputs,
@@ -220,14 +220,14 @@ void N2D2::DeconvCell_Frame<T>::backPropagate()
 
         const Tensor<T>& input = tensor_cast_nocopy<T>(mInputs[k]);
 
-        ConvCell_Frame_Kernels::backwardFilter<T>(&alpha,
-                                               mDiffInputs,
-                                               input,
-                                               mConvDesc,
-                                               &beta,
-                                               mDiffSharedSynapses[k],
-                                               mMapping.rows(offset,
-                                                          mInputs[k].dimZ()));
+        DeconvCell_Frame_Kernels::backwardFilter<T>(&alpha,
+                                                    input,
+                                                    mDiffInputs,
+                                                    mConvDesc,
+                                                    &beta,
+                                                    mDiffSharedSynapses[k],
+                                                    mMapping.rows(offset,
+                                                            mInputs[k].dimZ()));
 
         offset += mInputs[k].dimZ();
     }
@@ -249,14 +249,14 @@ void N2D2::DeconvCell_Frame<T>::backPropagate()
                 ? tensor_cast<T>(mDiffOutputs[k])
                 : tensor_cast_nocopy<T>(mDiffOutputs[k]);
 
-            ConvCell_Frame_Kernels::forward<T>(&alpha,
-                                            mDiffInputs,
-                                            mSharedSynapses[k],
-                                            mConvDesc,
-                                            &beta,
-                                            diffOutput,
-                                            mMapping.rows(offset,
-                                                       mInputs[k].dimZ()));
+            DeconvCell_Frame_Kernels::backwardData<T>(&alpha,
+                                                      mSharedSynapses[k],
+                                                      mDiffInputs,
+                                                      mConvDesc,
+                                                      &beta,
+                                                      diffOutput,
+                                                      mMapping.rows(offset,
+                                                            mInputs[k].dimZ()));
 
             offset += mInputs[k].dimZ();
 
@@ -319,7 +319,7 @@ void N2D2::DeconvCell_Frame<T>::checkGradient(double epsilon, double maxError)
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << k << "]";
 
-            gc.check(name.str(), mInputs[k], mDiffOutputs[k]);
+            gc.check(name.str(), mInputs[k], mDiffOutputs[k], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -348,6 +348,23 @@ void N2D2::DeconvCell_Frame<T>::saveFreeParameters(const std::string
         throw std::runtime_error("Error writing synaptic file: " + fileName);
 }
 
+template <class T>
+std::vector<std::pair<std::string, N2D2::BaseTensor*> >
+N2D2::DeconvCell_Frame<T>::getFreeParametersTensors()
+{
+    std::vector<std::pair<std::string, BaseTensor*> > tensors;
+
+    for (unsigned int k = 0; k < mSharedSynapses.size(); ++k) {
+        tensors.push_back(std::make_pair("weights" + std::to_string(k),
+                                         &mSharedSynapses[k]));
+    }
+
+    if (!mNoBias)
+        tensors.push_back(std::make_pair("biases", mBias.get()));
+
+    return tensors;
+}
+
 template <class T>
 void N2D2::DeconvCell_Frame<T>::loadFreeParameters(const std::string& fileName,
                                                 bool ignoreNotExists)
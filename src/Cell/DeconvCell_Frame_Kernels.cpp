@@ -0,0 +1,701 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Cell/DeconvCell_Frame_Kernels.hpp"
+#include "third_party/half.hpp"
+#include "utils/Half.hpp"
+#include "utils/Utils.hpp"
+
+namespace {
+// Number of elements of the per-thread GEMM buffers (cols block)
+const unsigned int BLOCK_SIZE = 16384;
+
+inline bool isConnected(const N2D2::Tensor<bool>& maps,
+                        unsigned int output,
+                        unsigned int channel)
+{
+    return (maps.empty() || maps(output, channel));
+}
+
+/// Range [min, max[ of the input positions i such that
+/// 0 <= i * stride + offset < outputSize
+inline void validRange(int offset,
+                       unsigned int stride,
+                       unsigned int inputSize,
+                       unsigned int outputSize,
+                       unsigned int& min,
+                       unsigned int& max)
+{
+    const int iMin = (offset < 0)
+        ? (-offset + (int)stride - 1) / (int)stride : 0;
+    const int iMax = ((int)outputSize - offset > 0)
+        ? ((int)outputSize - offset + (int)stride - 1) / (int)stride : 0;
+
+    min = (unsigned int)std::min(iMin, (int)inputSize);
+    max = (unsigned int)std::max(std::min(iMax, (int)inputSize), (int)min);
+}
+
+template <class T>
+void forwardCol2Im(const T alpha,
+                   const N2D2::Tensor<T>& inputs,
+                   const N2D2::Tensor<T>& sharedSynapses,
+                   const N2D2::DeconvCell_Frame_Kernels::Descriptor& desc,
+                   N2D2::Tensor<T>& outputs,
+                   const N2D2::Tensor<bool>& maps)
+{
+    const unsigned int kx = sharedSynapses.dimX();
+    const unsigned int ky = sharedSynapses.dimY();
+    const unsigned int kSize = kx * ky;
+    const unsigned int inputsWidth = inputs.dimX();
+    const unsigned int inputsHeight = inputs.dimY();
+    const unsigned int outputsWidth = outputs.dimX();
+    const unsigned int outputsHeight = outputs.dimY();
+    const unsigned int nbChannels = inputs.dimZ();
+    const unsigned int nbOutputs = outputs.dimZ();
+
+    // Blocks of whole input rows
+    const unsigned int blockRows = std::max(1U,
+        std::min(inputsHeight, BLOCK_SIZE / (kSize * inputsWidth)));
+    const int size = inputs.dimB() * nbOutputs;
+
+#pragma omp parallel if (size > 1)
+    {
+        std::vector<T> cols(kSize * blockRows * inputsWidth);
+
+#pragma omp for schedule(dynamic)
+        for (int index = 0; index < size; ++index) {
+            const unsigned int batchPos = index / nbOutputs;
+            const unsigned int output = index % nbOutputs;
+            T* outputsData = &outputs(0, 0, output, batchPos);
+
+            for (unsigned int iy0 = 0; iy0 < inputsHeight; iy0 += blockRows) {
+                const unsigned int nbRows
+                    = std::min(blockRows, inputsHeight - iy0);
+                const unsigned int blockSize = nbRows * inputsWidth;
+
+                // GEMM: cols = W(output)^T x inputs(rows block)
+                std::fill(cols.begin(), cols.end(), T(0.0));
+
+                for (unsigned int channel = 0; channel < nbChannels;
+                    ++channel)
+                {
+                    if (!isConnected(maps, output, channel))
+                        continue;
+
+                    const T* weights = &sharedSynapses(0, 0, output, channel);
+                    const T* inputsData = &inputs(0, iy0, channel, batchPos);
+
+                    for (unsigned int k = 0; k < kSize; ++k) {
+                        const T weight = weights[k];
+                        T* col = &cols[k * blockSize];
+
+                        for (unsigned int i = 0; i < blockSize; ++i)
+                            col[i] += weight * inputsData[i];
+                    }
+                }
+
+                // col2im scatter
+                for (unsigned int sy = 0; sy < ky; ++sy) {
+                    const int offsetY = (int)(sy * desc.dilation[1])
+                                            - desc.padding[1];
+                    unsigned int iyMin, iyMax;
+                    validRange(offsetY, desc.stride[1], inputsHeight,
+                               outputsHeight, iyMin, iyMax);
+
+                    for (unsigned int sx = 0; sx < kx; ++sx) {
+                        const int offsetX = (int)(sx * desc.dilation[0])
+                                                - desc.padding[0];
+                        unsigned int ixMin, ixMax;
+                        validRange(offsetX, desc.stride[0], inputsWidth,
+                                   outputsWidth, ixMin, ixMax);
+
+                        const T* col = &cols[(sx + sy * kx) * blockSize];
+
+                        for (unsigned int iy = std::max(iy0, iyMin);
+                            iy < std::min(iy0 + nbRows, iyMax); ++iy)
+                        {
+                            const unsigned int oy = iy * desc.stride[1]
+                                                        + offsetY;
+                            T* outputsRow = outputsData + oy * outputsWidth;
+                            const T* colRow = col + (iy - iy0) * inputsWidth;
+
+                            for (unsigned int ix = ixMin; ix < ixMax; ++ix) {
+                                outputsRow[ix * desc.stride[0] + offsetX]
+                                    += alpha * colRow[ix];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+void forwardSubPixel(const T alpha,
+                     const N2D2::Tensor<T>& inputs,
+                     const N2D2::Tensor<T>& sharedSynapses,
+                     const N2D2::DeconvCell_Frame_Kernels::Descriptor& desc,
+                     N2D2::Tensor<T>& outputs,
+                     const N2D2::Tensor<bool>& maps)
+{
+    const unsigned int kx = sharedSynapses.dimX();
+    const unsigned int ky = sharedSynapses.dimY();
+    const unsigned int strideX = desc.stride[0];
+    const unsigned int strideY = desc.stride[1];
+    const unsigned int inputsWidth = inputs.dimX();
+    const unsigned int inputsHeight = inputs.dimY();
+    const unsigned int outputsWidth = outputs.dimX();
+    const unsigned int outputsHeight = outputs.dimY();
+    const unsigned int nbChannels = inputs.dimZ();
+    const unsigned int nbOutputs = outputs.dimZ();
+
+    // Sub-pixel phase (rx, ry) = outputs (rx + m * strideX, ry + n * strideY)
+    const unsigned int phaseWidth = (outputsWidth + strideX - 1) / strideX;
+    const unsigned int phaseHeight = (outputsHeight + strideY - 1) / strideY;
+    const int size = inputs.dimB() * nbOutputs;
+
+#pragma omp parallel if (size > 1)
+    {
+        std::vector<T> phase(phaseWidth * phaseHeight);
+
+#pragma omp for schedule(dynamic)
+        for (int index = 0; index < size; ++index) {
+            const unsigned int batchPos = index / nbOutputs;
+            const unsigned int output = index % nbOutputs;
+            T* outputsData = &outputs(0, 0, output, batchPos);
+
+            for (unsigned int ry = 0; ry < strideY; ++ry) {
+                for (unsigned int rx = 0; rx < strideX; ++rx) {
+                    const unsigned int width
+                        = (outputsWidth - rx + strideX - 1) / strideX;
+                    const unsigned int height
+                        = (outputsHeight - ry + strideY - 1) / strideY;
+
+                    std::fill(phase.begin(), phase.end(), T(0.0));
+
+                    for (unsigned int channel = 0; channel < nbChannels;
+                        ++channel)
+                    {
+                        if (!isConnected(maps, output, channel))
+                            continue;
+
+                        const T* weights
+                            = &sharedSynapses(0, 0, output, channel);
+                        const T* inputsData
+                            = &inputs(0, 0, channel, batchPos);
+
+                        // Only the taps landing on this phase contribute:
+                        // no multiplication by the zeros of the upsampled
+                        // inputs
+                        for (unsigned int sy = 0; sy < ky; ++sy) {
+                            const int numY = (int)ry + desc.padding[1]
+                                - (int)(sy * desc.dilation[1]);
+
+                            if (((numY % (int)strideY) + (int)strideY)
+                                    % (int)strideY != 0)
+                            {
+                                continue;
+                            }
+
+                            const int dy = numY / (int)strideY;
+                            const int nMin
+                                = N2D2::Utils::clamp<int>(-dy, 0, height);
+                            const int nMax = N2D2::Utils::clamp<int>(
+                                (int)inputsHeight - dy, nMin, height);
+
+                            for (unsigned int sx = 0; sx < kx; ++sx) {
+                                const int numX = (int)rx + desc.padding[0]
+                                    - (int)(sx * desc.dilation[0]);
+
+                                if (((numX % (int)strideX) + (int)strideX)
+                                        % (int)strideX != 0)
+                                {
+                                    continue;
+                                }
+
+                                const int dx = numX / (int)strideX;
+                                const int mMin
+                                    = N2D2::Utils::clamp<int>(-dx, 0, width);
+                                const int mMax = N2D2::Utils::clamp<int>(
+                                    (int)inputsWidth - dx, mMin, width);
+
+                                const T weight = weights[sx + sy * kx];
+
+                                for (int n = nMin; n < nMax; ++n) {
+                                    T* phaseRow = &phase[n * phaseWidth];
+                                    const T* inputsRow = inputsData
+                                        + (n + dy) * inputsWidth;
+
+                                    for (int m = mMin; m < mMax; ++m) {
+                                        phaseRow[m]
+                                            += weight * inputsRow[m + dx];
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    for (unsigned int n = 0; n < height; ++n) {
+                        T* outputsRow = outputsData
+                            + (ry + n * strideY) * outputsWidth + rx;
+                        const T* phaseRow = &phase[n * phaseWidth];
+
+                        for (unsigned int m = 0; m < width; ++m)
+                            outputsRow[m * strideX] += alpha * phaseRow[m];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+void scale(const T beta, N2D2::Tensor<T>& data)
+{
+    if (beta == T(0.0))
+        data.fill(T(0.0));
+    else if (beta != T(1.0)) {
+        const int size = data.size();
+
+#pragma omp parallel for if (size > 1024)
+        for (int index = 0; index < size; ++index)
+            data(index) *= beta;
+    }
+}
+}
+
+template <class T>
+void N2D2::DeconvCell_Frame_Kernels::forward(const T* alpha,
+                                             const Tensor<T>& inputs,
+                                             const Tensor<T>& sharedSynapses,
+                                             const Descriptor& desc,
+                                             const T* beta,
+                                             Tensor<T>& outputs,
+                                             const Tensor<bool>& maps)
+{
+    scale(*beta, outputs);
+
+    if (desc.stride[0] == 2 && desc.stride[1] == 2)
+        forwardSubPixel(*alpha, inputs, sharedSynapses, desc, outputs, maps);
+    else
+        forwardCol2Im(*alpha, inputs, sharedSynapses, desc, outputs, maps);
+}
+
+template <class T>
+void N2D2::DeconvCell_Frame_Kernels::backwardData(const T* alpha,
+                                                  const Tensor
+                                                  <T>& sharedSynapses,
+                                                  const Tensor
+                                                  <T>& diffInputs,
+                                                  const Descriptor& desc,
+                                                  const T* beta,
+                                                  Tensor<T>& diffOutputs,
+                                                  const Tensor<bool>& maps)
+{
+    // Gradient of a transposed convolution = convolution of the diffInputs:
+    // im2col of the diffInputs, followed by a GEMM with the weights
+    const unsigned int kx = sharedSynapses.dimX();
+    const unsigned int ky = sharedSynapses.dimY();
+    const unsigned int kSize = kx * ky;
+    const unsigned int outputsWidth = diffOutputs.dimX();
+    const unsigned int outputsHeight = diffOutputs.dimY();
+    const unsigned int inputsWidth = diffInputs.dimX();
+    const unsigned int inputsHeight = diffInputs.dimY();
+    const unsigned int nbChannels = diffOutputs.dimZ();
+    const unsigned int nbOutputs = diffInputs.dimZ();
+
+    const unsigned int blockRows = std::max(1U,
+        std::min(outputsHeight,
+                 BLOCK_SIZE / (nbOutputs * kSize * outputsWidth)));
+    const unsigned int nbBlocks = (outputsHeight + blockRows - 1) / blockRows;
+    const int size = diffOutputs.dimB() * nbBlocks;
+
+#pragma omp parallel if (size > 1)
+    {
+        std::vector<T> cols(nbOutputs * kSize * blockRows * outputsWidth);
+        std::vector<T> gradient(blockRows * outputsWidth);
+
+#pragma omp for schedule(dynamic)
+        for (int index = 0; index < size; ++index) {
+            const unsigned int batchPos = index / nbBlocks;
+            const unsigned int iy0 = (index % nbBlocks) * blockRows;
+            const unsigned int nbRows = std::min(blockRows,
+                                                 outputsHeight - iy0);
+            const unsigned int blockSize = nbRows * outputsWidth;
+
+            // im2col
+            for (unsigned int output = 0; output < nbOutputs; ++output) {
+                const T* diffInputsData = &diffInputs(0, 0, output, batchPos);
+
+                for (unsigned int sy = 0; sy < ky; ++sy) {
+                    const int offsetY = (int)(sy * desc.dilation[1])
+                                            - desc.padding[1];
+                    unsigned int iyMin, iyMax;
+                    validRange(offsetY, desc.stride[1], outputsHeight,
+                               inputsHeight, iyMin, iyMax);
+
+                    for (unsigned int sx = 0; sx < kx; ++sx) {
+                        const int offsetX = (int)(sx * desc.dilation[0])
+                                                - desc.padding[0];
+                        unsigned int ixMin, ixMax;
+                        validRange(offsetX, desc.stride[0], outputsWidth,
+                                   inputsWidth, ixMin, ixMax);
+
+                        T* col = &cols[(sx + kx * (sy + ky * output))
+                                       * blockSize];
+                        std::fill(col, col + blockSize, T(0.0));
+
+                        for (unsigned int iy = std::max(iy0, iyMin);
+                            iy < std::min(iy0 + nbRows, iyMax); ++iy)
+                        {
+                            const T* diffInputsRow = diffInputsData
+                                + (iy * desc.stride[1] + offsetY)
+                                    * inputsWidth;
+                            T* colRow = col + (iy - iy0) * outputsWidth;
+
+                            for (unsigned int ix = ixMin; ix < ixMax; ++ix) {
+                                colRow[ix] = diffInputsRow[ix * desc.stride[0]
+                                                           + offsetX];
+                            }
+                        }
+                    }
+                }
+            }
+
+            // GEMM: diffOutputs(rows block) = W x cols
+            for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+                std::fill(gradient.begin(), gradient.end(), T(0.0));
+
+                for (unsigned int output = 0; output < nbOutputs; ++output) {
+                    if (!isConnected(maps, output, channel))
+                        continue;
+
+                    const T* weights = &sharedSynapses(0, 0, output, channel);
+
+                    for (unsigned int k = 0; k < kSize; ++k) {
+                        const T weight = weights[k];
+                        const T* col = &cols[(k + kSize * output) * blockSize];
+
+                        for (unsigned int i = 0; i < blockSize; ++i)
+                            gradient[i] += weight * col[i];
+                    }
+                }
+
+                T* diffOutputsData = &diffOutputs(0, iy0, channel, batchPos);
+
+                if ((*beta) == T(0.0)) {
+                    for (unsigned int i = 0; i < blockSize; ++i)
+                        diffOutputsData[i] = (*alpha) * gradient[i];
+                }
+                else {
+                    for (unsigned int i = 0; i < blockSize; ++i) {
+                        diffOutputsData[i] = (*alpha) * gradient[i]
+                            + (*beta) * diffOutputsData[i];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+void N2D2::DeconvCell_Frame_Kernels::backwardFilter(const T* alpha,
+                                                    const Tensor
+                                                    <T>& inputs,
+                                                    const Tensor
+                                                    <T>& diffInputs,
+                                                    const Descriptor& desc,
+                                                    const T* beta,
+                                                    Tensor
+                                                    <T>& diffSharedSynapses,
+                                                    const Tensor<bool>& maps)
+{
+    // diffSharedSynapses = inputs x im2col(diffInputs)^T, one row of
+    // im2col(diffInputs) (= one output and one kernel tap) per task
+    const unsigned int kx = diffSharedSynapses.dimX();
+    const unsigned int ky = diffSharedSynapses.dimY();
+    const unsigned int kSize = kx * ky;
+    const unsigned int inputsWidth = inputs.dimX();
+    const unsigned int inputsHeight = inputs.dimY();
+    const unsigned int inputsSize = inputsWidth * inputsHeight;
+    const unsigned int outputsWidth = diffInputs.dimX();
+    const unsigned int outputsHeight = diffInputs.dimY();
+    const unsigned int nbChannels = inputs.dimZ();
+    const unsigned int nbOutputs = diffInputs.dimZ();
+    const int size = nbOutputs * kSize;
+
+#pragma omp parallel if (size > 1)
+    {
+        std::vector<T> col(inputsSize);
+        std::vector<T> gradient(nbChannels);
+
+#pragma omp for schedule(dynamic)
+        for (int index = 0; index < size; ++index) {
+            const unsigned int output = index / kSize;
+            const unsigned int k = index % kSize;
+            const unsigned int sx = k % kx;
+            const unsigned int sy = k / kx;
+
+            const int offsetX = (int)(sx * desc.dilation[0]) - desc.padding[0];
+            const int offsetY = (int)(sy * desc.dilation[1]) - desc.padding[1];
+            unsigned int ixMin, ixMax, iyMin, iyMax;
+            validRange(offsetX, desc.stride[0], inputsWidth, outputsWidth,
+                       ixMin, ixMax);
+            validRange(offsetY, desc.stride[1], inputsHeight, outputsHeight,
+                       iyMin, iyMax);
+
+            std::fill(gradient.begin(), gradient.end(), T(0.0));
+
+            for (unsigned int batchPos = 0; batchPos < inputs.dimB();
+                ++batchPos)
+            {
+                // Row of im2col(diffInputs) for (output, sx, sy)
+                const T* diffInputsData = &diffInputs(0, 0, output, batchPos);
+                std::fill(col.begin(), col.end(), T(0.0));
+
+                for (unsigned int iy = iyMin; iy < iyMax; ++iy) {
+                    const T* diffInputsRow = diffInputsData
+                        + (iy * desc.stride[1] + offsetY) * outputsWidth;
+                    T* colRow = &col[iy * inputsWidth];
+
+                    for (unsigned int ix = ixMin; ix < ixMax; ++ix) {
+                        colRow[ix] = diffInputsRow[ix * desc.stride[0]
+                                                   + offsetX];
+                    }
+                }
+
+                for (unsigned int channel = 0; channel < nbChannels;
+                    ++channel)
+                {
+                    if (!isConnected(maps, output, channel))
+                        continue;
+
+                    const T* inputsData = &inputs(0, 0, channel, batchPos);
+                    T sum(0.0);
+
+                    for (unsigned int i = 0; i < inputsSize; ++i)
+                        sum += inputsData[i] * col[i];
+
+                    gradient[channel] += sum;
+                }
+            }
+
+            for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+                if (!isConnected(maps, output, channel))
+                    continue;
+
+                T& diffSynapse = diffSharedSynapses(sx, sy, output, channel);
+                diffSynapse = ((*beta) == T(0.0))
+                    ? (*alpha) * gradient[channel]
+                    : (*alpha) * gradient[channel] + (*beta) * diffSynapse;
+            }
+        }
+    }
+}
+
+namespace {
+// Float copies of the half-precision tensors, reused across calls (one set
+// per thread), as in ConvCell_Frame_Kernels
+enum FloatBuffer {
+    Src0Buffer,
+    Src1Buffer,
+    DstBuffer,
+    NbFloatBuffers
+};
+
+N2D2::Tensor<float>& toFloatTensor(
+    const N2D2::Tensor<half_float::half>& tensor,
+    FloatBuffer buffer,
+    bool copyData = true)
+{
+    static thread_local std::vector<N2D2::Tensor<float> >
+        floatTensors(NbFloatBuffers);
+
+    N2D2::Tensor<float>& floatTensor = floatTensors[buffer];
+    floatTensor.resize(tensor.dims());
+
+    if (tensor.empty())
+        return floatTensor;
+
+    if (copyData) {
+        N2D2::Half::toFloat(&(*tensor.begin()), &(*floatTensor.begin()),
+                            tensor.size());
+    }
+    else {
+        // The kernels scale the previous values with beta = 0: they must be
+        // finite
+        floatTensor.fill(0.0f);
+    }
+
+    return floatTensor;
+}
+
+void fromFloatTensor(const N2D2::Tensor<float>& floatTensor,
+                     N2D2::Tensor<half_float::half>& tensor)
+{
+    if (!tensor.empty()) {
+        N2D2::Half::fromFloat(&(*floatTensor.begin()), &(*tensor.begin()),
+                              tensor.size());
+    }
+}
+}
+
+namespace N2D2 {
+template <>
+void DeconvCell_Frame_Kernels::forward<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Tensor<half_float::half>& sharedSynapses,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& outputs,
+    const Tensor<bool>& maps)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& outputsF = toFloatTensor(outputs, DstBuffer,
+                                            betaF != 0.0f);
+    DeconvCell_Frame_Kernels::forward<float>(&alphaF,
+                                             toFloatTensor(inputs,
+                                                           Src0Buffer),
+                                             toFloatTensor(sharedSynapses,
+                                                           Src1Buffer),
+                                             desc,
+                                             &betaF,
+                                             outputsF,
+                                             maps);
+    fromFloatTensor(outputsF, outputs);
+}
+
+template <>
+void DeconvCell_Frame_Kernels::backwardData<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& sharedSynapses,
+    const Tensor<half_float::half>& diffInputs,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& diffOutputs,
+    const Tensor<bool>& maps)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& diffOutputsF = toFloatTensor(diffOutputs, DstBuffer,
+                                                betaF != 0.0f);
+    DeconvCell_Frame_Kernels::backwardData<float>(&alphaF,
+                                                  toFloatTensor(sharedSynapses,
+                                                                Src0Buffer),
+                                                  toFloatTensor(diffInputs,
+                                                                Src1Buffer),
+                                                  desc,
+                                                  &betaF,
+                                                  diffOutputsF,
+                                                  maps);
+    fromFloatTensor(diffOutputsF, diffOutputs);
+}
+
+template <>
+void DeconvCell_Frame_Kernels::backwardFilter<half_float::half>(
+    const half_float::half* alpha,
+    const Tensor<half_float::half>& inputs,
+    const Tensor<half_float::half>& diffInputs,
+    const Descriptor& desc,
+    const half_float::half* beta,
+    Tensor<half_float::half>& diffSharedSynapses,
+    const Tensor<bool>& maps)
+{
+    const float alphaF = (float)(*alpha);
+    const float betaF = (float)(*beta);
+
+    Tensor<float>& diffSharedSynapsesF
+        = toFloatTensor(diffSharedSynapses, DstBuffer, betaF != 0.0f);
+    DeconvCell_Frame_Kernels::backwardFilter<float>(&alphaF,
+                                                    toFloatTensor(inputs,
+                                                                  Src0Buffer),
+                                                    toFloatTensor(diffInputs,
+                                                                  Src1Buffer),
+                                                    desc,
+                                                    &betaF,
+                                                    diffSharedSynapsesF,
+                                                    maps);
+    fromFloatTensor(diffSharedSynapsesF, diffSharedSynapses);
+}
+}
+
+namespace N2D2 {
+    template void DeconvCell_Frame_Kernels::forward<float>(const float* alpha,
+                                           const Tensor<float>& inputs,
+                                           const Tensor
+                                           <float>& sharedSynapses,
+                                           const Descriptor& desc,
+                                           const float* beta,
+                                           Tensor<float>& outputs,
+                                           const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::forward<double>(const double* alpha,
+                                           const Tensor<double>& inputs,
+                                           const Tensor
+                                           <double>& sharedSynapses,
+                                           const Descriptor& desc,
+                                           const double* beta,
+                                           Tensor<double>& outputs,
+                                           const Tensor<bool>& maps);
+
+    template void DeconvCell_Frame_Kernels::backwardData<float>(const float* alpha,
+                                                const Tensor
+                                                <float>& sharedSynapses,
+                                                const Tensor
+                                                <float>& diffInputs,
+                                                const Descriptor& desc,
+                                                const float* beta,
+                                                Tensor<float>& diffOutputs,
+                                                const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::backwardData<double>(const double* alpha,
+                                                const Tensor
+                                                <double>& sharedSynapses,
+                                                const Tensor
+                                                <double>& diffInputs,
+                                                const Descriptor& desc,
+                                                const double* beta,
+                                                Tensor<double>& diffOutputs,
+                                                const Tensor<bool>& maps);
+
+    template void DeconvCell_Frame_Kernels::backwardFilter<float>(const float* alpha,
+                                                  const Tensor
+                                                  <float>& inputs,
+                                                  const Tensor
+                                                  <float>& diffInputs,
+                                                  const Descriptor& desc,
+                                                  const float* beta,
+                                                  Tensor
+                                                  <float>& diffSharedSynapses,
+                                                  const Tensor<bool>& maps);
+    template void DeconvCell_Frame_Kernels::backwardFilter<double>(const double* alpha,
+                                                  const Tensor
+                                                  <double>& inputs,
+                                                  const Tensor
+                                                  <double>& diffInputs,
+                                                  const Descriptor& desc,
+                                                  const double* beta,
+                                                  Tensor
+                                                  <double>& diffSharedSynapses,
+                                                  const Tensor<bool>& maps);
+}
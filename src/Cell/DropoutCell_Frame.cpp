@@ -21,6 +21,7 @@
 #include "Cell/DropoutCell_Frame.hpp"
 #include "DeepNet.hpp"
 #include "third_party/half.hpp"
+#include "utils/Random.hpp"
 
 template <>
 N2D2::Registrar<N2D2::DropoutCell>
@@ -66,7 +67,8 @@ void N2D2::DropoutCell_Frame<T>::initialize()
         }
     }
 
-    mMask.resize(mOutputs.dims());
+    // One bit per activation
+    mMask.resize({(mOutputs.size() + 63) / 64});
 }
 
 template <class T>
@@ -104,32 +106,52 @@ void N2D2::DropoutCell_Frame<T>::propagate(bool inference)
             }
         }
     } else {
+        // The mask is stored as a bitset (one bit per activation). A single
+        // seed is drawn from the global generator for the whole batch, the
+        // mask is then generated in parallel with a counter-based generator
+        // and is independent of the number of threads.
+        const unsigned long long seed
+            = ((unsigned long long)Random::mtRand() << 32)
+                | Random::mtRand();
+        const unsigned long long threshold
+            = (unsigned long long)((1.0 - mDropout) * 4294967296.0);
+        const int nbWords = (int)mMask.size();
+
+#pragma omp parallel for if (nbWords > 16)
+        for (int word = 0; word < nbWords; ++word) {
+            unsigned long long bits = 0ULL;
+
+            for (unsigned int bit = 0; bit < 64; bit += 2) {
+                // Two 32 bits uniform numbers per 64 bits random number
+                const unsigned long long r = Random::counterRand(seed,
+                    32ULL * word + bit / 2);
+
+                bits |= (unsigned long long)((r & 0xFFFFFFFFULL) < threshold)
+                            << bit;
+                bits |= (unsigned long long)((r >> 32) < threshold)
+                            << (bit + 1);
+            }
+
+            mMask(word) = bits;
+        }
+
         for (unsigned int k = 0, size = mInputs.size(); k < size; ++k) {
             const Tensor<T>& input = tensor_cast<T>(mInputs[k]);
+            const unsigned int batchSize = mInputs[k].size() / mInputs.dimB();
+            const unsigned int outputStride = mOutputs.dimX() * mOutputs.dimY()
+                                                * mInputs.dimZ();
 
-            unsigned int outputOffset = offset;
-            unsigned int inputOffset = 0;
-
-            for (unsigned int batchPos = 0; batchPos < mInputs.dimB();
-                ++batchPos)
+#pragma omp parallel for if (mInputs.dimB() > 4)
+            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos)
             {
-                for (unsigned int index = 0,
-                     batchSize = (mInputs[k].size() / mInputs.dimB());
-                     index < batchSize;
-                     ++index)
-                {
-                    const unsigned int outputIndex = index + outputOffset;
-
-                    mMask(outputIndex) = Random::randBernoulli(1.0 - mDropout);
-                    mOutputs(outputIndex) = (mMask(outputIndex))
-                        ? input(index + inputOffset)
-                        : 0.0;
-                }
-
-                outputOffset += mOutputs.dimX() * mOutputs.dimY()
-                                * mInputs.dimZ();
-                inputOffset += mOutputs.dimX() * mOutputs.dimY()
-                               * mInputs[k].dimZ();
+                const unsigned int outputOffset = offset
+                    + batchPos * outputStride;
+                const unsigned int inputOffset = batchPos * batchSize;
+
+                applyMask(&(*input.begin()) + inputOffset,
+                          &(*mOutputs.begin()) + outputOffset,
+                          batchSize,
+                          outputOffset);
             }
 
             offset += mOutputs.dimX() * mOutputs.dimY() * mInputs[k].dimZ();
@@ -155,27 +177,19 @@ void N2D2::DropoutCell_Frame<T>::backPropagate()
         Tensor<T> diffOutput
             = tensor_cast_nocopy<T>(mDiffOutputs[k]);
 
-        unsigned int outputOffset = offset;
-        unsigned int inputOffset = 0;
+        const unsigned int batchSize = mInputs[k].size() / mInputs.dimB();
+        const unsigned int outputStride = mOutputs.dimX() * mOutputs.dimY()
+                                            * mInputs.dimZ();
 
-        for (unsigned int batchPos = 0; batchPos < mInputs.dimB();
-            ++batchPos)
-        {
-            for (unsigned int index = 0,
-                 batchSize = (mInputs[k].size() / mInputs.dimB());
-                 index < batchSize;
-                 ++index)
-            {
-                const unsigned int outputIndex = index + outputOffset;
-                diffOutput(index + inputOffset) = (mMask(outputIndex))
-                    ? mDiffInputs(outputIndex)
-                    : 0.0;
-            }
+#pragma omp parallel for if (mInputs.dimB() > 4)
+        for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
+            const unsigned int outputOffset = offset + batchPos * outputStride;
+            const unsigned int inputOffset = batchPos * batchSize;
 
-            outputOffset += mOutputs.dimX() * mOutputs.dimY()
-                            * mInputs.dimZ();
-            inputOffset += mOutputs.dimX() * mOutputs.dimY()
-                           * mInputs[k].dimZ();
+            applyMask(&(*mDiffInputs.begin()) + outputOffset,
+                      &(*diffOutput.begin()) + inputOffset,
+                      batchSize,
+                      outputOffset);
         }
 
         offset += mOutputs.dimX() * mOutputs.dimY() * mInputs[k].dimZ();
@@ -187,6 +201,23 @@ void N2D2::DropoutCell_Frame<T>::backPropagate()
     mDiffOutputs.synchronizeHToD();
 }
 
+template <class T>
+void N2D2::DropoutCell_Frame<T>::applyMask(const T* input,
+                                           T* output,
+                                           unsigned int size,
+                                           unsigned int maskOffset) const
+{
+    const unsigned long long* mask = &(*mMask.begin());
+
+    // Branchless select, vectorized by the compiler
+    for (unsigned int index = 0; index < size; ++index) {
+        const unsigned int bit = maskOffset + index;
+        const bool keep = ((mask[bit / 64] >> (bit % 64)) & 1ULL);
+
+        output[index] = (keep) ? input[index] : T(0.0);
+    }
+}
+
 template <class T>
 void N2D2::DropoutCell_Frame<T>::update()
 {
@@ -22,10 +22,33 @@
 #include "Cell/ElemWiseCell_Frame.hpp"
 #include "DeepNet.hpp"
 
+template <>
 N2D2::Registrar<N2D2::ElemWiseCell>
-N2D2::ElemWiseCell_Frame::mRegistrar("Frame", N2D2::ElemWiseCell_Frame::create);
+N2D2::ElemWiseCell_Frame<half_float::half>::mRegistrar("Frame",
+    N2D2::ElemWiseCell_Frame<half_float::half>::create,
+    N2D2::Registrar<N2D2::ElemWiseCell>::Type<half_float::half>());
 
-N2D2::ElemWiseCell_Frame::ElemWiseCell_Frame(const DeepNet& deepNet, const std::string& name,
+template <>
+N2D2::Registrar<N2D2::ElemWiseCell>
+N2D2::ElemWiseCell_Frame<float>::mRegistrar("Frame",
+    N2D2::ElemWiseCell_Frame<float>::create,
+    N2D2::Registrar<N2D2::ElemWiseCell>::Type<float>());
+
+template <>
+N2D2::Registrar<N2D2::ElemWiseCell>
+N2D2::ElemWiseCell_Frame<double>::mRegistrar("Frame",
+    N2D2::ElemWiseCell_Frame<double>::create,
+    N2D2::Registrar<N2D2::ElemWiseCell>::Type<double>());
+
+namespace {
+// Element-wise operations are processed by blocks of this size, so that the
+// output block stays in cache while the inputs are accumulated one by one
+const unsigned int blockSize = 4096;
+}
+
+template <class T>
+N2D2::ElemWiseCell_Frame<T>::ElemWiseCell_Frame(const DeepNet& deepNet,
+                                     const std::string& name,
                                      unsigned int nbOutputs,
                                      Operation operation,
                                      const std::vector<Float_T>& weights,
@@ -38,19 +61,22 @@ N2D2::ElemWiseCell_Frame::ElemWiseCell_Frame(const DeepNet& deepNet, const std::
                operation,
                weights,
                shifts),
-      Cell_Frame<Float_T>(deepNet, name, nbOutputs, activation)
+      Cell_Frame<T>(deepNet, name, nbOutputs, activation),
+      mInPlace(this, "InPlace", false),
+      mInPlaceInput(false)
 {
     // ctor
 }
 
-void N2D2::ElemWiseCell_Frame::initialize()
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::initialize()
 {
     for (unsigned int k = 0, size = mInputs.size(); k < size; ++k) {
         if (mInputs[k].dimZ() != mOutputs.dimZ()
             || mInputs[k].dimB() != mOutputs.dimB())
         {
             std::stringstream errorMsg;
-            errorMsg << "ElemWiseCell_Frame::initialize(): for cell "
+            errorMsg << "ElemWiseCell_Frame<T>::initialize(): for cell "
                 << mName << ": the input tensor dimensions ("
                 << mInputs[k].dims() << ") must match the output dimensions ("
                 << mOutputs.dims() << ") for input #" << k << ".";
@@ -67,155 +93,354 @@ void N2D2::ElemWiseCell_Frame::initialize()
 
     if (mOperation == EuclideanSum)
         mInterTerm.resize(mOutputs.dims());
+
+    mInPlaceInput = false;
+
+    if (mInPlace && mOperation == Sum && !mInputs.empty()) {
+        const Tensor<T>* input0 = dynamic_cast<Tensor<T>*>(&mInputs[0]);
+
+        // Tensor::swap() exchanges the whole data buffers: the first input
+        // must not be a sub-tensor view
+        if (input0 != NULL && input0->dims() == mOutputs.dims()
+            && input0->size() == input0->data().size())
+        {
+            // Find the parent cell producing the first input
+            const std::vector<std::shared_ptr<Cell> > parents
+                = mDeepNet.getParentCells(mName);
+
+            for (std::vector<std::shared_ptr<Cell> >::const_iterator it
+                 = parents.begin(), itEnd = parents.end(); it != itEnd; ++it)
+            {
+                const std::shared_ptr<Cell_Frame_Top> parentFrame
+                    = std::dynamic_pointer_cast<Cell_Frame_Top>(*it);
+
+                if (parentFrame && &parentFrame->getOutputs() == &mInputs[0]) {
+                    mInPlaceInput
+                        = (mDeepNet.getChildCells((*it)->getName()).size()
+                            == 1);
+                    break;
+                }
+            }
+
+            // The first input buffer must not be read through another input,
+            // as it is overwritten by the sum and swapped with the outputs
+            for (unsigned int k = 1, size = mInputs.size(); k < size; ++k) {
+                const Tensor<T>* inputK
+                    = dynamic_cast<Tensor<T>*>(&mInputs[k]);
+
+                if (&mInputs[k] == &mInputs[0]
+                    || (inputK != NULL && &inputK->data() == &input0->data()))
+                {
+                    mInPlaceInput = false;
+                    break;
+                }
+            }
+        }
+
+        if (!mInPlaceInput) {
+            std::cout << Utils::cwarning << "ElemWiseCell_Frame<T>::"
+                "initialize(): in-place Sum is not possible for cell "
+                << mName << ", the first input must be the whole outputs "
+                "of a single child Frame cell of the same type, and must not "
+                "be bound to another input." << Utils::cdef << std::endl;
+        }
+    }
 }
 
-void N2D2::ElemWiseCell_Frame::propagate(bool inference)
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::propagate(bool inference)
 {
     const unsigned int nbInputs = mInputs.size();
     const unsigned int nbElems = mInputs[0].size();
 
     mInputs.synchronizeDBasedToH();
 
-    std::vector<Tensor<Float_T> > inputs;
+    std::vector<Tensor<T> > inputs;
 
     for (unsigned int k = 0; k < nbInputs; ++k)
-        inputs.push_back(tensor_cast<Float_T>(mInputs[k]));
+        inputs.push_back(tensor_cast<T>(mInputs[k]));
 
-    if (mOperation == Sum) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mOutputs(n) = mWeights[0] * inputs[0](n)
-                            + mShifts[0];
+    std::vector<const T*> inputsData;
 
-            for (unsigned int k = 1; k < nbInputs; ++k) {
-                mOutputs(n) += mWeights[k] * inputs[k](n)
-                                + mShifts[k];
-            }
-        }
+    for (unsigned int k = 0; k < nbInputs; ++k)
+        inputsData.push_back(&inputs[k](0));
+
+    if (mOperation == Sum && isInPlace(inference)) {
+        // Accumulate in the first input buffer, which has no other consumer,
+        // and make it the outputs buffer. The previous outputs buffer is
+        // given to the parent cell in exchange.
+        Tensor<T>& input0 = dynamic_cast<Tensor<T>&>(mInputs[0]);
+
+        sum(inputsData, &input0(0), nbElems);
+        mOutputs.swap(input0);
+    }
+    else if (mOperation == Sum)
+        sum(inputsData, &mOutputs(0), nbElems);
+    else if (mOperation == AbsSum)
+        absSum(inputsData, &mOutputs(0), nbElems);
+    else if (mOperation == EuclideanSum)
+        euclideanSum(inputsData, &mOutputs(0), nbElems);
+    else if (mOperation == Prod)
+        prod(inputsData, &mOutputs(0), nbElems);
+    else if (mOperation == Max)
+        max(inputsData, &mOutputs(0), nbElems);
+    else {
+        throw std::runtime_error("ElemWiseCell_Frame<T>::propagate(): "
+                                 "unknown operation type.");
     }
-    else if (mOperation == AbsSum) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mOutputs(n) = mWeights[0] * std::abs(inputs[0](n));
 
-            for (unsigned int k = 1; k < nbInputs; ++k)
-                mOutputs(n) += mWeights[k] * std::abs(inputs[k](n));
+    Cell_Frame<T>::propagate(inference);
+    mDiffInputs.clearValid();
+}
+
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::sum(const std::vector<const T*>& inputs,
+                                      T* outputs,
+                                      unsigned int size) const
+{
+    const unsigned int nbInputs = inputs.size();
+    const int nbBlocks = (size + blockSize - 1) / blockSize;
+
+#pragma omp parallel for if (nbBlocks > 1)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int end = std::min(offset + blockSize, size);
+
+        // Coefficient and shift are applied in the same pass
+        const T* input = inputs[0];
+        const T weight = T(mWeights[0]);
+        const T shift = T(mShifts[0]);
+
+        for (unsigned int n = offset; n < end; ++n)
+            outputs[n] = weight * input[n] + shift;
+
+        for (unsigned int k = 1; k < nbInputs; ++k) {
+            const T* inputK = inputs[k];
+            const T weightK = T(mWeights[k]);
+            const T shiftK = T(mShifts[k]);
+
+            for (unsigned int n = offset; n < end; ++n)
+                outputs[n] += weightK * inputK[n] + shiftK;
         }
     }
-    else if (mOperation == EuclideanSum) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mInterTerm(n) = (mWeights[0] * mWeights[0])
-                * (inputs[0](n) * inputs[0](n))
-                + (mShifts[0]*mShifts[0]);
-
-            for (unsigned int k = 1; k < nbInputs; ++k) {
-                mInterTerm(n) += (mWeights[k] * mWeights[k])
-                    * (inputs[k](n) * inputs[k](n))
-                    + (mShifts[k]*mShifts[k]);
-            }
+}
+
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::absSum(const std::vector<const T*>& inputs,
+                                         T* outputs,
+                                         unsigned int size) const
+{
+    const unsigned int nbInputs = inputs.size();
+    const int nbBlocks = (size + blockSize - 1) / blockSize;
 
-            mInterTerm(n) = std::sqrt(mInterTerm(n));
-            mOutputs(n) = mInterTerm(n);
+#pragma omp parallel for if (nbBlocks > 1)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int end = std::min(offset + blockSize, size);
+
+        const T* input = inputs[0];
+        const T weight = T(mWeights[0]);
+
+        for (unsigned int n = offset; n < end; ++n)
+            outputs[n] = weight * T(std::abs(input[n]));
+
+        for (unsigned int k = 1; k < nbInputs; ++k) {
+            const T* inputK = inputs[k];
+            const T weightK = T(mWeights[k]);
+
+            for (unsigned int n = offset; n < end; ++n)
+                outputs[n] += weightK * T(std::abs(inputK[n]));
         }
     }
-    else if (mOperation == Prod) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            mOutputs(n) = inputs[0](n);
+}
+
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::euclideanSum(
+    const std::vector<const T*>& inputs,
+    T* outputs,
+    unsigned int size)
+{
+    const unsigned int nbInputs = inputs.size();
+    const int nbBlocks = (size + blockSize - 1) / blockSize;
+    T* interTerm = &mInterTerm(0);
+
+#pragma omp parallel for if (nbBlocks > 1)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int end = std::min(offset + blockSize, size);
+
+        const T* input = inputs[0];
+        const T weight2 = T(mWeights[0] * mWeights[0]);
+        const T shift2 = T(mShifts[0] * mShifts[0]);
+
+        for (unsigned int n = offset; n < end; ++n)
+            interTerm[n] = weight2 * (input[n] * input[n]) + shift2;
 
-            for (unsigned int k = 1; k < nbInputs; ++k)
-                mOutputs(n) *= inputs[k](n);
+        for (unsigned int k = 1; k < nbInputs; ++k) {
+            const T* inputK = inputs[k];
+            const T weightK2 = T(mWeights[k] * mWeights[k]);
+            const T shiftK2 = T(mShifts[k] * mShifts[k]);
+
+            for (unsigned int n = offset; n < end; ++n)
+                interTerm[n] += weightK2 * (inputK[n] * inputK[n]) + shiftK2;
         }
-    }
-    else if (mOperation == Max) {
-        for (unsigned int n = 0; n < nbElems; ++n) {
-            Float_T maxVal = inputs[0](n);
-            unsigned int argMax = 0;
-
-            for (unsigned int k = 1; k < nbInputs; ++k) {
-                if (inputs[k](n) > maxVal) {
-                    maxVal = inputs[k](n);
-                    argMax = k;
-                }
-            }
 
-            mOutputs(n) = maxVal;
-            mArgMax(n) = argMax;
+        for (unsigned int n = offset; n < end; ++n) {
+            interTerm[n] = T(std::sqrt(interTerm[n]));
+            outputs[n] = interTerm[n];
         }
     }
-    else {
-        throw std::runtime_error("ElemWiseCell_Frame::propagate(): "
-                                 "unknown operation type.");
+}
+
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::prod(const std::vector<const T*>& inputs,
+                                       T* outputs,
+                                       unsigned int size) const
+{
+    const unsigned int nbInputs = inputs.size();
+    const int nbBlocks = (size + blockSize - 1) / blockSize;
+
+#pragma omp parallel for if (nbBlocks > 1)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int end = std::min(offset + blockSize, size);
+
+        std::copy(inputs[0] + offset, inputs[0] + end, outputs + offset);
+
+        for (unsigned int k = 1; k < nbInputs; ++k) {
+            const T* inputK = inputs[k];
+
+            for (unsigned int n = offset; n < end; ++n)
+                outputs[n] *= inputK[n];
+        }
     }
+}
 
-    Cell_Frame<Float_T>::propagate(inference);
-    mDiffInputs.clearValid();
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::max(const std::vector<const T*>& inputs,
+                                      T* outputs,
+                                      unsigned int size)
+{
+    const unsigned int nbInputs = inputs.size();
+    const int nbBlocks = (size + blockSize - 1) / blockSize;
+    unsigned int* argMax = &mArgMax(0);
+
+#pragma omp parallel for if (nbBlocks > 1)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const unsigned int offset = block * blockSize;
+        const unsigned int end = std::min(offset + blockSize, size);
+
+        std::copy(inputs[0] + offset, inputs[0] + end, outputs + offset);
+        std::fill(argMax + offset, argMax + end, 0U);
+
+        // Branchless selection, for the first maximum in case of equality
+        for (unsigned int k = 1; k < nbInputs; ++k) {
+            const T* inputK = inputs[k];
+
+            for (unsigned int n = offset; n < end; ++n) {
+                const bool greater = (inputK[n] > outputs[n]);
+                outputs[n] = (greater) ? inputK[n] : outputs[n];
+                argMax[n] = (greater) ? k : argMax[n];
+            }
+        }
+    }
 }
 
-void N2D2::ElemWiseCell_Frame::backPropagate()
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::backPropagate()
 {
     if (mDiffOutputs.empty())
         return;
 
     const unsigned int nbInputs = mInputs.size();
-    const unsigned int nbElems = mInputs[0].size();
+    const int nbElems = mInputs[0].size();
 
-    Cell_Frame<Float_T>::backPropagate();
+    Cell_Frame<T>::backPropagate();
 
-    std::vector<Tensor<Float_T> > inputs;
+    // The inputs are not needed for Sum and Max (and may have been
+    // overwritten by the in-place Sum)
+    std::vector<Tensor<T> > inputs;
+    std::vector<const T*> inputsData;
 
-    for (unsigned int k = 0; k < nbInputs; ++k)
-        inputs.push_back(tensor_cast_nocopy<Float_T>(mInputs[k]));
+    if (mOperation == AbsSum || mOperation == EuclideanSum
+        || mOperation == Prod)
+    {
+        for (unsigned int k = 0; k < nbInputs; ++k)
+            inputs.push_back(tensor_cast_nocopy<T>(mInputs[k]));
+
+        for (unsigned int k = 0; k < nbInputs; ++k)
+            inputsData.push_back(&inputs[k](0));
+    }
+
+    const T* diffInputs = &mDiffInputs(0);
 
-    #pragma omp parallel for
-    for (int k = 0; k < (int)nbInputs; ++k) {
-        const float beta = (mDiffOutputs[k].isValid()) ? 1.0f : 0.0f;
+    for (unsigned int k = 0; k < nbInputs; ++k) {
+        const T beta = (mDiffOutputs[k].isValid()) ? T(1.0) : T(0.0);
 
-        Tensor<Float_T> diffOutput = (mDiffOutputs[k].isValid())
-            ? tensor_cast<Float_T>(mDiffOutputs[k])
-            : tensor_cast_nocopy<Float_T>(mDiffOutputs[k]);
+        Tensor<T> diffOutput = (mDiffOutputs[k].isValid())
+            ? tensor_cast<T>(mDiffOutputs[k])
+            : tensor_cast_nocopy<T>(mDiffOutputs[k]);
+        T* diffOutputData = &diffOutput(0);
 
         if (mOperation == Sum) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                diffOutput(n) = mWeights[k] * mDiffInputs(n)
-                                    + beta * diffOutput(n);
+            const T weight = T(mWeights[k]);
+
+#pragma omp parallel for if (nbElems > 1024)
+            for (int n = 0; n < nbElems; ++n) {
+                diffOutputData[n] = weight * diffInputs[n]
+                                    + beta * diffOutputData[n];
             }
         }
         else if (mOperation == AbsSum) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                const Float_T sign = (inputs[k](n) >= 0.0) ? 1.0 : -1.0;
-                diffOutput(n) = mWeights[k] * sign * mDiffInputs(n)
-                                    + beta * diffOutput(n);
+            const T* input = inputsData[k];
+            const T weight = T(mWeights[k]);
+
+#pragma omp parallel for if (nbElems > 1024)
+            for (int n = 0; n < nbElems; ++n) {
+                const T sign = (input[n] >= T(0.0)) ? T(1.0) : T(-1.0);
+                diffOutputData[n] = weight * sign * diffInputs[n]
+                                    + beta * diffOutputData[n];
             }
         }
         else if (mOperation == EuclideanSum) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                diffOutput(n) = (mInterTerm(n) != 0.0)
-                    ? (mWeights[k] * mWeights[k])
-                        * (inputs[k](n) / mInterTerm(n))
-                        * mDiffInputs(n) + beta * diffOutput(n)
-                    : beta * diffOutput(n);
+            const T* input = inputsData[k];
+            const T* interTerm = &mInterTerm(0);
+            const T weight2 = T(mWeights[k] * mWeights[k]);
+
+#pragma omp parallel for if (nbElems > 1024)
+            for (int n = 0; n < nbElems; ++n) {
+                diffOutputData[n] = (interTerm[n] != T(0.0))
+                    ? weight2 * (input[n] / interTerm[n])
+                        * diffInputs[n] + beta * diffOutputData[n]
+                    : beta * diffOutputData[n];
             }
         }
         else if (mOperation == Prod) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                Float_T prodTerm = 1.0;
+#pragma omp parallel for if (nbElems > 1024)
+            for (int n = 0; n < nbElems; ++n) {
+                T prodTerm(1.0);
 
                 for (unsigned int i = 0; i < nbInputs; ++i) {
-                    if (i != (unsigned int)k)
-                        prodTerm *= inputs[i](n);
+                    if (i != k)
+                        prodTerm *= inputsData[i][n];
                 }
 
-                diffOutput(n) = prodTerm * mDiffInputs(n)
-                                    + beta * diffOutput(n);
+                diffOutputData[n] = prodTerm * diffInputs[n]
+                                    + beta * diffOutputData[n];
             }
         }
         else if (mOperation == Max) {
-            for (unsigned int n = 0; n < nbElems; ++n) {
-                diffOutput(n) = (mArgMax(n) == (unsigned int)k)
-                    ? (mDiffInputs(n) + beta * diffOutput(n))
-                    : beta * diffOutput(n);
+            const unsigned int* argMax = &mArgMax(0);
+
+#pragma omp parallel for if (nbElems > 1024)
+            for (int n = 0; n < nbElems; ++n) {
+                diffOutputData[n] = (argMax[n] == k)
+                    ? (diffInputs[n] + beta * diffOutputData[n])
+                    : beta * diffOutputData[n];
             }
         }
         else {
-            throw std::runtime_error("ElemWiseCell_Frame::propagate(): "
+            throw std::runtime_error("ElemWiseCell_Frame<T>::backPropagate(): "
                                      "unknown operation type.");
         }
 
@@ -226,18 +451,20 @@ void N2D2::ElemWiseCell_Frame::backPropagate()
     mDiffOutputs.synchronizeHToD();
 }
 
-void N2D2::ElemWiseCell_Frame::update()
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::update()
 {
 }
 
-void N2D2::ElemWiseCell_Frame::checkGradient(double epsilon, double maxError)
+template <class T>
+void N2D2::ElemWiseCell_Frame<T>::checkGradient(double epsilon, double maxError)
 {
-    GradientCheck<Float_T> gc(epsilon, maxError);
+    GradientCheck<T> gc(epsilon, maxError);
     gc.initialize(mInputs,
                   mOutputs,
                   mDiffInputs,
-                  std::bind(&ElemWiseCell_Frame::propagate, this, false),
-                  std::bind(&ElemWiseCell_Frame::backPropagate, this),
+                  std::bind(&ElemWiseCell_Frame<T>::propagate, this, false),
+                  std::bind(&ElemWiseCell_Frame<T>::backPropagate, this),
                   (mOperation == Max));
 
     if (!mDiffOutputs.empty()) {
@@ -245,7 +472,7 @@ void N2D2::ElemWiseCell_Frame::checkGradient(double epsilon, double maxError)
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << in << "]";
 
-            gc.check(name.str(), mInputs[in], mDiffOutputs[in]);
+            gc.check(name.str(), mInputs[in], mDiffOutputs[in], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -254,7 +481,14 @@ void N2D2::ElemWiseCell_Frame::checkGradient(double epsilon, double maxError)
     }
 }
 
-N2D2::ElemWiseCell_Frame::~ElemWiseCell_Frame()
+template <class T>
+N2D2::ElemWiseCell_Frame<T>::~ElemWiseCell_Frame()
 {
 
 }
+
+namespace N2D2 {
+    template class ElemWiseCell_Frame<half_float::half>;
+    template class ElemWiseCell_Frame<float>;
+    template class ElemWiseCell_Frame<double>;
+}
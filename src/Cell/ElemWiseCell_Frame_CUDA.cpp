@@ -27,7 +27,8 @@
 
 N2D2::Registrar<N2D2::ElemWiseCell>
 N2D2::ElemWiseCell_Frame_CUDA::mRegistrar("Frame_CUDA",
-                                      N2D2::ElemWiseCell_Frame_CUDA::create);
+    N2D2::ElemWiseCell_Frame_CUDA::create,
+    N2D2::Registrar<N2D2::ElemWiseCell>::Type<Float_T>());
 
 N2D2::ElemWiseCell_Frame_CUDA::ElemWiseCell_Frame_CUDA(
     const DeepNet& deepNet, 
@@ -385,7 +386,7 @@ void N2D2::ElemWiseCell_Frame_CUDA::checkGradient(double epsilon, double maxErro
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << k << "]";
 
-            gc.check(name.str(), mInputs[k], mDiffOutputs[k]);
+            gc.check(name.str(), mInputs[k], mDiffOutputs[k], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -48,6 +48,15 @@ void N2D2::FMPCell_Frame::initialize()
             throw std::runtime_error("Zero-sized input for FMPCell " + mName);
     }
 
+    mChannelsOutputs.assign(getNbChannels(), std::vector<unsigned int>());
+
+    for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+        for (unsigned int channel = 0; channel < getNbChannels(); ++channel) {
+            if (isConnection(channel, output))
+                mChannelsOutputs[channel].push_back(output);
+        }
+    }
+
     // Generate initial regions for checkGradient()
     generateRegions(mGridX, mInputs[0].dimX(), mOutputs.dimX());
     generateRegions(mGridY, mInputs[0].dimY(), mOutputs.dimY());
@@ -60,17 +69,19 @@ void N2D2::FMPCell_Frame::propagate(bool inference)
     mInputs.synchronizeDBasedToH();
 
     if (!inference)
-        mInputsBackProp.assign({mInputs[0].dimX(),
-                               mInputs[0].dimY(),
-                               mInputs.dimZ(),
-                               mInputs.dimB()},
-                               std::vector<unsigned int>());
+        mArgMax.assign(mOutputs.dims(), PoolCell_Frame_Kernels::ArgMax());
 
     if (!mLockRandom) {
         generateRegions(mGridX, mInputs[0].dimX(), mOutputs.dimX());
         generateRegions(mGridY, mInputs[0].dimY(), mOutputs.dimY());
     }
 
+    // The regions are computed once and are read-only in the parallel loop
+    computeRegionsBounds(mGridX, mInputs[0].dimX(),
+                         mRegionsStartX, mRegionsStopX);
+    computeRegionsBounds(mGridY, mInputs[0].dimY(),
+                         mRegionsStartY, mRegionsStopY);
+
     const unsigned int size = mInputs.dimB() * getNbOutputs();
 
     const Tensor<Float_T>& input0 = tensor_cast<Float_T>(mInputs[0]);
@@ -82,10 +93,16 @@ void N2D2::FMPCell_Frame::propagate(bool inference)
 #endif
     for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
         for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+            if (mPoolNbChannels[output] == 0)
+                continue; // No connection to this output...
+
             for (unsigned int oy = 0; oy < mOutputs.dimY(); ++oy) {
+                const unsigned int iyStart = mRegionsStartY[oy];
+                const unsigned int iyStop = mRegionsStopY[oy];
+
                 for (unsigned int ox = 0; ox < mOutputs.dimX(); ++ox) {
-                    if (mPoolNbChannels[output] == 0)
-                        continue; // No connection to this output...
+                    const unsigned int ixStart = mRegionsStartX[ox];
+                    const unsigned int ixStop = mRegionsStopX[ox];
 
                     // For each output, compute the pool value
                     Float_T poolValue =
@@ -99,49 +116,32 @@ void N2D2::FMPCell_Frame::propagate(bool inference)
                         if (!isConnection(channel, output))
                             continue;
 
-                        const unsigned int ixStart = (ox > 0) ? mGridX[ox - 1]
-                                                              : 0;
-                        const unsigned int iyStart = (oy > 0) ? mGridY[oy - 1]
-                                                              : 0;
-                        unsigned int ixStop = mGridX[ox];
-                        unsigned int iyStop = mGridY[oy];
-
-                        if (!mOverlapping) {
-                            --ixStop;
-                            --iyStop;
-                        }
-
-                        if (ox == mOutputs.dimX() - 1)
-                            ixStop = input0.dimX() - 1;
-
-                        if (oy == mOutputs.dimY() - 1)
-                            iyStop = input0.dimY() - 1;
-
                         for (unsigned int iy = iyStart; iy <= iyStop; ++iy) {
-                            for (unsigned int ix = ixStart; ix <= ixStop;
-                                 ++ix) {
-                                if (input0(ix, iy, channel, batchPos)
-                                    > poolValue) {
-                                    poolValue
-                                        = input0(ix, iy, channel, batchPos);
-
-                                    channelMax = channel;
-                                    ixMax = ix;
-                                    iyMax = iy;
-                                }
+                            // Rows are contiguous in memory
+                            const Float_T* row
+                                = &input0(0, iy, channel, batchPos);
+                            const Float_T* rowMax
+                                = std::max_element(row + ixStart,
+                                                   row + ixStop + 1);
+
+                            // Keep the first max. to match the sequential
+                            // scan order
+                            if (*rowMax > poolValue) {
+                                poolValue = *rowMax;
+                                channelMax = channel;
+                                ixMax = rowMax - row;
+                                iyMax = iy;
                             }
                         }
                     }
 
+                    // Each output is only written by one thread: no lock
                     if (!inference) {
-// For this output node, take the max. input across all connected channels
-// Critical section needed because channelMax can be the same for several
-// outputs
-#pragma omp critical(FMPCell_Frame__propagate)
-                        mInputsBackProp(ixMax, iyMax, channelMax, batchPos)
-                            .push_back(ox + oy * mOutputs.dimX()
-                                       + output * mOutputs.dimX()
-                                         * mOutputs.dimY());
+                        mArgMax(ox, oy, output, batchPos)
+                            = PoolCell_Frame_Kernels::ArgMax(ixMax,
+                                                             iyMax,
+                                                             channelMax,
+                                                             true);
                     }
 
                     // Compute the output signal
@@ -168,6 +168,10 @@ void N2D2::FMPCell_Frame::backPropagate()
         ? tensor_cast<Float_T>(mDiffOutputs[0])
         : tensor_cast_nocopy<Float_T>(mDiffOutputs[0]);
 
+    const bool isValid = mDiffOutputs[0].isValid();
+
+    // Each thread gathers the gradient for its own (batchPos, channel) input
+    // plane, from the outputs whose max. was taken in this plane
 #if defined(_OPENMP) && _OPENMP >= 200805
 #pragma omp parallel for collapse(2) if (size > 16)
 #else
@@ -176,27 +180,37 @@ void N2D2::FMPCell_Frame::backPropagate()
     for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
         for (unsigned int channel = 0; channel < getNbChannels(); ++channel)
         {
-            const bool isValid = mDiffOutputs[0].isValid();
-
             for (unsigned int iy = 0; iy < mInputs[0].dimY(); ++iy) {
                 for (unsigned int ix = 0; ix < mInputs[0].dimX(); ++ix) {
-                    Float_T gradient = 0.0;
-
-                    // In max pooling, the unit which was chosen as the max
-                    // receives all the error since very small changes
-                    // in input would perturb the result only through that unit
-                    for (std::vector<unsigned int>::const_iterator it
-                         = mInputsBackProp(ix, iy, channel, batchPos).begin(),
-                         itEnd
-                         = mInputsBackProp(ix, iy, channel, batchPos).end();
-                         it != itEnd;
-                         ++it) {
-                        gradient += mDiffInputs(*it, batchPos);
-                    }
-
                     diffOutput0(ix, iy, channel, batchPos)
-                        = gradient + isValid
-                                     * diffOutput0(ix, iy, channel, batchPos);
+                        = isValid * diffOutput0(ix, iy, channel, batchPos);
+                }
+            }
+
+            // In max pooling, the unit which was chosen as the max
+            // receives all the error since very small changes
+            // in input would perturb the result only through that unit
+            const std::vector<unsigned int>& outputs
+                = mChannelsOutputs[channel];
+
+            for (std::vector<unsigned int>::const_iterator it
+                 = outputs.begin(), itEnd = outputs.end(); it != itEnd; ++it)
+            {
+                const unsigned int output = (*it);
+
+                for (unsigned int oy = 0; oy < mOutputs.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < mOutputs.dimX(); ++ox) {
+                        const PoolCell_Frame_Kernels::ArgMax& inputMax
+                            = mArgMax(ox, oy, output, batchPos);
+
+                        if (inputMax.valid && inputMax.channel == channel) {
+                            diffOutput0(inputMax.ix,
+                                        inputMax.iy,
+                                        channel,
+                                        batchPos)
+                                += mDiffInputs(ox, oy, output, batchPos);
+                        }
+                    }
                 }
             }
         }
@@ -228,7 +242,7 @@ void N2D2::FMPCell_Frame::checkGradient(double epsilon, double maxError)
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << in << "]";
 
-            gc.check(name.str(), mInputs[in], mDiffOutputs[in]);
+            gc.check(name.str(), mInputs[in], mDiffOutputs[in], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -243,26 +257,14 @@ void N2D2::FMPCell_Frame::logRegions(const std::string& fileName) const
 {
     Tensor<Float_T> regions({mInputs[0].dimX(), mInputs[0].dimY()}, 0.0);
 
+    std::vector<unsigned int> startX, stopX, startY, stopY;
+    computeRegionsBounds(mGridX, mInputs[0].dimX(), startX, stopX);
+    computeRegionsBounds(mGridY, mInputs[0].dimY(), startY, stopY);
+
     for (unsigned int oy = 0; oy < mOutputs.dimY(); ++oy) {
         for (unsigned int ox = 0; ox < mOutputs.dimX(); ++ox) {
-            const unsigned int ixStart = (ox > 0) ? mGridX[ox - 1] : 0;
-            const unsigned int iyStart = (oy > 0) ? mGridY[oy - 1] : 0;
-            unsigned int ixStop = mGridX[ox];
-            unsigned int iyStop = mGridY[oy];
-
-            if (!mOverlapping) {
-                --ixStop;
-                --iyStop;
-            }
-
-            if (ox == mOutputs.dimX() - 1)
-                ixStop = mInputs[0].dimX() - 1;
-
-            if (oy == mOutputs.dimY() - 1)
-                iyStop = mInputs[0].dimY() - 1;
-
-            for (unsigned int iy = iyStart; iy <= iyStop; ++iy) {
-                for (unsigned int ix = ixStart; ix <= ixStop; ++ix)
+            for (unsigned int iy = startY[oy]; iy <= stopY[oy]; ++iy) {
+                for (unsigned int ix = startX[ox]; ix <= stopX[ox]; ++ix)
                     regions(ix, iy) += ((ox % 2) != (oy % 2)) ? 0 : 1;
             }
         }
@@ -271,6 +273,25 @@ void N2D2::FMPCell_Frame::logRegions(const std::string& fileName) const
     StimuliProvider::logData(fileName, regions);
 }
 
+void N2D2::FMPCell_Frame::computeRegionsBounds(
+    const std::vector<unsigned int>& grid,
+    unsigned int sizeIn,
+    std::vector<unsigned int>& start,
+    std::vector<unsigned int>& stop) const
+{
+    const unsigned int sizeOut = grid.size();
+
+    start.resize(sizeOut);
+    stop.resize(sizeOut);
+
+    for (unsigned int o = 0; o < sizeOut; ++o) {
+        start[o] = (o > 0) ? grid[o - 1] : 0;
+        stop[o] = (o == sizeOut - 1) ? sizeIn - 1
+                : (mOverlapping) ? grid[o]
+                : grid[o] - 1;
+    }
+}
+
 void N2D2::FMPCell_Frame::generateRegions(std::vector<unsigned int>& grid,
                                           unsigned int sizeIn,
                                           unsigned int sizeOut)
@@ -338,7 +338,7 @@ void N2D2::FcCell_Frame<T>::checkGradient(double epsilon, double maxError)
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << in << "]";
 
-            gc.check(name.str(), mInputs[in], mDiffOutputs[in]);
+            gc.check(name.str(), mInputs[in], mDiffOutputs[in], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -368,6 +368,23 @@ void N2D2::FcCell_Frame<T>::saveFreeParameters(const std::string& fileName) cons
         throw std::runtime_error("Error writing synaptic file: " + fileName);
 }
 
+template <class T>
+std::vector<std::pair<std::string, N2D2::BaseTensor*> >
+N2D2::FcCell_Frame<T>::getFreeParametersTensors()
+{
+    std::vector<std::pair<std::string, BaseTensor*> > tensors;
+
+    for (unsigned int k = 0; k < mSynapses.size(); ++k) {
+        tensors.push_back(std::make_pair("weights" + std::to_string(k),
+                                         &mSynapses[k]));
+    }
+
+    if (!mNoBias)
+        tensors.push_back(std::make_pair("biases", &mBias));
+
+    return tensors;
+}
+
 template <class T>
 void N2D2::FcCell_Frame<T>::loadFreeParameters(const std::string& fileName,
                                             bool ignoreNotExists)
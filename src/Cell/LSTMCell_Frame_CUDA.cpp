@@ -970,7 +970,7 @@ void N2D2::LSTMCell_Frame_CUDA<T>::checkGradient(double epsilon, double maxError
             std::stringstream name;
             name << mName + "Frame_CUDA_mDiffOutputs[" << k << "]";
 
-            gc.check(name.str(), mInputs[k], mDiffOutputs[k]);
+            gc.check(name.str(), mInputs[k], mDiffOutputs[k], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -23,6 +23,328 @@
 #include "Cell/PoolCell_Frame_Kernels_struct.hpp"
 #include "third_party/half.hpp"
 
+namespace {
+/// Pooling window bounds along one dimension, computed once per call for
+/// every output position
+struct PoolWindow {
+    PoolWindow(unsigned int outputSize,
+               unsigned int inputSize,
+               unsigned int pool,
+               unsigned int stride,
+               int padding);
+
+    // First input position of the window (negative in the padding)
+    std::vector<int> start;
+    // Valid offsets [sMin, sMax[ in the window
+    std::vector<unsigned int> sMin;
+    std::vector<unsigned int> sMax;
+    // Output positions [interiorBegin, interiorEnd[ whose window lies
+    // entirely within the input
+    unsigned int interiorBegin;
+    unsigned int interiorEnd;
+};
+
+PoolWindow::PoolWindow(unsigned int outputSize,
+                       unsigned int inputSize,
+                       unsigned int pool,
+                       unsigned int stride,
+                       int padding)
+    : start(outputSize),
+      sMin(outputSize),
+      sMax(outputSize),
+      interiorBegin(0),
+      interiorEnd(0)
+{
+    bool interior = false;
+
+    for (unsigned int o = 0; o < outputSize; ++o) {
+        start[o] = (int)(o * stride) - padding;
+        sMin[o] = (unsigned int)std::max(-start[o], 0);
+        sMax[o] = std::max(sMin[o], (unsigned int)N2D2::Utils::clamp
+            <int>((int)inputSize - start[o], 0, pool));
+
+        if (sMin[o] == 0 && sMax[o] == pool) {
+            if (!interior) {
+                interiorBegin = o;
+                interior = true;
+            }
+
+            interiorEnd = o + 1;
+        }
+    }
+}
+
+/// Input channel connected to each output (-1 if none), for the one-to-one
+/// (or one-to-none) mappings used by nearly all pooling layers. Returns
+/// false if any output is connected to more than one channel.
+bool getOutputsChannel(const N2D2::Tensor<bool>& maps,
+                       unsigned int nbOutputs,
+                       unsigned int nbChannels,
+                       std::vector<int>& outputsChannel)
+{
+    if (maps.empty()) {
+        outputsChannel.assign(nbOutputs, (nbChannels == 1) ? 0 : -1);
+        return (nbChannels <= 1);
+    }
+
+    outputsChannel.assign(nbOutputs, -1);
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+            if (maps(output, channel)) {
+                if (outputsChannel[output] >= 0)
+                    return false;
+
+                outputsChannel[output] = channel;
+            }
+        }
+    }
+
+    return true;
+}
+
+/// List of the inputs connected to each output (channels for each output if
+/// byOutput is true, outputs for each channel otherwise)
+std::vector<std::vector<unsigned int> >
+getConnections(const N2D2::Tensor<bool>& maps,
+               unsigned int nbOutputs,
+               unsigned int nbChannels,
+               bool byOutput)
+{
+    std::vector<std::vector<unsigned int> > connections(
+        (byOutput) ? nbOutputs : nbChannels);
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+            if (maps.empty() || maps(output, channel)) {
+                if (byOutput)
+                    connections[output].push_back(channel);
+                else
+                    connections[channel].push_back(output);
+            }
+        }
+    }
+
+    return connections;
+}
+
+/// Maximum in the window [sxMin, sxMax[ x [syMin, syMax[ at (ix, iy) of an
+/// input plane. The first maximum in row-major order is retained.
+template <class T>
+inline bool windowMax(const T* input,
+                      unsigned int inputWidth,
+                      int ix,
+                      int iy,
+                      unsigned int sxMin,
+                      unsigned int sxMax,
+                      unsigned int syMin,
+                      unsigned int syMax,
+                      T& poolValue,
+                      unsigned int& ixMax,
+                      unsigned int& iyMax)
+{
+    bool valid = false;
+
+    for (unsigned int sy = syMin; sy < syMax; ++sy) {
+        const size_t row = (size_t)(iy + (int)sy) * inputWidth;
+
+        for (unsigned int sx = sxMin; sx < sxMax; ++sx) {
+            const T value = input[row + (ix + (int)sx)];
+
+            if (!valid || value > poolValue) {
+                poolValue = value;
+                valid = true;
+
+                ixMax = ix + sx;
+                iyMax = iy + sy;
+            }
+        }
+    }
+
+    return valid;
+}
+
+template <class T>
+inline T windowSum(const T* input,
+                   unsigned int inputWidth,
+                   int ix,
+                   int iy,
+                   unsigned int sxMin,
+                   unsigned int sxMax,
+                   unsigned int syMin,
+                   unsigned int syMax)
+{
+    T sum(0.0);
+
+    for (unsigned int sy = syMin; sy < syMax; ++sy) {
+        const size_t row = (size_t)(iy + (int)sy) * inputWidth;
+
+        for (unsigned int sx = sxMin; sx < sxMax; ++sx)
+            sum += input[row + (ix + (int)sx)];
+    }
+
+    return sum;
+}
+
+template <class T>
+inline void windowAdd(T* diffOutput,
+                      unsigned int diffOutputWidth,
+                      int ix,
+                      int iy,
+                      unsigned int sxMin,
+                      unsigned int sxMax,
+                      unsigned int syMin,
+                      unsigned int syMax,
+                      T gradient)
+{
+    for (unsigned int sy = syMin; sy < syMax; ++sy) {
+        const size_t row = (size_t)(iy + (int)sy) * diffOutputWidth;
+
+        for (unsigned int sx = sxMin; sx < sxMax; ++sx)
+            diffOutput[row + (ix + (int)sx)] += gradient;
+    }
+}
+
+/// Run func(ox, oy, sxMin, sxMax, syMin, syMax) for every output position of
+/// a plane. Windows lying entirely within the input are given the
+/// compile-time bounds POOL_X x POOL_Y when these are non-zero, so that the
+/// 2x2 and 3x3 reductions are fully unrolled.
+template <unsigned int POOL_X, unsigned int POOL_Y, class Func>
+inline void forEachWindow(const PoolWindow& wx,
+                          const PoolWindow& wy,
+                          Func func)
+{
+    const unsigned int outputWidth = wx.start.size();
+    const unsigned int outputHeight = wy.start.size();
+
+    for (unsigned int oy = 0; oy < outputHeight; ++oy) {
+        unsigned int ox = 0;
+
+        if (POOL_X > 0 && oy >= wy.interiorBegin && oy < wy.interiorEnd) {
+            for (; ox < wx.interiorBegin; ++ox) {
+                func(ox, oy, wx.sMin[ox], wx.sMax[ox],
+                     wy.sMin[oy], wy.sMax[oy]);
+            }
+
+            for (; ox < wx.interiorEnd; ++ox)
+                func(ox, oy, 0U, POOL_X, 0U, POOL_Y);
+        }
+
+        for (; ox < outputWidth; ++ox) {
+            func(ox, oy, wx.sMin[ox], wx.sMax[ox],
+                 wy.sMin[oy], wy.sMax[oy]);
+        }
+    }
+}
+
+template <class T, unsigned int POOL_X, unsigned int POOL_Y>
+void forwardMaxPlane(T alpha,
+                     const T* input,
+                     unsigned int inputWidth,
+                     unsigned int channel,
+                     const PoolWindow& wx,
+                     const PoolWindow& wy,
+                     T beta,
+                     T* output,
+                     N2D2::PoolCell_Frame_Kernels::ArgMax* argMax)
+{
+    const unsigned int outputWidth = wx.start.size();
+
+    forEachWindow<POOL_X, POOL_Y>(wx, wy,
+        [&](unsigned int ox, unsigned int oy,
+            unsigned int sxMin, unsigned int sxMax,
+            unsigned int syMin, unsigned int syMax)
+    {
+        const unsigned int o = ox + oy * outputWidth;
+        T poolValue(0.0);
+        unsigned int ixMax = 0;
+        unsigned int iyMax = 0;
+
+        const bool valid = windowMax(input, inputWidth, wx.start[ox],
+                                     wy.start[oy], sxMin, sxMax, syMin, syMax,
+                                     poolValue, ixMax, iyMax);
+
+        argMax[o] = N2D2::PoolCell_Frame_Kernels::ArgMax(ixMax, iyMax,
+                                                         channel, valid);
+        output[o] = alpha * poolValue + beta * output[o];
+    });
+}
+
+template <class T, unsigned int POOL_X, unsigned int POOL_Y>
+void forwardAveragePlane(T alpha,
+                         const T* input,
+                         unsigned int inputWidth,
+                         unsigned int poolSize,
+                         bool countIncludePadding,
+                         const PoolWindow& wx,
+                         const PoolWindow& wy,
+                         T beta,
+                         T* output)
+{
+    const unsigned int outputWidth = wx.start.size();
+
+    forEachWindow<POOL_X, POOL_Y>(wx, wy,
+        [&](unsigned int ox, unsigned int oy,
+            unsigned int sxMin, unsigned int sxMax,
+            unsigned int syMin, unsigned int syMax)
+    {
+        const unsigned int o = ox + oy * outputWidth;
+        const T poolValue = windowSum(input, inputWidth, wx.start[ox],
+                                      wy.start[oy], sxMin, sxMax,
+                                      syMin, syMax);
+        const unsigned int poolCount = (countIncludePadding)
+            ? poolSize : (sxMax - sxMin) * (syMax - syMin);
+
+        output[o] = alpha * ((poolCount > 0)
+                                ? T(poolValue / poolCount) : T(0.0))
+                    + beta * output[o];
+    });
+}
+
+template <class T, unsigned int POOL_X, unsigned int POOL_Y>
+void backwardAveragePlane(T alpha,
+                          const T* diffInput,
+                          unsigned int poolSize,
+                          const PoolWindow& wx,
+                          const PoolWindow& wy,
+                          T* diffOutput,
+                          unsigned int diffOutputWidth)
+{
+    const unsigned int outputWidth = wx.start.size();
+
+    forEachWindow<POOL_X, POOL_Y>(wx, wy,
+        [&](unsigned int ox, unsigned int oy,
+            unsigned int sxMin, unsigned int sxMax,
+            unsigned int syMin, unsigned int syMax)
+    {
+        const T gradient = alpha * diffInput[ox + oy * outputWidth]
+            / T(poolSize);
+
+        windowAdd(diffOutput, diffOutputWidth, wx.start[ox], wy.start[oy],
+                  sxMin, sxMax, syMin, syMax, gradient);
+    });
+}
+
+inline bool isPool(const N2D2::PoolCell_Frame_Kernels::Descriptor& desc,
+                   unsigned int pool)
+{
+    return (desc.pool[0] == pool && desc.pool[1] == pool);
+}
+
+/// diffOutput = beta * diffOutput, without propagating uninitialized values
+/// when beta is 0
+template <class T>
+void scalePlane(T beta, T* diffOutput, unsigned int size)
+{
+    if (beta == T(0.0))
+        std::fill(diffOutput, diffOutput + size, T(0.0));
+    else if (beta != T(1.0)) {
+        for (unsigned int i = 0; i < size; ++i)
+            diffOutput[i] *= beta;
+    }
+}
+}
+
 template <class T>
 void N2D2::PoolCell_Frame_Kernels::forwardAverage(const T* alpha,
                                                   const Tensor<T>&
@@ -34,6 +356,66 @@ void N2D2::PoolCell_Frame_Kernels::forwardAverage(const T* alpha,
                                                   const Tensor<bool>& maps)
 {
     const unsigned int size = inputs.dimB() * outputs.dimZ();
+    const unsigned int poolSize = desc.pool[0] * desc.pool[1];
+
+    const PoolWindow wx(outputs.dimX(), inputs.dimX(), desc.pool[0],
+                        desc.stride[0], desc.padding[0]);
+    const PoolWindow wy(outputs.dimY(), inputs.dimY(), desc.pool[1],
+                        desc.stride[1], desc.padding[1]);
+
+    std::vector<int> outputsChannel;
+
+    if (getOutputsChannel(maps, outputs.dimZ(), inputs.dimZ(),
+                          outputsChannel))
+    {
+        // Channel-wise pooling: each output plane is reduced from a single
+        // input plane
+        const unsigned int inputWidth = inputs.dimX();
+        const unsigned int outputSize = outputs.dimX() * outputs.dimY();
+
+#if defined(_OPENMP) && _OPENMP >= 200805
+#pragma omp parallel for collapse(2) if (size > 16)
+#else
+#pragma omp parallel for if (inputs.dimB() > 4 && size > 16)
+#endif
+        for (int batchPos = 0; batchPos < (int)inputs.dimB(); ++batchPos) {
+            for (unsigned int output = 0; output < outputs.dimZ(); ++output)
+            {
+                T* outputPlane = &outputs(0, 0, output, batchPos);
+                const int channel = outputsChannel[output];
+
+                if (channel < 0) {
+                    for (unsigned int i = 0; i < outputSize; ++i)
+                        outputPlane[i] = (*beta) * outputPlane[i];
+
+                    continue;
+                }
+
+                const T* inputPlane = &inputs(0, 0, channel, batchPos);
+
+                if (isPool(desc, 2)) {
+                    forwardAveragePlane<T, 2, 2>(*alpha, inputPlane,
+                        inputWidth, poolSize, countIncludePadding, wx, wy,
+                        *beta, outputPlane);
+                }
+                else if (isPool(desc, 3)) {
+                    forwardAveragePlane<T, 3, 3>(*alpha, inputPlane,
+                        inputWidth, poolSize, countIncludePadding, wx, wy,
+                        *beta, outputPlane);
+                }
+                else {
+                    forwardAveragePlane<T, 0, 0>(*alpha, inputPlane,
+                        inputWidth, poolSize, countIncludePadding, wx, wy,
+                        *beta, outputPlane);
+                }
+            }
+        }
+
+        return;
+    }
+
+    const std::vector<std::vector<unsigned int> > outputsChannels
+        = getConnections(maps, outputs.dimZ(), inputs.dimZ(), true);
 
 #if defined(_OPENMP) && _OPENMP >= 200805
 #pragma omp parallel for collapse(2) if (size > 16)
@@ -42,51 +424,34 @@ void N2D2::PoolCell_Frame_Kernels::forwardAverage(const T* alpha,
 #endif
     for (int batchPos = 0; batchPos < (int)inputs.dimB(); ++batchPos) {
         for (unsigned int output = 0; output < outputs.dimZ(); ++output) {
+            const std::vector<unsigned int>& channels
+                = outputsChannels[output];
+
             for (unsigned int oy = 0; oy < outputs.dimY(); ++oy) {
                 for (unsigned int ox = 0; ox < outputs.dimX(); ++ox) {
-                    const unsigned int sxMin = (unsigned int)std::max(
-                        desc.padding[0] - (int)(ox * desc.stride[0]), 0);
-                    const unsigned int syMin = (unsigned int)std::max(
-                        desc.padding[1] - (int)(oy * desc.stride[1]), 0);
-                    const unsigned int sxMax = Utils::clamp
-                        <int>(inputs.dimX() + desc.padding[0] - ox * desc.stride[0],
-                              0,
-                              desc.pool[0]);
-                    const unsigned int syMax = Utils::clamp
-                        <int>(inputs.dimY() + desc.padding[1] - oy * desc.stride[1],
-                              0,
-                              desc.pool[1]);
-
-                    const int ix = (int)(ox * desc.stride[0]) - desc.padding[0];
-                    const int iy = (int)(oy * desc.stride[1]) - desc.padding[1];
-
                     // For each output, compute the pool value
                     T poolValue(0.0);
                     unsigned int poolCount = 0;
 
-                    for (unsigned int channel = 0; channel < inputs.dimZ();
-                         ++channel)
+                    for (std::vector<unsigned int>::const_iterator it
+                         = channels.begin(), itEnd = channels.end();
+                         it != itEnd; ++it)
                     {
-                        if (!maps.empty() && !maps(output, channel))
-                            continue;
-
-                        for (unsigned int sy = syMin; sy < syMax; ++sy) {
-                            for (unsigned int sx = sxMin; sx < sxMax; ++sx) {
-                                poolValue += inputs(ix + sx,
-                                                    iy + sy,
-                                                    channel,
-                                                    batchPos);
-                            }
-                        }
+                        poolValue += windowSum(&inputs(0, 0, *it, batchPos),
+                                               inputs.dimX(),
+                                               wx.start[ox], wy.start[oy],
+                                               wx.sMin[ox], wx.sMax[ox],
+                                               wy.sMin[oy], wy.sMax[oy]);
 
                         poolCount += (countIncludePadding)
-                            ? (desc.pool[0] * desc.pool[1])
-                            : (sxMax - sxMin)*(syMax - syMin);
+                            ? poolSize
+                            : (wx.sMax[ox] - wx.sMin[ox])
+                                * (wy.sMax[oy] - wy.sMin[oy]);
                     }
 
                     outputs(ox, oy, output, batchPos)
                         = (*alpha) * ((poolCount > 0) ?
-                                      (poolValue / poolCount) : 0.0)
+                                      T(poolValue / poolCount) : T(0.0))
                           + (*beta) * outputs(ox, oy, output, batchPos);
                 }
             }
@@ -107,6 +472,97 @@ void N2D2::PoolCell_Frame_Kernels::forwardMax(const T* alpha,
 {
     const unsigned int size = inputs.dimB() * outputs.dimZ();
 
+    if (useArgMax) {
+        // Replay the stored argmax indices
+#if defined(_OPENMP) && _OPENMP >= 200805
+#pragma omp parallel for collapse(2) if (size > 16)
+#else
+#pragma omp parallel for if (inputs.dimB() > 4 && size > 16)
+#endif
+        for (int batchPos = 0; batchPos < (int)inputs.dimB(); ++batchPos) {
+            for (unsigned int output = 0; output < outputs.dimZ(); ++output)
+            {
+                for (unsigned int oy = 0; oy < outputs.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < outputs.dimX(); ++ox) {
+                        const ArgMax inputMax
+                            = argMax(ox, oy, output, batchPos);
+                        const T poolValue = (inputMax.valid)
+                            ? inputs(inputMax.ix,
+                                     inputMax.iy,
+                                     inputMax.channel,
+                                     batchPos)
+                            : T(0.0);
+
+                        outputs(ox, oy, output, batchPos)
+                            = (*alpha) * poolValue
+                              + (*beta) * outputs(ox, oy, output, batchPos);
+                    }
+                }
+            }
+        }
+
+        return;
+    }
+
+    const PoolWindow wx(outputs.dimX(), inputs.dimX(), desc.pool[0],
+                        desc.stride[0], desc.padding[0]);
+    const PoolWindow wy(outputs.dimY(), inputs.dimY(), desc.pool[1],
+                        desc.stride[1], desc.padding[1]);
+
+    std::vector<int> outputsChannel;
+
+    if (getOutputsChannel(maps, outputs.dimZ(), inputs.dimZ(),
+                          outputsChannel))
+    {
+        // Channel-wise pooling: each output plane is reduced from a single
+        // input plane
+        const unsigned int inputWidth = inputs.dimX();
+        const unsigned int outputSize = outputs.dimX() * outputs.dimY();
+
+#if defined(_OPENMP) && _OPENMP >= 200805
+#pragma omp parallel for collapse(2) if (size > 16)
+#else
+#pragma omp parallel for if (inputs.dimB() > 4 && size > 16)
+#endif
+        for (int batchPos = 0; batchPos < (int)inputs.dimB(); ++batchPos) {
+            for (unsigned int output = 0; output < outputs.dimZ(); ++output)
+            {
+                T* outputPlane = &outputs(0, 0, output, batchPos);
+                ArgMax* argMaxPlane = &argMax(0, 0, output, batchPos);
+                const int channel = outputsChannel[output];
+
+                if (channel < 0) {
+                    for (unsigned int i = 0; i < outputSize; ++i) {
+                        argMaxPlane[i] = ArgMax();
+                        outputPlane[i] = (*beta) * outputPlane[i];
+                    }
+
+                    continue;
+                }
+
+                const T* inputPlane = &inputs(0, 0, channel, batchPos);
+
+                if (isPool(desc, 2)) {
+                    forwardMaxPlane<T, 2, 2>(*alpha, inputPlane, inputWidth,
+                        channel, wx, wy, *beta, outputPlane, argMaxPlane);
+                }
+                else if (isPool(desc, 3)) {
+                    forwardMaxPlane<T, 3, 3>(*alpha, inputPlane, inputWidth,
+                        channel, wx, wy, *beta, outputPlane, argMaxPlane);
+                }
+                else {
+                    forwardMaxPlane<T, 0, 0>(*alpha, inputPlane, inputWidth,
+                        channel, wx, wy, *beta, outputPlane, argMaxPlane);
+                }
+            }
+        }
+
+        return;
+    }
+
+    const std::vector<std::vector<unsigned int> > outputsChannels
+        = getConnections(maps, outputs.dimZ(), inputs.dimZ(), true);
+
 #if defined(_OPENMP) && _OPENMP >= 200805
 #pragma omp parallel for collapse(2) if (size > 16)
 #else
@@ -114,74 +570,46 @@ void N2D2::PoolCell_Frame_Kernels::forwardMax(const T* alpha,
 #endif
     for (int batchPos = 0; batchPos < (int)inputs.dimB(); ++batchPos) {
         for (unsigned int output = 0; output < outputs.dimZ(); ++output) {
+            const std::vector<unsigned int>& channels
+                = outputsChannels[output];
+
             for (unsigned int oy = 0; oy < outputs.dimY(); ++oy) {
                 for (unsigned int ox = 0; ox < outputs.dimX(); ++ox) {
-                    const unsigned int sxMin = (unsigned int)std::max(
-                        desc.padding[0] - (int)(ox * desc.stride[0]), 0);
-                    const unsigned int syMin = (unsigned int)std::max(
-                        desc.padding[1] - (int)(oy * desc.stride[1]), 0);
-                    const unsigned int sxMax = Utils::clamp
-                        <int>(inputs.dimX() + desc.padding[0] - ox * desc.stride[0],
-                              0,
-                              desc.pool[0]);
-                    const unsigned int syMax = Utils::clamp
-                        <int>(inputs.dimY() + desc.padding[1] - oy * desc.stride[1],
-                              0,
-                              desc.pool[1]);
-
-                    const int ix = (int)(ox * desc.stride[0]) - desc.padding[0];
-                    const int iy = (int)(oy * desc.stride[1]) - desc.padding[1];
-
-                    T poolValue(0.0);
-
                     // For each output, compute the pool value
-                    if (useArgMax) {
-                        const ArgMax inputMax
-                            = argMax(ox, oy, output, batchPos);
+                    T poolValue(0.0);
+                    unsigned int ixMax = 0;
+                    unsigned int iyMax = 0;
+                    unsigned int channelMax = 0;
+                    bool valid = false;
 
-                        if (inputMax.valid) {
-                            poolValue = inputs(inputMax.ix,
-                                               inputMax.iy,
-                                               inputMax.channel,
-                                               batchPos);
-                        }
-                    }
-                    else {
-                        unsigned int ixMax = 0;
-                        unsigned int iyMax = 0;
-                        unsigned int channelMax = 0;
-                        bool valid = false;
+                    for (std::vector<unsigned int>::const_iterator it
+                         = channels.begin(), itEnd = channels.end();
+                         it != itEnd; ++it)
+                    {
+                        T channelValue(0.0);
+                        unsigned int ixChannel = 0;
+                        unsigned int iyChannel = 0;
 
-                        for (unsigned int channel = 0; channel < inputs.dimZ();
-                             ++channel)
+                        if (windowMax(&inputs(0, 0, *it, batchPos),
+                                      inputs.dimX(),
+                                      wx.start[ox], wy.start[oy],
+                                      wx.sMin[ox], wx.sMax[ox],
+                                      wy.sMin[oy], wy.sMax[oy],
+                                      channelValue, ixChannel, iyChannel)
+                            && (!valid || channelValue > poolValue))
                         {
-                            if (!maps.empty() && !maps(output, channel))
-                                continue;
+                            poolValue = channelValue;
+                            valid = true;
 
-                            for (unsigned int sy = syMin; sy < syMax; ++sy) {
-                                for (unsigned int sx = sxMin; sx < sxMax; ++sx)
-                                {
-                                    const T value = inputs(ix + sx,
-                                                                 iy + sy,
-                                                                 channel,
-                                                                 batchPos);
-
-                                    if (!valid || value > poolValue) {
-                                        poolValue = value;
-                                        valid = true;
-
-                                        ixMax = ix + sx;
-                                        iyMax = iy + sy;
-                                        channelMax = channel;
-                                    }
-                                }
-                            }
+                            ixMax = ixChannel;
+                            iyMax = iyChannel;
+                            channelMax = *it;
                         }
-
-                        argMax(ox, oy, output, batchPos)
-                            = ArgMax(ixMax, iyMax, channelMax, valid);
                     }
 
+                    argMax(ox, oy, output, batchPos)
+                        = ArgMax(ixMax, iyMax, channelMax, valid);
+
                     outputs(ox, oy, output, batchPos)
                         = (*alpha) * poolValue
                           + (*beta) * outputs(ox, oy, output, batchPos);
@@ -207,9 +635,77 @@ void N2D2::PoolCell_Frame_Kernels::backwardAverage(const T* alpha,
             " exclude padding not implemented");
     }
 
+    const unsigned int size = diffOutputs.dimB() * diffOutputs.dimZ();
+    const unsigned int poolSize = desc.pool[0] * desc.pool[1];
+
+    std::vector<int> outputsChannel;
+
+    if (getOutputsChannel(maps, diffInputs.dimZ(), diffOutputs.dimZ(),
+                          outputsChannel))
+    {
+        // Channel-wise pooling: scatter the gradient of the outputs
+        // connected to each channel (in parallel over the channels)
+        const PoolWindow wx(diffInputs.dimX(), diffOutputs.dimX(),
+                            desc.pool[0], desc.stride[0], desc.padding[0]);
+        const PoolWindow wy(diffInputs.dimY(), diffOutputs.dimY(),
+                            desc.pool[1], desc.stride[1], desc.padding[1]);
+        const std::vector<std::vector<unsigned int> > channelsOutputs
+            = getConnections(maps, diffInputs.dimZ(), diffOutputs.dimZ(),
+                             false);
+        const unsigned int diffOutputWidth = diffOutputs.dimX();
+        const unsigned int diffOutputSize = diffOutputs.dimX()
+                                            * diffOutputs.dimY();
+
+#if defined(_OPENMP) && _OPENMP >= 200805
+#pragma omp parallel for collapse(2) if (size > 16)
+#else
+#pragma omp parallel for if (diffOutputs.dimB() > 4 && size > 16)
+#endif
+        for (int batchPos = 0; batchPos < (int)diffOutputs.dimB();
+             ++batchPos)
+        {
+            for (unsigned int channel = 0; channel < diffOutputs.dimZ();
+                 ++channel)
+            {
+                T* diffOutputPlane = &diffOutputs(0, 0, channel, batchPos);
+                scalePlane(*beta, diffOutputPlane, diffOutputSize);
+
+                const std::vector<unsigned int>& outputs
+                    = channelsOutputs[channel];
+
+                for (std::vector<unsigned int>::const_iterator it
+                     = outputs.begin(), itEnd = outputs.end();
+                     it != itEnd; ++it)
+                {
+                    const T* diffInputPlane
+                        = &diffInputs(0, 0, *it, batchPos);
+
+                    if (isPool(desc, 2)) {
+                        backwardAveragePlane<T, 2, 2>(*alpha, diffInputPlane,
+                            poolSize, wx, wy, diffOutputPlane,
+                            diffOutputWidth);
+                    }
+                    else if (isPool(desc, 3)) {
+                        backwardAveragePlane<T, 3, 3>(*alpha, diffInputPlane,
+                            poolSize, wx, wy, diffOutputPlane,
+                            diffOutputWidth);
+                    }
+                    else {
+                        backwardAveragePlane<T, 0, 0>(*alpha, diffInputPlane,
+                            poolSize, wx, wy, diffOutputPlane,
+                            diffOutputWidth);
+                    }
+                }
+            }
+        }
+
+        return;
+    }
+
     const unsigned int oxStride = desc.stride[0] * diffInputs.dimX();
     const unsigned int oyStride = desc.stride[1] * diffInputs.dimY();
-    const unsigned int size = diffOutputs.dimB() * diffOutputs.dimZ();
+    const std::vector<std::vector<unsigned int> > channelsOutputs
+        = getConnections(maps, diffInputs.dimZ(), diffOutputs.dimZ(), false);
 
     std::vector<unsigned int> poolChannelsCount(diffInputs.dimZ(), 0);
 
@@ -228,6 +724,9 @@ void N2D2::PoolCell_Frame_Kernels::backwardAverage(const T* alpha,
         for (unsigned int channel = 0; channel < diffOutputs.dimZ();
              ++channel)
         {
+            const std::vector<unsigned int>& outputs
+                = channelsOutputs[channel];
+
             for (unsigned int iy = 0; iy < diffOutputs.dimY(); ++iy) {
                 for (unsigned int ix = 0; ix < diffOutputs.dimX(); ++ix) {
                     const unsigned int ixPad = ix + desc.padding[0];
@@ -258,27 +757,21 @@ void N2D2::PoolCell_Frame_Kernels::backwardAverage(const T* alpha,
                             const unsigned int ox = (ixPad - sx) / desc.stride[0];
                             const unsigned int oy = (iyPad - sy) / desc.stride[1];
 
-                            for (unsigned int output = 0;
-                                 output < diffInputs.dimZ();
-                                 ++output)
+                            for (std::vector<unsigned int>::const_iterator it
+                                 = outputs.begin(), itEnd = outputs.end();
+                                 it != itEnd; ++it)
                             {
-                                if (!maps.empty() && !maps(output, channel))
-                                    continue;
-
                                 poolGradient += diffInputs(ox,
                                                            oy,
-                                                           output,
+                                                           *it,
                                                            batchPos)
-                                                / poolChannelsCount[output];
+                                                / poolChannelsCount[*it];
                             }
                         }
                     }
 
-                    const unsigned int poolCount
-                        = desc.pool[0] * desc.pool[1];
-
                     diffOutputs(ix, iy, channel, batchPos)
-                        = (*alpha) * (poolGradient / poolCount)
+                        = (*alpha) * (poolGradient / poolSize)
                           + (*beta) * diffOutputs(ix, iy, channel, batchPos);
                 }
             }
@@ -297,9 +790,69 @@ void N2D2::PoolCell_Frame_Kernels::backwardMax(const T* alpha,
                                                const Tensor<ArgMax>& argMax,
                                                const Tensor<bool>& maps)
 {
+    const unsigned int size = diffOutputs.dimB() * diffOutputs.dimZ();
+
+    std::vector<int> outputsChannel;
+
+    if (getOutputsChannel(maps, diffInputs.dimZ(), diffOutputs.dimZ(),
+                          outputsChannel))
+    {
+        // Channel-wise pooling: scatter the gradient of the outputs
+        // connected to each channel to their stored argmax position (in
+        // parallel over the channels)
+        const std::vector<std::vector<unsigned int> > channelsOutputs
+            = getConnections(maps, diffInputs.dimZ(), diffOutputs.dimZ(),
+                             false);
+        const unsigned int diffOutputWidth = diffOutputs.dimX();
+        const unsigned int diffOutputSize = diffOutputs.dimX()
+                                            * diffOutputs.dimY();
+        const unsigned int diffInputSize = diffInputs.dimX()
+                                           * diffInputs.dimY();
+
+#if defined(_OPENMP) && _OPENMP >= 200805
+#pragma omp parallel for collapse(2) if (size > 16)
+#else
+#pragma omp parallel for if (diffOutputs.dimB() > 4 && size > 16)
+#endif
+        for (int batchPos = 0; batchPos < (int)diffOutputs.dimB();
+             ++batchPos)
+        {
+            for (unsigned int channel = 0; channel < diffOutputs.dimZ();
+                 ++channel)
+            {
+                T* diffOutputPlane = &diffOutputs(0, 0, channel, batchPos);
+                scalePlane(*beta, diffOutputPlane, diffOutputSize);
+
+                const std::vector<unsigned int>& outputs
+                    = channelsOutputs[channel];
+
+                for (std::vector<unsigned int>::const_iterator it
+                     = outputs.begin(), itEnd = outputs.end();
+                     it != itEnd; ++it)
+                {
+                    const T* diffInputPlane
+                        = &diffInputs(0, 0, *it, batchPos);
+                    const ArgMax* argMaxPlane
+                        = &argMax(0, 0, *it, batchPos);
+
+                    for (unsigned int o = 0; o < diffInputSize; ++o) {
+                        if (argMaxPlane[o].valid) {
+                            diffOutputPlane[argMaxPlane[o].ix
+                                    + argMaxPlane[o].iy * diffOutputWidth]
+                                += (*alpha) * diffInputPlane[o];
+                        }
+                    }
+                }
+            }
+        }
+
+        return;
+    }
+
     const unsigned int oxStride = desc.stride[0] * diffInputs.dimX();
     const unsigned int oyStride = desc.stride[1] * diffInputs.dimY();
-    const unsigned int size = diffOutputs.dimB() * diffOutputs.dimZ();
+    const std::vector<std::vector<unsigned int> > channelsOutputs
+        = getConnections(maps, diffInputs.dimZ(), diffOutputs.dimZ(), false);
 
 #if defined(_OPENMP) && _OPENMP >= 200805
 #pragma omp parallel for collapse(2) if (size > 16)
@@ -310,6 +863,9 @@ void N2D2::PoolCell_Frame_Kernels::backwardMax(const T* alpha,
         for (unsigned int channel = 0; channel < diffOutputs.dimZ();
              ++channel)
         {
+            const std::vector<unsigned int>& outputs
+                = channelsOutputs[channel];
+
             for (unsigned int iy = 0; iy < diffOutputs.dimY(); ++iy) {
                 for (unsigned int ix = 0; ix < diffOutputs.dimX(); ++ix) {
                     const unsigned int ixPad = ix + desc.padding[0];
@@ -340,15 +896,12 @@ void N2D2::PoolCell_Frame_Kernels::backwardMax(const T* alpha,
                             const unsigned int ox = (ixPad - sx) / desc.stride[0];
                             const unsigned int oy = (iyPad - sy) / desc.stride[1];
 
-                            for (unsigned int output = 0;
-                                 output < diffInputs.dimZ();
-                                 ++output)
+                            for (std::vector<unsigned int>::const_iterator it
+                                 = outputs.begin(), itEnd = outputs.end();
+                                 it != itEnd; ++it)
                             {
-                                if (!maps.empty() && !maps(output, channel))
-                                    continue;
-
                                 const ArgMax inputMax
-                                    = argMax(ox, oy, output, batchPos);
+                                    = argMax(ox, oy, *it, batchPos);
 
                                 if (ix == inputMax.ix
                                     && iy == inputMax.iy
@@ -357,7 +910,7 @@ void N2D2::PoolCell_Frame_Kernels::backwardMax(const T* alpha,
                                 {
                                     poolGradient += diffInputs(ox,
                                                                oy,
-                                                               output,
+                                                               *it,
                                                                batchPos);
                                 }
                             }
@@ -47,7 +47,8 @@ N2D2::SoftmaxCell_Frame<T>::SoftmaxCell_Frame(const DeepNet& deepNet, const std:
                                            unsigned int groupSize)
     : Cell(deepNet, name, nbOutputs),
       SoftmaxCell(deepNet, name, nbOutputs, withLoss, groupSize),
-      Cell_Frame<T>(deepNet, name, nbOutputs)
+      Cell_Frame<T>(deepNet, name, nbOutputs),
+      mFusedLoss(this, "FusedLoss", false)
 {
     // ctor
 }
@@ -74,6 +75,17 @@ void N2D2::SoftmaxCell_Frame<T>::initialize()
                                     "the number of outputs.");
 
     }
+
+    if (mFusedLoss) {
+        if (!mWithLoss || mGroupSize > 0) {
+            throw std::domain_error("SoftmaxCell_Frame<T>::initialize():"
+                                    " FusedLoss requires WithLoss and is not "
+                                    "compatible with GroupSize.");
+        }
+
+        mLogSumExp.resize({mOutputsDims[0], mOutputsDims[1], 1,
+                           mOutputs.dimB()});
+    }
 }
 
 template <class T>
@@ -102,18 +114,25 @@ void N2D2::SoftmaxCell_Frame<T>::propagate(bool /*inference*/)
                     // double required for large number of channels
                     T sum(0.0);
 
-                    for (unsigned int output = stride; output < nbNeurons; ++output)
-                        sum += std::exp(input(ox, oy, output, batchPos) - maxVal);
+                    for (unsigned int output = stride; output < nbNeurons; ++output) {
+                        const T e(std::exp(input(ox, oy, output, batchPos)
+                                           - maxVal));
+                        mOutputs(ox, oy, output, batchPos) = e;
+                        sum += e;
+                    }
 
                     if (sum > T(0.0)) {
+                        const T invSum = T(1.0) / sum;
+
                         for (unsigned int output = stride; output < nbNeurons; ++output)
-                            mOutputs(ox, oy, output, batchPos)
-                                = std::exp(input(ox, oy, output, batchPos)
-                                        - maxVal) / sum;
+                            mOutputs(ox, oy, output, batchPos) *= invSum;
                     } else {
                         for (unsigned int output = stride; output < nbNeurons; ++output)
                             mOutputs(ox, oy, output, batchPos) = T(0.0);
                     }
+
+                    if (mFusedLoss)
+                        mLogSumExp(ox, oy, 0, batchPos) = maxVal + std::log(sum);
                 }
             }
         }
@@ -183,6 +202,125 @@ void N2D2::SoftmaxCell_Frame<T>::backPropagate()
     mDiffOutputs.synchronizeHToD();
 }
 
+template <class T>
+double N2D2::SoftmaxCell_Frame<T>::setOutputTarget(const Tensor<int>& targets,
+                                                   double targetVal,
+                                                   double defaultVal)
+{
+    if (!mFusedLoss)
+        return Cell_Frame<T>::setOutputTarget(targets, targetVal, defaultVal);
+
+    if (targets.size() / targets.dimB() != 1
+        || mOutputsDims[0] != 1 || mOutputsDims[1] != 1)
+    {
+        throw std::domain_error("SoftmaxCell_Frame<T>::setOutputTarget(): "
+                                "require one target per batch.");
+    }
+
+    return setOutputTargetsFused(targets, targetVal, defaultVal, false);
+}
+
+template <class T>
+double N2D2::SoftmaxCell_Frame<T>::setOutputTargets(const Tensor<int>& targets,
+                                                    double targetVal,
+                                                    double defaultVal)
+{
+    if (!mFusedLoss)
+        return Cell_Frame<T>::setOutputTargets(targets, targetVal, defaultVal);
+
+    if (targets.dimX() != mOutputsDims[0] || targets.dimY() != mOutputsDims[1])
+    {
+        std::ostringstream errorStr;
+        errorStr << "SoftmaxCell_Frame<T>::setOutputTargets(): wrong target "
+            "matrix size. Expected " << mOutputsDims << ", got "
+            << targets.dims() << std::endl;
+
+        throw std::domain_error(errorStr.str());
+    }
+
+    return setOutputTargetsFused(targets, targetVal, defaultVal, true);
+}
+
+/**
+ * Fused error and cross-entropy loss computation. The error written in
+ * mDiffInputs is the same as in Cell_Frame<T>::setOutputTarget(s)(), but the
+ * returned loss is the cross-entropy \f$\sum_j t_j (lse - x_j)\f$, which
+ * remains finite even when a probability underflows to 0.
+*/
+template <class T>
+double N2D2::SoftmaxCell_Frame<T>::setOutputTargetsFused(
+    const Tensor<int>& targets,
+    double targetVal,
+    double defaultVal,
+    bool balanced)
+{
+    if (targets.dimB() != mOutputs.dimB())
+        throw std::domain_error("SoftmaxCell_Frame<T>::setOutputTargets(): "
+                                "target and output batch sizes don't match.");
+
+    const unsigned int nbOutputs = getNbOutputs();
+
+    // Check the targets first, as nothing may be thrown in the parallel loop
+    for (unsigned int index = 0; index < targets.size(); ++index) {
+        if (targets(index) >= (int)nbOutputs) {
+            std::stringstream errorMsg;
+            errorMsg << "SoftmaxCell_Frame<T>::setOutputTargets(): output "
+                "target (" << targets(index) << ") out of range [0,"
+                << (nbOutputs - 1) << "].";
+
+            throw std::domain_error(errorMsg.str());
+        }
+    }
+
+    const Tensor<T>& input = tensor_cast<T>(mInputs[0]);
+    const unsigned int size = mOutputsDims[0] * mOutputsDims[1];
+    double loss = 0.0;
+
+#pragma omp parallel for if (mOutputs.dimB() > 4) reduction(+:loss)
+    for (int batchPos = 0; batchPos < (int)mOutputs.dimB(); ++batchPos) {
+        const Tensor<int> target = targets[batchPos];
+        std::vector<unsigned int> nbTargetOutputs(nbOutputs, 1);
+
+        if (balanced) {
+            std::fill(nbTargetOutputs.begin(), nbTargetOutputs.end(), 0);
+
+            for (unsigned int pos = 0; pos < size; ++pos) {
+                if (target(pos) >= 0)
+                    ++nbTargetOutputs[target(pos)];
+            }
+        }
+
+        for (unsigned int pos = 0; pos < size; ++pos) {
+            const unsigned int ox = pos % mOutputsDims[0];
+            const unsigned int oy = pos / mOutputsDims[0];
+            const int cls = target(pos);
+
+            if (cls < 0) {
+                for (unsigned int output = 0; output < nbOutputs; ++output)
+                    mDiffInputs(ox, oy, output, batchPos) = T(0.0);
+
+                continue;
+            }
+
+            const double lse = mLogSumExp(ox, oy, 0, batchPos);
+            const double scale = 1.0 / nbTargetOutputs[cls];
+
+            for (unsigned int output = 0; output < nbOutputs; ++output) {
+                const double t = ((int)output == cls) ? targetVal : defaultVal;
+
+                mDiffInputs(ox, oy, output, batchPos)
+                    = T(scale * (t - (double)mOutputs(ox, oy, output,
+                                                      batchPos)));
+
+                if (t != 0.0)
+                    loss += t * (lse - (double)input(ox, oy, output, batchPos));
+            }
+        }
+    }
+
+    return (loss / mOutputs.dimB());
+}
+
 template <class T>
 void N2D2::SoftmaxCell_Frame<T>::update()
 {
@@ -203,7 +341,7 @@ void N2D2::SoftmaxCell_Frame<T>::checkGradient(double epsilon, double maxError)
             std::stringstream name;
             name << mName + "_mDiffOutputs[" << in << "]";
 
-            gc.check(name.str(), mInputs[in], mDiffOutputs[in]);
+            gc.check(name.str(), mInputs[in], mDiffOutputs[in], true);
         }
     } else {
         std::cout << Utils::cwarning << "Empty diff. outputs for cell " << mName
@@ -19,13 +19,26 @@
 */
 
 #include "Cochlea.hpp"
-#include "Aer.hpp"
 #include "AerEvent.hpp"
-#include "Sound.hpp"
+#include "Environment.hpp"
+#include "NodeEnv.hpp"
 #include "utils/Gnuplot.hpp"
 
+namespace {
+// Number of channels processed together by the streaming engine, which is a
+// multiple of the SIMD width
+const unsigned int groupSize = 64;
+}
+
 N2D2::Cochlea::Cochlea(unsigned int nbChannels)
-    : mNbChannels(nbChannels), mNormalize(this, "Normalize", true)
+    : mNbChannels(nbChannels),
+      mStreamExpLeak(1.0),
+      mStreamSamplingPeriod(0.0),
+      mStreamDt(0),
+      mStreamRefractory(0),
+      mStreamStochastic(false),
+      mStreamSample(0),
+      mNormalize(this, "Normalize", true)
 {
     // ctor
 }
@@ -61,14 +74,8 @@ unsigned int N2D2::Cochlea::load(const std::string& fileName,
 
 #pragma omp parallel for ordered schedule(dynamic)
     for (int i = 0; i < (int)mNbChannels; ++i) {
-        const double centerFreq
-            = (filterSpace == LinearSpace)
-                  ? lowFreq + (upFreq - lowFreq) * i / (mNbChannels - 1)
-                  : -earQ * minBw
-                    + (lowFreq + earQ * minBw)
-                      * std::exp((std::log(upFreq + earQ * minBw)
-                                  - std::log(lowFreq + earQ * minBw)) * i
-                                 / (double)mNbChannels);
+        const double centerFreq = centerFrequency(
+            i, lowFreq, upFreq, filterSpace, earQ, minBw);
 
         const double freqBand = (earQ > 0.0) ? centerFreq / earQ + minBw
                                              : minBw;
@@ -266,3 +273,378 @@ unsigned int N2D2::Cochlea::load(const std::string& fileName,
               << std::endl;
     return events.size();
 }
+
+unsigned int N2D2::Cochlea::loadStream(const std::string& fileName,
+                                       unsigned int order,
+                                       double lowFreq,
+                                       double upFreq,
+                                       double threshold,
+                                       Time_T leak,
+                                       Time_T refractory,
+                                       FilterSpace filterSpace,
+                                       double earQ,
+                                       double minBw,
+                                       double start,
+                                       double end,
+                                       unsigned int blockSize)
+{
+    Sound audio;
+    double scale = 1.0;
+
+    if (mNormalize) {
+        // First pass to compute the RMS value of the signal
+        double sumSq = 0.0;
+        unsigned long long int nbSamples = 0;
+
+        audio.openStream(fileName, start, end);
+
+        while (unsigned int size = audio.readBlock(blockSize)) {
+            sumSq += std::inner_product(
+                audio(0).begin(), audio(0).end(), audio(0).begin(), 0.0);
+            nbSamples += size;
+        }
+
+        if (nbSamples == 0)
+            throw std::runtime_error("Cochlea::loadStream(): empty audio "
+                                     "file: " + fileName);
+
+        scale = 1.0 / std::sqrt(sumSq / nbSamples);
+    }
+
+    audio.openStream(fileName, start, end);
+    initializeStream(audio.getSamplingFrequency(),
+                     order,
+                     lowFreq,
+                     upFreq,
+                     threshold,
+                     leak,
+                     refractory,
+                     filterSpace,
+                     earQ,
+                     minBw);
+
+    std::string shortName = Utils::fileBaseName(fileName);
+
+    if (threshold <= 0.0)
+        shortName += "-stoch";
+
+    // Create the file with its header
+    Aer::save(shortName + ".dat", Aer::AerData_T());
+
+    Aer::AerData_T events;
+    unsigned int nbEvents = 0;
+
+    while (audio.readBlock(blockSize) > 0) {
+        if (scale != 1.0)
+            audio.normalize(0, scale);
+
+        events.clear();
+        nbEvents += processBlock(audio(0), events);
+        Aer::save(shortName + ".dat", events, true);
+    }
+
+    std::cout << "[loadCochlea] *** " << nbEvents
+              << " events generated for " << mNbChannels << " inputs"
+              << std::endl;
+    return nbEvents;
+}
+
+void N2D2::Cochlea::initializeStream(unsigned int samplingFrequency,
+                                     unsigned int order,
+                                     double lowFreq,
+                                     double upFreq,
+                                     double threshold,
+                                     Time_T leak,
+                                     Time_T refractory,
+                                     FilterSpace filterSpace,
+                                     double earQ,
+                                     double minBw)
+{
+    // Only used to design the filters
+    const Sound audio(samplingFrequency);
+
+    mStreamDt = (Time_T)(TimeS / samplingFrequency);
+    mStreamExpLeak = (leak > 0.0)
+        ? std::exp(-((double)mStreamDt) / ((double)leak)) : 1.0;
+    mStreamSamplingPeriod = 1.0 / samplingFrequency;
+    mStreamRefractory = refractory;
+    mStreamStochastic = (threshold <= 0.0);
+
+    mStreamFilters.clear();
+    mStreamThresholds.resize(mNbChannels);
+
+    for (unsigned int i = 0; i < mNbChannels; ++i) {
+        const double centerFreq = centerFrequency(
+            i, lowFreq, upFreq, filterSpace, earQ, minBw);
+        const double freqBand = (earQ > 0.0) ? centerFreq / earQ + minBw
+                                             : minBw;
+
+        // Same filters as in load(), applied in the same order
+        std::vector<Sound::Filter_T> filters;
+
+        if (order > 0) {
+            const Sound::Filter_T filter
+                = audio.newFilter(Sound::Butterworth,
+                                  Sound::BandPass,
+                                  2,
+                                  centerFreq - freqBand / 2.0,
+                                  centerFreq + freqBand / 2.0);
+            filters.assign(order / 2, filter);
+
+            if (order % 2 == 1) {
+                filters.push_back(audio.newFilter(Sound::Butterworth,
+                                                  Sound::BandPass,
+                                                  1,
+                                                  centerFreq - freqBand / 2.0,
+                                                  centerFreq + freqBand / 2.0));
+            }
+        } else {
+            filters.resize(4);
+            std::tie(filters[0], filters[1], filters[2], filters[3])
+                = audio.newGammatoneFilter(centerFreq, freqBand);
+        }
+
+        if (i == 0) {
+            for (std::vector<Sound::Filter_T>::const_iterator it
+                 = filters.begin(),
+                 itEnd = filters.end();
+                 it != itEnd;
+                 ++it) {
+                mStreamFilters.push_back(FilterBank(mNbChannels,
+                                                    (*it).first.size(),
+                                                    (*it).second.size() - 1));
+            }
+        }
+
+        for (unsigned int f = 0; f < filters.size(); ++f)
+            mStreamFilters[f].setFilter(i, filters[f]);
+
+        mStreamThresholds[i]
+            = (earQ > 0.0)
+                  ? threshold
+                    * std::pow(freqBand / (lowFreq / earQ + minBw), 1.0 / 3.0)
+                  : threshold;
+    }
+
+    const Sound::Filter_T filterLowPass
+        = audio.newFilter(Sound::Butterworth, Sound::LowPass, 1, 65);
+
+    mStreamLowPass = FilterBank(mNbChannels,
+                                filterLowPass.first.size(),
+                                filterLowPass.second.size() - 1);
+
+    for (unsigned int i = 0; i < mNbChannels; ++i)
+        mStreamLowPass.setFilter(i, filterLowPass);
+
+    resetStream();
+}
+
+void N2D2::Cochlea::resetStream()
+{
+    std::for_each(mStreamFilters.begin(),
+                  mStreamFilters.end(),
+                  std::bind(&FilterBank::reset, std::placeholders::_1));
+    mStreamLowPass.reset();
+
+    mStreamSample = 0;
+    mStreamIntegration.assign(mNbChannels, 0.0);
+    mStreamRefractoryEnd.assign(mNbChannels, 0);
+}
+
+unsigned int N2D2::Cochlea::processBlock(const std::vector<double>& samples,
+                                         Aer::AerData_T& events)
+{
+    if (mStreamThresholds.size() != mNbChannels) {
+        throw std::runtime_error("Cochlea::processBlock(): the streaming "
+                                 "engine is not initialized");
+    }
+
+    const int nbGroups = (mNbChannels + groupSize - 1) / groupSize;
+    std::vector<Aer::AerData_T> groupEvents(nbGroups);
+
+    // Random::randUniform() is not thread-safe
+#pragma omp parallel for schedule(dynamic) if (nbGroups > 1 && !mStreamStochastic)
+    for (int group = 0; group < nbGroups; ++group) {
+        const unsigned int first = group * groupSize;
+        const unsigned int last = std::min(first + groupSize, mNbChannels);
+        const unsigned int size = last - first;
+        double signal[groupSize];
+
+        for (unsigned int s = 0; s < samples.size(); ++s) {
+            const unsigned long long int n = mStreamSample + s;
+
+            std::fill(signal, signal + size, samples[s]);
+
+            for (std::vector<FilterBank>::iterator it = mStreamFilters.begin(),
+                 itEnd = mStreamFilters.end();
+                 it != itEnd;
+                 ++it)
+                (*it).apply(signal, first, last, n);
+
+            // Half-wave rectification and then low-pass filter
+            for (unsigned int ch = 0; ch < size; ++ch)
+                signal[ch] = std::max(0.0, signal[ch]);
+
+            mStreamLowPass.apply(signal, first, last, n);
+
+            const Time_T timestamp = n * mStreamDt;
+
+            for (unsigned int ch = 0; ch < size; ++ch) {
+                const unsigned int i = first + ch;
+
+                if (!mStreamStochastic) {
+                    if (timestamp >= mStreamRefractoryEnd[i]) {
+                        mStreamIntegration[i]
+                            = mStreamIntegration[i] * mStreamExpLeak
+                              + signal[ch] * mStreamSamplingPeriod;
+                    }
+
+                    if (mStreamIntegration[i] >= mStreamThresholds[i]) {
+                        mStreamIntegration[i] = 0.0;
+                        mStreamRefractoryEnd[i] = timestamp
+                                                  + mStreamRefractory;
+
+                        groupEvents[group].push_back(std::make_pair(
+                            timestamp, AerEvent::unmaps(0, 0, i)));
+                    }
+                } else {
+                    if (-signal[ch] * mStreamThresholds[i]
+                        > Random::randUniform())
+                        groupEvents[group].push_back(std::make_pair(
+                            timestamp, AerEvent::unmaps(0, 0, i)));
+                }
+            }
+        }
+    }
+
+    mStreamSample += samples.size();
+
+    const size_t offset = events.size();
+
+    for (int group = 0; group < nbGroups; ++group) {
+        events.insert(events.end(),
+                      groupEvents[group].begin(),
+                      groupEvents[group].end());
+    }
+
+    std::sort(events.begin() + offset, events.end());
+    return (events.size() - offset);
+}
+
+unsigned int N2D2::Cochlea::processBlock(const std::vector<double>& samples,
+                                         Environment& env,
+                                         Time_T offset)
+{
+    if (env.getNodes(0).size() < mNbChannels) {
+        throw std::runtime_error("Cochlea::processBlock(): the environment "
+                                 "has less nodes than channels");
+    }
+
+    Aer::AerData_T events;
+    processBlock(samples, events);
+
+    AerEvent event;
+
+    for (Aer::AerData_T::const_iterator it = events.begin(),
+                                        itEnd = events.end();
+         it != itEnd;
+         ++it) {
+        event.addr = (*it).second;
+        event.unmaps();
+
+        env.getNodeByIndex(0, event.node)
+            ->incomingSpike(NULL, offset + (*it).first);
+    }
+
+    return events.size();
+}
+
+N2D2::Cochlea::FilterBank::FilterBank(unsigned int nbChannels_,
+                                      unsigned int nbB_,
+                                      unsigned int nbA_)
+    : nbChannels(nbChannels_),
+      nbB(nbB_),
+      nbA(nbA_),
+      b(nbB_ * nbChannels_, 0.0),
+      a(nbA_ * nbChannels_, 0.0),
+      invGain(nbChannels_, 1.0),
+      x(nbB_ * nbChannels_, 0.0),
+      y(nbA_ * nbChannels_, 0.0)
+{
+    // ctor
+}
+
+void N2D2::Cochlea::FilterBank::setFilter(unsigned int channel,
+                                          const Sound::Filter_T& filter)
+{
+    if (filter.first.size() != nbB || filter.second.size() != nbA + 1) {
+        throw std::runtime_error("Cochlea::FilterBank::setFilter(): filters "
+                                 "must have the same order for all channels");
+    }
+
+    for (unsigned int k = 0; k < nbB; ++k)
+        b[k * nbChannels + channel] = filter.first[k];
+
+    for (unsigned int k = 0; k < nbA; ++k)
+        a[k * nbChannels + channel] = filter.second[k];
+
+    invGain[channel] = 1.0 / filter.second.back();
+}
+
+void N2D2::Cochlea::FilterBank::reset()
+{
+    std::fill(x.begin(), x.end(), 0.0);
+    std::fill(y.begin(), y.end(), 0.0);
+}
+
+void N2D2::Cochlea::FilterBank::apply(double* signal,
+                                      unsigned int first,
+                                      unsigned int last,
+                                      unsigned long long int n)
+{
+    // Same computation as Sound::applyFilter(), in direct form I
+    const unsigned int size = last - first;
+    double* xn = &x[(n % nbB) * nbChannels + first];
+
+    for (unsigned int ch = 0; ch < size; ++ch) {
+        xn[ch] = signal[ch] * invGain[first + ch];
+        signal[ch] = 0.0;
+    }
+
+    // a[k] is applied to y[n - nbA + k]
+    for (unsigned int k = 0; k < nbA; ++k) {
+        const double* ak = &a[k * nbChannels + first];
+        const double* yk = &y[((n + k) % nbA) * nbChannels + first];
+
+        for (unsigned int ch = 0; ch < size; ++ch)
+            signal[ch] -= ak[ch] * yk[ch];
+    }
+
+    // b[k] is applied to x[n - nbB + 1 + k]
+    for (unsigned int k = 0; k < nbB; ++k) {
+        const double* bk = &b[k * nbChannels + first];
+        const double* xk = &x[((n + 1 + k) % nbB) * nbChannels + first];
+
+        for (unsigned int ch = 0; ch < size; ++ch)
+            signal[ch] += bk[ch] * xk[ch];
+    }
+
+    if (nbA > 0)
+        std::copy(signal, signal + size, &y[(n % nbA) * nbChannels + first]);
+}
+
+double N2D2::Cochlea::centerFrequency(unsigned int channel,
+                                      double lowFreq,
+                                      double upFreq,
+                                      FilterSpace filterSpace,
+                                      double earQ,
+                                      double minBw) const
+{
+    return (filterSpace == LinearSpace)
+        ? lowFreq + (upFreq - lowFreq) * channel / (mNbChannels - 1)
+        : -earQ * minBw
+          + (lowFreq + earQ * minBw)
+            * std::exp((std::log(upFreq + earQ * minBw)
+                        - std::log(lowFreq + earQ * minBw)) * channel
+                       / (double)mNbChannels);
+}
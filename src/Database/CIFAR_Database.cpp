@@ -50,74 +50,55 @@ void N2D2::CIFAR_Database::loadCIFAR(const std::string& dataFile,
     labels.close();
 
     // Images
-    std::ifstream images(dataFile.c_str(), std::fstream::binary);
+    // The data file is memory-mapped and the stimuli are read directly from
+    // it, without being converted to individual image files
+    const std::shared_ptr<MemoryMappedFile> images
+        = std::make_shared<MemoryMappedFile>(dataFile);
 
-    if (!images.good())
-        throw std::runtime_error("Could not open images file: " + dataFile);
+    const size_t imageSize = 3 * nbRows * nbColumns;
+    const size_t recordSize = 1 + coarseAndFine + imageSize;
+    const unsigned int nbImages = images->size() / recordSize;
 
-    const std::ifstream::pos_type size
-        = images.seekg(0, std::ifstream::end).tellg();
-    images.seekg(0, std::ifstream::beg);
-
-    const unsigned int nbImages
-        = size / (1 + coarseAndFine + 3 * nbRows * nbColumns);
+    if (images->size() % recordSize != 0)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + dataFile);
 
     // For each image...
     for (unsigned int i = 0; i < nbImages; ++i) {
+        const size_t offset = i * recordSize;
+
         // Read label
-        unsigned char label;
-        images.read(reinterpret_cast<char*>(&label), sizeof(label));
+        unsigned char label = images->data()[offset];
+
+        if (coarseAndFine && !useCoarse)
+            label = images->data()[offset + 1];
 
-        if (coarseAndFine) {
-            unsigned char fineLabel;
-            images.read(reinterpret_cast<char*>(&fineLabel), sizeof(fineLabel));
+        if (label >= labelsName.size()) {
+            std::ostringstream errorStr;
+            errorStr << "Label out of range (" << (unsigned int)label
+                << ") for image #" << i << " in data file: " << dataFile;
 
-            if (!useCoarse)
-                label = fineLabel;
+            throw std::runtime_error(errorStr.str());
         }
 
         std::ostringstream nameStr;
         nameStr << dataFile << "[" << std::setfill('0') << std::setw(5) << i
                 << "].ppm";
 
-        // ... generate the stimuli
-        if (!std::ifstream(nameStr.str()).good()) {
-            cv::Mat frame(
-                cv::Size(nbColumns, nbRows), CV_8UC3, cv::Scalar(0, 0, 0));
-
-            for (int c = 2; c >= 0; --c) {
-                for (unsigned int y = 0; y < nbRows; ++y) {
-                    for (unsigned int x = 0; x < nbColumns; ++x) {
-                        unsigned char color;
-                        images.read(reinterpret_cast<char*>(&color),
-                                    sizeof(color));
-
-                        // Vec3b color order: blue, green, red
-                        frame.at<cv::Vec3b>(y, x)[c] = color;
-                    }
-                }
-            }
-
-            if (!cv::imwrite(nameStr.str(), frame))
-                throw std::runtime_error("Unable to write image: "
-                                         + nameStr.str());
-        } else {
-            // Skip image data (to grab labels only)
-            images.seekg(3 * nbColumns * nbRows, images.cur);
-        }
-
         mStimuli.push_back(Stimulus(nameStr.str(), labelID(labelsName[label])));
+
+        // ... reference the stimulus data (planar RGB)
+        StimulusBlob& blob = mStimuli.back().blob;
+        blob.file = images;
+        blob.offset = offset + 1 + coarseAndFine;
+        blob.rows = nbRows;
+        blob.cols = nbColumns;
+        blob.channels = 3;
+        blob.depth = CV_8U;
+        blob.planar = true;
+
         mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
     }
-
-    if (images.eof())
-        throw std::runtime_error(
-            "End-of-file reached prematurely in data file: " + dataFile);
-    else if (!images.good())
-        throw std::runtime_error("Error while reading data file: " + dataFile);
-    else if (images.get() != std::fstream::traits_type::eof())
-        throw std::runtime_error("Data file size larger than expected: "
-                                 + dataFile);
 }
 
 N2D2::CIFAR10_Database::CIFAR10_Database(double validation)
@@ -22,8 +22,13 @@
 #include "DataFile/DataFile.hpp"
 #include "utils/Registrar.hpp"
 
+#include <ctime>
+#include <set>
+
 N2D2::DIR_Database::DIR_Database(bool loadDataInMemory)
-    : Database(loadDataInMemory)
+    : Database(loadDataInMemory),
+      mManifestFile(this, "ManifestFile", ""),
+      mManifestLoaded(false)
 {
     // ctor
 }
@@ -61,6 +66,140 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
     if (!((std::string)mDefaultLabel).empty())
         labelID(mDefaultLabel);
 
+    const std::string manifestFile = mManifestFile;
+
+    if (!manifestFile.empty() && !mManifestLoaded) {
+        loadManifest(manifestFile);
+        mManifestLoaded = true;
+    }
+
+    scanDirs(dirPath, depth);
+    addDir(dirPath, depth, labelName, labelDepth);
+
+    if (!manifestFile.empty())
+        saveManifest(manifestFile);
+}
+
+/**
+ * Breadth-first scan of the directories tree, in parallel for all the
+ * directories of a same level. Directories already in mDirs whose
+ * modification time did not change are not rescanned, and directories that
+ * no longer exist are removed from mDirs.
+*/
+void N2D2::DIR_Database::scanDirs(const std::string& dirPath, int depth)
+{
+    std::vector<std::pair<std::string, int> > dirs;
+    dirs.push_back(std::make_pair(dirPath, depth));
+
+    std::set<std::string> visited;
+    unsigned int nbScanned = 0;
+
+    while (!dirs.empty()) {
+        std::vector<DirEntry> entries(dirs.size());
+        std::vector<char> scanned(dirs.size(), false);
+        std::string error;
+
+#pragma omp parallel for schedule(dynamic) if (dirs.size() > 1)
+        for (int i = 0; i < (int)dirs.size(); ++i) {
+            const std::string& path = dirs[i].first;
+            struct stat dirStat;
+
+            if (stat(path.c_str(), &dirStat) < 0) {
+#pragma omp critical(DIR_Database__scanDirs)
+                error = path;
+                continue;
+            }
+
+            // mDirs is not modified in the parallel loop
+            const std::map<std::string, DirEntry>::const_iterator itDir
+                = mDirs.find(path);
+
+            if (itDir != mDirs.end()
+                && (*itDir).second.mtime == (long long int)dirStat.st_mtime)
+            {
+                entries[i] = (*itDir).second;
+                continue;
+            }
+
+            try {
+                scanDir(path, entries[i]);
+            }
+            catch (const std::runtime_error& /*e*/) {
+#pragma omp critical(DIR_Database__scanDirs)
+                error = path;
+                continue;
+            }
+
+            // A directory modified during this second may be modified again
+            // without changing its mtime: don't trust it next time
+            entries[i].mtime = (std::time(NULL) > dirStat.st_mtime + 1)
+                ? (long long int)dirStat.st_mtime : -1;
+            scanned[i] = true;
+        }
+
+        if (!error.empty())
+            throw std::runtime_error("Couldn't open database directory: "
+                                     + error);
+
+        std::vector<std::pair<std::string, int> > subDirs;
+
+        for (unsigned int i = 0; i < dirs.size(); ++i) {
+            if (scanned[i])
+                ++nbScanned;
+
+            mDirs[dirs[i].first] = entries[i];
+            visited.insert(dirs[i].first);
+
+            if (dirs[i].second == 0)
+                continue;
+
+            const DirEntry& entry = mDirs[dirs[i].first];
+
+            for (std::vector<std::string>::const_iterator it
+                 = entry.subDirs.begin(), itEnd = entry.subDirs.end();
+                 it != itEnd; ++it)
+            {
+                const std::string subDirPath = dirs[i].first + "/" + (*it);
+
+                if (!isMasked(subDirPath, false)) {
+                    subDirs.push_back(std::make_pair(subDirPath,
+                                                     dirs[i].second - 1));
+                }
+            }
+        }
+
+        dirs.swap(subDirs);
+    }
+
+    // Prune the entries of removed directories, which would otherwise stay
+    // in the manifest forever
+    unsigned int nbPruned = 0;
+
+    for (std::map<std::string, DirEntry>::iterator it = mDirs.begin();
+         it != mDirs.end(); )
+    {
+        struct stat dirStat;
+
+        if (visited.find((*it).first) == visited.end()
+            && stat((*it).first.c_str(), &dirStat) < 0)
+        {
+            mDirs.erase(it++);
+            ++nbPruned;
+        }
+        else
+            ++it;
+    }
+
+    if (mManifestLoaded) {
+        std::cout << "Rescanned " << nbScanned << " modified director"
+            << ((nbScanned != 1) ? "ies" : "y") << ", pruned " << nbPruned
+            << " removed director" << ((nbPruned != 1) ? "ies" : "y")
+            << std::endl;
+    }
+}
+
+void N2D2::DIR_Database::scanDir(const std::string& dirPath, DirEntry& entry)
+{
     DIR* pDir = opendir(dirPath.c_str());
 
     if (pDir == NULL)
@@ -69,71 +208,90 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
 
     struct dirent* pFile;
     struct stat fileStat;
-    std::vector<std::string> subDirs;
-    std::vector<std::string> files;
 
-    std::cout << "Loading directory database \"" << dirPath << "\""
-              << std::endl;
+    entry.files.clear();
+    entry.subDirs.clear();
 
     while ((pFile = readdir(pDir))) {
-        const std::string fileName(pFile->d_name);
-        const std::string filePath(dirPath + "/" + fileName);
-
-        // Ignore file in case of stat failure
-        if (stat(filePath.c_str(), &fileStat) < 0)
-            continue;
         // Exclude current and parent directories
         if (!strcmp(pFile->d_name, ".") || !strcmp(pFile->d_name, ".."))
             continue;
 
-        bool masked = false;
-
-        for (std::vector<std::string>::const_iterator it = mIgnoreMasks.begin(),
-             itEnd = mIgnoreMasks.end(); it != itEnd; ++it)
+        const std::string fileName(pFile->d_name);
+        bool isDir;
+
+#if defined(_DIRENT_HAVE_D_TYPE) && defined(DT_DIR)
+        // Avoid a stat() call per file when the file type is known
+        if (pFile->d_type == DT_DIR)
+            isDir = true;
+        else if (pFile->d_type == DT_REG)
+            isDir = false;
+        else
+#endif
         {
-            if (Utils::match((*it), filePath)) {
-                std::cout << Utils::cnotice << "Notice: path \"" << filePath
-                          << "\" ignored (matching mask: " << (*it) << ")."
-                          << Utils::cdef << std::endl;
-                masked = true;
-            }
+            // Ignore file in case of stat failure
+            if (stat((dirPath + "/" + fileName).c_str(), &fileStat) < 0)
+                continue;
+
+            isDir = S_ISDIR(fileStat.st_mode);
         }
 
-        if (masked)
-            continue;
+        if (isDir)
+            entry.subDirs.push_back(fileName);
+        else
+            entry.files.push_back(fileName);
+    }
 
-        if (S_ISDIR(fileStat.st_mode))
-            subDirs.push_back(filePath);
-        else {
-            // Exclude files with wrong extension
-            std::string fileExtension = Utils::fileExtension(fileName);
-            std::transform(fileExtension.begin(),
-                           fileExtension.end(),
-                           fileExtension.begin(),
-                           ::tolower);
-
-            if (mValidExtensions.empty() || std::find(mValidExtensions.begin(),
-                                                      mValidExtensions.end(),
-                                                      fileExtension)
-                                            != mValidExtensions.end()) {
-                if (!Registrar<DataFile>::exists(fileExtension)) {
-                    std::cout << Utils::cnotice << "Notice: file " << fileName
-                              << " does not appear to be a valid stimulus,"
-                                 " ignoring." << Utils::cdef << std::endl;
-                    continue;
-                }
+    closedir(pDir);
+
+    std::sort(entry.files.begin(), entry.files.end());
+    std::sort(entry.subDirs.begin(), entry.subDirs.end());
+}
 
-                files.push_back(filePath);
+void N2D2::DIR_Database::addDir(const std::string& dirPath,
+                                int depth,
+                                const std::string& labelName,
+                                int labelDepth)
+{
+    const DirEntry& entry = mDirs[dirPath];
+    std::vector<std::string> files;
+
+    std::cout << "Loading directory database \"" << dirPath << "\""
+              << std::endl;
+
+    for (std::vector<std::string>::const_iterator it = entry.files.begin(),
+         itEnd = entry.files.end(); it != itEnd; ++it)
+    {
+        const std::string& fileName = (*it);
+        const std::string filePath(dirPath + "/" + fileName);
+
+        if (isMasked(filePath))
+            continue;
+
+        // Exclude files with wrong extension
+        std::string fileExtension = Utils::fileExtension(fileName);
+        std::transform(fileExtension.begin(),
+                       fileExtension.end(),
+                       fileExtension.begin(),
+                       ::tolower);
+
+        if (mValidExtensions.empty() || std::find(mValidExtensions.begin(),
+                                                  mValidExtensions.end(),
+                                                  fileExtension)
+                                        != mValidExtensions.end()) {
+            if (!Registrar<DataFile>::exists(fileExtension)) {
+                std::cout << Utils::cnotice << "Notice: file " << fileName
+                          << " does not appear to be a valid stimulus,"
+                             " ignoring." << Utils::cdef << std::endl;
+                continue;
             }
+
+            files.push_back(filePath);
         }
     }
 
-    closedir(pDir);
-
     if (!files.empty()) {
         // Load stimuli contained in this directory
-        std::sort(files.begin(), files.end());
-
         const int dirLabelID = (labelDepth >= 0) ? labelID(labelName) : -1;
 
         for (std::vector<std::string>::const_iterator it = files.begin(),
@@ -147,25 +305,150 @@ void N2D2::DIR_Database::loadDir(const std::string& dirPath,
 
     if (depth != 0) {
         // Recursively load stimuli contained in the subdirectories
-        std::sort(subDirs.begin(), subDirs.end());
+        for (std::vector<std::string>::const_iterator it
+             = entry.subDirs.begin(), itEnd = entry.subDirs.end();
+             it != itEnd; ++it)
+        {
+            const std::string subDirPath = dirPath + "/" + (*it);
+
+            if (isMasked(subDirPath))
+                continue;
 
-        for (std::vector<std::string>::const_iterator it = subDirs.begin(),
-                                                      itEnd = subDirs.end();
-             it != itEnd;
-             ++it) {
             if (labelDepth > 0)
-                loadDir(*it,
-                        depth - 1,
-                        labelName + "/" + Utils::baseName(*it),
-                        labelDepth - 1);
+                addDir(subDirPath,
+                       depth - 1,
+                       labelName + "/" + (*it),
+                       labelDepth - 1);
             else
-                loadDir(*it, depth - 1, labelName, labelDepth);
+                addDir(subDirPath, depth - 1, labelName, labelDepth);
         }
     }
 
     std::cout << "Found " << mStimuli.size() << " stimuli" << std::endl;
 }
 
+bool N2D2::DIR_Database::isMasked(const std::string& filePath,
+                                  bool notice) const
+{
+    bool masked = false;
+
+    for (std::vector<std::string>::const_iterator it = mIgnoreMasks.begin(),
+         itEnd = mIgnoreMasks.end(); it != itEnd; ++it)
+    {
+        if (Utils::match((*it), filePath)) {
+            if (notice) {
+                std::cout << Utils::cnotice << "Notice: path \"" << filePath
+                          << "\" ignored (matching mask: " << (*it) << ")."
+                          << Utils::cdef << std::endl;
+            }
+
+            masked = true;
+        }
+    }
+
+    return masked;
+}
+
+/**
+ * Manifest format, one line per entry, with tab-separated fields:
+ * D <mtime> <directory path>
+ * F <file name>        (files of the previous directory)
+ * S <sub-directory name>   (sub-directories of the previous directory)
+*/
+void N2D2::DIR_Database::loadManifest(const std::string& fileName)
+{
+    std::ifstream manifest(fileName.c_str());
+
+    if (!manifest.good())
+        return;
+
+    std::map<std::string, DirEntry> dirs;
+    DirEntry* entry = NULL;
+    std::string line;
+
+    while (std::getline(manifest, line)) {
+        const size_t sep = line.find('\t');
+
+        if (sep == std::string::npos)
+            continue;
+
+        const std::string type = line.substr(0, sep);
+        const std::string value = line.substr(sep + 1);
+
+        if (type == "D") {
+            const size_t sepPath = value.find('\t');
+
+            if (sepPath == std::string::npos)
+                break;
+
+            entry = &dirs[value.substr(sepPath + 1)];
+            std::istringstream(value.substr(0, sepPath)) >> entry->mtime;
+        }
+        else if (entry != NULL && type == "F")
+            entry->files.push_back(value);
+        else if (entry != NULL && type == "S")
+            entry->subDirs.push_back(value);
+        else {
+            std::cout << Utils::cwarning << "Warning: invalid manifest file: "
+                      << fileName << ", ignoring." << Utils::cdef
+                      << std::endl;
+            return;
+        }
+    }
+
+    mDirs.swap(dirs);
+
+    std::cout << "Loaded manifest " << fileName << " (" << mDirs.size()
+              << " directories)" << std::endl;
+}
+
+void N2D2::DIR_Database::saveManifest(const std::string& fileName) const
+{
+    // Write to a temporary file first, so that an interrupted write does not
+    // leave an incomplete manifest
+    const std::string tmpFileName = fileName + ".tmp";
+    std::ofstream manifest(tmpFileName.c_str());
+
+    if (!manifest.good())
+        throw std::runtime_error("Could not create manifest file: "
+                                 + tmpFileName);
+
+    for (std::map<std::string, DirEntry>::const_iterator it = mDirs.begin(),
+         itEnd = mDirs.end(); it != itEnd; ++it)
+    {
+        manifest << "D\t" << (*it).second.mtime << "\t" << (*it).first
+            << "\n";
+
+        for (std::vector<std::string>::const_iterator itFile
+             = (*it).second.files.begin(),
+             itFileEnd = (*it).second.files.end();
+             itFile != itFileEnd; ++itFile)
+        {
+            manifest << "F\t" << (*itFile) << "\n";
+        }
+
+        for (std::vector<std::string>::const_iterator itDir
+             = (*it).second.subDirs.begin(),
+             itDirEnd = (*it).second.subDirs.end();
+             itDir != itDirEnd; ++itDir)
+        {
+            manifest << "S\t" << (*itDir) << "\n";
+        }
+    }
+
+    manifest.close();
+
+    if (!manifest.good())
+        throw std::runtime_error("Error while writing manifest file: "
+                                 + tmpFileName);
+
+    std::remove(fileName.c_str());
+
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+        throw std::runtime_error("Could not write manifest file: "
+                                 + fileName);
+}
+
 void N2D2::DIR_Database::loadFile(const std::string& fileName)
 {
     loadFile(fileName, -1);
@@ -246,15 +246,7 @@ void N2D2::Database::logStats(const std::string& sizeFileName,
             const StimulusID id = mStimuliSets(*itSet)[i];
 
             // Read stimuli
-            std::string fileExtension = Utils::fileExtension(mStimuli[id].name);
-            std::transform(fileExtension.begin(),
-                           fileExtension.end(),
-                           fileExtension.begin(),
-                           ::tolower);
-
-            std::shared_ptr<DataFile> dataFile = Registrar
-                <DataFile>::create(fileExtension)();
-            cv::Mat stimulus = dataFile->read(mStimuli[id].name);
+            cv::Mat stimulus = readStimulus(id);
 
             // Stats
             if (stimulus.cols > (int)maxWidth) {
@@ -600,6 +592,7 @@ void N2D2::Database::extractROIs()
                 mStimuli.push_back(Stimulus(mStimuli[id].name,
                                             (*it)->getLabel(),
                                             std::vector<ROI*>(1, *it)));
+                mStimuli.back().blob = mStimuli[id].blob;
                 mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
             }
 
@@ -1712,15 +1705,7 @@ cv::Mat N2D2::Database::loadStimulusData(StimulusID id)
     if (mStimuliDepth == -1) {
 #pragma omp critical(Database__loadStimulusData)
         if (mStimuliDepth == -1) {
-            std::string fileExtension = Utils::fileExtension(mStimuli[0].name);
-            std::transform(fileExtension.begin(),
-                           fileExtension.end(),
-                           fileExtension.begin(),
-                           ::tolower);
-
-            std::shared_ptr<DataFile> dataFile = Registrar
-                <DataFile>::create(fileExtension)();
-            mStimuliDepth = dataFile->read(mStimuli[0].name).depth();
+            mStimuliDepth = readStimulus(0).depth();
 
             std::cout << Utils::cnotice << "Notice: stimuli depth is "
                       << Utils::cvMatDepthToString(mStimuliDepth)
@@ -1729,15 +1714,7 @@ cv::Mat N2D2::Database::loadStimulusData(StimulusID id)
         }
     }
 
-    std::string fileExtension = Utils::fileExtension(mStimuli[id].name);
-    std::transform(fileExtension.begin(),
-                   fileExtension.end(),
-                   fileExtension.begin(),
-                   ::tolower);
-
-    std::shared_ptr<DataFile> dataFile = Registrar
-        <DataFile>::create(fileExtension)();
-    cv::Mat data = dataFile->read(mStimuli[id].name);
+    cv::Mat data = readStimulus(id);
 
     // Check stimulus depth
     if (data.depth() != mStimuliDepth) {
@@ -1788,6 +1765,58 @@ cv::Mat N2D2::Database::loadStimulusData(StimulusID id)
     return data;
 }
 
+cv::Mat N2D2::Database::readStimulus(StimulusID id) const
+{
+    if (mStimuli[id].blob.file)
+        return readStimulusBlob(mStimuli[id].blob);
+
+    std::string fileExtension = Utils::fileExtension(mStimuli[id].name);
+    std::transform(fileExtension.begin(),
+                   fileExtension.end(),
+                   fileExtension.begin(),
+                   ::tolower);
+
+    std::shared_ptr<DataFile> dataFile = Registrar
+        <DataFile>::create(fileExtension)();
+    return dataFile->read(mStimuli[id].name);
+}
+
+cv::Mat N2D2::Database::readStimulusBlob(const StimulusBlob& blob)
+{
+    const int planeType = CV_MAKETYPE(blob.depth, 1);
+    const size_t planeSize = blob.rows * blob.cols
+        * cv::Mat(1, 1, planeType).elemSize1();
+
+    if (blob.offset + blob.channels * planeSize > blob.file->size()) {
+        throw std::runtime_error("Database::readStimulusBlob(): stimulus out "
+                                 "of range in file: "
+                                 + blob.file->getFileName());
+    }
+
+    // The mapping is read-only and only lives as long as the database: the
+    // headers over it are never returned, the data is always copied (cloned
+    // or merged) in a matrix owning its own buffer
+    unsigned char* data
+        = const_cast<unsigned char*>(blob.file->data() + blob.offset);
+
+    if (!blob.planar || blob.channels == 1) {
+        return cv::Mat(blob.rows, blob.cols,
+                       CV_MAKETYPE(blob.depth, blob.channels), data).clone();
+    }
+
+    // Planar RGB to interleaved BGR
+    std::vector<cv::Mat> channels;
+
+    for (int c = blob.channels - 1; c >= 0; --c) {
+        channels.push_back(cv::Mat(blob.rows, blob.cols, planeType,
+                                   data + c * planeSize));
+    }
+
+    cv::Mat mat;
+    cv::merge(channels, mat);
+    return mat;
+}
+
 cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id) const
 {
     std::string fileExtension = Utils::fileExtension(mStimuli[id].name);
@@ -1798,21 +1827,20 @@ cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id) const
 
     cv::Mat labels;
 
-    if (mDataFileLabel && Registrar<DataFile>::exists(fileExtension)) {
+    if (mDataFileLabel && !mStimuli[id].blob.file
+        && Registrar<DataFile>::exists(fileExtension))
+    {
         std::shared_ptr<DataFile> dataFile = Registrar
             <DataFile>::create(fileExtension)();
         labels = dataFile->readLabel(mStimuli[id].name);
     }
 
     if (mStimuli[id].label == -1 || !labels.empty() || mForceCompositeLabel) {
-        std::shared_ptr<DataFile> dataFile = Registrar
-            <DataFile>::create(fileExtension)();
-
         const int defaultLabel = getDefaultLabelID();
 
         // Composite stimulus
         // Construct the labels matrix with the ROIs
-        cv::Mat stimulus = dataFile->read(mStimuli[id].name);
+        cv::Mat stimulus = readStimulus(id);
 
         if (labels.empty()) {
             // means mStimuli[id].label == -1
@@ -1991,8 +2019,8 @@ void init_Database(py::module &m) {
     .export_values();
 
     db.def(py::init<bool>(), py::arg("loadDataInMemory") = false)
-    .def("loadROIs", &Database::loadROIs, py::arg("fileName"), py::arg("relPath") = "", py::arg("noImageSize") = false)
-    .def("loadROIsDir", &Database::loadROIsDir, py::arg("dirName"), py::arg("fileExt") = "", py::arg("depth") = 0)
+    .def("loadROIs", &Database::loadROIs, py::arg("fileName"), py::arg("relPath") = "", py::arg("noImageSize") = false, py::call_guard<py::gil_scoped_release>())
+    .def("loadROIsDir", &Database::loadROIsDir, py::arg("dirName"), py::arg("fileExt") = "", py::arg("depth") = 0, py::call_guard<py::gil_scoped_release>())
     .def("saveROIs", &Database::saveROIs, py::arg("fileName"), py::arg("header") = "")
     .def("logStats", &Database::logStats, py::arg("sizeFileName"), py::arg("labelFileName"), py::arg("setMask") = Database::All)
     .def("logROIsStats", &Database::logROIsStats, py::arg("sizeFileName"), py::arg("labelFileName"), py::arg("setMask") = Database::All);
@@ -89,6 +89,25 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
         throw std::runtime_error(
             "The number of images and the number of labels does not match.");
 
+    if (!images.good())
+        throw std::runtime_error("Error while reading data file: " + dataPath);
+
+    const size_t headerSize = images.tellg();
+    images.close();
+
+    // The images file is memory-mapped and the stimuli are read directly
+    // from it, without being converted to individual image files
+    const std::shared_ptr<MemoryMappedFile> imagesData
+        = std::make_shared<MemoryMappedFile>(dataPath);
+    const size_t imageSize = nbRows * nbColumns;
+
+    if (imagesData->size() < headerSize + (size_t)nbImages * imageSize)
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + dataPath);
+    else if (imagesData->size() > headerSize + (size_t)nbImages * imageSize)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + dataPath);
+
     // For each image...
     for (unsigned int i = 0; i < nbImages; ++i) {
         unsigned char buff;
@@ -97,25 +116,6 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
         nameStr << dataPath << "[" << std::setfill('0') << std::setw(5) << i
                 << "].pgm";
 
-        // ... generate the stimuli
-        if (!std::ifstream(nameStr.str()).good()) {
-            cv::Mat frame(cv::Size(nbColumns, nbRows), CV_8UC1);
-
-            for (unsigned int y = 0; y < nbRows; ++y) {
-                for (unsigned int x = 0; x < nbColumns; ++x) {
-                    images.read(reinterpret_cast<char*>(&buff), sizeof(buff));
-                    frame.at<unsigned char>(y, x) = buff;
-                }
-            }
-
-            if (!cv::imwrite(nameStr.str(), frame))
-                throw std::runtime_error("Unable to write image: "
-                                         + nameStr.str());
-        } else {
-            // Skip image data (to grab labels only)
-            images.seekg(nbColumns * nbRows, images.cur);
-        }
-
         // ... attach the corresponding label
         labels.read(reinterpret_cast<char*>(&buff), sizeof(buff));
 
@@ -123,18 +123,19 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
         labelStr << (unsigned int)buff;
 
         mStimuli.push_back(Stimulus(nameStr.str(), labelID(labelStr.str())));
+
+        // ... reference the stimulus data
+        StimulusBlob& blob = mStimuli.back().blob;
+        blob.file = imagesData;
+        blob.offset = headerSize + (size_t)i * imageSize;
+        blob.rows = nbRows;
+        blob.cols = nbColumns;
+        blob.channels = 1;
+        blob.depth = CV_8U;
+
         mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
     }
 
-    if (images.eof())
-        throw std::runtime_error(
-            "End-of-file reached prematurely in data file: " + dataPath);
-    else if (!images.good())
-        throw std::runtime_error("Error while reading data file: " + dataPath);
-    else if (images.get() != std::fstream::traits_type::eof())
-        throw std::runtime_error("Data file size larger than expected: "
-                                 + dataPath);
-
     if (labels.eof())
         throw std::runtime_error(
             "End-of-file reached prematurely in data file: " + labelPath);
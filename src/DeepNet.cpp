@@ -34,9 +34,15 @@
 #include "Cell/DropoutCell.hpp"
 #include "Cell/FcCell.hpp"
 #include "Cell/SoftmaxCell.hpp"
+#include "utils/MemoryMappedFile.hpp"
 #include "utils/Utils.hpp"
 #include "Solver/Solver.hpp"
 
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <typeinfo>
+
 N2D2::DeepNet::DeepNet(Network& net)
     : mName(this, "Name", ""),
       mSignalsDiscretization(this, "SignalsDiscretization", 0U),
@@ -460,6 +466,392 @@ void N2D2::DeepNet::importNetworkFreeParameters(const std::string& dirName,
         << " was not found!" << std::endl;
 }
 
+namespace {
+// Binary checkpoint layout, all integers are uint64_t in native byte order:
+//   "N2D2CKPT" | version | number of tensors
+//   directory, for each tensor: name size | name ("cell/tensor") | data type
+//     | number of dims | dims | data offset | data size (in bytes)
+//   tensors data, each block aligned on checkpointAlignment bytes
+const char checkpointMagic[8] = {'N', '2', 'D', '2', 'C', 'K', 'P', 'T'};
+const uint64_t checkpointVersion = 1;
+const uint64_t checkpointAlignment = 64;
+
+enum CheckpointDataType {
+    CheckpointFloat16 = 0,
+    CheckpointFloat32 = 1,
+    CheckpointFloat64 = 2
+};
+
+struct CheckpointEntry {
+    std::string name;
+    uint64_t dataType;
+    std::vector<size_t> dims;
+    uint64_t offset;
+    uint64_t size;
+    N2D2::BaseTensor* tensor;
+    uint64_t tensorDataType;
+};
+
+uint64_t checkpointDataType(const N2D2::BaseTensor& tensor)
+{
+    if (tensor.getType() == &typeid(half_float::half))
+        return CheckpointFloat16;
+    else if (tensor.getType() == &typeid(float))
+        return CheckpointFloat32;
+    else if (tensor.getType() == &typeid(double))
+        return CheckpointFloat64;
+    else {
+        throw std::runtime_error("Checkpoint: tensor type not supported: "
+                                 + std::string(tensor.getType()->name()));
+    }
+}
+
+size_t checkpointDataTypeSize(uint64_t dataType)
+{
+    switch (dataType) {
+    case CheckpointFloat16:
+        return sizeof(half_float::half);
+    case CheckpointFloat32:
+        return sizeof(float);
+    case CheckpointFloat64:
+        return sizeof(double);
+    default:
+        throw std::runtime_error("Checkpoint: unknown data type");
+    }
+}
+
+template <class T>
+unsigned char* checkpointTensorData(N2D2::BaseTensor& tensor)
+{
+    N2D2::Tensor<T>& tensorT = dynamic_cast<N2D2::Tensor<T>&>(tensor);
+    return reinterpret_cast<unsigned char*>(&(*tensorT.begin()));
+}
+
+unsigned char* checkpointTensorData(N2D2::BaseTensor& tensor,
+                                    uint64_t dataType)
+{
+    switch (dataType) {
+    case CheckpointFloat16:
+        return checkpointTensorData<half_float::half>(tensor);
+    case CheckpointFloat32:
+        return checkpointTensorData<float>(tensor);
+    default:
+        return checkpointTensorData<double>(tensor);
+    }
+}
+
+template <class T>
+void checkpointConvert(const unsigned char* data,
+                       const std::vector<size_t>& dims,
+                       N2D2::BaseTensor& tensor)
+{
+    N2D2::Tensor<T> src(dims);
+    std::memcpy(&(*src.begin()), data, src.size() * sizeof(T));
+    tensor = src;
+}
+
+void checkpointWrite(std::ostream& os, uint64_t value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint64_t checkpointRead(const unsigned char* data,
+                        size_t dataSize,
+                        size_t& pos)
+{
+    if (pos + sizeof(uint64_t) > dataSize)
+        throw std::runtime_error("Checkpoint: truncated directory");
+
+    uint64_t value;
+    std::memcpy(&value, data + pos, sizeof(value));
+    pos += sizeof(value);
+    return value;
+}
+}
+
+void N2D2::DeepNet::saveNetworkCheckpoint(const std::string& fileName) const
+{
+    std::vector<CheckpointEntry> entries;
+
+    for (std::map<std::string, std::shared_ptr<Cell> >::const_iterator it
+         = mCells.begin(),
+         itEnd = mCells.end();
+         it != itEnd;
+         ++it)
+    {
+        const std::vector<std::pair<std::string, BaseTensor*> > tensors
+            = (*it).second->getFreeParametersTensors();
+
+        for (std::vector<std::pair<std::string, BaseTensor*> >
+             ::const_iterator itTensor = tensors.begin(),
+             itTensorEnd = tensors.end();
+             itTensor != itTensorEnd;
+             ++itTensor)
+        {
+            BaseTensor* tensor = (*itTensor).second;
+            tensor->synchronizeDToH();
+
+            CheckpointEntry entry;
+            entry.name = (*it).first + "/" + (*itTensor).first;
+            entry.dataType = checkpointDataType(*tensor);
+            entry.dims = tensor->dims();
+            entry.offset = 0;
+            entry.size = tensor->size()
+                * checkpointDataTypeSize(entry.dataType);
+            entry.tensor = tensor;
+            entry.tensorDataType = entry.dataType;
+            entries.push_back(entry);
+        }
+    }
+
+    // Directory size, to compute the data offsets
+    uint64_t offset = sizeof(checkpointMagic) + 2 * sizeof(uint64_t);
+
+    for (std::vector<CheckpointEntry>::const_iterator it = entries.begin(),
+         itEnd = entries.end(); it != itEnd; ++it)
+    {
+        offset += (5 + (*it).dims.size()) * sizeof(uint64_t)
+            + (*it).name.size();
+    }
+
+    for (std::vector<CheckpointEntry>::iterator it = entries.begin(),
+         itEnd = entries.end(); it != itEnd; ++it)
+    {
+        offset = ((offset + checkpointAlignment - 1) / checkpointAlignment)
+            * checkpointAlignment;
+        (*it).offset = offset;
+        offset += (*it).size;
+    }
+
+    const uint64_t fileSize = offset;
+
+    {
+        std::ofstream ckpt(fileName.c_str(), std::fstream::binary);
+
+        if (!ckpt.good())
+            throw std::runtime_error("Could not create checkpoint file: "
+                                     + fileName);
+
+        ckpt.write(checkpointMagic, sizeof(checkpointMagic));
+        checkpointWrite(ckpt, checkpointVersion);
+        checkpointWrite(ckpt, entries.size());
+
+        for (std::vector<CheckpointEntry>::const_iterator it
+             = entries.begin(), itEnd = entries.end(); it != itEnd; ++it)
+        {
+            checkpointWrite(ckpt, (*it).name.size());
+            ckpt.write((*it).name.data(), (*it).name.size());
+            checkpointWrite(ckpt, (*it).dataType);
+            checkpointWrite(ckpt, (*it).dims.size());
+
+            for (std::vector<size_t>::const_iterator itDims
+                 = (*it).dims.begin(), itDimsEnd = (*it).dims.end();
+                 itDims != itDimsEnd; ++itDims)
+            {
+                checkpointWrite(ckpt, (*itDims));
+            }
+
+            checkpointWrite(ckpt, (*it).offset);
+            checkpointWrite(ckpt, (*it).size);
+        }
+
+        // Reserve the whole file, so that blocks can be written in parallel
+        if (fileSize > (uint64_t)ckpt.tellp()) {
+            ckpt.seekp(fileSize - 1);
+            ckpt.put(0);
+        }
+
+        if (!ckpt.good())
+            throw std::runtime_error("Error writing checkpoint file: "
+                                     + fileName);
+    }
+
+    int nbErrors = 0;
+
+#pragma omp parallel reduction(+:nbErrors) if (entries.size() > 1)
+    {
+        std::fstream ckpt(fileName.c_str(),
+                          std::fstream::in | std::fstream::out
+                            | std::fstream::binary);
+
+        if (!ckpt.good())
+            ++nbErrors;
+
+#pragma omp for schedule(dynamic)
+        for (int i = 0; i < (int)entries.size(); ++i) {
+            if (entries[i].size == 0 || !ckpt.good())
+                continue;
+
+            ckpt.seekp(entries[i].offset);
+            ckpt.write(reinterpret_cast<const char*>(checkpointTensorData(
+                            *entries[i].tensor, entries[i].dataType)),
+                       entries[i].size);
+
+            if (!ckpt.good())
+                ++nbErrors;
+        }
+    }
+
+    if (nbErrors > 0)
+        throw std::runtime_error("Error writing checkpoint file: " + fileName);
+}
+
+void N2D2::DeepNet::loadNetworkCheckpoint(const std::string& fileName,
+                                          bool ignoreNotExists)
+{
+    std::cout << "Loading checkpoint '" << fileName << "'." << std::endl;
+
+    const MemoryMappedFile ckpt(fileName);
+    const unsigned char* data = ckpt.data();
+    const size_t dataSize = ckpt.size();
+
+    if (dataSize < sizeof(checkpointMagic)
+        || std::memcmp(data, checkpointMagic, sizeof(checkpointMagic)) != 0)
+    {
+        throw std::runtime_error("Not a N2D2 checkpoint file: " + fileName);
+    }
+
+    size_t pos = sizeof(checkpointMagic);
+    const uint64_t version = checkpointRead(data, dataSize, pos);
+
+    if (version != checkpointVersion) {
+        std::stringstream msgStr;
+        msgStr << "Unsupported checkpoint version " << version << " in file: "
+            << fileName;
+        throw std::runtime_error(msgStr.str());
+    }
+
+    const uint64_t nbEntries = checkpointRead(data, dataSize, pos);
+    std::map<std::string, CheckpointEntry> directory;
+
+    for (uint64_t i = 0; i < nbEntries; ++i) {
+        CheckpointEntry entry;
+        const uint64_t nameSize = checkpointRead(data, dataSize, pos);
+
+        if (nameSize > dataSize - pos)
+            throw std::runtime_error("Checkpoint: truncated directory");
+
+        entry.name.assign(reinterpret_cast<const char*>(data + pos),
+                          nameSize);
+        pos += nameSize;
+
+        entry.dataType = checkpointRead(data, dataSize, pos);
+        entry.dims.resize(checkpointRead(data, dataSize, pos));
+
+        for (std::vector<size_t>::iterator it = entry.dims.begin(),
+             itEnd = entry.dims.end(); it != itEnd; ++it)
+        {
+            (*it) = checkpointRead(data, dataSize, pos);
+        }
+
+        entry.offset = checkpointRead(data, dataSize, pos);
+        entry.size = checkpointRead(data, dataSize, pos);
+        entry.tensor = NULL;
+        entry.tensorDataType = entry.dataType;
+
+        const size_t nbElements = (entry.dims.empty()) ? 0
+            : std::accumulate(entry.dims.begin(), entry.dims.end(),
+                              (size_t)1, std::multiplies<size_t>());
+
+        if (entry.size != nbElements * checkpointDataTypeSize(entry.dataType)
+            || entry.offset > dataSize || entry.size > dataSize - entry.offset)
+        {
+            throw std::runtime_error("Checkpoint: invalid data block for "
+                                     "tensor " + entry.name + " in file: "
+                                     + fileName);
+        }
+
+        directory[entry.name] = entry;
+    }
+
+    // Match the cells free parameters with the directory (serial, as tensors
+    // may be resized)
+    std::vector<CheckpointEntry> entries;
+
+    for (std::map<std::string, std::shared_ptr<Cell> >::const_iterator it
+         = mCells.begin(),
+         itEnd = mCells.end();
+         it != itEnd;
+         ++it)
+    {
+        const std::vector<std::pair<std::string, BaseTensor*> > tensors
+            = (*it).second->getFreeParametersTensors();
+
+        for (std::vector<std::pair<std::string, BaseTensor*> >
+             ::const_iterator itTensor = tensors.begin(),
+             itTensorEnd = tensors.end();
+             itTensor != itTensorEnd;
+             ++itTensor)
+        {
+            const std::string name = (*it).first + "/" + (*itTensor).first;
+            const std::map<std::string, CheckpointEntry>::const_iterator
+                itEntry = directory.find(name);
+
+            if (itEntry == directory.end()) {
+                if (ignoreNotExists) {
+                    std::cout << Utils::cnotice << "Notice: tensor " << name
+                              << " not found in checkpoint file: "
+                              << fileName << Utils::cdef << std::endl;
+                    continue;
+                } else {
+                    throw std::runtime_error("Tensor " + name + " not found"
+                                             " in checkpoint file: "
+                                             + fileName);
+                }
+            }
+
+            BaseTensor* tensor = (*itTensor).second;
+
+            if (tensor->dims() != (*itEntry).second.dims) {
+                if (tensor->empty())
+                    tensor->resize((*itEntry).second.dims);
+                else {
+                    std::stringstream msgStr;
+                    msgStr << "Tensor " << name << " dims mismatch in"
+                        " checkpoint file: " << fileName << " (expected "
+                        << tensor->dims() << ", got "
+                        << (*itEntry).second.dims << ")";
+                    throw std::runtime_error(msgStr.str());
+                }
+            }
+
+            entries.push_back((*itEntry).second);
+            entries.back().tensor = tensor;
+            entries.back().tensorDataType = checkpointDataType(*tensor);
+        }
+    }
+
+    // Tensors data is a straight copy from the mapped file (or a conversion
+    // when the cell data type differs)
+#pragma omp parallel for schedule(dynamic) if (entries.size() > 1)
+    for (int i = 0; i < (int)entries.size(); ++i) {
+        const CheckpointEntry& entry = entries[i];
+
+        if (entry.size == 0)
+            continue;
+
+        const unsigned char* src = data + entry.offset;
+
+        if (entry.tensorDataType == entry.dataType) {
+            std::memcpy(checkpointTensorData(*entry.tensor, entry.dataType),
+                        src, entry.size);
+        }
+        else if (entry.dataType == CheckpointFloat16)
+            checkpointConvert<half_float::half>(src, entry.dims,
+                                                *entry.tensor);
+        else if (entry.dataType == CheckpointFloat32)
+            checkpointConvert<float>(src, entry.dims, *entry.tensor);
+        else
+            checkpointConvert<double>(src, entry.dims, *entry.tensor);
+    }
+
+    for (std::vector<CheckpointEntry>::const_iterator it = entries.begin(),
+         itEnd = entries.end(); it != itEnd; ++it)
+    {
+        (*it).tensor->synchronizeHToD();
+    }
+}
+
 std::shared_ptr<N2D2::Monitor> N2D2::DeepNet::getMonitor(const std::string
                                                          & name) const
 {
@@ -2232,7 +2624,7 @@ void init_DeepNet(py::module &m) {
     .def("addTarget", &DeepNet::addTarget, py::arg("cell"))
     .def("addMonitor", &DeepNet::addMonitor, py::arg("name"), py::arg("monitor"))
     .def("addCMonitor", &DeepNet::addCMonitor, py::arg("name"), py::arg("monitor"))
-    .def("update", &DeepNet::update, py::arg("log"), py::arg("start"), py::arg("stop") = 0, py::arg("update") = true)
+    .def("update", &DeepNet::update, py::arg("log"), py::arg("start"), py::arg("stop") = 0, py::arg("update") = true, py::call_guard<py::gil_scoped_release>())
     .def("save", &DeepNet::save, py::arg("dirName"))
     .def("load", &DeepNet::load, py::arg("dirName"))
     .def("saveNetworkParameters", &DeepNet::saveNetworkParameters)
@@ -2242,12 +2634,14 @@ void init_DeepNet(py::module &m) {
     .def("importNetworkFreeParameters", (void (DeepNet::*)(const std::string&, bool)) &DeepNet::importNetworkFreeParameters, py::arg("dirName"), py::arg("ignoreNotExists") = false)
     .def("importNetworkFreeParameters", (void (DeepNet::*)(const std::string&, const std::string&)) &DeepNet::importNetworkFreeParameters, py::arg("dirName"), py::arg("weightName"))
     //.def("importNetworkSolverParameters", &DeepNet::importNetworkSolverParameters, py::arg("dirName"))
-    .def("checkGradient", &DeepNet::checkGradient, py::arg("epsilon") = 1.0e-4, py::arg("maxError") = 1.0e-6)
+    .def("saveNetworkCheckpoint", &DeepNet::saveNetworkCheckpoint, py::arg("fileName"), py::call_guard<py::gil_scoped_release>())
+    .def("loadNetworkCheckpoint", &DeepNet::loadNetworkCheckpoint, py::arg("fileName"), py::arg("ignoreNotExists") = false, py::call_guard<py::gil_scoped_release>())
+    .def("checkGradient", &DeepNet::checkGradient, py::arg("epsilon") = 1.0e-4, py::arg("maxError") = 1.0e-6, py::call_guard<py::gil_scoped_release>())
     .def("initialize", &DeepNet::initialize)
-    .def("learn", &DeepNet::learn, py::arg("timings") = NULL)
-    .def("test", &DeepNet::test, py::arg("set"), py::arg("timings") = NULL)
-    .def("cTicks", &DeepNet::cTicks, py::arg("start"), py::arg("stop"), py::arg("timestep"), py::arg("record") = false)
-    .def("cTargetsProcess", &DeepNet::cTargetsProcess, py::arg("set"))
+    .def("learn", &DeepNet::learn, py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("test", &DeepNet::test, py::arg("set"), py::arg("timings") = NULL, py::call_guard<py::gil_scoped_release>())
+    .def("cTicks", &DeepNet::cTicks, py::arg("start"), py::arg("stop"), py::arg("timestep"), py::arg("record") = false, py::call_guard<py::gil_scoped_release>())
+    .def("cTargetsProcess", &DeepNet::cTargetsProcess, py::arg("set"), py::call_guard<py::gil_scoped_release>())
     .def("cReset", &DeepNet::cReset, py::arg("timestamp") = 0)
     .def("initializeCMonitors", &DeepNet::initializeCMonitors, py::arg("nbTimesteps"))
     .def("spikeCodingCompare", &DeepNet::spikeCodingCompare, py::arg("dirName"), py::arg("idx"))
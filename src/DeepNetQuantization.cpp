@@ -294,6 +294,14 @@ void N2D2::DeepNetQuantization::normalizeOutputsRange(const std::unordered_map<s
     double prevScalingFactor = 1.0;
     bool nextIsMaxPool = false;
 
+    // Calibrate all the layers at once, in parallel
+    std::unordered_map<std::string, double> outputsThreshold;
+    if(actClippingMode != ClippingMode::NONE) {
+        outputsThreshold = Histogram::calibrateOutputsHistogram(outputsHistogram,
+                                                                nbBits,
+                                                                actClippingMode);
+    }
+
     const std::vector<std::vector<std::string>>& layers = mDeepNet.getLayers();
     for (auto itLayer = layers.begin() + 1; itLayer != layers.end(); ++itLayer) {
         if(itLayer->size() != 1) {
@@ -330,13 +338,13 @@ void N2D2::DeepNetQuantization::normalizeOutputsRange(const std::unordered_map<s
         {
             const std::string cellStats = nextIsMaxPool?(itLayer + 1)->front():itLayer->front();
             scalingFactor = getCellThreshold(cellStats, 
-                                             outputsHistogram, outputsRange, 
-                                             nbBits, actClippingMode);
+                                             outputsThreshold, outputsRange, 
+                                             actClippingMode);
         }
         else {
             scalingFactor = getCellThreshold(itLayer->front(),
-                                             outputsHistogram, outputsRange, 
-                                             nbBits, ClippingMode::NONE);
+                                             outputsThreshold, outputsRange, 
+                                             ClippingMode::NONE);
         }
 
 
@@ -462,15 +470,14 @@ std::vector<std::vector<unsigned char>> N2D2::DeepNetQuantization::approximateRe
 }
 
 double N2D2::DeepNetQuantization::getCellThreshold(const std::string& cellName,
-                                       const std::unordered_map<std::string, Histogram>& outputsHistogram,
+                                       const std::unordered_map<std::string, double>& outputsThreshold,
                                        const std::unordered_map<std::string, RangeStats>& outputsRange,
-                                       std::size_t nbBits, ClippingMode actClippingMode) 
+                                       ClippingMode actClippingMode) 
 {
     switch(actClippingMode) {
         case ClippingMode::KL_DIVERGENCE:
-            return outputsHistogram.at(cellName).calibrateKLDivergence(nbBits);
         case ClippingMode::MSE:
-            return outputsHistogram.at(cellName).calibrateMSE(nbBits);
+            return outputsThreshold.at(cellName);
         default: {
             const auto& range = outputsRange.at(cellName);
             return Utils::max_abs(range.minVal(), range.maxVal());
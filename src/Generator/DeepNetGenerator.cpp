@@ -2127,7 +2127,7 @@ void N2D2::DeepNetGenerator::ONNX_processGraph(std::shared_ptr<DeepNet> deepNet,
                 = std::shared_ptr<Activation>();
 
             std::shared_ptr<ElemWiseCell> elemWiseCell
-                = Registrar<ElemWiseCell>::create(model)(deepNet->getNetwork(),
+                = Registrar<ElemWiseCell>::create<Float_T>(model)(deepNet->getNetwork(),
                                                             *deepNet, 
                                                             node.output(0),
                                                             inputDataCell->getNbOutputs(),
@@ -2239,7 +2239,7 @@ namespace py = pybind11;
 namespace N2D2 {
 void init_DeepNetGenerator(py::module &m) {
     py::class_<DeepNetGenerator>(m, "DeepNetGenerator")
-    .def_static("generate", &DeepNetGenerator::generate, py::arg("network"), py::arg("fileName"));
+    .def_static("generate", &DeepNetGenerator::generate, py::arg("network"), py::arg("fileName"), py::call_guard<py::gil_scoped_release>());
 }
 }
 #endif
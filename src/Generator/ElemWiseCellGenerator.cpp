@@ -60,14 +60,31 @@ N2D2::ElemWiseCellGenerator::generate(Network& network, const DeepNet& deepNet,
             iniConfig, section, model, dataType, "ActivationFunction");
 
     // Cell construction
-    std::shared_ptr<ElemWiseCell> cell = Registrar
-        <ElemWiseCell>::create(model)(network, deepNet,
-                                  section,
-                                  nbOutputs,
-                                  operation,
-                                  weights,
-                                  shifts,
-                                  activation);
+    std::shared_ptr<ElemWiseCell> cell
+        = (dataType == Float32)
+            ? Registrar<ElemWiseCell>::create<float>(model)(network, deepNet,
+                                                            section,
+                                                            nbOutputs,
+                                                            operation,
+                                                            weights,
+                                                            shifts,
+                                                            activation)
+          : (dataType == Float16)
+            ? Registrar<ElemWiseCell>::create<half_float::half>(model)(network,
+                                                            deepNet,
+                                                            section,
+                                                            nbOutputs,
+                                                            operation,
+                                                            weights,
+                                                            shifts,
+                                                            activation)
+            : Registrar<ElemWiseCell>::create<double>(model)(network, deepNet,
+                                                            section,
+                                                            nbOutputs,
+                                                            operation,
+                                                            weights,
+                                                            shifts,
+                                                            activation);
 
     if (!cell) {
         throw std::runtime_error(
@@ -103,6 +103,16 @@ N2D2::StimuliProviderGenerator::generateSubSections(const std::shared_ptr
         if (Utils::match(section + ".StimuliData*", *it)) {
             std::shared_ptr<StimuliData> stimuliData
                 = StimuliDataGenerator::generate(*sp, iniConfig, *it);
+        } else if (Utils::match(section + ".BatchAugmentation*", *it)) {
+            const Database::StimuliSetMask applyTo
+                = iniConfig.getProperty
+                  <Database::StimuliSetMask>("ApplyTo", Database::LearnOnly);
+
+            std::shared_ptr<BatchAugmentation> augmentation
+                = std::make_shared<BatchAugmentation>();
+            augmentation->setParameters(iniConfig.getSection(*it, true));
+
+            sp->addBatchAugmentation(augmentation, applyTo);
         } else if (Utils::match(section + ".*Transformation*", *it)) {
             const Database::StimuliSetMask applyTo
                 = iniConfig.getProperty
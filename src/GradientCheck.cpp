@@ -18,6 +18,8 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <set>
 
@@ -26,6 +28,22 @@
 #include "third_party/half.hpp"
 #include "utils/Random.hpp"
 
+double N2D2::GradientCheckBase::mErrorRate = 0.0;
+double N2D2::GradientCheckBase::mConfidence = 0.99;
+
+size_t N2D2::GradientCheckBase::getNbSamples(size_t size)
+{
+    if (mErrorRate <= 0.0 || mErrorRate >= 1.0)
+        return size;
+
+    // Probability that none of n samples hits a wrong gradient:
+    // (1 - errorRate)^n <= 1 - confidence
+    const double nbSamples = std::ceil(std::log(1.0 - mConfidence)
+                                       / std::log(1.0 - mErrorRate));
+
+    return std::min(size, (size_t)std::max(1.0, nbSamples));
+}
+
 template <class T>
 N2D2::GradientCheck<T>::GradientCheck(double epsilon, double maxError)
     : mEpsilon(epsilon), mMaxError(maxError)
@@ -106,92 +124,251 @@ template <class T>
 template <class U>
 void N2D2::GradientCheck<T>::check(const std::string& tensorName,
                                    Tensor<U>& tensor,
-                                   Tensor<U>& diffTensor)
+                                   Tensor<U>& diffTensor,
+                                   bool cellInput)
 {
+    tensor.synchronizeDToH();
+    diffTensor.synchronizeDToH();
+
+    // Elements to check
+    const size_t size = tensor.size();
+    const size_t nbSamples = getNbSamples(size);
+    std::vector<size_t> indexes(size);
+
+    for (size_t index = 0; index < size; ++index)
+        indexes[index] = index;
+
+    if (nbSamples < size) {
+        for (size_t i = 0; i < nbSamples; ++i) {
+            const size_t j = Random::randUniform((int)i, (int)size - 1);
+            std::swap(indexes[i], indexes[j]);
+        }
+
+        indexes.resize(nbSamples);
+        std::sort(indexes.begin(), indexes.end());
+    }
+
+    unsigned int nbPropagates = 0;
+
+    // Perturbation rounds: one element of each batch sample per forward pass
+    // for the inputs of a batch independent cell, one element per forward
+    // pass otherwise
+    const bool batchIndependent = (cellInput
+                                && isBatchIndependent(tensor, nbPropagates));
+    const size_t batchSize = (batchIndependent) ? tensor.dimB() : 1;
+    const size_t batchStride = size / batchSize;
+    std::vector<std::vector<size_t> > batchIndexes(batchSize);
+
+    for (std::vector<size_t>::const_iterator it = indexes.begin(),
+        itEnd = indexes.end(); it != itEnd; ++it)
+    {
+        batchIndexes[(*it) / batchStride].push_back(*it);
+    }
+
     double cumulativeError = 0.0;
+    double cumulativeRelError = 0.0;
+    double maxRelError = 0.0;
     unsigned int nbGradients = 0;
 
-    tensor.synchronizeDToH();
-    diffTensor.synchronizeDToH();
+    std::vector<size_t> round;
+    std::vector<U> values;
+    std::vector<double> costsPlus;
+    std::vector<double> costsMinus;
+
+    for (size_t r = 0; ; ++r) {
+        round.clear();
+
+        for (size_t batchPos = 0; batchPos < batchSize; ++batchPos) {
+            if (r < batchIndexes[batchPos].size())
+                round.push_back(batchIndexes[batchPos][r]);
+        }
+
+        if (round.empty())
+            break;
+
+        values.resize(round.size());
+
+        for (size_t i = 0; i < round.size(); ++i)
+            values[i] = tensor(round[i]);
+
+        // Compute approx. gradient
+        for (size_t i = 0; i < round.size(); ++i) {
+            tensor(round[i]) = values[i] + mEpsilon / 2.0;
+            tensor.synchronizeHToD(round[i], 1);
+        }
+
+        mPropagate(false);
+        costs(costsPlus);
+
+        for (size_t i = 0; i < round.size(); ++i) {
+            tensor(round[i]) = values[i] - mEpsilon / 2.0;
+            tensor.synchronizeHToD(round[i], 1);
+        }
+
+        mPropagate(false);
+        costs(costsMinus);
+        nbPropagates += 2;
+
+        for (size_t i = 0; i < round.size(); ++i) {
+            const size_t index = round[i];
+
+            tensor(index) = values[i];
+            tensor.synchronizeHToD(index, 1);
+
+            double approxGradient = 0.0;
 
-    for (unsigned int b = 0; b < tensor.dimB(); ++b) {
-        for (unsigned int z = 0; z < tensor.dimZ(); ++z) {
-            for (unsigned int y = 0; y < tensor.dimY(); ++y) {
-                for (unsigned int x = 0; x < tensor.dimX(); ++x) {
-                    const U value = tensor(x, y, z, b);
-
-                    // Compute approx. gradient
-                    tensor(x, y, z, b) = value + mEpsilon / 2.0;
-                    tensor.synchronizeHToD(x, y, z, b, 1);
-                    mPropagate(false);
-
-                    double approxGradient = cost();
-
-                    tensor(x, y, z, b) = value - mEpsilon / 2.0;
-                    tensor.synchronizeHToD(x, y, z, b, 1);
-                    mPropagate(false);
-
-                    approxGradient = (approxGradient - cost()) / mEpsilon;
-
-                    // Computed gradient
-                    tensor(x, y, z, b) = value;
-                    tensor.synchronizeHToD(x, y, z, b, 1);
-
-                    const U gradient = -diffTensor(x, y, z, b);
-                    const double error = std::fabs(gradient - approxGradient);
-
-                    cumulativeError += error;
-                    ++nbGradients;
-
-                    if (error >= mMaxError || std::isnan(error)) {
-                        std::cout << "Gradient check error for \"" << tensorName
-                                  << "\""
-                                  << " @ (" << x << ", " << y << ", " << z
-                                  << ", " << b << ")\n"
-                                  << std::setprecision(std::numeric_limits
-                                                       <double>::digits10 + 1)
-                                  << "  Computed = " << gradient
-                                  << "\n"
-                                     "  Approximated = " << approxGradient
-                                  << "\n"
-                                     "  Error = " << error
-                                  << " > max. error = " << mMaxError
-                                  << std::endl;
-
-                        throw std::runtime_error("Gradient check failed!");
-                    }
+            if (batchIndependent) {
+                const size_t batchPos = index / batchStride;
+                approxGradient = (costsPlus[batchPos] - costsMinus[batchPos])
+                    / mEpsilon;
+            }
+            else {
+                for (size_t batchPos = 0; batchPos < costsPlus.size();
+                    ++batchPos)
+                {
+                    approxGradient += costsPlus[batchPos]
+                                        - costsMinus[batchPos];
                 }
+
+                approxGradient /= mEpsilon;
+            }
+
+            // Computed gradient
+            const U gradient = -diffTensor(index);
+            const double error = std::fabs(gradient - approxGradient);
+            const double scale = std::max(std::fabs((double)gradient),
+                                          std::fabs(approxGradient));
+            const double relError = (scale > 0.0) ? error / scale : 0.0;
+
+            cumulativeError += error;
+            cumulativeRelError += relError;
+            maxRelError = std::max(maxRelError, relError);
+            ++nbGradients;
+
+            if (error >= mMaxError || std::isnan(error)) {
+                std::cout << "Gradient check error for \"" << tensorName
+                          << "\" @ (";
+
+                for (size_t dim = 0, coord = index; dim < tensor.nbDims();
+                    ++dim)
+                {
+                    std::cout << ((dim > 0) ? ", " : "")
+                              << (coord % tensor.dims()[dim]);
+                    coord /= tensor.dims()[dim];
+                }
+
+                std::cout << ")\n"
+                          << std::setprecision(std::numeric_limits
+                                               <double>::digits10 + 1)
+                          << "  Computed = " << gradient
+                          << "\n"
+                             "  Approximated = " << approxGradient
+                          << "\n"
+                             "  Error = " << error
+                          << " > max. error = " << mMaxError
+                          << std::endl;
+
+                throw std::runtime_error("Gradient check failed!");
             }
         }
     }
 
+    const double norm = (nbGradients == 0) ? 1.0 : nbGradients;
+
     std::cout << "Gradient check for \"" << tensorName
-              << "\" PASSED! (avg error = "
-              << (cumulativeError / ((nbGradients == 0) ? 1.0 : nbGradients))
-              << ")" << std::endl;
+              << "\" PASSED! (avg error = " << (cumulativeError / norm)
+              << ", max/avg rel. error = " << maxRelError << "/"
+              << (cumulativeRelError / norm) << ", " << nbGradients << "/"
+              << size << " gradients in " << nbPropagates << " propagations)"
+              << std::endl;
+}
+
+template <class T>
+template <class U>
+bool N2D2::GradientCheck<T>::isBatchIndependent(Tensor<U>& tensor,
+                                                unsigned int& nbPropagates)
+{
+    const unsigned int batchSize = mOutputs->dimB();
+
+    if (tensor.nbDims() < 2 || tensor.dimB() != batchSize || batchSize < 2)
+        return false;
+
+    mPropagate(false);
+    mOutputs->synchronizeDToH();
+    ++nbPropagates;
+
+    const Tensor<T> outputs(mOutputs->dims(), mOutputs->begin(),
+                            mOutputs->end());
+    const size_t outputsStride = outputs.size() / batchSize;
+
+    // Perturb elements of the first batch sample until one changes its
+    // outputs: the cell is batch independent if the outputs of the other
+    // samples are unchanged
+    const unsigned int maxTries = 16;
+
+    for (size_t index = 0,
+        stride = tensor.size() / batchSize; index < stride; ++index)
+    {
+        if (index >= maxTries)
+            break;
+
+        const U value = tensor(index);
+        tensor(index) = value + mEpsilon;
+        tensor.synchronizeHToD(index, 1);
+
+        mPropagate(false);
+        mOutputs->synchronizeDToH();
+        ++nbPropagates;
+
+        tensor(index) = value;
+        tensor.synchronizeHToD(index, 1);
+
+        bool changed = false;
+
+        for (size_t o = 0; o < outputsStride; ++o) {
+            if ((*mOutputs)(o) != outputs(o)) {
+                changed = true;
+                break;
+            }
+        }
+
+        for (size_t o = outputsStride; o < outputs.size(); ++o) {
+            if ((*mOutputs)(o) != outputs(o))
+                return false;
+        }
+
+        if (changed)
+            return true;
+    }
+
+    return false;
 }
 
 template <class T>
 void N2D2::GradientCheck<T>::check(const std::string& tensorName,
                                    BaseTensor& tensor,
-                                   BaseTensor& diffTensor)
+                                   BaseTensor& diffTensor,
+                                   bool cellInput)
 {
     assert(tensor.getType() == diffTensor.getType());
 
     if (tensor.getType() == &typeid(float)) {
         check(tensorName,
               dynamic_cast<Tensor<float>&>(tensor),
-              dynamic_cast<Tensor<float>&>(diffTensor));
+              dynamic_cast<Tensor<float>&>(diffTensor),
+              cellInput);
     }
     else if (tensor.getType() == &typeid(half_float::half)) {
         check(tensorName,
               dynamic_cast<Tensor<half_float::half>&>(tensor),
-              dynamic_cast<Tensor<half_float::half>&>(diffTensor));
+              dynamic_cast<Tensor<half_float::half>&>(diffTensor),
+              cellInput);
     }
     else if (tensor.getType() == &typeid(double)) {
         check(tensorName,
               dynamic_cast<Tensor<double>&>(tensor),
-              dynamic_cast<Tensor<double>&>(diffTensor));
+              dynamic_cast<Tensor<double>&>(diffTensor),
+              cellInput);
     }
     else
         throw std::runtime_error("GradientCheck::check(): type not supported");
@@ -204,20 +381,28 @@ N2D2::GradientCheck<T>::~GradientCheck()
 }
 
 template <class T>
-double N2D2::GradientCheck<T>::cost() const
+void N2D2::GradientCheck<T>::costs(std::vector<double>& batchCosts) const
 {
     mOutputs->synchronizeDToH();
-    const int outputSize = mOutputs->size();
 
-    double cost = 0.0;
+    const int batchSize = mOutputs->dimB();
+    const int outputsStride = mOutputs->size() / batchSize;
 
-#pragma omp parallel for reduction(+ : cost)
-    for (int index = 0; index < outputSize; ++index) {
-        const double error = 1.0 - (*mOutputs)(index);
-        cost += error * error;
-    }
+    batchCosts.resize(batchSize);
 
-    return (1.0 / 2.0) * cost;
+#pragma omp parallel for if (batchSize > 1 && outputsStride > 32)
+    for (int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        double cost = 0.0;
+
+        for (int index = batchPos * outputsStride,
+            indexEnd = index + outputsStride; index < indexEnd; ++index)
+        {
+            const double error = 1.0 - (*mOutputs)(index);
+            cost += error * error;
+        }
+
+        batchCosts[batchPos] = (1.0 / 2.0) * cost;
+    }
 }
 
 namespace N2D2 {
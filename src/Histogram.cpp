@@ -23,6 +23,37 @@
 #include "utils/Utils.hpp"
 #include "utils/Gnuplot.hpp"
 
+namespace {
+// End of the run of bins starting at @p begin that share the same key, for a
+// key that is monotonic with the bin index (galloping search, in
+// O(log(run length)))
+template <class KEY>
+std::size_t runEnd(std::size_t begin, std::size_t end, const KEY& key)
+{
+    const auto value = key(begin);
+    std::size_t last = begin;
+    std::size_t step = 1;
+
+    while (last + step < end && key(last + step) == value) {
+        last += step;
+        step *= 2;
+    }
+
+    std::size_t first = std::min(last + step, end);
+
+    while (first - last > 1) {
+        const std::size_t mid = last + (first - last) / 2;
+
+        if (key(mid) == value)
+            last = mid;
+        else
+            first = mid;
+    }
+
+    return first;
+}
+}
+
 
 N2D2::Histogram::Histogram(double minVal, double maxVal, std::size_t nbBins)
     : mMinVal(minVal), mMaxVal(maxVal),
@@ -58,10 +89,16 @@ std::size_t N2D2::Histogram::getNbBins() const {
 
 std::size_t N2D2::Histogram::getBinIdx(double value) const {
     assert(getBinWidth() > 0);
-    
-    const double clampedValue = Utils::clamp(value, mMinVal, mMaxVal);
-    std::size_t binIdx = static_cast<std::size_t>((clampedValue - mMinVal) / getBinWidth() + 1e-6);
-    if(binIdx == mNbBins) {
+    return binIdx(value, mMinVal, mMaxVal, mNbBins);
+}
+
+std::size_t N2D2::Histogram::binIdx(double value, double minVal, double maxVal,
+                                    std::size_t nbBins)
+{
+    const double binWidth = (maxVal - minVal) / nbBins;
+    const double clampedValue = Utils::clamp(value, minVal, maxVal);
+    std::size_t binIdx = static_cast<std::size_t>((clampedValue - minVal) / binWidth + 1e-6);
+    if(binIdx == nbBins) {
         binIdx--;
     }
 
@@ -171,26 +208,7 @@ void N2D2::Histogram::log(const std::string& fileName,
 }
 
 double N2D2::Histogram::calibrateMSE(std::size_t nbBits) const {
-    if(mNbValues == 0) {
-        return 0.0;
-    }
-
-    double threshold = Utils::max_abs(mMinVal, mMaxVal);
-    double bestThreshold = threshold;
-    double bestMSE = std::numeric_limits<double>::max();
-
-    const double threshold_decr_step = threshold/1000.0;
-    while(threshold > 0.0) {
-        const double mse = MSE(threshold, nbBits);
-        if(mse < bestMSE) {
-            bestMSE = mse;
-            bestThreshold = threshold;
-        }
-        
-        threshold -= threshold_decr_step;
-    }
-
-    return bestThreshold;
+    return calibrate(nbBits, ClippingMode::MSE);
 }
 
 double N2D2::Histogram::MSE(double threshold, std::size_t nbBits) const {
@@ -216,27 +234,262 @@ double N2D2::Histogram::MSE(double threshold, std::size_t nbBits) const {
 
 
 double N2D2::Histogram::calibrateKLDivergence(std::size_t nbBits) const {
+    return calibrate(nbBits, ClippingMode::KL_DIVERGENCE);
+}
+
+std::unordered_map<std::string, double>
+N2D2::Histogram::calibrateOutputsHistogram(
+                const std::unordered_map<std::string, Histogram>& outputsHistogram,
+                std::size_t nbBits, ClippingMode clippingMode)
+{
+    if(clippingMode == ClippingMode::NONE) {
+        throw std::runtime_error("Unsupported clipping mode.");
+    }
+
+    std::vector<const std::string*> names;
+    std::vector<const Histogram*> histograms;
+
+    for (auto it = outputsHistogram.begin(); it != outputsHistogram.end(); ++it) {
+        names.push_back(&(*it).first);
+        histograms.push_back(&(*it).second);
+    }
+
+    const int nbHistograms = (int)histograms.size();
+    std::vector<Calibration> calibrations(nbHistograms);
+
+#pragma omp parallel for if (nbHistograms > 1)
+    for (int h = 0; h < nbHistograms; ++h) {
+        if (histograms[h]->mNbValues > 0)
+            calibrations[h] = histograms[h]->prepareCalibration(clippingMode);
+    }
+
+    // Flatten the (histogram, threshold) pairs in a single loop, for a good
+    // load balancing whatever the number of histograms
+    std::vector<std::pair<int, int> > candidates;
+
+    for (int h = 0; h < nbHistograms; ++h) {
+        for (int i = 0; i < (int)calibrations[h].thresholds.size(); ++i)
+            candidates.push_back(std::make_pair(h, i));
+    }
+
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int c = 0; c < (int)candidates.size(); ++c) {
+        Calibration& calibration = calibrations[candidates[c].first];
+        const int i = candidates[c].second;
+
+        calibration.criterion[i] = histograms[candidates[c].first]
+            ->calibrationCriterion(calibration, calibration.thresholds[i],
+                                   nbBits, clippingMode);
+    }
+
+    std::vector<double> thresholds(nbHistograms, 0.0);
+
+#pragma omp parallel for schedule(dynamic) if (nbHistograms > 1)
+    for (int h = 0; h < nbHistograms; ++h) {
+        if (histograms[h]->mNbValues > 0) {
+            thresholds[h] = histograms[h]->selectThreshold(calibrations[h],
+                                                           nbBits,
+                                                           clippingMode);
+        }
+    }
+
+    std::unordered_map<std::string, double> outputsThreshold;
+
+    for (int h = 0; h < nbHistograms; ++h)
+        outputsThreshold[*names[h]] = thresholds[h];
+
+    return outputsThreshold;
+}
+
+double N2D2::Histogram::calibrate(std::size_t nbBits,
+                                  ClippingMode clippingMode) const
+{
+    if(clippingMode == ClippingMode::NONE) {
+        throw std::runtime_error("Unsupported clipping mode.");
+    }
+
     if(mNbValues == 0) {
         return 0.0;
     }
 
-    const bool isUnsigned = mMinVal >= 0.0;
-    const std::size_t nbQuantizedBins = 1 << nbBits;
+    Calibration calibration = prepareCalibration(clippingMode);
+    const int nbThresholds = (int)calibration.thresholds.size();
+
+#pragma omp parallel for if (nbThresholds * mNbBins > 65536)
+    for (int i = 0; i < nbThresholds; ++i) {
+        calibration.criterion[i] = calibrationCriterion(calibration,
+                                                        calibration.thresholds[i],
+                                                        nbBits, clippingMode);
+    }
+
+    return selectThreshold(calibration, nbBits, clippingMode);
+}
+
+N2D2::Histogram::Calibration
+N2D2::Histogram::prepareCalibration(ClippingMode clippingMode) const
+{
+    assert(mNbValues > 0);
+
+    Calibration calibration;
 
-    double threshold = Utils::max_abs(mMinVal, mMaxVal);
-    double bestThreshold = threshold;
-    double bestDivergence = std::numeric_limits<double>::max();;
+    // Same candidates as the original serial search
+    const double maxThreshold = Utils::max_abs(mMinVal, mMaxVal);
+    double threshold = maxThreshold;
 
     const double threshold_decr_step = threshold/1000.0;
     while(threshold > 0.0) {
-        const double divergence = KLDivergence(*this, quantize(isUnsigned?0:-threshold, 
-                                                               threshold, nbQuantizedBins));
-        if(divergence < bestDivergence) {
-            bestDivergence = divergence;
-            bestThreshold = threshold;
+        calibration.thresholds.push_back(threshold);
+        threshold -= threshold_decr_step;
+    }
+
+    calibration.criterion.resize(calibration.thresholds.size(),
+                                 std::numeric_limits<double>::max());
+
+    calibration.cumCounts.resize(mNbBins + 1, 0);
+    calibration.pLogP = 0.0;
+
+    if(clippingMode == ClippingMode::MSE) {
+        calibration.cumMoment1.resize(mNbBins + 1, 0.0);
+        calibration.cumMoment2.resize(mNbBins + 1, 0.0);
+    }
+
+    for(std::size_t bin = 0; bin < mNbBins; bin++) {
+        calibration.cumCounts[bin + 1] = calibration.cumCounts[bin]
+                                            + mValues[bin];
+
+        if(clippingMode == ClippingMode::MSE) {
+            const double value = getBinValue(bin);
+
+            calibration.cumMoment1[bin + 1] = calibration.cumMoment1[bin]
+                                                + mValues[bin] * value;
+            calibration.cumMoment2[bin + 1] = calibration.cumMoment2[bin]
+                                                + mValues[bin] * value * value;
         }
+        else if(mValues[bin] > 0) {
+            const double p = (mValues[bin] / (double)mNbValues);
+            calibration.pLogP += p * std::log(p);
+        }
+    }
 
-        threshold -= threshold_decr_step;
+    // The error of the approximation comes from the cancellation between
+    // large cumulative terms, the bounds below are orders of magnitude
+    // above it while still discriminating the candidates
+    if(clippingMode == ClippingMode::MSE) {
+        calibration.tolerance = 1.0e-9 * 9.0 * maxThreshold * maxThreshold;
+    }
+    else {
+        calibration.tolerance = 1.0e-9 * (1.0 + std::fabs(calibration.pLogP)
+            + 2.0 * std::log((double)mNbValues * mNbBins));
+    }
+
+    return calibration;
+}
+
+double N2D2::Histogram::calibrationCriterion(const Calibration& calibration,
+                                             double threshold,
+                                             std::size_t nbBits,
+                                             ClippingMode clippingMode) const
+{
+    const bool isUnsigned = mMinVal >= 0.0;
+    const std::vector<std::size_t>& cumCounts = calibration.cumCounts;
+
+    if(clippingMode == ClippingMode::MSE) {
+        assert(nbBits > 1);
+
+        const double minVal = isUnsigned?0:-(1 << (nbBits - 1));
+        const double maxVal = isUnsigned?((1 << nbBits) - 1):((1 << (nbBits - 1)) - 1);
+        const double scaling = maxVal/threshold;
+
+        // Quantized level of each bin, as in MSE()
+        const auto level = [&](std::size_t bin) {
+            return Utils::clamp(std::round(getBinValue(bin)*scaling), minVal, maxVal);
+        };
+
+        // Sum of count*(value - approx)^2 over each run of bins with the
+        // same quantized value
+        double mse = 0.0;
+        for(std::size_t bin = 0; bin < mNbBins; ) {
+            const std::size_t end = runEnd(bin, mNbBins, level);
+            const double approx = level(bin)/scaling;
+
+            const double s0 = (double)(cumCounts[end] - cumCounts[bin]);
+            const double s1 = calibration.cumMoment1[end]
+                                - calibration.cumMoment1[bin];
+            const double s2 = calibration.cumMoment2[end]
+                                - calibration.cumMoment2[bin];
+
+            mse += s2 - 2.0 * approx * s1 + approx * approx * s0;
+            bin = end;
+        }
+
+        return mse / mNbValues;
+    }
+    else {
+        const double minVal = isUnsigned?0:-threshold;
+        const std::size_t nbQuantizedBins = 1 << nbBits;
+
+        // Quantized histogram bin of each bin, as in quantize()
+        const auto quantIdx = [&](std::size_t bin) {
+            return binIdx(getBinValue(bin), minVal, threshold, nbQuantizedBins);
+        };
+
+        // Each quantized bin gathers a run of bins. With Q its count and n
+        // the number of bins in the run, KLDivergence() is:
+        // sum(p*log(p)) - sum(Q*(log(Q) - log(qNorm)))/N, qNorm = sum(n*Q)
+        double qNorm = 0.0;
+        double qLogQ = 0.0;
+        for(std::size_t bin = 0; bin < mNbBins; ) {
+            const std::size_t end = runEnd(bin, mNbBins, quantIdx);
+            const std::size_t count = cumCounts[end] - cumCounts[bin];
+
+            if(count > 0) {
+                qNorm += (double)(end - bin) * count;
+                qLogQ += count * std::log((double)count);
+            }
+
+            bin = end;
+        }
+
+        return calibration.pLogP
+            - (qLogQ - mNbValues * std::log(qNorm)) / mNbValues;
+    }
+}
+
+double N2D2::Histogram::selectThreshold(const Calibration& calibration,
+                                        std::size_t nbBits,
+                                        ClippingMode clippingMode) const
+{
+    const bool isUnsigned = mMinVal >= 0.0;
+    const std::size_t nbQuantizedBins = 1 << nbBits;
+
+    double minCriterion = std::numeric_limits<double>::max();
+    for(std::size_t i = 0; i < calibration.criterion.size(); i++) {
+        if(calibration.criterion[i] < minCriterion) {
+            minCriterion = calibration.criterion[i];
+        }
+    }
+
+    // Same selection as the original serial search (first strictly better
+    // threshold in decreasing order), restricted to the candidates that can
+    // be the minimum given the approximation error
+    double bestThreshold = calibration.thresholds.front();
+    double bestCriterion = std::numeric_limits<double>::max();
+
+    for(std::size_t i = 0; i < calibration.thresholds.size(); i++) {
+        if(!(calibration.criterion[i] <= minCriterion + calibration.tolerance)) {
+            continue;
+        }
+
+        const double threshold = calibration.thresholds[i];
+        const double criterion = (clippingMode == ClippingMode::MSE)
+            ? MSE(threshold, nbBits)
+            : KLDivergence(*this, quantize(isUnsigned?0:-threshold,
+                                           threshold, nbQuantizedBins));
+
+        if(criterion < bestCriterion) {
+            bestCriterion = criterion;
+            bestThreshold = threshold;
+        }
     }
 
     return bestThreshold;
@@ -378,15 +631,21 @@ void N2D2::Histogram::logOutputsHistogram(const std::string& dirName,
 {
     Utils::createDirectories(dirName);
 
+    std::unordered_map<std::string, double> outputsThreshold;
+
+    if(clippingMode != ClippingMode::NONE) {
+        outputsThreshold = calibrateOutputsHistogram(outputsHistogram,
+                                                     nbBits, clippingMode);
+    }
+
+    const std::string thresholdName
+        = (clippingMode == ClippingMode::KL_DIVERGENCE) ? "KL" : "MSE";
+
     for (auto it = outputsHistogram.begin(); it != outputsHistogram.end(); ++it) {
         std::unordered_map<std::string, double> thresholds;
 
-        Histogram hist = (*it).second;
-        if(clippingMode == ClippingMode::KL_DIVERGENCE) {
-            thresholds["KL"] = hist.calibrateKLDivergence(nbBits);
-        }
-        else if(clippingMode == ClippingMode::MSE) {
-            thresholds["MSE"] = hist.calibrateMSE(nbBits);
+        if(clippingMode != ClippingMode::NONE) {
+            thresholds[thresholdName] = outputsThreshold.at((*it).first);
         }
 
         (*it).second.log(dirName + "/" + (*it).first + ".dat", thresholds);
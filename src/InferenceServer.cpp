@@ -0,0 +1,507 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "InferenceServer.hpp"
+#include "DeepNet.hpp"
+#include "StimuliProvider.hpp"
+#include "Target/Target.hpp"
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <stdint.h>
+
+N2D2::InferenceServer::InferenceServer(const std::shared_ptr<DeepNet>& deepNet,
+                                       double maxLatency,
+                                       unsigned int targetIndex,
+                                       size_t maxRequestSize)
+    : mDeepNet(deepNet),
+      mTarget(deepNet->getTarget(targetIndex)),
+      mBatchSize(deepNet->getStimuliProvider()->getBatchSize()),
+      mMaxLatency(std::chrono::duration_cast<Clock_T::duration>(
+          std::chrono::duration<double>(maxLatency))),
+      mMaxRequestSize(maxRequestSize),
+      mStop(false),
+      mListenFd(-1),
+      mFirstRequest(true)
+{
+    // ctor
+    mWorker = std::thread(&InferenceServer::run, this);
+}
+
+std::future<N2D2::InferenceServer::Result>
+N2D2::InferenceServer::submit(const cv::Mat& mat)
+{
+    Request request;
+    request.mat = mat;
+    request.arrival = Clock_T::now();
+
+    std::future<Result> result = request.result.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mStop)
+            throw std::runtime_error("InferenceServer::submit(): server is "
+                                     "stopped");
+
+        if (mFirstRequest) {
+            mStartTime = request.arrival;
+            mFirstRequest = false;
+        }
+
+        mQueue.push_back(std::move(request));
+    }
+
+    mCondition.notify_all();
+    return result;
+}
+
+void N2D2::InferenceServer::run()
+{
+    std::vector<Request> batch;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() {
+                return (mStop || !mQueue.empty());
+            });
+
+            if (mQueue.empty())
+                break;  // mStop
+
+            // Wait for the batch to fill up, but no longer than the maximum
+            // latency of the oldest request
+            const Clock_T::time_point deadline = mQueue.front().arrival
+                                                    + mMaxLatency;
+            mCondition.wait_until(lock, deadline, [this]() {
+                return (mStop || mQueue.size() >= mBatchSize);
+            });
+
+            const unsigned int nbRequests
+                = std::min<size_t>(mBatchSize, mQueue.size());
+
+            batch.clear();
+
+            for (unsigned int i = 0; i < nbRequests; ++i) {
+                batch.push_back(std::move(mQueue.front()));
+                mQueue.pop_front();
+            }
+        }
+
+        processBatch(batch);
+    }
+}
+
+void N2D2::InferenceServer::processBatch(std::vector<Request>& batch)
+{
+    const Clock_T::time_point startTime = Clock_T::now();
+    std::shared_ptr<StimuliProvider> sp = mDeepNet->getStimuliProvider();
+    std::vector<std::exception_ptr> errors(batch.size());
+
+    // Same as StimuliProvider::readBatch(): batch positions are independent
+#pragma omp parallel for if (batch.size() > 1)
+    for (int batchPos = 0; batchPos < (int)batch.size(); ++batchPos) {
+        try {
+            sp->streamStimulus(batch[batchPos].mat, Database::Test, batchPos);
+        }
+        catch (...) {
+            errors[batchPos] = std::current_exception();
+        }
+    }
+
+    try {
+        mDeepNet->test(Database::Test);
+
+        const Target::TensorLabels_T& estimatedLabels
+            = mTarget->getEstimatedLabels();
+        const Target::TensorLabelsValue_T& estimatedLabelsValue
+            = mTarget->getEstimatedLabelsValue();
+
+        for (unsigned int batchPos = 0; batchPos < batch.size(); ++batchPos) {
+            if (errors[batchPos]) {
+                batch[batchPos].result.set_exception(errors[batchPos]);
+                continue;
+            }
+
+            const Tensor<int> labels = estimatedLabels[batchPos];
+            const Tensor<Float_T> values = estimatedLabelsValue[batchPos];
+
+            // Deep copy, as the target tensors are overwritten by the next
+            // batch
+            Result result;
+            result.estimatedLabels.resize(labels.dims());
+            result.estimatedLabels = labels;
+            result.estimatedLabelsValue.resize(values.dims());
+            result.estimatedLabelsValue = values;
+            batch[batchPos].result.set_value(result);
+        }
+    }
+    catch (...) {
+        for (unsigned int batchPos = 0; batchPos < batch.size(); ++batchPos) {
+            if (!errors[batchPos])
+                batch[batchPos].result.set_exception(std::current_exception());
+        }
+    }
+
+    const Clock_T::time_point endTime = Clock_T::now();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mMetrics.nbBatches;
+    mMetrics.nbRequests += batch.size();
+    mMetrics.batchTime += std::chrono::duration_cast
+        <std::chrono::duration<double> >(endTime - startTime).count();
+    mMetrics.elapsed = std::chrono::duration_cast
+        <std::chrono::duration<double> >(endTime - mStartTime).count();
+
+    for (std::vector<Request>::const_iterator it = batch.begin(),
+         itEnd = batch.end(); it != itEnd; ++it)
+    {
+        const double queueLatency = std::chrono::duration_cast
+            <std::chrono::duration<double> >(startTime - (*it).arrival)
+                .count();
+
+        mMetrics.queueLatency += queueLatency;
+        mMetrics.maxQueueLatency = std::max(mMetrics.maxQueueLatency,
+                                            queueLatency);
+    }
+}
+
+N2D2::InferenceServer::Metrics N2D2::InferenceServer::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    // mMetrics holds the sums
+    Metrics metrics(mMetrics);
+
+    if (metrics.nbRequests > 0)
+        metrics.queueLatency /= metrics.nbRequests;
+
+    if (metrics.nbBatches > 0)
+        metrics.batchTime /= metrics.nbBatches;
+
+    return metrics;
+}
+
+void N2D2::InferenceServer::resetMetrics()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMetrics = Metrics();
+    mFirstRequest = true;
+}
+
+void N2D2::InferenceServer::logMetrics(std::ostream& os) const
+{
+    const Metrics metrics = getMetrics();
+
+    os << "Requests: " << metrics.nbRequests
+        << " | batches: " << metrics.nbBatches
+        << " | avg. batch size: " << std::fixed << std::setprecision(2)
+        << metrics.batchSize() << "/" << mBatchSize
+        << " | avg. queue latency: " << 1.0e3 * metrics.queueLatency << " ms"
+        << " (max " << 1.0e3 * metrics.maxQueueLatency << " ms)"
+        << " | avg. batch time: " << 1.0e3 * metrics.batchTime << " ms"
+        << " | throughput: " << metrics.throughput() << " req/s"
+        << std::endl;
+}
+
+#ifndef WIN32
+namespace {
+bool readAll(int fd, void* data, size_t size)
+{
+    char* ptr = static_cast<char*>(data);
+
+    while (size > 0) {
+        const ssize_t nbBytes = ::read(fd, ptr, size);
+
+        if (nbBytes <= 0)
+            return false;
+
+        ptr += nbBytes;
+        size -= nbBytes;
+    }
+
+    return true;
+}
+
+bool writeAll(int fd, const void* data, size_t size)
+{
+    const char* ptr = static_cast<const char*>(data);
+
+    while (size > 0) {
+        const ssize_t nbBytes = ::send(fd, ptr, size, MSG_NOSIGNAL);
+
+        if (nbBytes <= 0)
+            return false;
+
+        ptr += nbBytes;
+        size -= nbBytes;
+    }
+
+    return true;
+}
+}
+#endif
+
+void N2D2::InferenceServer::listen(const std::string& socketPath)
+{
+#ifndef WIN32
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("InferenceServer::listen(): socket path too "
+                                 "long: " + socketPath);
+    }
+
+    std::strcpy(addr.sun_path, socketPath.c_str());
+    ::unlink(socketPath.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0
+        || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+        || ::listen(fd, SOMAXCONN) < 0)
+    {
+        if (fd >= 0)
+            ::close(fd);
+
+        throw std::runtime_error("InferenceServer::listen(): could not listen"
+                                 " on socket: " + socketPath + " ("
+                                 + std::strerror(errno) + ")");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mStop) {
+            ::close(fd);
+            return;
+        }
+
+        mListenFd = fd;
+    }
+
+    while (true) {
+        const int clientFd = ::accept(fd, NULL, NULL);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mStop) {
+            if (clientFd >= 0)
+                ::close(clientFd);
+
+            break;
+        }
+
+        if (clientFd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+
+            mListenFd = -1;
+            ::close(fd);
+            throw std::runtime_error("InferenceServer::listen(): accept() "
+                                     "failed on socket: " + socketPath);
+        }
+
+        // Join the threads of the clients that disconnected
+        for (std::vector<std::thread>::iterator it = mClients.begin();
+             it != mClients.end(); )
+        {
+            if (mFinishedClients.erase((*it).get_id()) > 0) {
+                // The thread returns right after releasing mMutex
+                (*it).join();
+                it = mClients.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        mClientFds.insert(clientFd);
+        mClients.push_back(std::thread(&InferenceServer::serveClient, this,
+                                       clientFd));
+    }
+
+    ::unlink(socketPath.c_str());
+#else
+    throw std::runtime_error("InferenceServer::listen(): Unix domain sockets"
+                             " are not supported on this platform ("
+                             + socketPath + ")");
+#endif
+}
+
+void N2D2::InferenceServer::serveClient(int fd)
+{
+#ifndef WIN32
+    std::vector<unsigned char> buffer;
+    uint32_t size;
+
+    while (readAll(fd, &size, sizeof(size))) {
+        if (size > mMaxRequestSize) {
+            // The payload is read in chunks and discarded, so that the
+            // connection stays usable
+            char discard[4096];
+            bool discarded = true;
+
+            for (uint32_t remaining = size; remaining > 0 && discarded; ) {
+                const uint32_t chunk = std::min(remaining,
+                                                (uint32_t)sizeof(discard));
+                discarded = readAll(fd, discard, chunk);
+                remaining -= chunk;
+            }
+
+            if (!discarded)
+                break;
+
+            std::ostringstream errorStr;
+            errorStr << "request size (" << size << " bytes) exceeds the "
+                "maximum request size (" << mMaxRequestSize << " bytes)";
+
+            const std::string error = errorStr.str();
+            const int32_t status = -1;
+            size = error.size();
+
+            if (!writeAll(fd, &status, sizeof(status))
+                || !writeAll(fd, &size, sizeof(size))
+                || !writeAll(fd, error.data(), error.size()))
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        buffer.resize(size);
+
+        if (size > 0 && !readAll(fd, &buffer[0], size))
+            break;
+
+        int32_t status = 0;
+        std::vector<char> response;
+
+        try {
+            const cv::Mat encoded(1, (int)buffer.size(), CV_8UC1,
+                                  (buffer.empty()) ? NULL : &buffer[0]);
+            const cv::Mat mat = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+
+            if (mat.empty())
+                throw std::runtime_error("could not decode image");
+
+            const Result result = process(mat);
+            const uint32_t nbValues = result.estimatedLabels.size();
+
+            response.resize(nbValues * (sizeof(int32_t) + sizeof(float)));
+            char* ptr = (response.empty()) ? NULL : &response[0];
+
+            for (unsigned int i = 0; i < nbValues; ++i) {
+                const int32_t label = result.estimatedLabels(i);
+                const float value = result.estimatedLabelsValue(i);
+
+                std::memcpy(ptr, &label, sizeof(label));
+                ptr += sizeof(label);
+                std::memcpy(ptr, &value, sizeof(value));
+                ptr += sizeof(value);
+            }
+
+            size = nbValues;
+        }
+        catch (const std::exception& e) {
+            status = -1;
+            response.assign(e.what(), e.what() + std::strlen(e.what()));
+            size = response.size();
+        }
+
+        if (!writeAll(fd, &status, sizeof(status))
+            || !writeAll(fd, &size, sizeof(size))
+            || (!response.empty()
+                && !writeAll(fd, &response[0], response.size())))
+        {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mClientFds.erase(fd) > 0)
+        ::close(fd);
+
+    mFinishedClients.insert(std::this_thread::get_id());
+#endif
+}
+
+void N2D2::InferenceServer::stop()
+{
+    std::vector<std::thread> clients;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        if (mStop)
+            return;
+
+        mStop = true;
+
+#ifndef WIN32
+        // Unblock accept() and the clients read()
+        if (mListenFd >= 0) {
+            ::shutdown(mListenFd, SHUT_RDWR);
+            ::close(mListenFd);
+            mListenFd = -1;
+        }
+
+        for (std::set<int>::const_iterator it = mClientFds.begin(),
+             itEnd = mClientFds.end(); it != itEnd; ++it)
+        {
+            ::shutdown((*it), SHUT_RDWR);
+        }
+#endif
+
+        clients.swap(mClients);
+        mFinishedClients.clear();
+    }
+
+    // Pending requests are still processed
+    mCondition.notify_all();
+
+    for (std::vector<std::thread>::iterator it = clients.begin(),
+         itEnd = clients.end(); it != itEnd; ++it)
+    {
+        (*it).join();
+    }
+
+    if (mWorker.joinable())
+        mWorker.join();
+}
+
+N2D2::InferenceServer::~InferenceServer()
+{
+    stop();
+}
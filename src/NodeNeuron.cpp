@@ -28,6 +28,8 @@ N2D2::NodeNeuron::NodeNeuron(Network& net)
     : Node(net),
       // Internal variables
       mInitializedState(false),
+      mLinkIdOffset(0),
+      mLinksCompiled(false),
       mStateLogPlot(false),
       mCacheValid(false)
 {
@@ -61,6 +63,62 @@ void N2D2::NodeNeuron::addLink(Node* origin)
     // Add the connexion
     mLinks.insert(std::make_pair(origin, newSynapse()));
     origin->addBranch(this);
+
+    if (mLinksCompiled)
+        compileLinks();
+}
+
+void N2D2::NodeNeuron::compileLinks()
+{
+    std::vector<std::pair<NodeId_T, Node*> > nodes;
+    nodes.reserve(mLinks.size());
+
+    for (std::unordered_map<Node*, Synapse*>::const_iterator it
+         = mLinks.begin(),
+         itEnd = mLinks.end();
+         it != itEnd;
+         ++it)
+        nodes.push_back(std::make_pair((*it).first->getId(), (*it).first));
+
+    std::sort(nodes.begin(), nodes.end());
+
+    mLinkNodes.clear();
+    mLinkSynapses.clear();
+    mLinkIndex.clear();
+    mLinkPositions.clear();
+    mLinkIdOffset = 0;
+
+    mLinkNodes.reserve(nodes.size());
+    mLinkSynapses.reserve(nodes.size());
+
+    for (std::vector<std::pair<NodeId_T, Node*> >::const_iterator it
+         = nodes.begin(),
+         itEnd = nodes.end();
+         it != itEnd;
+         ++it) {
+        mLinkNodes.push_back((*it).second);
+        mLinkSynapses.push_back(mLinks[(*it).second]);
+    }
+
+    if (!nodes.empty()) {
+        // Direct lookup table only if it does not waste too much memory,
+        // which is the case for inputs coming from a few Xcell or Environment
+        // (IDs are allocated sequentially at node creation)
+        const size_t range = nodes.back().first - nodes.front().first + 1;
+
+        if (range <= 4 * nodes.size() + 64) {
+            mLinkIdOffset = nodes.front().first;
+            mLinkIndex.assign(range, -1);
+
+            for (unsigned int i = 0; i < nodes.size(); ++i)
+                mLinkIndex[nodes[i].first - mLinkIdOffset] = i;
+        } else {
+            for (unsigned int i = 0; i < nodes.size(); ++i)
+                mLinkPositions[nodes[i].second] = i;
+        }
+    }
+
+    mLinksCompiled = true;
 }
 
 void N2D2::NodeNeuron::addLateralBranch(NodeNeuron* lateralBranch)
@@ -77,9 +135,10 @@ void N2D2::NodeNeuron::notify(Time_T timestamp, NotifyType notify)
 {
     Node::notify(timestamp, notify);
 
-    if (notify == Initialize)
+    if (notify == Initialize) {
+        compileLinks();
         initialize();
-    else if (notify == Finalize) {
+    } else if (notify == Finalize) {
         finalize();
 
         if (mStateLog.is_open() && mStateLogPlot) {
@@ -52,6 +52,7 @@ N2D2::NodeNeuron_Behavioral::NodeNeuron_Behavioral(Network& net)
       mWeightBias(this, "WeightBias", 0.0),
       mStdpLtd(this, "StdpLtd", 0 * TimeS),
       mBiologicalStdp(this, "BiologicalStdp", false),
+      mTraceStdp(this, "TraceStdp", false),
       // Internal variables
       mIntegration(0.0),
       mAllowFire(true),
@@ -60,7 +61,10 @@ N2D2::NodeNeuron_Behavioral::NodeNeuron_Behavioral(Network& net)
       mLastSpikeTime(0),
       mEvent(NULL),
       mRefractoryEnd(0),
-      mLastStdp(0)
+      mLastStdp(0),
+      mTraceStdpCnt(0),
+      mTraceFifoSize(0),
+      mTraceFifoCnt(0)
 {
     // ctor
 }
@@ -81,8 +85,36 @@ void N2D2::NodeNeuron_Behavioral::propagateSpike(Node* origin,
                                                  Time_T timestamp,
                                                  EventType_T type)
 {
-    const Time_T delay = static_cast
-                         <Synapse_Behavioral*>(mLinks[origin])->delay;
+    Synapse* synapse;
+
+    if (mTraceStdp) {
+        if (mTraceStdpDone.size() != mLinkSynapses.size())
+            initializeTrace();
+
+        const unsigned int pos = getLinkPosition(origin);
+        synapse = mLinkSynapses[pos];
+
+        if (mOrderStdp == 0) {
+            if (mBiologicalStdp) {
+                // Only the first pre-synaptic spike since the last STDP is
+                // needed to know that the synapse is active
+                if (mTracePreTime[pos] <= mLastStdp)
+                    mTraceActive.push_back(std::make_pair(timestamp, pos));
+            } else {
+                mTraceActive.push_back(std::make_pair(timestamp, pos));
+
+                // Spikes out of the LTP window for any future post-synaptic
+                // spike can be discarded
+                while (mTraceActive.front().first + mStdpLtp < timestamp)
+                    mTraceActive.pop_front();
+            }
+        }
+
+        mTracePreTime[pos] = timestamp;
+    } else
+        synapse = getLink(origin);
+
+    const Time_T delay = static_cast<Synapse_Behavioral*>(synapse)->delay;
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -94,12 +126,29 @@ void N2D2::NodeNeuron_Behavioral::incomingSpike(Node* origin,
                                                 Time_T timestamp,
                                                 EventType_T /*type*/)
 {
-    Synapse_Behavioral* synapse = static_cast
-        <Synapse_Behavioral*>(mLinks[origin]);
-    ++synapse->statsReadEvents;
+    Synapse_Behavioral* synapse;
+
+    if (mTraceStdp) {
+        if (mTraceStdpDone.size() != mLinkSynapses.size())
+            initializeTrace();
+
+        const unsigned int pos = getLinkPosition(origin);
+
+        // Apply the deferred STDP updates before reading the weight
+        flushTrace(pos);
+
+        synapse = static_cast<Synapse_Behavioral*>(mLinkSynapses[pos]);
+        ++synapse->statsReadEvents;
+
+        if (mEnableStdp && mOrderStdp > 0)
+            traceLtpFifo(pos);
+    } else {
+        synapse = static_cast<Synapse_Behavioral*>(getLink(origin));
+        ++synapse->statsReadEvents;
+    }
 
     // LTP
-    if (mEnableStdp && mOrderStdp > 0) {
+    if (mEnableStdp && mOrderStdp > 0 && !mTraceStdp) {
         std::deque<Synapse_Behavioral*>::iterator it
             = std::find(mLtpFifo.begin(), mLtpFifo.end(), synapse);
 
@@ -187,9 +236,14 @@ void N2D2::NodeNeuron_Behavioral::emitSpike(Time_T timestamp, EventType_T type)
                   << std::endl;
 
     if (mEnableStdp && mAllowStdp) {
+        if (!mLinksCompiled)
+            compileLinks();
+
         unsigned int ltp = 0;
 
-        if (mOrderStdp > 0) {
+        if (mTraceStdp)
+            traceStdp(timestamp);
+        else if (mOrderStdp > 0) {
             for (std::deque<Synapse_Behavioral*>::const_iterator it
                  = mLtpFifo.begin(),
                  itEnd = mLtpFifo.end();
@@ -199,29 +253,26 @@ void N2D2::NodeNeuron_Behavioral::emitSpike(Time_T timestamp, EventType_T type)
                 ++ltp;
             }
 
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
+            for (std::vector<Synapse*>::const_iterator it
+                 = mLinkSynapses.begin(),
+                 itEnd = mLinkSynapses.end();
                  it != itEnd;
                  ++it) {
                 Synapse_Behavioral* synapse = static_cast
-                    <Synapse_Behavioral*>((*it).second);
+                    <Synapse_Behavioral*>(*it);
 
                 if (std::find(mLtpFifo.begin(), mLtpFifo.end(), synapse)
                     == mLtpFifo.end())
                     decreaseWeight(synapse, synapse->weightDecrement);
             }
         } else {
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
+            for (unsigned int i = 0, size = mLinkSynapses.size(); i < size;
+                 ++i) {
                 Synapse_Behavioral* synapse = static_cast
-                    <Synapse_Behavioral*>((*it).second);
+                    <Synapse_Behavioral*>(mLinkSynapses[i]);
 
                 if (stdp(synapse,
-                         (*it).first->getLastActivationTime(),
+                         mLinkNodes[i]->getLastActivationTime(),
                          timestamp))
                     ++ltp;
             }
@@ -295,8 +346,16 @@ void N2D2::NodeNeuron_Behavioral::reset(Time_T timestamp)
     if (mEnableStdp) {
         mLastStdp = 0;
         mLtpFifo.clear();
+
+        std::fill(mTraceFifoStamp.begin(), mTraceFifoStamp.end(), 0);
+        mTraceFifo.clear();
+        mTraceFifoSize = 0;
     }
 
+    // The input nodes are reset as well
+    std::fill(mTracePreTime.begin(), mTracePreTime.end(), 0);
+    mTraceActive.clear();
+
     if (mStateLog.is_open())
         mStateLog << timestamp / ((double)TimeS) << " " << mIntegration
                   << std::endl;
@@ -324,6 +383,175 @@ void N2D2::NodeNeuron_Behavioral::initialize()
         mStateLog << 0.0 << " " << mIntegration << std::endl;
 }
 
+void N2D2::NodeNeuron_Behavioral::finalize()
+{
+    // The weights must be up-to-date at the end of the run
+    for (unsigned int pos = 0, size = mTraceStdpDone.size(); pos < size; ++pos)
+        flushTrace(pos);
+}
+
+void N2D2::NodeNeuron_Behavioral::initializeTrace()
+{
+    const unsigned int nbLinks = mLinkSynapses.size();
+
+    mTracePreTime.resize(nbLinks);
+    mTraceStdpDone.assign(nbLinks, mTraceStdpCnt);
+    mTraceFifoStamp.assign(nbLinks, 0);
+    mTraceFifo.clear();
+    mTraceFifoSize = 0;
+
+    std::vector<std::pair<Time_T, unsigned int> > active;
+
+    for (unsigned int pos = 0; pos < nbLinks; ++pos) {
+        mTracePreTime[pos] = mLinkNodes[pos]->getLastActivationTime();
+
+        if (mTracePreTime[pos] > 0)
+            active.push_back(std::make_pair(mTracePreTime[pos], pos));
+    }
+
+    std::sort(active.begin(), active.end());
+    mTraceActive.assign(active.begin(), active.end());
+}
+
+void N2D2::NodeNeuron_Behavioral::traceLtpFifo(unsigned int pos)
+{
+    // Same as mLtpFifo, without the linear search: each access is stamped
+    // and older accesses to the same link are ignored
+    if (mTraceFifoStamp[pos] == 0)
+        ++mTraceFifoSize;
+
+    mTraceFifoStamp[pos] = ++mTraceFifoCnt;
+    mTraceFifo.push_back(std::make_pair(pos, mTraceFifoCnt));
+
+    while (!mTraceFifo.empty()) {
+        const std::pair<unsigned int, unsigned long long int>& access
+            = mTraceFifo.front();
+
+        if (mTraceFifoStamp[access.first] == access.second) {
+            if (mTraceFifoSize <= mOrderStdp)
+                break;
+
+            mTraceFifoStamp[access.first] = 0;
+            --mTraceFifoSize;
+        }
+
+        mTraceFifo.pop_front();
+    }
+
+    if (mTraceFifo.size() > 2 * mOrderStdp + 64) {
+        std::deque<std::pair<unsigned int, unsigned long long int> > fifo;
+
+        for (std::deque<std::pair<unsigned int, unsigned long long int> >
+             ::const_iterator it = mTraceFifo.begin(),
+             itEnd = mTraceFifo.end();
+             it != itEnd;
+             ++it) {
+            if (mTraceFifoStamp[(*it).first] == (*it).second)
+                fifo.push_back(*it);
+        }
+
+        mTraceFifo.swap(fifo);
+    }
+}
+
+void N2D2::NodeNeuron_Behavioral::traceStdp(Time_T timestamp)
+{
+    if (mTraceStdpDone.size() != mLinkSynapses.size())
+        initializeTrace();
+
+    if (mOrderStdp > 0) {
+        for (std::deque<std::pair<unsigned int, unsigned long long int> >
+             ::const_iterator it = mTraceFifo.begin(),
+             itEnd = mTraceFifo.end();
+             it != itEnd;
+             ++it) {
+            const unsigned int pos = (*it).first;
+
+            if (mTraceFifoStamp[pos] != (*it).second)
+                continue;
+
+            Synapse_Behavioral* synapse = static_cast
+                <Synapse_Behavioral*>(mLinkSynapses[pos]);
+
+            flushTrace(pos);
+            increaseWeight(synapse, synapse->weightIncrement);
+            mTraceStdpDone[pos] = mTraceStdpCnt + 1;
+        }
+    } else {
+        if (!mBiologicalStdp) {
+            while (!mTraceActive.empty()
+                   && mTraceActive.front().first + mStdpLtp < timestamp)
+                mTraceActive.pop_front();
+        }
+
+        for (std::deque<std::pair<Time_T, unsigned int> >::const_iterator it
+             = mTraceActive.begin(),
+             itEnd = mTraceActive.end();
+             it != itEnd;
+             ++it) {
+            const unsigned int pos = (*it).second;
+
+            // Skip the links already updated and, without biological STDP,
+            // the pre-synaptic spikes that are not the last one
+            if (mTraceStdpDone[pos] > mTraceStdpCnt
+                || (!mBiologicalStdp && mTracePreTime[pos] != (*it).first))
+                continue;
+
+            flushTrace(pos);
+            stdp(static_cast<Synapse_Behavioral*>(mLinkSynapses[pos]),
+                 mTracePreTime[pos],
+                 timestamp);
+            mTraceStdpDone[pos] = mTraceStdpCnt + 1;
+        }
+
+        // With biological STDP, the synapses must be active again after
+        // this post-synaptic spike
+        if (mBiologicalStdp)
+            mTraceActive.clear();
+    }
+
+    // All the other links get the default update, which is deferred
+    ++mTraceStdpCnt;
+}
+
+void N2D2::NodeNeuron_Behavioral::flushTrace(unsigned int pos)
+{
+    const unsigned int nbPending = mTraceStdpCnt - mTraceStdpDone[pos];
+
+    if (nbPending == 0)
+        return;
+
+    mTraceStdpDone[pos] = mTraceStdpCnt;
+
+    Synapse_Behavioral* synapse = static_cast
+        <Synapse_Behavioral*>(mLinkSynapses[pos]);
+
+    // Update of an inactive synapse in stdp()
+    const bool bias = (mOrderStdp == 0 && mBiologicalStdp);
+    const bool increase = (bias && mWeightBias >= 0.0);
+    const double dw = (bias) ? std::fabs((double)mWeightBias)
+                             : (double)synapse->weightDecrement;
+
+    for (unsigned int n = 0; n < nbPending; ++n) {
+        // Once the weight is saturated, only the stats are updated
+        if (increase) {
+            if (synapse->weight >= synapse->weightMax) {
+                synapse->statsIncEvents += nbPending - n;
+                break;
+            }
+
+            increaseWeight(synapse, dw);
+        } else {
+            if (synapse->weight <= synapse->weightMin) {
+                synapse->statsDecEvents += nbPending - n;
+                break;
+            }
+
+            decreaseWeight(synapse, dw);
+        }
+    }
+}
+
 bool N2D2::NodeNeuron_Behavioral::stdp(Synapse_Behavioral* synapse,
                                        Time_T preTime,
                                        Time_T postTime) const
@@ -93,7 +93,7 @@ void N2D2::NodeNeuron_PCM::propagateSpike(Node* origin,
                                           Time_T timestamp,
                                           EventType_T type)
 {
-    const Time_T delay = static_cast<Synapse_PCM*>(mLinks[origin])->delay;
+    const Time_T delay = static_cast<Synapse_PCM*>(getLink(origin))->delay;
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -105,7 +105,7 @@ void N2D2::NodeNeuron_PCM::incomingSpike(Node* origin,
                                          Time_T timestamp,
                                          EventType_T /*type*/)
 {
-    Synapse_PCM* synapse = static_cast<Synapse_PCM*>(mLinks[origin]);
+    Synapse_PCM* synapse = static_cast<Synapse_PCM*>(getLink(origin));
 
     // Stats
     ++synapse->statsReadEvents;
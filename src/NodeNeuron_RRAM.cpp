@@ -94,7 +94,7 @@ void N2D2::NodeNeuron_RRAM::propagateSpike(Node* origin,
                                            Time_T timestamp,
                                            EventType_T type)
 {
-    const Time_T delay = static_cast<Synapse_RRAM*>(mLinks[origin])->delay;
+    const Time_T delay = static_cast<Synapse_RRAM*>(getLink(origin))->delay;
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -106,7 +106,7 @@ void N2D2::NodeNeuron_RRAM::incomingSpike(Node* origin,
                                           Time_T timestamp,
                                           EventType_T /*type*/)
 {
-    Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(mLinks[origin]);
+    Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(getLink(origin));
 
     // Stats
     ++synapse->statsReadEvents;
@@ -95,11 +95,11 @@ void N2D2::NodeNeuron_Reflective::propagateSpike(Node* origin,
     Synapse_Behavioral* synapse = NULL;
 
     if (type == ForwardEvent)
-        synapse = static_cast<Synapse_Behavioral*>(mLinks[origin]);
+        synapse = static_cast<Synapse_Behavioral*>(getLink(origin));
     else if (type == BackwardEvent) {
         NodeNeuron_Reflective* reflective = static_cast
             <NodeNeuron_Reflective*>(origin);
-        synapse = static_cast<Synapse_Behavioral*>(reflective->mLinks[this]);
+        synapse = static_cast<Synapse_Behavioral*>(reflective->getLink(this));
     } else
         throw std::runtime_error(
             "Unexpected incoming event type for reflective node!");
@@ -133,11 +133,11 @@ void N2D2::NodeNeuron_Reflective::incomingSpike(Node* origin,
     Synapse_Behavioral* synapse = NULL;
 
     if (type == ForwardEvent)
-        synapse = static_cast<Synapse_Behavioral*>(mLinks[origin]);
+        synapse = static_cast<Synapse_Behavioral*>(getLink(origin));
     else if (type == BackwardEvent) {
         NodeNeuron_Reflective* reflective = static_cast
             <NodeNeuron_Reflective*>(origin);
-        synapse = static_cast<Synapse_Behavioral*>(reflective->mLinks[this]);
+        synapse = static_cast<Synapse_Behavioral*>(reflective->getLink(this));
     } else
         throw std::runtime_error(
             "Unexpected incoming event type for reflective node!");
@@ -249,7 +249,7 @@ void N2D2::NodeNeuron_Reflective::emitSpike(Time_T timestamp, EventType_T type)
             NodeNeuron_Reflective* reflective = static_cast
                 <NodeNeuron_Reflective*>((*it));
             Synapse_Behavioral* synapse = static_cast
-                <Synapse_Behavioral*>(reflective->mLinks[this]);
+                <Synapse_Behavioral*>(reflective->getLink(this));
 
             if (reflective->getLastActivationTime() > 0
                 && reflective->getLastActivationTime() + stdpLtp >= timestamp)
@@ -25,8 +25,12 @@
 #include "utils/Utils.hpp"
 #include "utils/WindowFunction.hpp"
 
+#include <functional>
+
 N2D2::Sound::Sound(unsigned int samplingFrequency, unsigned short bitPerSample)
-    : mSamplingFrequency(samplingFrequency), mBitPerSample(bitPerSample)
+    : mSamplingFrequency(samplingFrequency),
+      mBitPerSample(bitPerSample),
+      mStreamRemaining(0)
 {
     // ctor
     mData.resize(1);
@@ -34,6 +38,7 @@ N2D2::Sound::Sound(unsigned int samplingFrequency, unsigned short bitPerSample)
 
 N2D2::Sound::Sound(const std::vector<double>& data,
                    unsigned int samplingFrequency)
+    : mStreamRemaining(0)
 {
     mData.push_back(data);
     mSamplingFrequency = samplingFrequency;
@@ -41,7 +46,8 @@ N2D2::Sound::Sound(const std::vector<double>& data,
 
 N2D2::Sound::Sound(const Sound& sound, double start, double end)
     : mSamplingFrequency(sound.mSamplingFrequency),
-      mBitPerSample(sound.mBitPerSample)
+      mBitPerSample(sound.mBitPerSample),
+      mStreamRemaining(0)
 {
     mData.resize(sound.mData.size());
 
@@ -79,6 +85,140 @@ void N2D2::Sound::load(const std::string& fileName, double start, double end)
     if (!data.good())
         throw std::runtime_error("Could not open sound file: " + fileName);
 
+    const unsigned int chunkSize = readHeader(data, fileName);
+
+    // For each channel
+    for (std::vector<std::vector<double> >::iterator it = mData.begin(),
+                                                     itEnd = mData.end();
+         it != itEnd;
+         ++it) {
+        // Make sure it's empty (if the object was already used)
+        (*it).clear();
+        // Reserve the memory for the samples
+        (*it).reserve(chunkSize / mData.size() / (mBitPerSample / 8));
+    }
+
+    const unsigned int nbSamples = chunkSize / mData.size()
+                                   / (mBitPerSample / 8);
+    const unsigned int startSample = (unsigned int)(start * mSamplingFrequency);
+    const unsigned int endSample
+        = (end > 0.0) ? (unsigned int)(end * mSamplingFrequency) : nbSamples;
+
+    if (startSample > nbSamples)
+        throw std::out_of_range("Start extraction time higher than the "
+                                "sound duration for file: " + fileName);
+
+    if (endSample > nbSamples)
+        throw std::out_of_range("End extraction time higher than the "
+                                "sound duration for file: " + fileName);
+
+    // Discard samples before start time
+    for (unsigned int s = 0; s < startSample; ++s) {
+        for (unsigned int i = 0, size = mData.size(); i < size; ++i)
+            readSample(data);
+    }
+
+    // For each sample
+    for (unsigned int s = startSample; s < endSample; ++s) {
+        // For each channel
+        for (std::vector<std::vector<double> >::iterator it = mData.begin(),
+                                                         itEnd = mData.end();
+             it != itEnd;
+             ++it) {
+            // Append the sample to the channel
+            (*it).push_back(readSample(data));
+        }
+    }
+
+    // Discard samples after end time
+    for (unsigned int s = endSample; s < nbSamples; ++s) {
+        for (unsigned int i = 0, size = mData.size(); i < size; ++i)
+            readSample(data);
+    }
+
+    std::string chunkId(4, 0);
+    unsigned int trailingSize;
+
+    while (data.read(reinterpret_cast<char*>(&chunkId[0]), 4)) {
+        data.read(reinterpret_cast<char*>(&trailingSize), 4);
+
+        std::cout << "Notice: Unsupported WAV file chunk (\""
+                  << Utils::escapeBinary(chunkId)
+                  << "\") in file: " << fileName << std::endl;
+        data.ignore(trailingSize);
+    }
+}
+
+void N2D2::Sound::openStream(const std::string& fileName,
+                             double start,
+                             double end)
+{
+    mStream = std::make_shared<std::ifstream>(fileName.c_str(),
+                                              std::fstream::binary);
+
+    if (!mStream->good())
+        throw std::runtime_error("Could not open sound file: " + fileName);
+
+    const unsigned int chunkSize = readHeader(*mStream, fileName);
+    const unsigned int nbSamples = chunkSize / mData.size()
+                                   / (mBitPerSample / 8);
+    const unsigned int startSample = (unsigned int)(start * mSamplingFrequency);
+    const unsigned int endSample
+        = (end > 0.0) ? (unsigned int)(end * mSamplingFrequency) : nbSamples;
+
+    if (startSample > nbSamples)
+        throw std::out_of_range("Start extraction time higher than the "
+                                "sound duration for file: " + fileName);
+
+    if (endSample > nbSamples)
+        throw std::out_of_range("End extraction time higher than the "
+                                "sound duration for file: " + fileName);
+
+    // Skip samples before start time
+    mStream->seekg((std::streamoff)startSample * mData.size()
+                   * (mBitPerSample / 8), std::ios::cur);
+    mStreamRemaining = endSample - startSample;
+
+    for (std::vector<std::vector<double> >::iterator it = mData.begin(),
+                                                     itEnd = mData.end();
+         it != itEnd;
+         ++it)
+        (*it).clear();
+}
+
+unsigned int N2D2::Sound::readBlock(unsigned int nbSamples)
+{
+    if (!mStream)
+        throw std::runtime_error("Sound::readBlock(): no stream opened");
+
+    const unsigned int size = std::min(nbSamples, mStreamRemaining);
+
+    for (std::vector<std::vector<double> >::iterator it = mData.begin(),
+                                                     itEnd = mData.end();
+         it != itEnd;
+         ++it) {
+        (*it).clear();
+        (*it).reserve(size);
+    }
+
+    for (unsigned int s = 0; s < size; ++s) {
+        for (std::vector<std::vector<double> >::iterator it = mData.begin(),
+                                                         itEnd = mData.end();
+             it != itEnd;
+             ++it)
+            (*it).push_back(readSample(*mStream));
+    }
+
+    if (!mStream->good())
+        throw std::runtime_error("Sound::readBlock(): error reading data");
+
+    mStreamRemaining -= size;
+    return size;
+}
+
+unsigned int N2D2::Sound::readHeader(std::istream& data,
+                                     const std::string& fileName)
+{
     std::string chunkId(4, 0);
     unsigned int chunkSize;
 
@@ -148,90 +288,42 @@ void N2D2::Sound::load(const std::string& fileName, double start, double end)
                 throw std::runtime_error("Invalid sound file (bytePerBlock != "
                                          "mData.size()*mBitPerSample/8): "
                                          + fileName);
-        } else if (chunkId == "data") {
-            // For each channel
-            for (std::vector<std::vector<double> >::iterator it = mData.begin(),
-                                                             itEnd
-                                                             = mData.end();
-                 it != itEnd;
-                 ++it) {
-                // Make sure it's empty (if the object was already used)
-                (*it).clear();
-                // Reserve the memory for the samples
-                (*it).reserve(chunkSize / mData.size() / (mBitPerSample / 8));
-            }
-
-            const unsigned int nbSamples = chunkSize / mData.size()
-                                           / (mBitPerSample / 8);
-            const unsigned int startSample
-                = (unsigned int)(start * mSamplingFrequency);
-            const unsigned int endSample
-                = (end > 0.0) ? (unsigned int)(end * mSamplingFrequency)
-                              : nbSamples;
-
-            if (startSample > nbSamples)
-                throw std::out_of_range("Start extraction time higher than the "
-                                        "sound duration for file: " + fileName);
-
-            if (endSample > nbSamples)
-                throw std::out_of_range("End extraction time higher than the "
-                                        "sound duration for file: " + fileName);
-
-            int byte;
-
-            // Discard samples before start time
-            for (unsigned int s = 0; s < startSample; ++s) {
-                for (unsigned int i = 0, size = mData.size(); i < size; ++i)
-                    data.read(reinterpret_cast<char*>(&byte),
-                              mBitPerSample / 8);
-            }
-
-            // For each sample
-            for (unsigned int s = startSample; s < endSample; ++s) {
-                // For each channel
-                for (std::vector<std::vector<double> >::iterator it
-                     = mData.begin(),
-                     itEnd = mData.end();
-                     it != itEnd;
-                     ++it) {
-                    data.read(reinterpret_cast<char*>(&byte),
-                              mBitPerSample / 8);
-
-                    if (mBitPerSample == 8) {
-                        if (byte & 0x80)
-                            byte |= ~0xFF;
-                        else
-                            byte &= 0xFF;
-                    } else if (mBitPerSample == 16) {
-                        if (byte & 0x8000)
-                            byte |= ~0xFFFF;
-                        else
-                            byte &= 0x0000FFFF;
-                    } else if (mBitPerSample == 24) {
-                        if (byte & 0x800000)
-                            byte |= ~0xFFFFFF;
-                        else
-                            byte &= 0xFFFFFF;
-                    }
-
-                    // Append the sample to the channel
-                    (*it).push_back(byte);
-                }
-            }
-
-            // Discard samples after end time
-            for (unsigned int s = endSample; s < nbSamples; ++s) {
-                for (unsigned int i = 0, size = mData.size(); i < size; ++i)
-                    data.read(reinterpret_cast<char*>(&byte),
-                              mBitPerSample / 8);
-            }
-        } else {
+        } else if (chunkId == "data")
+            return chunkSize;
+        else {
             std::cout << "Notice: Unsupported WAV file chunk (\""
                       << Utils::escapeBinary(chunkId)
                       << "\") in file: " << fileName << std::endl;
             data.ignore(chunkSize);
         }
     }
+
+    throw std::runtime_error("Missing data chunk in sound file: " + fileName);
+}
+
+int N2D2::Sound::readSample(std::istream& data) const
+{
+    int byte = 0;
+    data.read(reinterpret_cast<char*>(&byte), mBitPerSample / 8);
+
+    if (mBitPerSample == 8) {
+        if (byte & 0x80)
+            byte |= ~0xFF;
+        else
+            byte &= 0xFF;
+    } else if (mBitPerSample == 16) {
+        if (byte & 0x8000)
+            byte |= ~0xFFFF;
+        else
+            byte &= 0x0000FFFF;
+    } else if (mBitPerSample == 24) {
+        if (byte & 0x800000)
+            byte |= ~0xFFFFFF;
+        else
+            byte &= 0xFFFFFF;
+    }
+
+    return byte;
 }
 
 void N2D2::Sound::loadSignal(const std::string& fileName,
@@ -1118,6 +1210,25 @@ void N2D2::Sound::applyFilter(const Filter_T& filter,
             out.pop_front();
             out.push_back(mData[channel][s]);
         }
+    } else if (filter.first.size() >= 64) {
+        // Long FIR Filter (e.g. resample()): FFT convolution
+        const Real_T gain = filter.second.back();
+        const std::vector<double> h(filter.first.rbegin(),
+                                    filter.first.rend());
+
+        std::vector<double>& data = mData.at(channel);
+        std::transform(data.begin(),
+                       data.end(),
+                       data.begin(),
+                       std::bind(std::divides<double>(),
+                                 std::placeholders::_1,
+                                 (double)gain));
+
+        const unsigned int size = data.size();
+        data = DSP::convolve(data, h);
+
+        // The last trailing sample, with only zeros at the filter input, is 0
+        data.resize(size + ((appendTrailing) ? filter.first.size() : 0), 0.0);
     } else {
         // FIR Filter
         std::deque<double> in(filter.first.size(), 0.0);
@@ -18,17 +18,23 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include <cstdio>
+
 #include "StimuliData.hpp"
 #include "StimuliProvider.hpp"
 #include "utils/BinaryCvMat.hpp"
 #include "utils/Gnuplot.hpp"
+#include "utils/Random.hpp"
 
 N2D2::StimuliData::StimuliData(const std::string& name,
                                StimuliProvider& provider)
     : mName(name),
       mProvider(provider),
       mMeanData(this, "MeanData", false),
-      mStdDevData(this, "StdDevData", false)
+      mStdDevData(this, "StdDevData", false),
+      mSampleRatio(this, "SampleRatio", 1.0),
+      mCheckpointInterval(this, "CheckpointInterval", 10000U),
+      mNbStimuliPopulation(0)
 {
     // ctor
     Utils::createDirectories(mName);
@@ -39,7 +45,11 @@ N2D2::StimuliData::StimuliData(const StimuliData& stimuliData)
       mName(stimuliData.mName),
       mProvider(stimuliData.mProvider),
       mMeanData(this, "MeanData", stimuliData.mMeanData),
-      mStdDevData(this, "StdDevData", stimuliData.mStdDevData)
+      mStdDevData(this, "StdDevData", stimuliData.mStdDevData),
+      mSampleRatio(this, "SampleRatio", stimuliData.mSampleRatio),
+      mCheckpointInterval(this, "CheckpointInterval",
+                          stimuliData.mCheckpointInterval),
+      mNbStimuliPopulation(0)
 {
     // copy-ctor
 }
@@ -58,9 +68,22 @@ void N2D2::StimuliData::displayData() const
             << mMaxSize.dimZ << "]\n"
                                 "Value range: [" << mGlobalValue.minVal << ", "
             << mGlobalValue.maxVal << "]\n"
-                                      "Value mean: " << mGlobalValue.mean
-            << "\n"
-               "Value std. dev.: " << mGlobalValue.stdDev << "\n";
+                                      "Value mean: " << mGlobalValue.mean;
+
+    if (mGlobalValueConfidence.mean > 0.0)
+        dataStr << " (+/- " << mGlobalValueConfidence.mean << ")";
+
+    dataStr << "\nValue std. dev.: " << mGlobalValue.stdDev;
+
+    if (mGlobalValueConfidence.stdDev > 0.0)
+        dataStr << " (+/- " << mGlobalValueConfidence.stdDev << ")";
+
+    dataStr << "\n";
+
+    if (mSize.size() < mNbStimuliPopulation) {
+        dataStr << "Sampled from: " << mNbStimuliPopulation << " stimuli"
+            " (95% confidence intervals)\n";
+    }
 
     const std::string fileName = mName + "/data.dat";
 
@@ -83,6 +106,8 @@ void N2D2::StimuliData::clear()
 
     mValue.clear();
     mGlobalValue = Value();
+    mGlobalValueConfidence = Confidence();
+    mNbStimuliPopulation = 0;
 }
 
 N2D2::StimuliData::Size N2D2::StimuliData::getMeanSize() const
@@ -244,23 +269,74 @@ unsigned int N2D2::StimuliData::generate(Database::StimuliSetMask setMask,
     clear();
 
     const std::string& cacheName = mName + "/_cache";
+    const std::string& partialName = mName + "/_partial";
 
-    // For progression visualization
-    unsigned int toLoad = 0;
+    if (mSampleRatio <= 0.0 || mSampleRatio > 1.0) {
+        throw std::runtime_error("StimuliData::generate(): SampleRatio must be"
+                                 " in ]0.0, 1.0]");
+    }
 
     const std::vector<Database::StimuliSet> stimuliSets
         = mProvider.getDatabase().getStimuliSets(setMask);
 
+    // List of the stimuli to process, randomly sampled in each set if
+    // SampleRatio < 1
+    StimuliList_T stimuli;
+
     for (std::vector<Database::StimuliSet>::const_iterator it
             = stimuliSets.begin(),
             itEnd = stimuliSets.end();
             it != itEnd;
             ++it) {
-        toLoad += mProvider.getDatabase().getNbStimuli(*it);
+        const unsigned int nbStimuli
+            = mProvider.getDatabase().getNbStimuli(*it);
+        mNbStimuliPopulation += nbStimuli;
+
+        std::vector<unsigned int> indexes(nbStimuli);
+
+        for (unsigned int index = 0; index < nbStimuli; ++index)
+            indexes[index] = index;
+
+        if (mSampleRatio < 1.0 && nbStimuli > 0) {
+            const unsigned int nbSamples = std::max(1U,
+                (unsigned int)std::ceil(mSampleRatio * nbStimuli));
+
+            // The sample only depends on the set, its size and SampleRatio
+            // and not on the global random generator state, so that a
+            // resumed analysis draws the same sample as its partial file
+            const unsigned long long seed = Random::counterRand(
+                ((unsigned long long)(*it) << 32) | nbStimuli, nbSamples);
+
+            // Partial Fisher-Yates shuffle
+            for (unsigned int i = 0; i < nbSamples; ++i) {
+                const unsigned int j = i + (unsigned int)
+                    (Random::counterRand(seed, i) % (nbStimuli - i));
+                std::swap(indexes[i], indexes[j]);
+            }
+
+            indexes.resize(nbSamples);
+            // Keep the database order for I/O locality
+            std::sort(indexes.begin(), indexes.end());
+        }
+
+        for (std::vector<unsigned int>::const_iterator itIndex
+             = indexes.begin(), itIndexEnd = indexes.end();
+             itIndex != itIndexEnd;
+             ++itIndex)
+        {
+            stimuli.push_back(std::make_pair(*it, *itIndex));
+        }
     }
 
-    std::cout << mName << " processing " << toLoad << " stimuli"
-        << std::flush;
+    // For progression visualization
+    const unsigned int toLoad = stimuli.size();
+
+    std::cout << mName << " processing " << toLoad << " stimuli";
+
+    if (toLoad < mNbStimuliPopulation)
+        std::cout << " (sampled from " << mNbStimuliPopulation << ")";
+
+    std::cout << std::flush;
 
     if (toLoad > 0 && !loadDataCache(cacheName)) {
         const unsigned int batchSize = mProvider.getBatchSize();
@@ -269,194 +345,94 @@ unsigned int N2D2::StimuliData::generate(Database::StimuliSetMask setMask,
         const std::string cachePath = mProvider.getCachePath();
         mProvider.setCachePath();
 
-        unsigned int minSizeX = std::numeric_limits<unsigned int>::max();
-        unsigned int minSizeY = std::numeric_limits<unsigned int>::max();
-        unsigned int minSizeZ = std::numeric_limits<unsigned int>::max();
-        unsigned int maxSizeX = 0U;
-        unsigned int maxSizeY = 0U;
-        unsigned int maxSizeZ = 0U;
-
-        Float_T globalValueMin = std::numeric_limits<Float_T>::max();
-        Float_T globalValueMax = -std::numeric_limits<Float_T>::max();
-
         const std::string& meanDataFile = mName + "/meanData.bin";
-        bool computeMeanData = mMeanData
+        const bool computeMeanData = mMeanData
                                 && !std::ifstream(meanDataFile.c_str()).good();
-        cv::Mat meanData;
 
         const std::string& stdDevDataFile = mName + "/stdDevData.bin";
-        bool computeStdDevData = mStdDevData
+        const bool computeStdDevData = mStdDevData
                                && !std::ifstream(stdDevDataFile.c_str()).good();
-        cv::Mat M2Data;
 
         mSize.resize(toLoad);
         mValue.resize(toLoad);
 
-        // to compute global mean
-        long double sumMean = 0.0;
-        unsigned long long int sumCount = 0;
-        // to compute global stdDev
-        long double sumM2 = 0.0;
-        std::vector<double> mean(toLoad, 0.0);
-        std::vector<unsigned int> count(toLoad, 0U);
+        // Global value stats and per-element stats for the mean/std. dev.
+        // data, merged from the per-thread accumulators
+        Accumulator globalAcc;
+        DataAccumulator dataAcc;
+        bool dataMismatch = false;
 
         unsigned int loaded = 0;
-        unsigned int progress = 0, progressPrev = 0;
-
-        // First loop: compute frame stats + global mean
-        for (std::vector<Database::StimuliSet>::const_iterator it
-             = stimuliSets.begin(),
-             itEnd = stimuliSets.end();
-             it != itEnd;
-             ++it) {
-            const unsigned int nbStimuli
-                = mProvider.getDatabase().getNbStimuli(*it);
-            const bool rawData = (mProvider.getNbTransformations(*it) == 0
-                                    && !noRaw);
-
-#pragma omp parallel for schedule(dynamic) reduction(+:sumMean,sumCount,sumM2)
-// min and max reduction not supported by MSVC, using double-checked locking instead.
-//reduction(min:minSizeX,minSizeY,minSizeZ,globalValueMin) reduction(max:maxSizeX,maxSizeY,maxSizeZ,globalValueMax)
-            for (int index = 0; index < (int)nbStimuli; ++index) {
-                StimuliProvider provider = mProvider.cloneParameters();
-
-                if (!rawData)
-                    provider.readStimulus(*it, index, 0);
-
-                const Tensor<Float_T> data
-                    = (rawData) ? provider.readRawData(*it, index)
-                                : provider.getData()[0];
-
-                assert(!data.empty());
-
-                double dataMean = 0.0;
-                double dataM2 = 0.0;
-                Float_T minVal = data(0);
-                Float_T maxVal = data(0);
-
-                // Use Welford's method to compute std. dev. in one pass
-                for (unsigned int k = 0, kSize = data.size(); k < kSize; ++k) {
-                    const double x = data(k);
-
-                    const double delta = (x - dataMean);
-                    dataMean += delta / (k + 1);
-                    const double delta2 = (x - dataMean);
-                    dataM2 += delta * delta2;
-
-                    if (x < minVal)
-                        minVal = x;
-
-                    if (x > maxVal)
-                        maxVal = x;
-                }
-
-                const double dataStdDev = std::sqrt(dataM2 / (data.size() - 1));
-
-                // to compute global mean
-                sumMean += dataMean * data.size();
-                sumCount += data.size();
-                // to compute global stdDev
-                sumM2 += dataM2;
-                mean[loaded + index] = dataMean;
-                count[loaded + index] = data.size();
-
-                // Size
-                const Size size(data.dimX(), data.dimY(), data.dimZ());
 
-                // Value
-                const Value value(minVal, maxVal, dataMean, dataStdDev);
+        if (mCheckpointInterval > 0
+            && loadPartial(partialName, stimuli, loaded, globalAcc, dataAcc,
+                           dataMismatch))
+        {
+            std::cout << " (resuming at " << loaded << ")" << std::flush;
+        }
 
-                if (data.dimX() < minSizeX) {
-#pragma omp critical(StimuliData__generate_minSizeX)
-                    if (data.dimX() < minSizeX)
-                        minSizeX = data.dimX();
-                }
+        unsigned int progressPrev = (unsigned int)(20.0 * loaded
+                                                    / (double)toLoad);
 
-                if (data.dimY() < minSizeY) {
-#pragma omp critical(StimuliData__generate_minSizeY)
-                    if (data.dimY() < minSizeY)
-                        minSizeY = data.dimY();
-                }
+        while (loaded < toLoad) {
+            const unsigned int chunkEnd = (mCheckpointInterval > 0)
+                ? std::min(loaded + (unsigned int)mCheckpointInterval, toLoad)
+                : toLoad;
+            const bool computeData = (computeMeanData || computeStdDevData)
+                                        && !dataMismatch;
 
-                if (data.dimZ() < minSizeZ) {
-#pragma omp critical(StimuliData__generate_minSizeZ)
-                    if (data.dimZ() < minSizeZ)
-                        minSizeZ = data.dimZ();
-                }
+#pragma omp parallel
+            {
+                StimuliProvider provider = mProvider.cloneParameters();
 
-                if (minVal < globalValueMin) {
-#pragma omp critical(StimuliData__generate_globalValueMin)
-                    if (minVal < globalValueMin)
-                        globalValueMin = minVal;
-                }
+                Accumulator threadAcc;
+                DataAccumulator threadDataAcc;
+                bool threadDataMismatch = false;
 
-                if (data.dimX() > maxSizeX) {
-#pragma omp critical(StimuliData__generate_maxSizeX)
-                    if (data.dimX() > maxSizeX)
-                        maxSizeX = data.dimX();
-                }
+#pragma omp for schedule(dynamic) nowait
+                for (int pos = (int)loaded; pos < (int)chunkEnd; ++pos) {
+                    const Database::StimuliSet set = stimuli[pos].first;
+                    const unsigned int index = stimuli[pos].second;
+                    const bool rawData = (mProvider.getNbTransformations(set)
+                                                == 0 && !noRaw);
 
-                if (data.dimY() > maxSizeY) {
-#pragma omp critical(StimuliData__generate_maxSizeY)
-                    if (data.dimY() > maxSizeY)
-                        maxSizeY = data.dimY();
-                }
+                    if (!rawData)
+                        provider.readStimulus(set, index, 0);
 
-                if (data.dimZ() > maxSizeZ) {
-#pragma omp critical(StimuliData__generate_maxSizeZ)
-                    if (data.dimZ() > maxSizeZ)
-                        maxSizeZ = data.dimZ();
-                }
+                    const Tensor<Float_T> data
+                        = (rawData) ? provider.readRawData(set, index)
+                                    : provider.getData()[0];
 
-                if (maxVal > globalValueMax) {
-#pragma omp critical(StimuliData__generate_globalValueMax)
-                    if (maxVal > globalValueMax)
-                        globalValueMax = maxVal;
-                }
+                    assert(!data.empty());
 
-                mSize[loaded + index] = size;
-                mValue[loaded + index] = value;
+                    Accumulator acc;
 
-                if (computeMeanData || computeStdDevData) {
-                    cv::Mat matData;
-                    // Use double for maximum precision
-                    ((cv::Mat)data).convertTo(matData, CV_64F);
+                    for (unsigned int k = 0, kSize = data.size(); k < kSize;
+                        ++k)
+                    {
+                        acc.push(data(k));
+                    }
 
-#pragma omp critical(StimuliData__generate_meanData)
-                    if (computeMeanData || computeStdDevData) {
-                        if (meanData.empty()) {
-                            meanData = cv::Mat::zeros(matData.size(),
-                                                      matData.type());
-                        }
+                    threadAcc.merge(acc);
 
-                        if (M2Data.empty() && computeStdDevData) {
-                            M2Data = cv::Mat::zeros(matData.size(),
-                                                    matData.type());
-                        }
+                    mSize[pos] = Size(data.dimX(), data.dimY(), data.dimZ());
+                    mValue[pos] = Value(acc.minVal, acc.maxVal, acc.mean,
+                                        std::sqrt(acc.variance()));
 
-                        if (matData.size() == meanData.size()
-                            && matData.type() == meanData.type())
+                    if (computeData && !threadDataMismatch) {
+                        if (threadDataAcc.dims.empty()
+                            || data.dims() == threadDataAcc.dims)
                         {
-                            const cv::Mat delta = (matData - meanData);
-                            meanData += delta / (loaded + index + 1);
-
-                            if (computeStdDevData) {
-                                const cv::Mat delta2 = (matData - meanData);
-                                M2Data += delta.mul(delta2);
-                            }
-                        }
-                        else {
-                            computeMeanData = false;
-                            computeStdDevData = false;
+                            threadDataAcc.push(data);
                         }
+                        else
+                            threadDataMismatch = true;
                     }
-                }
 
-                // Progress bar
-                progress = (unsigned int)(20.0 * (loaded + index)
-                                                            / (double)toLoad);
+                    // Progress bar
+                    const unsigned int progress
+                        = (unsigned int)(20.0 * pos / (double)toLoad);
 
-                if (progress > progressPrev) {
 #pragma omp critical(StimuliData__generate)
                     if (progress > progressPrev) {
                         std::cout << std::string(progress - progressPrev, '.')
@@ -464,45 +440,80 @@ unsigned int N2D2::StimuliData::generate(Database::StimuliSetMask setMask,
                         progressPrev = progress;
                     }
                 }
-            }
-
-            loaded += nbStimuli;
-        }
 
-        assert(loaded == toLoad);
+#pragma omp critical(StimuliData__generate_merge)
+                {
+                    globalAcc.merge(threadAcc);
 
-        mMinSize = Size(minSizeX, minSizeY, minSizeZ);
-        mMaxSize = Size(maxSizeX, maxSizeY, maxSizeZ);
+                    if (computeData) {
+                        if (threadDataMismatch
+                            || (!dataAcc.dims.empty()
+                                && !threadDataAcc.dims.empty()
+                                && dataAcc.dims != threadDataAcc.dims))
+                        {
+                            dataMismatch = true;
+                        }
+                        else
+                            dataAcc.merge(threadDataAcc);
+                    }
+                }
+            }
 
-        mGlobalValue.minVal = globalValueMin;
-        mGlobalValue.maxVal = globalValueMax;
+            loaded = chunkEnd;
 
-        // Compute global mean
-        const double globalMean = (sumCount > 0) ? sumMean / sumCount : 0.0;
-        mGlobalValue.mean = globalMean;
+            if (loaded < toLoad) {
+                savePartial(partialName, stimuli, loaded, globalAcc, dataAcc,
+                            dataMismatch);
+            }
+        }
 
-        // Compute global stdDev
-        // source: https://stats.stackexchange.com/questions/10441/how-to-calculate-the-variance-of-a-partition-of-variables
-        double sqSum = 0.0;
+        mMinSize = Size(std::numeric_limits<unsigned int>::max(),
+                        std::numeric_limits<unsigned int>::max(),
+                        std::numeric_limits<unsigned int>::max());
 
-        for (unsigned int k = 0; k < loaded; ++k) {
-            const double delta = (mean[k] - globalMean);
-            sqSum += count[k] * delta * delta;
+        for (std::vector<Size>::const_iterator it = mSize.begin(),
+                                               itEnd = mSize.end();
+             it != itEnd;
+             ++it)
+        {
+            mMinSize.dimX = std::min(mMinSize.dimX, (*it).dimX);
+            mMinSize.dimY = std::min(mMinSize.dimY, (*it).dimY);
+            mMinSize.dimZ = std::min(mMinSize.dimZ, (*it).dimZ);
+            mMaxSize.dimX = std::max(mMaxSize.dimX, (*it).dimX);
+            mMaxSize.dimY = std::max(mMaxSize.dimY, (*it).dimY);
+            mMaxSize.dimZ = std::max(mMaxSize.dimZ, (*it).dimZ);
         }
 
-        mGlobalValue.stdDev = (sumCount > 1)
-            ? std::sqrt((sumM2 + sqSum) / (sumCount - 1)) : 0.0;
+        mGlobalValue.minVal = globalAcc.minVal;
+        mGlobalValue.maxVal = globalAcc.maxVal;
+        mGlobalValue.mean = globalAcc.mean;
+        mGlobalValue.stdDev = std::sqrt(globalAcc.variance());
+
+        if (toLoad < mNbStimuliPopulation)
+            computeConfidence();
+
+        if ((computeMeanData || computeStdDevData) && !dataMismatch) {
+            const Tensor<double> meanTensor(dataAcc.dims,
+                                            dataAcc.mean.begin(),
+                                            dataAcc.mean.end());
+            const cv::Mat meanData = ((cv::Mat)meanTensor).clone();
 
-        if (computeMeanData || computeStdDevData) {
             BinaryCvMat::write(meanDataFile, meanData);
             StimuliProvider::logData(Utils::fileBaseName(meanDataFile) + ".dat",
                                      Tensor<Float_T>(meanData));
 
             if (computeStdDevData) {
-                M2Data /= (double)(toLoad - 1);
+                std::vector<double> stdDev(dataAcc.M2.size());
+
+                for (size_t k = 0; k < stdDev.size(); ++k) {
+                    stdDev[k] = (dataAcc.count > 1)
+                        ? std::sqrt(dataAcc.M2[k] / (dataAcc.count - 1)) : 0.0;
+                }
 
-                cv::Mat stdDevData;
-                cv::sqrt(M2Data, stdDevData);
+                const Tensor<double> stdDevTensor(dataAcc.dims,
+                                                  stdDev.begin(),
+                                                  stdDev.end());
+                const cv::Mat stdDevData = ((cv::Mat)stdDevTensor).clone();
 
                 const int nonZero = cv::countNonZero(stdDevData.reshape(1));
                 assert(nonZero <= (int)stdDevData.reshape(1).total());
@@ -537,6 +548,7 @@ unsigned int N2D2::StimuliData::generate(Database::StimuliSetMask setMask,
         mProvider.setBatchSize(batchSize);
         mProvider.setCachePath(cachePath);
         saveDataCache(cacheName);
+        std::remove(partialName.c_str());
     }
 
     std::cout << std::endl;
@@ -544,6 +556,112 @@ unsigned int N2D2::StimuliData::generate(Database::StimuliSetMask setMask,
     return toLoad;
 }
 
+void N2D2::StimuliData::computeConfidence()
+{
+    // Cluster sampling of the stimuli: the global mean and variance are ratio
+    // estimators over the sampled stimuli, whose variance is approximated by
+    // linearization (delta method), with finite population correction.
+    const size_t n = mValue.size();
+
+    if (n < 2) {
+        mGlobalValueConfidence = Confidence();
+        return;
+    }
+
+    double sumCount = 0.0;
+    double sumSq = 0.0;
+
+    for (size_t k = 0; k < n; ++k) {
+        const double count = (double)mSize[k].dimX * mSize[k].dimY
+                                * mSize[k].dimZ;
+        const double variance = (count > 1.0)
+            ? mValue[k].stdDev * mValue[k].stdDev * (count - 1.0) / count
+            : 0.0;
+
+        sumCount += count;
+        sumSq += count * (variance + mValue[k].mean * mValue[k].mean);
+    }
+
+    const double meanCount = sumCount / n;
+    const double mean = mGlobalValue.mean;
+    const double sq = sumSq / sumCount;
+    const double variance = sq - mean * mean;
+
+    double sumMeanRes2 = 0.0;
+    double sumVarRes2 = 0.0;
+
+    for (size_t k = 0; k < n; ++k) {
+        const double count = (double)mSize[k].dimX * mSize[k].dimY
+                                * mSize[k].dimZ;
+        const double variance_k = (count > 1.0)
+            ? mValue[k].stdDev * mValue[k].stdDev * (count - 1.0) / count
+            : 0.0;
+        const double sq_k = variance_k + mValue[k].mean * mValue[k].mean;
+
+        const double meanRes = count * (mValue[k].mean - mean) / meanCount;
+        const double varRes = count * ((sq_k - sq)
+                                - 2.0 * mean * (mValue[k].mean - mean))
+                                    / meanCount;
+
+        sumMeanRes2 += meanRes * meanRes;
+        sumVarRes2 += varRes * varRes;
+    }
+
+    const double fpc = 1.0 - n / (double)mNbStimuliPopulation;
+    const double z = 1.96;  // 95% confidence
+
+    mGlobalValueConfidence.mean
+        = z * std::sqrt(fpc * sumMeanRes2 / (n - 1) / n);
+    mGlobalValueConfidence.stdDev = (variance > 0.0)
+        ? z * std::sqrt(fpc * sumVarRes2 / (n - 1) / n)
+            / (2.0 * std::sqrt(variance))
+        : 0.0;
+}
+
+void N2D2::StimuliData::DataAccumulator::push(const Tensor<Float_T>& data)
+{
+    if (dims.empty()) {
+        dims = data.dims();
+        mean.assign(data.size(), 0.0);
+        M2.assign(data.size(), 0.0);
+    }
+
+    ++count;
+
+    for (size_t k = 0, size = mean.size(); k < size; ++k) {
+        const double x = data(k);
+        const double delta = (x - mean[k]);
+        mean[k] += delta / count;
+        const double delta2 = (x - mean[k]);
+        M2[k] += delta * delta2;
+    }
+}
+
+void N2D2::StimuliData::DataAccumulator::merge(const DataAccumulator& acc)
+{
+    if (acc.count == 0)
+        return;
+
+    if (count == 0) {
+        *this = acc;
+        return;
+    }
+
+    assert(acc.dims == dims);
+
+    const double n = (double)count + (double)acc.count;
+    const double ratio = acc.count / n;
+    const double factor = (double)count * acc.count / n;
+
+    for (size_t k = 0, size = mean.size(); k < size; ++k) {
+        const double delta = (acc.mean[k] - mean[k]);
+        mean[k] += delta * ratio;
+        M2[k] += acc.M2[k] + delta * delta * factor;
+    }
+
+    count += acc.count;
+}
+
 bool N2D2::StimuliData::loadDataCache(const std::string& fileName)
 {
     std::ifstream data(fileName.c_str(), std::fstream::binary);
@@ -577,6 +695,17 @@ bool N2D2::StimuliData::loadDataCache(const std::string& fileName)
     if (!data.good())
         throw std::runtime_error("Error reading cache file: " + fileName);
 
+    // Optional, for sampled statistics
+    data.read(reinterpret_cast<char*>(&mGlobalValueConfidence),
+              sizeof(mGlobalValueConfidence));
+    data.read(reinterpret_cast<char*>(&mNbStimuliPopulation),
+              sizeof(mNbStimuliPopulation));
+
+    if (!data.good()) {
+        mGlobalValueConfidence = Confidence();
+        mNbStimuliPopulation = mSize.size();
+    }
+
     return true;
 }
 
@@ -601,7 +730,168 @@ void N2D2::StimuliData::saveDataCache(const std::string& fileName) const
                valueLength * sizeof(mValue[0]));
     data.write(reinterpret_cast<const char*>(&mGlobalValue),
                sizeof(mGlobalValue));
+    data.write(reinterpret_cast<const char*>(&mGlobalValueConfidence),
+               sizeof(mGlobalValueConfidence));
+    data.write(reinterpret_cast<const char*>(&mNbStimuliPopulation),
+               sizeof(mNbStimuliPopulation));
 
     if (!data.good())
         throw std::runtime_error("Error writing cache file: " + fileName);
 }
+
+bool N2D2::StimuliData::loadPartial(const std::string& fileName,
+                                    const StimuliList_T& stimuli,
+                                    unsigned int& loaded,
+                                    Accumulator& globalAcc,
+                                    DataAccumulator& dataAcc,
+                                    bool& dataMismatch)
+{
+    std::ifstream data(fileName.c_str(), std::fstream::binary);
+
+    if (!data.good())
+        return false;
+
+    unsigned int nbStimuli;
+    data.read(reinterpret_cast<char*>(&nbStimuli), sizeof(nbStimuli));
+
+    StimuliList_T partialStimuli(nbStimuli);
+
+    if (data.good() && nbStimuli > 0) {
+        data.read(reinterpret_cast<char*>(&partialStimuli[0]),
+                  nbStimuli * sizeof(partialStimuli[0]));
+    }
+
+    if (!data.good())
+        throw std::runtime_error("Error reading partial file: " + fileName);
+
+    // The stimuli list changes with the sets or SampleRatio: start over
+    if (partialStimuli != stimuli) {
+        std::cout << Utils::cwarning << "Warning: StimuliData::generate(): "
+            "partial file " << fileName << " does not match the stimuli to "
+            "process and is ignored." << Utils::cdef << std::endl;
+        return false;
+    }
+
+    unsigned int partialLoaded;
+    Accumulator partialGlobalAcc;
+    DataAccumulator partialDataAcc;
+    bool partialDataMismatch;
+    unsigned int dimsSize;
+
+    data.read(reinterpret_cast<char*>(&partialLoaded), sizeof(partialLoaded));
+    data.read(reinterpret_cast<char*>(&partialGlobalAcc),
+              sizeof(partialGlobalAcc));
+    data.read(reinterpret_cast<char*>(&partialDataMismatch),
+              sizeof(partialDataMismatch));
+    data.read(reinterpret_cast<char*>(&partialDataAcc.count),
+              sizeof(partialDataAcc.count));
+    data.read(reinterpret_cast<char*>(&dimsSize), sizeof(dimsSize));
+
+    if (!data.good() || partialLoaded > nbStimuli)
+        throw std::runtime_error("Error reading partial file: " + fileName);
+
+    partialDataAcc.dims.resize(dimsSize);
+
+    if (dimsSize > 0) {
+        data.read(reinterpret_cast<char*>(&partialDataAcc.dims[0]),
+                  dimsSize * sizeof(partialDataAcc.dims[0]));
+
+        const size_t size = std::accumulate(partialDataAcc.dims.begin(),
+                                            partialDataAcc.dims.end(),
+                                            (size_t)1U,
+                                            std::multiplies<size_t>());
+
+        partialDataAcc.mean.resize(size);
+        partialDataAcc.M2.resize(size);
+        data.read(reinterpret_cast<char*>(&partialDataAcc.mean[0]),
+                  size * sizeof(partialDataAcc.mean[0]));
+        data.read(reinterpret_cast<char*>(&partialDataAcc.M2[0]),
+                  size * sizeof(partialDataAcc.M2[0]));
+    }
+
+    if (partialLoaded > 0) {
+        data.read(reinterpret_cast<char*>(&mSize[0]),
+                  partialLoaded * sizeof(mSize[0]));
+        data.read(reinterpret_cast<char*>(&mValue[0]),
+                  partialLoaded * sizeof(mValue[0]));
+    }
+
+    if (!data.good())
+        throw std::runtime_error("Error reading partial file: " + fileName);
+
+    loaded = partialLoaded;
+    globalAcc = partialGlobalAcc;
+    dataAcc = partialDataAcc;
+    dataMismatch = partialDataMismatch;
+    return true;
+}
+
+void N2D2::StimuliData::savePartial(const std::string& fileName,
+                                    const StimuliList_T& stimuli,
+                                    unsigned int loaded,
+                                    const Accumulator& globalAcc,
+                                    const DataAccumulator& dataAcc,
+                                    bool dataMismatch) const
+{
+    // Write to a temporary file first, so that an interruption during the
+    // write does not corrupt the previous partial file
+    const std::string tmpFileName = fileName + ".tmp";
+
+    std::ofstream data(tmpFileName.c_str(), std::fstream::binary);
+
+    if (!data.good()) {
+        throw std::runtime_error("Could not create partial file: "
+                                 + tmpFileName);
+    }
+
+    const unsigned int nbStimuli = stimuli.size();
+    data.write(reinterpret_cast<const char*>(&nbStimuli), sizeof(nbStimuli));
+
+    if (nbStimuli > 0) {
+        data.write(reinterpret_cast<const char*>(&stimuli[0]),
+                   nbStimuli * sizeof(stimuli[0]));
+    }
+
+    data.write(reinterpret_cast<const char*>(&loaded), sizeof(loaded));
+    data.write(reinterpret_cast<const char*>(&globalAcc), sizeof(globalAcc));
+    data.write(reinterpret_cast<const char*>(&dataMismatch),
+               sizeof(dataMismatch));
+    data.write(reinterpret_cast<const char*>(&dataAcc.count),
+               sizeof(dataAcc.count));
+
+    const unsigned int dimsSize = dataAcc.dims.size();
+    data.write(reinterpret_cast<const char*>(&dimsSize), sizeof(dimsSize));
+
+    if (dimsSize > 0) {
+        data.write(reinterpret_cast<const char*>(&dataAcc.dims[0]),
+                   dimsSize * sizeof(dataAcc.dims[0]));
+        data.write(reinterpret_cast<const char*>(&dataAcc.mean[0]),
+                   dataAcc.mean.size() * sizeof(dataAcc.mean[0]));
+        data.write(reinterpret_cast<const char*>(&dataAcc.M2[0]),
+                   dataAcc.M2.size() * sizeof(dataAcc.M2[0]));
+    }
+
+    if (loaded > 0) {
+        data.write(reinterpret_cast<const char*>(&mSize[0]),
+                   loaded * sizeof(mSize[0]));
+        data.write(reinterpret_cast<const char*>(&mValue[0]),
+                   loaded * sizeof(mValue[0]));
+    }
+
+    if (!data.good()) {
+        throw std::runtime_error("Error writing partial file: "
+                                 + tmpFileName);
+    }
+
+    data.close();
+
+#ifdef WIN32
+    // std::rename() does not overwrite an existing file on Windows
+    std::remove(fileName.c_str());
+#endif
+
+    if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        throw std::runtime_error("Could not rename partial file: "
+                                 + tmpFileName);
+    }
+}
@@ -171,6 +171,21 @@ void N2D2::StimuliProvider::addOnTheFlyTransformation(
         mTransformations(*it).onTheFly.push_back(transformation);
 }
 
+void N2D2::StimuliProvider::addBatchAugmentation(
+    const std::shared_ptr<BatchAugmentation>& augmentation,
+    Database::StimuliSetMask setMask)
+{
+    const std::vector<Database::StimuliSet> stimuliSets
+        = mDatabase.getStimuliSets(setMask);
+
+    for (std::vector<Database::StimuliSet>::const_iterator it
+         = stimuliSets.begin(),
+         itEnd = stimuliSets.end();
+         it != itEnd;
+         ++it)
+        mTransformations(*it).batch.push_back(augmentation);
+}
+
 void N2D2::StimuliProvider::addChannelTransformation(
     const CompositeTransformation& transformation,
     Database::StimuliSetMask setMask)
@@ -549,6 +564,8 @@ void N2D2::StimuliProvider::readRandomBatch(Database::StimuliSet set)
         for (int batchPos = 0; batchPos < (int)mBatchSize; ++batchPos)
             readStimulus(batchRef[batchPos], set, batchPos);
     }
+
+    applyBatchAugmentations(set, mBatchSize);
 }
 
 N2D2::Database::StimulusID
@@ -585,6 +602,7 @@ void N2D2::StimuliProvider::readBatch(Database::StimuliSet set,
         readStimulus(batchRef[batchPos], set, batchPos);
 
     std::fill(batchRef.begin() + batchSize, batchRef.end(), -1);
+    applyBatchAugmentations(set, batchSize);
 }
 
 void N2D2::StimuliProvider::streamBatch(int startIndex) {
@@ -827,9 +845,21 @@ N2D2::Database::StimulusID N2D2::StimuliProvider::readStimulus(
 void N2D2::StimuliProvider::streamStimulus(const cv::Mat& mat,
                                            Database::StimuliSet set,
                                            unsigned int batchPos)
+{
+    streamStimulus(transformStimulus(mat, set), batchPos);
+}
+
+void N2D2::StimuliProvider::streamStimulus(const Tensor<Float_T>& data,
+                                           unsigned int batchPos)
 {
     TensorData_T& dataRef = (mFuture) ? mFutureData : mData;
+    dataRef[batchPos] = data;
+}
 
+N2D2::Tensor<N2D2::Float_T>
+N2D2::StimuliProvider::transformStimulus(const cv::Mat& mat,
+                                         Database::StimuliSet set)
+{
     // Apply global transformation
     cv::Mat rawData = mat.clone();
     mTransformations(set).cacheable.apply(rawData);
@@ -870,7 +900,7 @@ void N2D2::StimuliProvider::streamStimulus(const cv::Mat& mat,
         }
     }
 
-    dataRef[batchPos] = data;
+    return data;
 }
 
 void N2D2::StimuliProvider::reverseLabels(const cv::Mat& mat,
@@ -1679,32 +1709,113 @@ void N2D2::StimuliProvider::saveDataCache(const std::string& fileName,
         BinaryCvMat::write(os, *it);
 }
 
+void N2D2::StimuliProvider::applyBatchAugmentations(Database::StimuliSet set,
+                                                    unsigned int batchSize)
+{
+    const std::vector<std::shared_ptr<BatchAugmentation> >& augmentations
+        = mTransformations(set).batch;
+
+    if (augmentations.empty())
+        return;
+
+    TensorData_T& dataRef = (mFuture) ? mFutureData : mData;
+    Tensor<int>& labelsRef = (mFuture) ? mFutureLabelsData : mLabelsData;
+
+    for (std::vector<std::shared_ptr<BatchAugmentation> >::const_iterator it
+         = augmentations.begin(),
+         itEnd = augmentations.end();
+         it != itEnd;
+         ++it)
+        (*it)->apply(dataRef, labelsRef, batchSize);
+}
 
 #ifdef PYBIND
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <chrono>
+#include <functional>
+#include <future>
+
 namespace py = pybind11;
 
 namespace N2D2 {
+/**
+ * Handle on a batch read in the background into the future buffers of a
+ * StimuliProvider (see StimuliProvider::future()). wait() makes the batch
+ * the current one (see StimuliProvider::synchronize()); it is also called
+ * when the handle is destroyed. No other batch must be read until then.
+*/
+class StimuliProvider_Prefetch {
+public:
+    StimuliProvider_Prefetch(const std::shared_ptr<StimuliProvider>& sp,
+                             const std::function<void()>& read)
+        : mSp(sp)
+    {
+        mSp->future();
+        mRead = std::async(std::launch::async, read);
+    }
+
+    bool ready() const
+    {
+        return (!mRead.valid() || mRead.wait_for(std::chrono::seconds(0))
+                                    == std::future_status::ready);
+    }
+
+    void wait()
+    {
+        if (mRead.valid()) {
+            // Rethrows the read exception, if any
+            mRead.get();
+            mSp->synchronize();
+        }
+    }
+
+    ~StimuliProvider_Prefetch()
+    {
+        if (mRead.valid()) {
+            mRead.wait();
+            mSp->synchronize();
+        }
+    }
+
+private:
+    std::shared_ptr<StimuliProvider> mSp;
+    std::future<void> mRead;
+};
+
 void init_StimuliProvider(py::module &m) {
+    py::class_<StimuliProvider_Prefetch, std::shared_ptr<StimuliProvider_Prefetch>>(m, "StimuliProviderPrefetch")
+    .def("ready", &StimuliProvider_Prefetch::ready)
+    .def("wait", &StimuliProvider_Prefetch::wait, py::call_guard<py::gil_scoped_release>());
+
+    // Reading methods release the GIL, so that Python can run concurrently.
+    // getData(), getLabelsData() and getTargetData() return a reference to
+    // the batch tensors: numpy.asarray() on them is a view (no copy) that can
+    // be read or written in place, valid until the next synchronize().
     py::class_<StimuliProvider, std::shared_ptr<StimuliProvider>>(m, "StimuliProvider", py::multiple_inheritance())
     .def(py::init<Database&, const std::vector<size_t>&, unsigned int, bool>(), py::arg("database"), py::arg("size"), py::arg("batchSize") = 1, py::arg("compositeStimuli") = false)
     .def("cloneParameters", &StimuliProvider::cloneParameters)
     .def("logTransformations", &StimuliProvider::logTransformations, py::arg("fileName"))
     .def("future", &StimuliProvider::future)
     .def("synchronize", &StimuliProvider::synchronize)
+    .def("prefetchRandomBatch", [](std::shared_ptr<StimuliProvider> sp, Database::StimuliSet set) {
+        return std::make_shared<StimuliProvider_Prefetch>(sp, [sp, set]() { sp->readRandomBatch(set); });
+    }, py::arg("set"))
+    .def("prefetchBatch", [](std::shared_ptr<StimuliProvider> sp, Database::StimuliSet set, unsigned int startIndex) {
+        return std::make_shared<StimuliProvider_Prefetch>(sp, [sp, set, startIndex]() { sp->readBatch(set, startIndex); });
+    }, py::arg("set"), py::arg("startIndex") = 0)
     .def("getRandomIndex", &StimuliProvider::getRandomIndex, py::arg("set"))
     .def("getRandomID", &StimuliProvider::getRandomID, py::arg("set"))
-    .def("readRandomBatch", &StimuliProvider::readRandomBatch, py::arg("set"))
-    .def("readRandomStimulus", &StimuliProvider::readRandomStimulus, py::arg("set"), py::arg("batchPos") = 0)
-    .def("readBatch", &StimuliProvider::readBatch, py::arg("set"), py::arg("startIndex") = 0)
-    .def("streamBatch", &StimuliProvider::streamBatch, py::arg("startIndex") = -1)
-    .def("readStimulusBatch", &StimuliProvider::readStimulusBatch, py::arg("set"), py::arg("id"))
-    .def("readStimulus", (void (StimuliProvider::*)(Database::StimulusID, Database::StimuliSet, unsigned int)) &StimuliProvider::readStimulus, py::arg("id"), py::arg("set"), py::arg("batchPos") = 0)
-    .def("readStimulus", (Database::StimulusID (StimuliProvider::*)(Database::StimuliSet, unsigned int, unsigned int)) &StimuliProvider::readStimulus, py::arg("set"), py::arg("index"), py::arg("batchPos") = 0)
-    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimulusID) const) &StimuliProvider::readRawData, py::arg("id"))
-    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimuliSet, unsigned int) const) &StimuliProvider::readRawData, py::arg("set"), py::arg("index"))
+    .def("readRandomBatch", &StimuliProvider::readRandomBatch, py::arg("set"), py::call_guard<py::gil_scoped_release>())
+    .def("readRandomStimulus", &StimuliProvider::readRandomStimulus, py::arg("set"), py::arg("batchPos") = 0, py::call_guard<py::gil_scoped_release>())
+    .def("readBatch", &StimuliProvider::readBatch, py::arg("set"), py::arg("startIndex") = 0, py::call_guard<py::gil_scoped_release>())
+    .def("streamBatch", &StimuliProvider::streamBatch, py::arg("startIndex") = -1, py::call_guard<py::gil_scoped_release>())
+    .def("readStimulusBatch", &StimuliProvider::readStimulusBatch, py::arg("set"), py::arg("id"), py::call_guard<py::gil_scoped_release>())
+    .def("readStimulus", (void (StimuliProvider::*)(Database::StimulusID, Database::StimuliSet, unsigned int)) &StimuliProvider::readStimulus, py::arg("id"), py::arg("set"), py::arg("batchPos") = 0, py::call_guard<py::gil_scoped_release>())
+    .def("readStimulus", (Database::StimulusID (StimuliProvider::*)(Database::StimuliSet, unsigned int, unsigned int)) &StimuliProvider::readStimulus, py::arg("set"), py::arg("index"), py::arg("batchPos") = 0, py::call_guard<py::gil_scoped_release>())
+    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimulusID) const) &StimuliProvider::readRawData, py::arg("id"), py::call_guard<py::gil_scoped_release>())
+    .def("readRawData", (Tensor<Float_T> (StimuliProvider::*)(Database::StimuliSet, unsigned int) const) &StimuliProvider::readRawData, py::arg("set"), py::arg("index"), py::call_guard<py::gil_scoped_release>())
     .def("setBatchSize", &StimuliProvider::setBatchSize, py::arg("batchSize"))
     .def("setCachePath", &StimuliProvider::setCachePath, py::arg("path") = "")
     .def("getDatabase", (Database& (StimuliProvider::*)()) &StimuliProvider::getDatabase)
@@ -1721,8 +1832,9 @@ void init_StimuliProvider(py::module &m) {
     .def("getChannelTransformation", &StimuliProvider::getChannelTransformation, py::arg("channel"), py::arg("set"))
     .def("getChannelOnTheFlyTransformation", &StimuliProvider::getChannelOnTheFlyTransformation, py::arg("channel"), py::arg("set"))
     .def("getBatch", &StimuliProvider::getBatch)
-    .def("getData", (StimuliProvider::TensorData_T& (StimuliProvider::*)()) &StimuliProvider::getData)
-    .def("getLabelsData", (Tensor<int>& (StimuliProvider::*)()) &StimuliProvider::getLabelsData)
+    .def("getData", (StimuliProvider::TensorData_T& (StimuliProvider::*)()) &StimuliProvider::getData, py::return_value_policy::reference_internal)
+    .def("getLabelsData", (Tensor<int>& (StimuliProvider::*)()) &StimuliProvider::getLabelsData, py::return_value_policy::reference_internal)
+    .def("getTargetData", (StimuliProvider::TensorData_T& (StimuliProvider::*)()) &StimuliProvider::getTargetData, py::return_value_policy::reference_internal)
     .def("getLabelsROIs", (const std::vector<std::vector<std::shared_ptr<ROI> > >& (StimuliProvider::*)() const) &StimuliProvider::getLabelsROIs)
     .def("getData", (const StimuliProvider::TensorData_T (StimuliProvider::*)(unsigned int, unsigned int) const) &StimuliProvider::getData, py::arg("channel"), py::arg("batchPos") = 0)
     .def("getLabelsData", (const Tensor<int> (StimuliProvider::*)(unsigned int, unsigned int) const) &StimuliProvider::getLabelsData, py::arg("channel"), py::arg("batchPos") = 0)
@@ -23,6 +23,9 @@
 #include "Cell/Cell.hpp"
 #include "Cell/Cell_Frame_Top.hpp"
 #include "Cell/Cell_CSpike_Top.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 N2D2::Registrar<N2D2::Target>
 N2D2::TargetScore::mRegistrar("TargetScore", N2D2::TargetScore::create);
@@ -446,6 +449,10 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
 
         mBatchSuccess.assign(values.dimB(), -1.0);
 
+        const unsigned int quantSteps = mConfusionQuantSteps;
+        const size_t shardSize = confusionMatrix.size() + 1;
+        getConfusionShard(shardSize);
+
 #pragma omp parallel for if (values.dimB() > 4 && values[0].size() > 1)
         for (int batchPos = 0; batchPos < (int)values.dimB(); ++batchPos) {
             const int id = mStimuliProvider->getBatch()[batchPos];
@@ -459,8 +466,8 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
             const Tensor<Float_T> target = mStimuliProvider->getTargetData()[batchPos];
             const Tensor<Float_T> estimated = values[batchPos];
 
-            ConfusionMatrix<unsigned long long int> confusion(
-                mConfusionQuantSteps, mConfusionQuantSteps, 0);
+            std::vector<unsigned long long int>& confusion
+                = getConfusionShard(shardSize);
 
             double mse = 0.0;
 
@@ -469,30 +476,26 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
                 mse += err * err;
 
                 const unsigned int t = Utils::clamp<unsigned int>(
-                    Utils::round((mConfusionQuantSteps - 1)
+                    Utils::round((quantSteps - 1)
                         * (target(index) - mConfusionRangeMin)
                             / (double)(mConfusionRangeMax - mConfusionRangeMin)),
-                    0U, mConfusionQuantSteps - 1);
+                    0U, quantSteps - 1);
                 const unsigned int e = Utils::clamp<unsigned int>(
-                    Utils::round((mConfusionQuantSteps - 1)
+                    Utils::round((quantSteps - 1)
                         * (estimated(index) - mConfusionRangeMin)
                             / (double)(mConfusionRangeMax - mConfusionRangeMin)),
-                    0U, mConfusionQuantSteps - 1);
+                    0U, quantSteps - 1);
 
-                confusion(t, e) += 1ULL;
+                ++confusion[t * quantSteps + e];
             }
 
             if (target.size() > 0)
                 mse /= target.size();
 
             mBatchSuccess[batchPos] = mse;
-
-#pragma omp critical(TargetScore__process)
-            std::transform(confusionMatrix.begin(), confusionMatrix.end(),
-                        confusion.begin(),
-                        confusionMatrix.begin(),
-                        std::plus<unsigned long long int>());
         }
+
+        reduceConfusionShards(confusionMatrix);
     }
     else {
         const unsigned int nbTargets = getNbTargets();
@@ -513,6 +516,12 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
         if (mTargetTopN > 1)
             mBatchTopNSuccess.assign(mTargets.dimB(), -1.0);
 
+        const size_t shardSize = confusionMatrix.size() + 1;
+        getConfusionShard(shardSize);
+
+        // Estimated label of each misclassified batch position (or -1)
+        std::vector<int> batchMisclassified(mTargets.dimB(), -1);
+
 #pragma omp parallel for if (mTargets.dimB() > 4 && mTargets[0].size() > 1)
         for (int batchPos = 0; batchPos < (int)mTargets.dimB(); ++batchPos) {
             const int id = mStimuliProvider->getBatch()[batchPos];
@@ -526,18 +535,17 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
             const Tensor<int> target = mTargets[batchPos];
             const Tensor<int> estimatedLabels = mEstimatedLabels[batchPos];
 
+            std::vector<unsigned long long int>& confusion
+                = getConfusionShard(shardSize);
+
             if (target.size() == 1) {
                 if (target(0) >= 0) {
-#pragma omp atomic
-                    confusionMatrix(target(0), estimatedLabels(0)) += 1ULL;
+                    ++confusion[target(0) * nbTargets + estimatedLabels(0)];
 
                     mBatchSuccess[batchPos] = (estimatedLabels(0) == target(0));
 
-                    if (!mBatchSuccess[batchPos]) {
-#pragma omp critical(TargetScore__process)
-                        misclassified.push_back(
-                            std::make_pair(id, estimatedLabels(0)));
-                    }
+                    if (!mBatchSuccess[batchPos])
+                        batchMisclassified[batchPos] = estimatedLabels(0);
 
                     // Top-N case :
                     if (mTargetTopN > 1) {
@@ -552,39 +560,37 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
                     }
                 }
             } else {
-                ConfusionMatrix<unsigned long long int> confusion(nbTargets,
-                                                                nbTargets,
-                                                                0);
-
-                std::vector<unsigned int> nbHits(nbTargets, 0);
+                // The last entry counts the ignored targets
+                std::vector<unsigned int> nbHits(nbTargets + 1, 0);
                 std::vector<unsigned int> nbHitsTopN(nbTargets, 0);
-                std::vector<unsigned int> nbLabels(nbTargets, 0);
-
-                for (unsigned int oy = 0; oy < mTargets.dimY(); ++oy) {
-                    for (unsigned int ox = 0; ox < mTargets.dimX(); ++ox) {
-                        if (target(ox, oy, 0) >= 0) {
-                            confusion(target(ox, oy, 0),
-                                            estimatedLabels(ox, oy, 0)) += 1;
-
-                            ++nbLabels[target(ox, oy, 0)];
-
-                            if (target(ox, oy, 0)
-                                == (int)estimatedLabels(ox, oy, 0))
-                                ++nbHits[target(ox, oy, 0)];
-
-                            // Top-N case :
-                            if (mTargetTopN > 1) {
-                                unsigned int topNscore = 0;
+                std::vector<unsigned int> nbLabels(nbTargets + 1, 0);
+
+                // First plane of the estimated labels is the top-1
+                labelPairHistogram(&target(0),
+                                   &estimatedLabels(0),
+                                   mTargets.dimX() * mTargets.dimY(),
+                                   nbTargets,
+                                   &confusion[0],
+                                   &nbLabels[0],
+                                   &nbHits[0]);
+
+                // Top-N case :
+                if (mTargetTopN > 1) {
+                    for (unsigned int oy = 0; oy < mTargets.dimY(); ++oy) {
+                        for (unsigned int ox = 0; ox < mTargets.dimX(); ++ox) {
+                            if (target(ox, oy, 0) < 0)
+                                continue;
 
-                                for (unsigned int n = 0; n < mTargetTopN; ++n) {
-                                    if (estimatedLabels(ox, oy, n)
-                                        == target(ox, oy, 0))
-                                        ++topNscore;
-                                }
+                            unsigned int topNscore = 0;
 
-                                if (topNscore > 0)
-                                    ++nbHitsTopN[target(ox, oy, 0)];
+                            for (unsigned int n = 0; n < mTargetTopN; ++n) {
+                                if (estimatedLabels(ox, oy, n)
+                                    == target(ox, oy, 0))
+                                    ++topNscore;
                             }
+
+                            if (topNscore > 0)
+                                ++nbHitsTopN[target(ox, oy, 0)];
                         }
                     }
                 }
@@ -608,12 +614,18 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
                     mBatchTopNSuccess[batchPos] = (nbValidTargets > 0) ?
                         (successTopN / nbValidTargets) : 1.0;
                 }
+            }
+        }
+
+        reduceConfusionShards(confusionMatrix);
 
-#pragma omp critical(TargetScore__process)
-                std::transform(confusionMatrix.begin(), confusionMatrix.end(),
-                            confusion.begin(),
-                            confusionMatrix.begin(),
-                            std::plus<unsigned long long int>());
+        for (unsigned int batchPos = 0; batchPos < mTargets.dimB();
+            ++batchPos)
+        {
+            if (batchMisclassified[batchPos] >= 0) {
+                misclassified.push_back(std::make_pair(
+                    mStimuliProvider->getBatch()[batchPos],
+                    batchMisclassified[batchPos]));
             }
         }
     }
@@ -628,6 +640,90 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
     }
 }
 
+void N2D2::TargetScore::labelPairHistogram(const int* target,
+                                          const int* estimated,
+                                          size_t size,
+                                          unsigned int nbTargets,
+                                          unsigned long long int* histogram,
+                                          unsigned int* nbLabels,
+                                          unsigned int* nbHits)
+{
+    const unsigned int ignoredPair = nbTargets * nbTargets;
+    const size_t blockSize = 256;
+
+    unsigned int pairs[blockSize];
+    unsigned int labels[blockSize];
+    unsigned int hits[blockSize];
+
+    for (size_t offset = 0; offset < size; offset += blockSize) {
+        const size_t blockEnd = std::min(size - offset, blockSize);
+
+        // Branchless bin computation, which can be vectorized
+        for (size_t i = 0; i < blockEnd; ++i) {
+            const int t = target[offset + i];
+            const int e = estimated[offset + i];
+            const bool valid = (t >= 0);
+
+            pairs[i] = (valid) ? (t * nbTargets + e) : ignoredPair;
+            labels[i] = (valid) ? t : nbTargets;
+            hits[i] = (valid && t == e) ? t : nbTargets;
+        }
+
+        for (size_t i = 0; i < blockEnd; ++i) {
+            ++histogram[pairs[i]];
+            ++nbLabels[labels[i]];
+            ++nbHits[hits[i]];
+        }
+    }
+}
+
+std::vector<unsigned long long int>&
+N2D2::TargetScore::getConfusionShard(size_t size)
+{
+#ifdef _OPENMP
+    if (omp_in_parallel())
+        return mConfusionShards[omp_get_thread_num()];
+
+    const unsigned int nbThreads = omp_get_max_threads();
+#else
+    const unsigned int nbThreads = 1;
+#endif
+
+    // Called outside the parallel region first: allocate the shards, which
+    // are kept between batches
+    mConfusionShards.resize(nbThreads);
+
+    for (unsigned int i = 0; i < nbThreads; ++i) {
+        if (mConfusionShards[i].size() != size)
+            mConfusionShards[i].assign(size, 0ULL);
+    }
+
+    return mConfusionShards[0];
+}
+
+void N2D2::TargetScore::reduceConfusionShards(
+    ConfusionMatrix<unsigned long long int>& confusionMatrix)
+{
+    const int size = confusionMatrix.size();
+    const unsigned int nbShards = mConfusionShards.size();
+
+#pragma omp parallel for if (size > 4096)
+    for (int index = 0; index < size; ++index) {
+        unsigned long long int sum = 0ULL;
+
+        for (unsigned int i = 0; i < nbShards; ++i) {
+            sum += mConfusionShards[i][index];
+            mConfusionShards[i][index] = 0ULL;
+        }
+
+        confusionMatrix(index) += sum;
+    }
+
+    // Reset the ignored pairs bin
+    for (unsigned int i = 0; i < nbShards; ++i)
+        mConfusionShards[i][size] = 0ULL;
+}
+
 void N2D2::TargetScore::correctLastBatch(
     std::vector<double>& batchSuccess,
     const std::deque<double>& success)
@@ -0,0 +1,189 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Transformation/BatchAugmentation.hpp"
+#include "utils/Random.hpp"
+
+N2D2::BatchAugmentation::BatchAugmentation()
+    : mRandomHorizontalFlip(this, "RandomHorizontalFlip", false),
+      mRandomVerticalFlip(this, "RandomVerticalFlip", false),
+      mRandomShift(this, "RandomShift", 0U),
+      mBrightness(this, "Brightness", 0.0),
+      mContrast(this, "Contrast", 0.0),
+      mCutoutSize(this, "CutoutSize", 0U),
+      mCutoutProbability(this, "CutoutProbability", 1.0)
+{
+    // ctor
+}
+
+void N2D2::BatchAugmentation::apply(Tensor<Float_T>& data,
+                                    Tensor<int>& labels,
+                                    unsigned int batchSize) const
+{
+    if (data.nbDims() < 3)
+        return;
+
+    if (batchSize == 0)
+        batchSize = data.dimB();
+
+    const unsigned int dimX = data.dims()[0];
+    const unsigned int dimY = data.dims()[1];
+    const unsigned int planeSize = dimX * dimY;
+    const unsigned int nbChannels = data.size() / data.dimB() / planeSize;
+
+    // Draw the parameters of all the stimuli first, in a deterministic order
+    std::vector<SampleParams> params(batchSize);
+
+    for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        SampleParams& sp = params[batchPos];
+        sp.horizontalFlip = (mRandomHorizontalFlip)
+            ? Random::randBernoulli() : false;
+        sp.verticalFlip = (mRandomVerticalFlip)
+            ? Random::randBernoulli() : false;
+        sp.shiftX = (mRandomShift > 0)
+            ? Random::randUniform(-(int)mRandomShift, (int)mRandomShift) : 0;
+        sp.shiftY = (mRandomShift > 0)
+            ? Random::randUniform(-(int)mRandomShift, (int)mRandomShift) : 0;
+        sp.contrast = (mContrast > 0.0)
+            ? Random::randUniform(1.0 - mContrast, 1.0 + mContrast) : 1.0;
+        sp.brightness = (mBrightness > 0.0)
+            ? Random::randUniform(-mBrightness, mBrightness) : 0.0;
+        sp.cutout = (mCutoutSize > 0
+                     && Random::randBernoulli(mCutoutProbability));
+        sp.cutoutX = (sp.cutout) ? Random::randUniform(0, (int)dimX - 1) : 0;
+        sp.cutoutY = (sp.cutout) ? Random::randUniform(0, (int)dimY - 1) : 0;
+    }
+
+    const bool geometric = (mRandomHorizontalFlip || mRandomVerticalFlip
+                            || mRandomShift > 0);
+    const bool spatialLabels = (labels.nbDims() >= 3
+                                && labels.dims()[0] == dimX
+                                && labels.dims()[1] == dimY);
+    const int halfCutout = mCutoutSize / 2;
+
+#pragma omp parallel for collapse(2) if (batchSize * nbChannels > 1)
+    for (int batchPos = 0; batchPos < (int)batchSize; ++batchPos) {
+        for (int channel = 0; channel < (int)nbChannels; ++channel) {
+            const SampleParams& sp = params[batchPos];
+            Float_T* plane = &data(0) + (batchPos * nbChannels + channel)
+                                        * planeSize;
+
+            if (geometric)
+                applyGeometric<Float_T>(plane, dimX, dimY, sp, 0.0);
+
+            if (sp.contrast != 1.0 || sp.brightness != 0.0) {
+                Float_T mean = 0.0;
+
+                if (sp.contrast != 1.0) {
+                    mean = std::accumulate(plane, plane + planeSize, Float_T())
+                           / planeSize;
+                }
+
+                // y = contrast * (x - mean) + mean + brightness
+                const Float_T shift = (1.0 - sp.contrast) * mean
+                                      + sp.brightness;
+
+                for (unsigned int i = 0; i < planeSize; ++i)
+                    plane[i] = sp.contrast * plane[i] + shift;
+            }
+
+            if (sp.cutout) {
+                const int yStart = std::max(0, sp.cutoutY - halfCutout);
+                const int yStop = std::min((int)dimY,
+                                     sp.cutoutY - halfCutout + (int)mCutoutSize);
+                const int xStart = std::max(0, sp.cutoutX - halfCutout);
+                const int xStop = std::min((int)dimX,
+                                     sp.cutoutX - halfCutout + (int)mCutoutSize);
+
+                for (int y = yStart; y < yStop; ++y) {
+                    std::fill(plane + y * dimX + xStart,
+                              plane + y * dimX + xStop,
+                              0.0);
+                }
+            }
+        }
+    }
+
+    if (geometric && spatialLabels) {
+        const unsigned int nbLabelsChannels = labels.size() / labels.dimB()
+                                              / planeSize;
+
+#pragma omp parallel for collapse(2) if (batchSize * nbLabelsChannels > 1)
+        for (int batchPos = 0; batchPos < (int)batchSize; ++batchPos) {
+            for (int channel = 0; channel < (int)nbLabelsChannels; ++channel) {
+                int* plane = &labels(0) + (batchPos * nbLabelsChannels
+                                           + channel) * planeSize;
+
+                // Label -1 is ignored for the learning
+                applyGeometric<int>(plane, dimX, dimY, params[batchPos], -1);
+            }
+        }
+    }
+}
+
+template <class T>
+void N2D2::BatchAugmentation::applyGeometric(T* plane,
+                                             unsigned int dimX,
+                                             unsigned int dimY,
+                                             const SampleParams& params,
+                                             T fillValue) const
+{
+    if (params.horizontalFlip) {
+        for (unsigned int y = 0; y < dimY; ++y)
+            std::reverse(plane + y * dimX, plane + (y + 1) * dimX);
+    }
+
+    if (params.verticalFlip) {
+        for (unsigned int y = 0; y < dimY / 2; ++y) {
+            std::swap_ranges(plane + y * dimX,
+                             plane + (y + 1) * dimX,
+                             plane + (dimY - 1 - y) * dimX);
+        }
+    }
+
+    if (params.shiftX == 0 && params.shiftY == 0)
+        return;
+
+    // In-place shift: out(x, y) = in(x - shiftX, y - shiftY). The iteration
+    // order ensures that a source pixel is read before being overwritten.
+    const int dx = params.shiftX;
+    const int dy = params.shiftY;
+
+    for (int j = 0; j < (int)dimY; ++j) {
+        const int y = (dy > 0) ? (int)dimY - 1 - j : j;
+        const int srcY = y - dy;
+        T* row = plane + y * dimX;
+
+        if (srcY < 0 || srcY >= (int)dimY) {
+            std::fill(row, row + dimX, fillValue);
+            continue;
+        }
+
+        const T* srcRow = plane + srcY * dimX;
+
+        for (int i = 0; i < (int)dimX; ++i) {
+            const int x = (dx > 0) ? (int)dimX - 1 - i : i;
+            const int srcX = x - dx;
+
+            row[x] = (srcX >= 0 && srcX < (int)dimX) ? srcRow[srcX]
+                                                     : fillValue;
+        }
+    }
+}
@@ -18,6 +18,211 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include "Transformation/ChannelExtractionTransformation.hpp"
 #include "Transformation/CompositeTransformation.hpp"
+#include "Transformation/RangeAffineTransformation.hpp"
+#include "FloatT.hpp"
 
 const char* N2D2::CompositeTransformation::Type = "Composite";
+
+namespace {
+/// Per-channel affine transformation y = scale * x + shift, in a single pass,
+/// resulting from the fusion of consecutive RangeAffineTransformation. It can
+/// be preceded by the extraction of a single BGR channel (Blue, Green or Red
+/// ChannelExtractionTransformation), which is then done in the same step.
+class FusedAffineTransformation : public N2D2::Transformation {
+public:
+    using Transformation::apply;
+
+    FusedAffineTransformation(const std::vector<double>& scale,
+                              const std::vector<double>& shift,
+                              int channel = -1)
+        : mScale(scale), mShift(shift), mChannel(channel)
+    {
+    }
+    const char* getType() const
+    {
+        return N2D2::RangeAffineTransformation::Type;
+    };
+    void apply(cv::Mat& frame,
+               cv::Mat& /*labels*/,
+               std::vector<std::shared_ptr<N2D2::ROI> >& /*labelsROI*/,
+               int /*id*/ = -1)
+    {
+        const int depth = N2D2::opencv_data_type<N2D2::Float_T>::value;
+        cv::Mat frameF;
+
+        // As ChannelExtractionTransformation, single channel frames are left
+        // unchanged
+        if (mChannel >= 0 && frame.channels() > 1) {
+            // Only the extracted channel is copied (no split of the frame)
+            cv::Mat channel(frame.rows, frame.cols, frame.depth());
+            const int fromTo[] = {mChannel, 0};
+            cv::mixChannels(&frame, 1, &channel, 1, fromTo, 1);
+            frame = channel;
+        }
+
+        if (mScale.size() == 1) {
+            // Conversion and affine transformation in the same pass
+            frame.convertTo(frameF, depth, mScale[0], mShift[0]);
+            frame = frameF;
+            return;
+        }
+
+        const int nbChannels = frame.channels();
+
+        if ((int)mScale.size() != nbChannels) {
+            throw std::runtime_error("RangeAffineTransformation::apply(): the "
+                                     "number of values must be 1 or match the "
+                                     "number of image channels.");
+        }
+
+        frame.convertTo(frameF, depth);
+
+        // The interleaved coefficients of a row are expanded in a per-thread
+        // scratch buffer, reused between calls, so that the inner loop is a
+        // plain vectorizable multiply-add
+        const int rowSize = frameF.cols * nbChannels;
+        static thread_local std::vector<N2D2::Float_T> rowScale;
+        static thread_local std::vector<N2D2::Float_T> rowShift;
+
+        rowScale.resize(rowSize);
+        rowShift.resize(rowSize);
+
+        for (int j = 0; j < rowSize; ++j) {
+            rowScale[j] = mScale[j % nbChannels];
+            rowShift[j] = mShift[j % nbChannels];
+        }
+
+        const N2D2::Float_T* scale = &rowScale[0];
+        const N2D2::Float_T* shift = &rowShift[0];
+
+        for (int i = 0; i < frameF.rows; ++i) {
+            N2D2::Float_T* rowPtr = frameF.ptr<N2D2::Float_T>(i);
+
+            for (int j = 0; j < rowSize; ++j)
+                rowPtr[j] = rowPtr[j] * scale[j] + shift[j];
+        }
+
+        frame = frameF;
+    }
+
+private:
+    virtual FusedAffineTransformation* doClone() const
+    {
+        return new FusedAffineTransformation(*this);
+    }
+
+    const std::vector<double> mScale;
+    const std::vector<double> mShift;
+    /// BGR channel to extract first (-1 if none)
+    const int mChannel;
+};
+
+/// Index of the BGR channel extracted by @p transformation, or -1 if it is not
+/// a plain channel extraction
+int getExtractedChannel(const std::shared_ptr<N2D2::Transformation>&
+                        transformation)
+{
+    const std::shared_ptr<N2D2::ChannelExtractionTransformation> extraction
+        = std::dynamic_pointer_cast<N2D2::ChannelExtractionTransformation>(
+            transformation);
+
+    if (!extraction)
+        return -1;
+
+    switch (extraction->getChannel()) {
+    case N2D2::ChannelExtractionTransformation::Blue:
+        return 0;
+    case N2D2::ChannelExtractionTransformation::Green:
+        return 1;
+    case N2D2::ChannelExtractionTransformation::Red:
+        return 2;
+    default:
+        // Color space conversions are not fused
+        return -1;
+    }
+}
+}
+
+void N2D2::CompositeTransformation::compile()
+{
+    mCompiledSet.clear();
+
+    // Pending channel extraction, fused only if followed by an affine step
+    std::shared_ptr<Transformation> extraction;
+    int channel = -1;
+    std::vector<double> scale;
+    std::vector<double> shift;
+
+    for (std::vector<std::shared_ptr<Transformation> >::const_iterator it
+         = mTransformationSet.begin(),
+         itEnd = mTransformationSet.end();
+         it != itEnd;
+         ++it) {
+        const std::shared_ptr<RangeAffineTransformation> rangeAffine
+            = std::dynamic_pointer_cast<RangeAffineTransformation>(*it);
+
+        if (rangeAffine) {
+            std::vector<double> stepScale;
+            std::vector<double> stepShift;
+            rangeAffine->getAffine(stepScale, stepShift);
+
+            if (scale.empty()) {
+                // After a channel extraction, the frame has a single channel
+                if (!extraction || stepScale.size() == 1) {
+                    scale.swap(stepScale);
+                    shift.swap(stepShift);
+                    extraction.reset();
+                    continue;
+                }
+            } else if ((scale.size() == 1 || stepScale.size() == 1
+                        || scale.size() == stepScale.size())
+                       && (channel < 0 || stepScale.size() == 1)) {
+                // Compose with the previous affine transformations
+                const unsigned int size = std::max(scale.size(),
+                                                   stepScale.size());
+
+                scale.resize(size, scale.back());
+                shift.resize(size, shift.back());
+                stepScale.resize(size, stepScale.back());
+                stepShift.resize(size, stepShift.back());
+
+                for (unsigned int ch = 0; ch < size; ++ch) {
+                    scale[ch] *= stepScale[ch];
+                    shift[ch] = shift[ch] * stepScale[ch] + stepShift[ch];
+                }
+
+                continue;
+            }
+        }
+
+        if (!scale.empty()) {
+            mCompiledSet.push_back(std::make_shared
+                <FusedAffineTransformation>(scale, shift, channel));
+            scale.clear();
+            shift.clear();
+        }
+        else if (extraction)
+            mCompiledSet.push_back(extraction);
+
+        extraction.reset();
+        channel = getExtractedChannel(*it);
+
+        if (rangeAffine) {
+            rangeAffine->getAffine(scale, shift);
+            channel = -1;
+        }
+        else if (channel >= 0)
+            extraction = *it;
+        else
+            mCompiledSet.push_back(*it);
+    }
+
+    if (!scale.empty()) {
+        mCompiledSet.push_back(
+            std::make_shared<FusedAffineTransformation>(scale, shift, channel));
+    }
+    else if (extraction)
+        mCompiledSet.push_back(extraction);
+}
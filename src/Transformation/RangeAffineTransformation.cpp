@@ -74,6 +74,17 @@ N2D2::RangeAffineTransformation::apply(cv::Mat& frame,
                                  "channels.");
     }
 
+    if (mFirstValue.size() <= 1 && mSecondValue.size() <= 1) {
+        // Same values for all the channels: no need to split the channels
+        applyOperator(frameF, mFirstOperator, mFirstValue[0]);
+
+        if (!mSecondValue.empty())
+            applyOperator(frameF, mSecondOperator, mSecondValue[0]);
+
+        frame = frameF;
+        return;
+    }
+
     std::vector<cv::Mat> channels;
     cv::split(frameF, channels);
 
@@ -101,10 +112,10 @@ void N2D2::RangeAffineTransformation::applyOperator(
 {
     switch (op) {
     case Plus:
-        mat += value;
+        mat += cv::Scalar::all(value);
         break;
     case Minus:
-        mat -= value;
+        mat -= cv::Scalar::all(value);
         break;
     case Multiplies:
         mat *= value;
@@ -114,3 +125,50 @@ void N2D2::RangeAffineTransformation::applyOperator(
         break;
     }
 }
+
+void N2D2::RangeAffineTransformation::getAffine(std::vector<double>& scale,
+                                                std::vector<double>& shift)
+    const
+{
+    const unsigned int size = std::max(mFirstValue.size(),
+                                       mSecondValue.size());
+
+    scale.assign(size, 1.0);
+    shift.assign(size, 0.0);
+
+    for (unsigned int ch = 0; ch < size; ++ch) {
+        applyOperator(scale[ch], shift[ch], mFirstOperator,
+                      (mFirstValue.size() > 1) ? mFirstValue[ch]
+                                               : mFirstValue[0]);
+
+        if (!mSecondValue.empty()) {
+            applyOperator(scale[ch], shift[ch], mSecondOperator,
+                          (mSecondValue.size() > 1) ? mSecondValue[ch]
+                                                    : mSecondValue[0]);
+        }
+    }
+}
+
+void N2D2::RangeAffineTransformation::applyOperator(
+    double& scale,
+    double& shift,
+    const Operator& op,
+    double value)
+{
+    switch (op) {
+    case Plus:
+        shift += value;
+        break;
+    case Minus:
+        shift -= value;
+        break;
+    case Multiplies:
+        scale *= value;
+        shift *= value;
+        break;
+    case Divides:
+        scale /= value;
+        shift /= value;
+        break;
+    }
+}
@@ -0,0 +1,419 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "VideoPipeline.hpp"
+#include "utils/Utils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+
+#include <dirent.h>
+// For the Windows version of dirent.h (http://www.softagalleria.net/dirent.php)
+#undef min
+#undef max
+
+unsigned int N2D2::VideoPipeline::FrameQueue::push(
+    const std::shared_ptr<Frame>& frame)
+{
+    unsigned int nbDropped = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        if (mDropPolicy == DropOldest) {
+            if (mFrames.size() >= mCapacity && !mFrames.empty()) {
+                mFrames.pop_front();
+                ++nbDropped;
+            }
+        } else {
+            mCondition.wait(lock, [this]() {
+                return (mClosed || mFrames.size() < mCapacity);
+            });
+        }
+
+        mFrames.push_back(frame);
+    }
+
+    mCondition.notify_all();
+    return nbDropped;
+}
+
+std::shared_ptr<N2D2::VideoPipeline::Frame>
+N2D2::VideoPipeline::FrameQueue::pop()
+{
+    std::shared_ptr<Frame> frame;
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]() {
+            return (mClosed || !mFrames.empty());
+        });
+
+        if (mFrames.empty())
+            return frame;
+
+        frame = mFrames.front();
+        mFrames.pop_front();
+    }
+
+    mCondition.notify_all();
+    return frame;
+}
+
+void N2D2::VideoPipeline::FrameQueue::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+    }
+
+    mCondition.notify_all();
+}
+
+double N2D2::VideoPipeline::StageStats::getLatencyPercentile(double percentile)
+    const
+{
+    const std::vector<std::size_t>& bins = latency.getBins();
+    const double threshold = percentile * nbFrames;
+    double cumCount = 0.0;
+
+    for (std::size_t bin = 0; bin < bins.size(); ++bin) {
+        cumCount += bins[bin];
+
+        if (cumCount >= threshold && cumCount > 0.0)
+            return latency.getBinValue(bin) + latency.getBinWidth() / 2.0;
+    }
+
+    return 0.0;
+}
+
+N2D2::VideoPipeline::VideoPipeline(const Source_T& source,
+                                   std::size_t queueSize,
+                                   DropPolicy dropPolicy)
+    : mSource(source),
+      mQueueSize(queueSize),
+      mDropPolicy(dropPolicy),
+      mStop(false)
+{
+    // ctor
+    if (queueSize == 0)
+        throw std::runtime_error("VideoPipeline: queue size must be > 0");
+
+    mEndToEndStats.name = "end-to-end";
+}
+
+void N2D2::VideoPipeline::addStage(const std::string& name,
+                                   const Stage_T& stage)
+{
+    mStages.push_back(std::make_pair(name, stage));
+
+    StageStats stats;
+    stats.name = name;
+    mStats.push_back(stats);
+}
+
+void N2D2::VideoPipeline::run()
+{
+    if (mStages.empty())
+        throw std::runtime_error("VideoPipeline::run(): no stage");
+
+    // Only the first queue (after capture) may drop frames: once a frame is
+    // captured and accepted, it goes through the whole pipeline
+    mQueues.clear();
+
+    for (std::size_t i = 0; i < mStages.size(); ++i) {
+        mQueues.push_back(std::make_shared<FrameQueue>(mQueueSize,
+            (i == 0) ? mDropPolicy : Block));
+    }
+
+    mStop = false;
+    mStartTime = Clock_T::now();
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < mStages.size(); ++i)
+        threads.push_back(std::thread(&VideoPipeline::runStage, this, i));
+
+    std::exception_ptr error;
+
+    try {
+        capture();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+
+    mQueues[0]->close();
+
+    for (std::vector<std::thread>::iterator it = threads.begin(),
+         itEnd = threads.end(); it != itEnd; ++it)
+    {
+        (*it).join();
+    }
+
+    mEndTime = Clock_T::now();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void N2D2::VideoPipeline::stop()
+{
+    mStop = true;
+}
+
+void N2D2::VideoPipeline::capture()
+{
+    unsigned long long index = 0;
+
+    while (!mStop) {
+        std::shared_ptr<Frame> frame = std::make_shared<Frame>();
+        frame->captureTime = Clock_T::now();
+
+        if (!mSource(frame->image))
+            break;
+
+        frame->index = index;
+        ++index;
+
+        const unsigned int nbDropped = mQueues[0]->push(frame);
+
+        if (nbDropped > 0) {
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            mStats[0].nbDropped += nbDropped;
+        }
+    }
+}
+
+void N2D2::VideoPipeline::runStage(std::size_t index)
+{
+    std::shared_ptr<FrameQueue> input = mQueues[index];
+    std::shared_ptr<FrameQueue> output = (index + 1 < mQueues.size())
+        ? mQueues[index + 1] : std::shared_ptr<FrameQueue>();
+
+    while (true) {
+        const std::shared_ptr<Frame> frame = input->pop();
+
+        if (!frame)
+            break;  // End of stream
+
+        const Clock_T::time_point start = Clock_T::now();
+
+        try {
+            mStages[index].second(*frame);
+        }
+        catch (const std::exception& e) {
+            std::cout << Utils::cwarning << "VideoPipeline: stage \""
+                << mStages[index].first << "\" failed on frame #"
+                << frame->index << ": " << e.what() << Utils::cdef
+                << std::endl;
+
+            // Skip this frame for the next stages
+            continue;
+        }
+
+        const Clock_T::time_point end = Clock_T::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mStatsMutex);
+            recordLatency(mStats[index], start, end);
+
+            if (!output)
+                recordLatency(mEndToEndStats, frame->captureTime, end);
+        }
+
+        if (output)
+            output->push(frame);
+    }
+
+    if (output)
+        output->close();
+}
+
+void N2D2::VideoPipeline::recordLatency(StageStats& stats,
+                                        const Clock_T::time_point& start,
+                                        const Clock_T::time_point& end)
+{
+    const double latency = std::chrono::duration_cast
+        <std::chrono::duration<double> >(end - start).count();
+
+    stats.latency.enlarge(latency, false);
+    stats.latency(latency);
+    stats.latencySum += latency;
+    ++stats.nbFrames;
+}
+
+std::vector<N2D2::VideoPipeline::StageStats>
+N2D2::VideoPipeline::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mStats;
+}
+
+N2D2::VideoPipeline::StageStats N2D2::VideoPipeline::getEndToEndStats() const
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    return mEndToEndStats;
+}
+
+double N2D2::VideoPipeline::getFps() const
+{
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+
+    const double elapsed = std::chrono::duration_cast
+        <std::chrono::duration<double> >(
+            ((mEndTime > mStartTime) ? mEndTime : Clock_T::now())
+                - mStartTime).count();
+
+    return (elapsed > 0.0) ? mEndToEndStats.nbFrames / elapsed : 0.0;
+}
+
+void N2D2::VideoPipeline::logStats(std::ostream& os) const
+{
+    std::vector<StageStats> stats = getStats();
+    stats.push_back(getEndToEndStats());
+
+    os << std::setw(16) << "stage" << std::setw(10) << "frames"
+        << std::setw(10) << "dropped" << std::setw(12) << "mean [ms]"
+        << std::setw(12) << "p50 [ms]" << std::setw(12) << "p95 [ms]"
+        << std::setw(12) << "p99 [ms]" << "\n";
+
+    for (std::vector<StageStats>::const_iterator it = stats.begin(),
+         itEnd = stats.end(); it != itEnd; ++it)
+    {
+        const double mean = ((*it).nbFrames > 0)
+            ? (*it).latencySum / (*it).nbFrames : 0.0;
+
+        os << std::setw(16) << (*it).name
+            << std::setw(10) << (*it).nbFrames
+            << std::setw(10) << (*it).nbDropped
+            << std::fixed << std::setprecision(2)
+            << std::setw(12) << 1.0e3 * mean
+            << std::setw(12) << 1.0e3 * (*it).getLatencyPercentile(0.50)
+            << std::setw(12) << 1.0e3 * (*it).getLatencyPercentile(0.95)
+            << std::setw(12) << 1.0e3 * (*it).getLatencyPercentile(0.99)
+            << "\n";
+    }
+
+    os << "End-to-end: " << std::fixed << std::setprecision(2) << getFps()
+        << " fps" << std::endl;
+}
+
+void N2D2::VideoPipeline::logLatencyHistograms(const std::string& dirName)
+    const
+{
+    Utils::createDirectories(dirName);
+
+    std::vector<StageStats> stats = getStats();
+    stats.push_back(getEndToEndStats());
+
+    for (std::vector<StageStats>::const_iterator it = stats.begin(),
+         itEnd = stats.end(); it != itEnd; ++it)
+    {
+        (*it).latency.log(dirName + "/" + (*it).name + ".dat");
+    }
+}
+
+N2D2::VideoPipeline::Source_T N2D2::VideoPipeline::videoSource(
+    const std::shared_ptr<cv::VideoCapture>& video)
+{
+    return [video](cv::Mat& mat) {
+        return (video->read(mat) && !mat.empty());
+    };
+}
+
+N2D2::VideoPipeline::Source_T N2D2::VideoPipeline::imagesSource(
+    const std::vector<std::string>& fileNames)
+{
+    std::shared_ptr<std::size_t> index = std::make_shared<std::size_t>(0);
+
+    return [fileNames, index](cv::Mat& mat) {
+        if ((*index) >= fileNames.size())
+            return false;
+
+        const std::string& fileName = fileNames[(*index)];
+        ++(*index);
+
+        mat = cv::imread(fileName, cv::IMREAD_UNCHANGED);
+
+        if (mat.empty()) {
+            throw std::runtime_error("VideoPipeline: could not read image: "
+                                     + fileName);
+        }
+
+        return true;
+    };
+}
+
+N2D2::VideoPipeline::Source_T N2D2::VideoPipeline::createSource(
+    const std::string& name)
+{
+    DIR* pDir = opendir(name.c_str());
+
+    if (pDir != NULL) {
+        // Directory of images, in file name order
+        std::vector<std::string> fileNames;
+        struct dirent* pFile;
+
+        while ((pFile = readdir(pDir))) {
+            const std::string fileName(pFile->d_name);
+            std::string ext = Utils::fileExtension(fileName);
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+            if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp"
+                || ext == "pgm" || ext == "ppm" || ext == "tif"
+                || ext == "tiff")
+            {
+                fileNames.push_back(name + "/" + fileName);
+            }
+        }
+
+        closedir(pDir);
+        std::sort(fileNames.begin(), fileNames.end());
+
+        if (fileNames.empty()) {
+            throw std::runtime_error("VideoPipeline: no image found in "
+                                     "directory: " + name);
+        }
+
+        return imagesSource(fileNames);
+    }
+
+    std::shared_ptr<cv::VideoCapture> video;
+
+    if (!name.empty() && name.find_first_not_of("0123456789")
+        == std::string::npos)
+    {
+        video = std::make_shared<cv::VideoCapture>(std::atoi(name.c_str()));
+    }
+    else
+        video = std::make_shared<cv::VideoCapture>(name);
+
+    if (!video->isOpened())
+        throw std::runtime_error("VideoPipeline: could not open: " + name);
+
+    return videoSource(video);
+}
+
+N2D2::VideoPipeline::~VideoPipeline()
+{
+    stop();
+}
@@ -0,0 +1,132 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "utils/Half.hpp"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+namespace {
+// Conversions are split in blocks of this size for OpenMP, which is a
+// multiple of the SIMD width
+const int blockSize = 4096;
+
+void halfToFloatBlock(const half_float::half* src, float* dst, size_t size)
+{
+    size_t i = 0;
+
+#if defined(__F16C__)
+    const uint16_t* src16 = reinterpret_cast<const uint16_t*>(src);
+
+    for (; i + 8 <= size; i += 8) {
+        const __m128i h = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src16 + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+#endif
+
+    for (; i < size; ++i)
+        dst[i] = half_float::half_cast<float>(src[i]);
+}
+
+void floatToHalfBlock(const float* src, half_float::half* dst, size_t size)
+{
+    size_t i = 0;
+
+#if defined(__F16C__)
+    uint16_t* dst16 = reinterpret_cast<uint16_t*>(dst);
+
+    for (; i + 8 <= size; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                          _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst16 + i), h);
+    }
+#endif
+
+    for (; i < size; ++i) {
+        dst[i] = half_float::half_cast<half_float::half,
+                                       std::round_to_nearest>(src[i]);
+    }
+}
+
+void bfloat16ToFloatBlock(const N2D2::bfloat16* src, float* dst, size_t size)
+{
+    // Simple shift, auto-vectorized by the compiler
+    for (size_t i = 0; i < size; ++i)
+        dst[i] = N2D2::bfloat16::toFloat(src[i].data);
+}
+
+void floatToBfloat16Block(const float* src, N2D2::bfloat16* dst, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        dst[i].data = N2D2::bfloat16::fromFloat(src[i]);
+}
+
+template <class SRC_T, class DST_T>
+void convert(const SRC_T* src,
+             DST_T* dst,
+             size_t size,
+             void (*func)(const SRC_T*, DST_T*, size_t))
+{
+    const int nbBlocks = (int)((size + blockSize - 1) / blockSize);
+
+#pragma omp parallel for if (nbBlocks > 16)
+    for (int block = 0; block < nbBlocks; ++block) {
+        const size_t offset = (size_t)block * blockSize;
+        (*func)(src + offset, dst + offset,
+                std::min<size_t>(blockSize, size - offset));
+    }
+}
+}
+
+void N2D2::Half::toFloat(const half_float::half* src, float* dst, size_t size)
+{
+    convert(src, dst, size, &halfToFloatBlock);
+}
+
+void N2D2::Half::fromFloat(const float* src, half_float::half* dst, size_t size)
+{
+    convert(src, dst, size, &floatToHalfBlock);
+}
+
+void N2D2::Half::toFloat(const bfloat16* src, float* dst, size_t size)
+{
+    convert(src, dst, size, &bfloat16ToFloatBlock);
+}
+
+void N2D2::Half::fromFloat(const float* src, bfloat16* dst, size_t size)
+{
+    convert(src, dst, size, &floatToBfloat16Block);
+}
+
+void N2D2::Half::toFloat(const float* src, float* dst, size_t size)
+{
+    if (src != dst)
+        std::copy(src, src + size, dst);
+}
+
+void N2D2::Half::fromFloat(const float* src, float* dst, size_t size)
+{
+    if (src != dst)
+        std::copy(src, src + size, dst);
+}
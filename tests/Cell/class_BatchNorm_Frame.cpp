@@ -25,6 +25,8 @@
 #include "DeepNet.hpp"
 #include "Environment.hpp"
 #include "Network.hpp"
+#include "third_party/half.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 
 using namespace N2D2;
@@ -50,8 +52,226 @@ public:
     friend class UnitTest_BatchNormCell_Frame_half_setScales;
     friend class UnitTest_BatchNormCell_Frame_half_addInput__env;
     friend class UnitTest_BatchNormCell_Frame_half_addInput;
+
+    /// Reference implementation of the training propagation (separate
+    /// passes for the mean, the variance and the normalization)
+    void propagateReference(Tensor<double>& outputs,
+                            std::vector<double>& mean,
+                            std::vector<double>& variance)
+    {
+        const Tensor<double> input = tensor_cast<double>(this->mInputs[0]);
+        const unsigned int size = input.dimX() * input.dimY() * input.dimB();
+
+        outputs.resize(input.dims());
+        mean.assign(input.dimZ(), 0.0);
+        variance.assign(input.dimZ(), 0.0);
+
+        for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
+            for (unsigned int batchPos = 0; batchPos < input.dimB(); ++batchPos) {
+                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < input.dimX(); ++ox)
+                        mean[channel] += input(ox, oy, channel, batchPos);
+                }
+            }
+
+            mean[channel] /= size;
+
+            for (unsigned int batchPos = 0; batchPos < input.dimB(); ++batchPos) {
+                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
+                        const double zeroed = input(ox, oy, channel, batchPos)
+                                                - mean[channel];
+                        variance[channel] += zeroed * zeroed;
+                    }
+                }
+            }
+
+            variance[channel] /= size;
+
+            const double var = std::sqrt(variance[channel] + this->mEpsilon);
+
+            for (unsigned int batchPos = 0; batchPos < input.dimB(); ++batchPos) {
+                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
+                        outputs(ox, oy, channel, batchPos)
+                            = (*this->mScale)(channel)
+                                * (input(ox, oy, channel, batchPos)
+                                    - mean[channel]) / var
+                              + (*this->mBias)(channel);
+                    }
+                }
+            }
+        }
+    }
+
+    void backPropagateReference(const std::vector<double>& mean,
+                                const std::vector<double>& variance,
+                                Tensor<double>& diffOutputs,
+                                std::vector<double>& diffScale,
+                                std::vector<double>& diffBias)
+    {
+        const Tensor<double> input = tensor_cast<double>(this->mInputs[0]);
+        const Tensor<double> diffInput
+            = tensor_cast<double>(this->mDiffInputs);
+        const unsigned int size = input.dimX() * input.dimY() * input.dimB();
+
+        diffOutputs.resize(input.dims());
+        diffScale.assign(input.dimZ(), 0.0);
+        diffBias.assign(input.dimZ(), 0.0);
+
+        for (unsigned int channel = 0; channel < input.dimZ(); ++channel) {
+            const double scale = (*this->mScale)(channel);
+            const double var = std::sqrt(variance[channel] + this->mEpsilon);
+            double sumMean1 = 0.0;
+            double sumMean2 = 0.0;
+            double sumVariance = 0.0;
+
+            for (unsigned int batchPos = 0; batchPos < input.dimB(); ++batchPos) {
+                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
+                        const double zeroed = input(ox, oy, channel, batchPos)
+                                                - mean[channel];
+                        const double diff
+                            = diffInput(ox, oy, channel, batchPos);
+
+                        diffScale[channel] += diff * zeroed / var;
+                        diffBias[channel] += diff;
+                        sumMean1 += diff * scale;
+                        sumMean2 += -2.0 * zeroed;
+                        sumVariance += diff * scale * zeroed;
+                    }
+                }
+            }
+
+            const double diffVariance = sumVariance * (-1.0 / 2.0)
+                * std::pow(variance[channel] + this->mEpsilon, -3.0 / 2.0);
+            const double diffMean = sumMean1 * (-1.0 / var)
+                + diffVariance * sumMean2 / size;
+
+            for (unsigned int batchPos = 0; batchPos < input.dimB(); ++batchPos) {
+                for (unsigned int oy = 0; oy < input.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < input.dimX(); ++ox) {
+                        diffOutputs(ox, oy, channel, batchPos)
+                            = diffInput(ox, oy, channel, batchPos) * scale
+                                / var
+                            + diffVariance * 2.0
+                                * (input(ox, oy, channel, batchPos)
+                                    - mean[channel]) / size
+                            + diffMean / size;
+                    }
+                }
+            }
+        }
+    }
+
+    Tensor<T>& getDiffInputsRef()
+    {
+        return this->mDiffInputs;
+    }
+
+    double getSavedMean(unsigned int output) const
+    {
+        return this->mSavedMean(output);
+    }
+
+    double getSavedVariance(unsigned int output) const
+    {
+        return this->mSavedVariance(output);
+    }
+
+    double getDiffScale(unsigned int output) const
+    {
+        return this->mDiffScale(output);
+    }
+
+    double getDiffBias(unsigned int output) const
+    {
+        return this->mDiffBias(output);
+    }
 };
 
+template <class T>
+double maxPropagateBackPropagateError(unsigned int nbChannels,
+                                 unsigned int channelsSize,
+                                 unsigned int batchSize)
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    BatchNormCell_Frame_Test<T> bn(dn, "bn", nbChannels,
+                                   std::shared_ptr<Activation>());
+
+    Tensor<T> inputs({channelsSize, channelsSize, nbChannels, batchSize});
+    Tensor<T> diffOutputs(inputs.dims());
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = T(Random::randUniform(-1.0, 3.0));
+
+    bn.addInput(inputs, diffOutputs);
+    bn.initialize();
+
+    for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+        bn.setScale(channel,
+                    Tensor<double>({1}, Random::randUniform(0.5, 1.5)));
+        bn.setBias(channel,
+                   Tensor<double>({1}, Random::randUniform(-0.5, 0.5)));
+    }
+
+    bn.propagate(false);
+
+    Tensor<T>& diffInputs = bn.getDiffInputsRef();
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = T(Random::randUniform(-1.0, 1.0));
+
+    diffInputs.setValid();
+    bn.backPropagate();
+
+    Tensor<double> outputsRef;
+    std::vector<double> meanRef;
+    std::vector<double> varianceRef;
+    bn.propagateReference(outputsRef, meanRef, varianceRef);
+
+    Tensor<double> diffOutputsRef;
+    std::vector<double> diffScaleRef;
+    std::vector<double> diffBiasRef;
+    bn.backPropagateReference(meanRef, varianceRef, diffOutputsRef,
+                              diffScaleRef, diffBiasRef);
+
+    const Tensor<T>& outputs = tensor_cast_nocopy<T>(bn.getOutputs());
+
+    // The gradients of the parameters are sums over a whole channel
+    const double channelSize = (double)inputs.size() / nbChannels;
+    double maxError = 0.0;
+
+    for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+        maxError = std::max(maxError,
+            std::fabs(bn.getSavedMean(channel) - meanRef[channel]));
+        maxError = std::max(maxError,
+            std::fabs(bn.getSavedVariance(channel) - varianceRef[channel]));
+        maxError = std::max(maxError,
+            std::fabs(bn.getDiffScale(channel) - diffScaleRef[channel])
+                / channelSize);
+        maxError = std::max(maxError,
+            std::fabs(bn.getDiffBias(channel) - diffBiasRef[channel])
+                / channelSize);
+    }
+
+    for (unsigned int index = 0; index < outputs.size(); ++index) {
+        maxError = std::max(maxError,
+            std::fabs(outputs(index) - outputsRef(index)));
+    }
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        maxError = std::max(maxError,
+            std::fabs(diffOutputs(index) - diffOutputsRef(index)));
+    }
+
+    return maxError;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // float
 ////////////////////////////////////////////////////////////////////////////////
@@ -177,4 +397,52 @@ TEST_DATASET(BatchNormCell_Frame_float,
                   * conv1.getOutputsHeight());
 }
 
+TEST_DATASET(BatchNormCell_Frame_float,
+             propagate_backPropagate,
+             (unsigned int nbChannels,
+              unsigned int channelsSize,
+              unsigned int batchSize),
+             std::make_tuple(1U, 5U, 3U),
+             std::make_tuple(3U, 16U, 32U),
+             std::make_tuple(64U, 8U, 4U))
+{
+    const double maxError = maxPropagateBackPropagateError<float>(nbChannels,
+        channelsSize, batchSize);
+
+    ASSERT_EQUALS_DELTA(maxError, 0.0, 1.0e-5);
+}
+
+TEST_DATASET(BatchNormCell_Frame_double,
+             propagate_backPropagate,
+             (unsigned int nbChannels,
+              unsigned int channelsSize,
+              unsigned int batchSize),
+             std::make_tuple(1U, 5U, 3U),
+             std::make_tuple(3U, 16U, 32U),
+             std::make_tuple(64U, 8U, 4U))
+{
+    const double maxError = maxPropagateBackPropagateError<double>(nbChannels,
+        channelsSize, batchSize);
+
+    ASSERT_EQUALS_DELTA(maxError, 0.0, 1.0e-12);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// half
+////////////////////////////////////////////////////////////////////////////////
+TEST_DATASET(BatchNormCell_Frame_half,
+             propagate_backPropagate,
+             (unsigned int nbChannels,
+              unsigned int channelsSize,
+              unsigned int batchSize),
+             std::make_tuple(1U, 5U, 3U),
+             std::make_tuple(3U, 16U, 32U),
+             std::make_tuple(64U, 8U, 4U))
+{
+    const double maxError = maxPropagateBackPropagateError<half_float::half>(
+        nbChannels, channelsSize, batchSize);
+
+    ASSERT_EQUALS_DELTA(maxError, 0.0, 1.0e-2);
+}
+
 RUN_TESTS()
@@ -21,12 +21,15 @@
 #include "N2D2.hpp"
 
 #include "Cell/ConvCell_Frame.hpp"
+#include "Cell/ConvCell_Frame_Kernels.hpp"
+#include "Cell/DeconvCell_Frame_Kernels.hpp"
 #include "Database/MNIST_IDX_Database.hpp"
 #include "DeepNet.hpp"
 #include "Environment.hpp"
 #include "Network.hpp"
 #include "third_party/half.hpp"
 #include "Transformation/RescaleTransformation.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 
 using namespace N2D2;
@@ -2119,4 +2122,168 @@ TEST_DATASET(ConvCell_Frame_half,
     }
 }
 
+// The half specializations of the kernels compute in float: their results
+// must match the float kernels up to the half rounding of the operands and
+// of the result
+template <class T>
+void fillRandomKernels(Tensor<T>& tensor)
+{
+    for (unsigned int index = 0; index < tensor.size(); ++index)
+        tensor(index) = T(Random::randUniform(-1.0, 1.0));
+}
+
+template <class T>
+Tensor<float> toFloatKernels(const Tensor<T>& tensor)
+{
+    Tensor<float> floatTensor(tensor.dims());
+
+    for (unsigned int index = 0; index < tensor.size(); ++index)
+        floatTensor(index) = (float)tensor(index);
+
+    return floatTensor;
+}
+
+template <class T>
+double maxRelativeError(const Tensor<half_float::half>& tensor,
+                        const Tensor<T>& tensorRef)
+{
+    double maxError = 0.0;
+
+    for (unsigned int index = 0; index < tensor.size(); ++index) {
+        const double error = std::fabs((double)tensor(index)
+                                       - (double)tensorRef(index));
+        maxError = std::max(maxError,
+                            error / std::max(1.0,
+                                        std::fabs((double)tensorRef(index))));
+    }
+
+    return maxError;
+}
+
+TEST_DATASET(ConvCell_Frame_Kernels_half,
+             float_equivalence,
+             (unsigned int kernelSize,
+              unsigned int stride,
+              int padding,
+              unsigned int inputsSize,
+              double beta),
+             std::make_tuple(3U, 1U, 1, 8U, 0.0),
+             std::make_tuple(3U, 2U, 1, 9U, 0.0),
+             std::make_tuple(4U, 2U, 1, 8U, 1.0),
+             std::make_tuple(5U, 1U, 0, 12U, 1.0))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbChannels = 3;
+    const unsigned int nbOutputs = 4;
+    const unsigned int batchSize = 2;
+
+    const ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1, 1}),
+        std::vector<unsigned int>({stride, stride}),
+        std::vector<int>({padding, padding}),
+        std::vector<unsigned int>({1, 1}));
+
+    const unsigned int convSize
+        = (inputsSize + 2 * padding - kernelSize) / stride + 1;
+    const unsigned int deconvSize
+        = (inputsSize - 1) * stride + kernelSize - 2 * padding;
+
+    const half_float::half alpha(1.0f);
+    const half_float::half betaH((float)beta);
+    const float alphaF = 1.0f;
+    const float betaF = (float)beta;
+
+    Tensor<half_float::half> inputs({inputsSize, inputsSize, nbChannels,
+                                     batchSize});
+    Tensor<half_float::half> sharedSynapses({kernelSize, kernelSize,
+                                             nbChannels, nbOutputs});
+    Tensor<half_float::half> deconvSharedSynapses({kernelSize, kernelSize,
+                                                   nbOutputs, nbChannels});
+    Tensor<half_float::half> convOutputs({convSize, convSize, nbOutputs,
+                                          batchSize});
+    Tensor<half_float::half> deconvOutputs({deconvSize, deconvSize, nbOutputs,
+                                            batchSize});
+    fillRandomKernels(inputs);
+    fillRandomKernels(sharedSynapses);
+    fillRandomKernels(deconvSharedSynapses);
+    fillRandomKernels(convOutputs);
+    fillRandomKernels(deconvOutputs);
+
+    // ConvCell_Frame_Kernels
+    Tensor<float> convOutputsRef = toFloatKernels(convOutputs);
+    ConvCell_Frame_Kernels::forward(&alphaF, toFloatKernels(inputs),
+                                    toFloatKernels(sharedSynapses), desc,
+                                    &betaF, convOutputsRef);
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, sharedSynapses, desc,
+                                    &betaH, convOutputs);
+
+    ASSERT_EQUALS_DELTA(maxRelativeError(convOutputs, convOutputsRef),
+                        0.0, 1.0e-2);
+
+    Tensor<float> diffInputsRef = toFloatKernels(inputs);
+    Tensor<half_float::half> diffInputs = inputs.clone();
+    ConvCell_Frame_Kernels::backwardData(&alphaF,
+                                         toFloatKernels(sharedSynapses),
+                                         toFloatKernels(convOutputs), desc,
+                                         &betaF, diffInputsRef);
+    ConvCell_Frame_Kernels::backwardData(&alpha, sharedSynapses, convOutputs,
+                                         desc, &betaH, diffInputs);
+
+    ASSERT_EQUALS_DELTA(maxRelativeError(diffInputs, diffInputsRef),
+                        0.0, 1.0e-2);
+
+    Tensor<float> diffSharedSynapsesRef = toFloatKernels(sharedSynapses);
+    Tensor<half_float::half> diffSharedSynapses = sharedSynapses.clone();
+    ConvCell_Frame_Kernels::backwardFilter(&alphaF, toFloatKernels(inputs),
+                                           toFloatKernels(convOutputs), desc,
+                                           &betaF, diffSharedSynapsesRef);
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, convOutputs, desc,
+                                           &betaH, diffSharedSynapses);
+
+    ASSERT_EQUALS_DELTA(maxRelativeError(diffSharedSynapses,
+                                         diffSharedSynapsesRef),
+                        0.0, 1.0e-2);
+
+    // DeconvCell_Frame_Kernels
+    Tensor<float> deconvOutputsRef = toFloatKernels(deconvOutputs);
+    DeconvCell_Frame_Kernels::forward(&alphaF, toFloatKernels(inputs),
+                                      toFloatKernels(deconvSharedSynapses),
+                                      desc, &betaF, deconvOutputsRef);
+    DeconvCell_Frame_Kernels::forward(&alpha, inputs, deconvSharedSynapses,
+                                      desc, &betaH, deconvOutputs);
+
+    ASSERT_EQUALS_DELTA(maxRelativeError(deconvOutputs, deconvOutputsRef),
+                        0.0, 1.0e-2);
+
+    Tensor<float> deconvDiffInputsRef = toFloatKernels(inputs);
+    Tensor<half_float::half> deconvDiffInputs = inputs.clone();
+    DeconvCell_Frame_Kernels::backwardData(
+        &alphaF, toFloatKernels(deconvSharedSynapses),
+        toFloatKernels(deconvOutputs), desc, &betaF, deconvDiffInputsRef);
+    DeconvCell_Frame_Kernels::backwardData(&alpha, deconvSharedSynapses,
+                                           deconvOutputs, desc, &betaH,
+                                           deconvDiffInputs);
+
+    ASSERT_EQUALS_DELTA(maxRelativeError(deconvDiffInputs,
+                                         deconvDiffInputsRef),
+                        0.0, 1.0e-2);
+
+    Tensor<float> deconvDiffSharedSynapsesRef
+        = toFloatKernels(deconvSharedSynapses);
+    Tensor<half_float::half> deconvDiffSharedSynapses
+        = deconvSharedSynapses.clone();
+    DeconvCell_Frame_Kernels::backwardFilter(&alphaF, toFloatKernels(inputs),
+                                             toFloatKernels(deconvOutputs),
+                                             desc, &betaF,
+                                             deconvDiffSharedSynapsesRef);
+    DeconvCell_Frame_Kernels::backwardFilter(&alpha, inputs, deconvOutputs,
+                                             desc, &betaH,
+                                             deconvDiffSharedSynapses);
+
+    ASSERT_EQUALS_DELTA(maxRelativeError(deconvDiffSharedSynapses,
+                                         deconvDiffSharedSynapsesRef),
+                        0.0, 1.0e-2);
+}
+
 RUN_TESTS()
@@ -0,0 +1,326 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/ConvCell_Frame_Kernels.hpp"
+#include "Cell/DeconvCell_Frame_Kernels.hpp"
+#include "containers/Tensor.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+template <class T>
+void fillRandom(Tensor<T>& tensor)
+{
+    for (unsigned int index = 0; index < tensor.size(); ++index)
+        tensor(index) = Random::randUniform(-1.0, 1.0);
+}
+
+// Reference: the transposed convolution is the backward data pass of a
+// convolution, and vice versa
+TEST_DATASET(DeconvCell_Frame_Kernels,
+             forward_backward,
+             (unsigned int kernelWidth,
+              unsigned int kernelHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              int paddingX,
+              int paddingY,
+              unsigned int inputsWidth,
+              unsigned int inputsHeight,
+              unsigned int nbChannels,
+              unsigned int nbOutputs,
+              unsigned int batchSize),
+             std::make_tuple(3U, 3U, 1U, 1U, 0, 0, 8U, 8U, 3U, 4U, 2U),
+             std::make_tuple(3U, 3U, 1U, 1U, 1, 1, 8U, 6U, 3U, 4U, 2U),
+             std::make_tuple(2U, 5U, 1U, 1U, 0, 2, 7U, 9U, 2U, 5U, 1U),
+             // Sub-pixel path (stride 2)
+             std::make_tuple(2U, 2U, 2U, 2U, 0, 0, 8U, 8U, 4U, 3U, 2U),
+             std::make_tuple(3U, 3U, 2U, 2U, 1, 1, 8U, 7U, 4U, 3U, 2U),
+             std::make_tuple(4U, 4U, 2U, 2U, 1, 1, 9U, 8U, 3U, 5U, 3U),
+             std::make_tuple(5U, 3U, 2U, 2U, 2, 0, 6U, 10U, 2U, 2U, 1U),
+             // Other strides
+             std::make_tuple(3U, 3U, 3U, 3U, 0, 0, 5U, 6U, 3U, 4U, 2U),
+             std::make_tuple(4U, 3U, 2U, 1U, 1, 1, 8U, 8U, 3U, 4U, 2U),
+             std::make_tuple(5U, 5U, 4U, 3U, 2, 1, 6U, 5U, 2U, 3U, 1U))
+{
+    Random::mtSeed(0);
+
+    const ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1, 1}),
+        std::vector<unsigned int>({strideX, strideY}),
+        std::vector<int>({paddingX, paddingY}),
+        std::vector<unsigned int>({1, 1}));
+
+    const unsigned int outputsWidth = (inputsWidth - 1) * strideX
+                                        + kernelWidth - 2 * paddingX;
+    const unsigned int outputsHeight = (inputsHeight - 1) * strideY
+                                        + kernelHeight - 2 * paddingY;
+
+    Tensor<double> inputs({inputsWidth, inputsHeight, nbChannels, batchSize});
+    Tensor<double> sharedSynapses({kernelWidth, kernelHeight, nbOutputs,
+                                   nbChannels});
+    Tensor<double> diffInputs({outputsWidth, outputsHeight, nbOutputs,
+                               batchSize});
+    fillRandom(inputs);
+    fillRandom(sharedSynapses);
+    fillRandom(diffInputs);
+
+    const double alpha = 1.0;
+    const double beta = 0.0;
+
+    // Forward
+    Tensor<double> outputs({outputsWidth, outputsHeight, nbOutputs,
+                            batchSize});
+    Tensor<double> outputsRef({outputsWidth, outputsHeight, nbOutputs,
+                               batchSize});
+    fillRandom(outputs);
+
+    DeconvCell_Frame_Kernels::forward(&alpha, inputs, sharedSynapses, desc,
+                                      &beta, outputs);
+    ConvCell_Frame_Kernels::backwardData(&alpha, sharedSynapses, inputs,
+                                         desc, &beta, outputsRef);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputs(index), outputsRef(index), 1.0e-12);
+
+    // Backward data
+    Tensor<double> diffOutputs(inputs.dims());
+    Tensor<double> diffOutputsRef(inputs.dims());
+    fillRandom(diffOutputs);
+
+    DeconvCell_Frame_Kernels::backwardData(&alpha, sharedSynapses, diffInputs,
+                                           desc, &beta, diffOutputs);
+    ConvCell_Frame_Kernels::forward(&alpha, diffInputs, sharedSynapses, desc,
+                                    &beta, diffOutputsRef);
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputs(index), diffOutputsRef(index),
+                            1.0e-12);
+    }
+
+    // Backward filter, with accumulation
+    Tensor<double> diffSharedSynapses(sharedSynapses.dims());
+    fillRandom(diffSharedSynapses);
+    Tensor<double> diffSharedSynapsesRef(sharedSynapses.dims());
+    diffSharedSynapsesRef = diffSharedSynapses;
+
+    const double betaAcc = 1.0;
+
+    DeconvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs,
+                                             desc, &betaAcc,
+                                             diffSharedSynapses);
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, diffInputs, inputs,
+                                           desc, &betaAcc,
+                                           diffSharedSynapsesRef);
+
+    for (unsigned int index = 0; index < diffSharedSynapses.size();
+        ++index)
+    {
+        ASSERT_EQUALS_DELTA(diffSharedSynapses(index),
+                            diffSharedSynapsesRef(index), 1.0e-12);
+    }
+}
+
+TEST_DATASET(DeconvCell_Frame_Kernels,
+             forward_maps,
+             (unsigned int strideX, unsigned int strideY),
+             std::make_tuple(1U, 1U),
+             std::make_tuple(2U, 2U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbChannels = 3;
+    const unsigned int nbOutputs = 5;
+
+    const ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1, 1}),
+        std::vector<unsigned int>({strideX, strideY}),
+        std::vector<int>({1, 1}),
+        std::vector<unsigned int>({1, 1}));
+
+    Tensor<float> inputs({6, 6, nbChannels, 2});
+    Tensor<float> sharedSynapses({4, 4, nbOutputs, nbChannels});
+    fillRandom(inputs);
+    fillRandom(sharedSynapses);
+
+    Tensor<bool> maps({nbOutputs, nbChannels});
+    Tensor<float> sharedSynapsesMasked(sharedSynapses.dims());
+    sharedSynapsesMasked = sharedSynapses;
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+            maps(output, channel) = ((output + channel) % 2 == 0);
+
+            if (!maps(output, channel))
+                sharedSynapsesMasked[channel][output].fill(0.0f);
+        }
+    }
+
+    const unsigned int outputsWidth = 5 * strideX + 4 - 2;
+    const unsigned int outputsHeight = 5 * strideY + 4 - 2;
+    const float alpha = 1.0f;
+    const float beta = 0.0f;
+
+    Tensor<float> outputs({outputsWidth, outputsHeight, nbOutputs, 2});
+    Tensor<float> outputsRef({outputsWidth, outputsHeight, nbOutputs, 2});
+
+    DeconvCell_Frame_Kernels::forward(&alpha, inputs, sharedSynapses, desc,
+                                      &beta, outputs, maps);
+    DeconvCell_Frame_Kernels::forward(&alpha, inputs, sharedSynapsesMasked,
+                                      desc, &beta, outputsRef);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputs(index), outputsRef(index), 1.0e-5);
+}
+
+// Reference: direct transposed convolution, for the dilated kernels
+// (not supported by ConvCell_Frame_Kernels)
+TEST_DATASET(DeconvCell_Frame_Kernels,
+             forward_backward_dilation,
+             (unsigned int kernelSize,
+              unsigned int stride,
+              int padding,
+              unsigned int dilation,
+              unsigned int inputsWidth,
+              unsigned int inputsHeight),
+             std::make_tuple(3U, 1U, 0, 2U, 6U, 5U),
+             std::make_tuple(3U, 1U, 2, 2U, 7U, 7U),
+             std::make_tuple(3U, 2U, 1, 2U, 6U, 7U),
+             std::make_tuple(2U, 2U, 0, 3U, 5U, 5U),
+             std::make_tuple(4U, 3U, 2, 2U, 5U, 4U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbChannels = 3;
+    const unsigned int nbOutputs = 4;
+    const unsigned int batchSize = 2;
+
+    const ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1, 1}),
+        std::vector<unsigned int>({stride, stride}),
+        std::vector<int>({padding, padding}),
+        std::vector<unsigned int>({dilation, dilation}));
+
+    const unsigned int outputsWidth = (inputsWidth - 1) * stride
+        + dilation * (kernelSize - 1) + 1 - 2 * padding;
+    const unsigned int outputsHeight = (inputsHeight - 1) * stride
+        + dilation * (kernelSize - 1) + 1 - 2 * padding;
+
+    Tensor<double> inputs({inputsWidth, inputsHeight, nbChannels, batchSize});
+    Tensor<double> sharedSynapses({kernelSize, kernelSize, nbOutputs,
+                                   nbChannels});
+    Tensor<double> diffInputs({outputsWidth, outputsHeight, nbOutputs,
+                               batchSize});
+    fillRandom(inputs);
+    fillRandom(sharedSynapses);
+    fillRandom(diffInputs);
+
+    Tensor<double> outputsRef({outputsWidth, outputsHeight, nbOutputs,
+                               batchSize}, 0.0);
+    Tensor<double> diffOutputsRef(inputs.dims(), 0.0);
+    Tensor<double> diffSharedSynapsesRef(sharedSynapses.dims());
+    fillRandom(diffSharedSynapsesRef);
+
+    Tensor<double> diffSharedSynapses(sharedSynapses.dims());
+    diffSharedSynapses = diffSharedSynapsesRef;
+
+    for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        for (unsigned int channel = 0; channel < nbChannels; ++channel) {
+            for (unsigned int output = 0; output < nbOutputs; ++output) {
+                for (unsigned int iy = 0; iy < inputsHeight; ++iy) {
+                    for (unsigned int ix = 0; ix < inputsWidth; ++ix) {
+                        for (unsigned int sy = 0; sy < kernelSize; ++sy) {
+                            for (unsigned int sx = 0; sx < kernelSize; ++sx)
+                            {
+                                const int ox = (int)(ix * stride
+                                    + sx * dilation) - padding;
+                                const int oy = (int)(iy * stride
+                                    + sy * dilation) - padding;
+
+                                if (ox < 0 || oy < 0
+                                    || ox >= (int)outputsWidth
+                                    || oy >= (int)outputsHeight)
+                                {
+                                    continue;
+                                }
+
+                                const double weight = sharedSynapses(
+                                    sx, sy, output, channel);
+
+                                outputsRef(ox, oy, output, batchPos)
+                                    += weight
+                                        * inputs(ix, iy, channel, batchPos);
+                                diffOutputsRef(ix, iy, channel, batchPos)
+                                    += weight
+                                        * diffInputs(ox, oy, output, batchPos);
+                                diffSharedSynapsesRef(sx, sy, output, channel)
+                                    += inputs(ix, iy, channel, batchPos)
+                                        * diffInputs(ox, oy, output, batchPos);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    const double alpha = 1.0;
+    const double beta = 0.0;
+    const double betaAcc = 1.0;
+
+    // Forward
+    Tensor<double> outputs(outputsRef.dims());
+    fillRandom(outputs);
+
+    DeconvCell_Frame_Kernels::forward(&alpha, inputs, sharedSynapses, desc,
+                                      &beta, outputs);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputs(index), outputsRef(index), 1.0e-12);
+
+    // Backward data
+    Tensor<double> diffOutputs(inputs.dims());
+    fillRandom(diffOutputs);
+
+    DeconvCell_Frame_Kernels::backwardData(&alpha, sharedSynapses, diffInputs,
+                                           desc, &beta, diffOutputs);
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputs(index), diffOutputsRef(index),
+                            1.0e-12);
+    }
+
+    // Backward filter, with accumulation
+    DeconvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs,
+                                             desc, &betaAcc,
+                                             diffSharedSynapses);
+
+    for (unsigned int index = 0; index < diffSharedSynapses.size();
+        ++index)
+    {
+        ASSERT_EQUALS_DELTA(diffSharedSynapses(index),
+                            diffSharedSynapsesRef(index), 1.0e-12);
+    }
+}
+
+RUN_TESTS()
@@ -0,0 +1,137 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/DropoutCell_Frame.hpp"
+#include "containers/Tensor.hpp"
+#include "DeepNet.hpp"
+#include "Network.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Random.hpp"
+
+#include <cmath>
+
+using namespace N2D2;
+
+class DropoutCell_Frame_Test : public DropoutCell_Frame<Float_T> {
+public:
+    DropoutCell_Frame_Test(const DeepNet& deepNet,
+                           const std::string& name,
+                           unsigned int nbOutputs)
+        : Cell(deepNet, name, nbOutputs),
+          DropoutCell(deepNet, name, nbOutputs),
+          DropoutCell_Frame<Float_T>(deepNet, name, nbOutputs)
+    {
+    }
+
+    Tensor<Float_T>& getDiffInputsRef()
+    {
+        return mDiffInputs;
+    }
+};
+
+TEST_DATASET(DropoutCell_Frame,
+             propagate_backPropagate,
+             (double dropout,
+              unsigned int channelsSize,
+              unsigned int nbChannels,
+              unsigned int batchSize),
+             std::make_tuple(0.5, 16U, 4U, 8U),
+             std::make_tuple(0.2, 7U, 3U, 5U),
+             std::make_tuple(0.8, 32U, 16U, 2U),
+             std::make_tuple(0.0, 5U, 1U, 3U))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    DropoutCell_Frame_Test drop(dn, "drop", nbChannels);
+    drop.setParameter("Dropout", dropout);
+
+    Tensor<Float_T> inputs({channelsSize, channelsSize, nbChannels,
+                            batchSize});
+    Tensor<Float_T> diffOutputs(inputs.dims());
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(0.5, 1.5);
+
+    drop.addInput(inputs, diffOutputs);
+    drop.initialize();
+    drop.propagate(false);
+
+    const Tensor<Float_T>& outputs
+        = tensor_cast_nocopy<Float_T>(drop.getOutputs());
+
+    unsigned int nbDropped = 0;
+
+    for (unsigned int index = 0; index < outputs.size(); ++index) {
+        // Kept activations are propagated unchanged (no rescaling)
+        if (outputs(index) == 0.0)
+            ++nbDropped;
+        else {
+            ASSERT_EQUALS(outputs(index), inputs(index));
+        }
+    }
+
+    // The number of dropped activations follows a binomial distribution:
+    // check it within 5 standard deviations
+    const double size = outputs.size();
+    const double stdDev = std::sqrt(size * dropout * (1.0 - dropout));
+
+    ASSERT_EQUALS_DELTA(nbDropped, size * dropout, 5.0 * stdDev + 0.5);
+
+    // The mask must be different for each batch
+    const Tensor<Float_T> outputsPrev(outputs.dims(), outputs.begin(),
+                                      outputs.end());
+    drop.propagate(false);
+
+    if (dropout > 0.0) {
+        ASSERT_TRUE(!std::equal(outputs.begin(), outputs.end(),
+                                outputsPrev.begin()));
+    }
+
+    // Backward must use the same mask as the last forward
+    Tensor<Float_T>& diffInputs = drop.getDiffInputsRef();
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = Random::randUniform(0.5, 1.5);
+
+    diffInputs.setValid();
+    drop.backPropagate();
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        if (outputs(index) == 0.0) {
+            ASSERT_EQUALS(diffOutputs(index), 0.0);
+        }
+        else {
+            ASSERT_EQUALS(diffOutputs(index), diffInputs(index));
+        }
+    }
+
+    // Inference is the identity
+    drop.propagate(true);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS(outputs(index), inputs(index));
+}
+
+RUN_TESTS()
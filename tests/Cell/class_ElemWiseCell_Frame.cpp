@@ -21,13 +21,14 @@
 #include "N2D2.hpp"
 
 #include "Cell/ElemWiseCell_Frame.hpp"
+#include "Cell/SoftmaxCell_Frame.hpp"
 #include "DeepNet.hpp"
 #include "Network.hpp"
 #include "utils/UnitTest.hpp"
 
 using namespace N2D2;
 
-class ElemWiseCell_Frame_Test : public ElemWiseCell_Frame {
+class ElemWiseCell_Frame_Test : public ElemWiseCell_Frame<Float_T> {
 public:
     ElemWiseCell_Frame_Test(const DeepNet& deepNet, 
                             const std::string& name,
@@ -39,7 +40,7 @@ public:
                    = std::shared_ptr<Activation>())
         : Cell(deepNet, name, nbOutputs),
           ElemWiseCell(deepNet, name, nbOutputs, operation, weights, shifts),
-          ElemWiseCell_Frame(deepNet, name, nbOutputs, operation, weights, shifts, activation)
+          ElemWiseCell_Frame<Float_T>(deepNet, name, nbOutputs, operation, weights, shifts, activation)
     {}
 };
 
@@ -868,4 +869,295 @@ TEST(ElemWiseCell_Frame,
     ASSERT_NOTHROW_ANY(elemWise.checkGradient(1.0e-4, 1.0e-3));
 }
 
+TEST_DATASET(ElemWiseCell_Frame,
+             propagate_sum2_inPlace,
+             (bool inference),
+             std::make_tuple(false),
+             std::make_tuple(true))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 4;
+
+    // Identity parent cell, without activation
+    std::shared_ptr<ElemWiseCell_Frame_Test> parent = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "parent", nbOutputs, ElemWiseCell::Sum);
+    std::shared_ptr<ElemWiseCell_Frame_Test> elemWise = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "elemwise", nbOutputs, ElemWiseCell::Sum,
+                                  std::vector<Float_T>({1.0, 0.5}),
+                                  std::vector<Float_T>({0.0, 0.25}));
+    elemWise->setParameter("InPlace", true);
+
+    Tensor<Float_T> inputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> inputsB({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsB({8, 8, nbOutputs, 2});
+
+    parent->addInput(inputsA, diffOutputsA);
+    dn.addCell(parent, std::vector<std::shared_ptr<Cell> >(1));
+    elemWise->addInput(parent.get());
+    elemWise->addInput(inputsB, diffOutputsB);
+    dn.addCell(elemWise, std::vector<std::shared_ptr<Cell> >(1, parent));
+
+    parent->initialize();
+    elemWise->initialize();
+
+    // The parent outputs are needed for its back-propagation in training
+    ASSERT_TRUE(!elemWise->isInPlace(false));
+    ASSERT_TRUE(elemWise->isInPlace(true));
+
+    // Several passes, as the buffers are exchanged at each pass
+    for (unsigned int pass = 0; pass < 3; ++pass) {
+        for (unsigned int index = 0; index < inputsA.size(); ++index) {
+            inputsA(index) = Random::randUniform(-1.0, 1.0);
+            inputsB(index) = Random::randUniform(-1.0, 1.0);
+        }
+
+        parent->propagate(inference);
+        elemWise->propagate(inference);
+
+        const Tensor<Float_T>& outputs
+            = tensor_cast<Float_T>(elemWise->getOutputs());
+
+        ASSERT_EQUALS(outputs.dims(), inputsA.dims());
+
+        for (unsigned int o = 0; o < outputs.size(); ++o) {
+            ASSERT_EQUALS_DELTA(outputs(o),
+                                inputsA(o) + 0.5 * inputsB(o) + 0.25,
+                                1.0e-6);
+        }
+
+        if (!inference) {
+            Tensor<Float_T> diffInputs = tensor_cast_nocopy<Float_T>(
+                elemWise->getDiffInputs());
+
+            for (unsigned int index = 0; index < diffInputs.size(); ++index)
+                diffInputs(index) = Random::randUniform(-1.0, 1.0);
+
+            diffInputs.setValid();
+            diffOutputsB.clearValid();
+            elemWise->backPropagate();
+
+            const Tensor<Float_T>& parentDiffInputs
+                = tensor_cast<Float_T>(parent->getDiffInputs());
+
+            for (unsigned int o = 0; o < diffInputs.size(); ++o) {
+                ASSERT_EQUALS_DELTA(parentDiffInputs(o), diffInputs(o),
+                                    1.0e-6);
+                ASSERT_EQUALS_DELTA(diffOutputsB(o), 0.5 * diffInputs(o),
+                                    1.0e-6);
+            }
+        }
+    }
+}
+
+TEST(ElemWiseCell_Frame,
+     propagate_sum2_inPlace_multipleChilds)
+{
+    Network net;
+    DeepNet dn(net);
+
+    const unsigned int nbOutputs = 4;
+
+    std::shared_ptr<ElemWiseCell_Frame_Test> parent = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "parent", nbOutputs, ElemWiseCell::Sum);
+    std::shared_ptr<ElemWiseCell_Frame_Test> elemWise = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "elemwise", nbOutputs, ElemWiseCell::Sum);
+    std::shared_ptr<ElemWiseCell_Frame_Test> other = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "other", nbOutputs, ElemWiseCell::Sum);
+    elemWise->setParameter("InPlace", true);
+
+    Tensor<Float_T> inputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> inputsB({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsB({8, 8, nbOutputs, 2});
+
+    parent->addInput(inputsA, diffOutputsA);
+    dn.addCell(parent, std::vector<std::shared_ptr<Cell> >(1));
+    elemWise->addInput(parent.get());
+    elemWise->addInput(inputsB, diffOutputsB);
+    dn.addCell(elemWise, std::vector<std::shared_ptr<Cell> >(1, parent));
+    other->addInput(parent.get());
+    dn.addCell(other, std::vector<std::shared_ptr<Cell> >(1, parent));
+
+    parent->initialize();
+    elemWise->initialize();
+
+    // The parent outputs are also used by "other"
+    ASSERT_TRUE(!elemWise->isInPlace(false));
+    ASSERT_TRUE(!elemWise->isInPlace(true));
+}
+
+TEST_DATASET(ElemWiseCell_Frame,
+             propagate_sum2_inPlace_sameInput,
+             (bool inference),
+             std::make_tuple(false),
+             std::make_tuple(true))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 4;
+
+    std::shared_ptr<ElemWiseCell_Frame_Test> parent = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "parent", nbOutputs, ElemWiseCell::Sum);
+    std::shared_ptr<ElemWiseCell_Frame_Test> elemWise = std::make_shared
+        <ElemWiseCell_Frame_Test>(dn, "elemwise", nbOutputs, ElemWiseCell::Sum,
+                                  std::vector<Float_T>({1.0, 0.5}),
+                                  std::vector<Float_T>({0.0, 0.0}));
+    elemWise->setParameter("InPlace", true);
+
+    Tensor<Float_T> inputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffOutputsA({8, 8, nbOutputs, 2});
+
+    // The parent outputs are bound to both inputs
+    parent->addInput(inputsA, diffOutputsA);
+    dn.addCell(parent, std::vector<std::shared_ptr<Cell> >(1));
+    elemWise->addInput(parent.get());
+    elemWise->addInput(parent.get());
+    dn.addCell(elemWise, std::vector<std::shared_ptr<Cell> >(1, parent));
+
+    parent->initialize();
+    elemWise->initialize();
+
+    ASSERT_TRUE(!elemWise->isInPlace(false));
+    ASSERT_TRUE(!elemWise->isInPlace(true));
+
+    for (unsigned int pass = 0; pass < 2; ++pass) {
+        for (unsigned int index = 0; index < inputsA.size(); ++index)
+            inputsA(index) = Random::randUniform(-1.0, 1.0);
+
+        parent->propagate(inference);
+        elemWise->propagate(inference);
+
+        const Tensor<Float_T>& parentOutputs
+            = tensor_cast<Float_T>(parent->getOutputs());
+        const Tensor<Float_T>& outputs
+            = tensor_cast<Float_T>(elemWise->getOutputs());
+
+        // The shared input must be left untouched
+        for (unsigned int o = 0; o < outputs.size(); ++o) {
+            ASSERT_EQUALS_DELTA(parentOutputs(o), inputsA(o), 1.0e-6);
+            ASSERT_EQUALS_DELTA(outputs(o), 1.5 * inputsA(o), 1.0e-6);
+        }
+    }
+}
+
+TEST(ElemWiseCell_Frame,
+     propagate_sum2_inPlace_softmax)
+{
+    const unsigned int nbOutputs = 4;
+
+    Tensor<Float_T> inputsA({8, 8, nbOutputs, 2});
+    Tensor<Float_T> inputsB({8, 8, nbOutputs, 2});
+    Tensor<Float_T> diffInputs({8, 8, nbOutputs, 2});
+
+    Random::mtSeed(0);
+
+    for (unsigned int index = 0; index < inputsA.size(); ++index) {
+        inputsA(index) = Random::randUniform(-1.0, 1.0);
+        inputsB(index) = Random::randUniform(-1.0, 1.0);
+        diffInputs(index) = Random::randUniform(-1.0, 1.0);
+    }
+
+    // Softmax reads its own outputs in backPropagate(): its gradients must
+    // be the same with and without the in-place Sum
+    std::vector<Tensor<Float_T> > diffOutputsSoftmax;
+
+    for (unsigned int inPlace = 0; inPlace < 2; ++inPlace) {
+        Network net;
+        DeepNet dn(net);
+
+        std::shared_ptr<SoftmaxCell_Frame<Float_T> > softmax
+            = std::make_shared<SoftmaxCell_Frame<Float_T> >(dn, "softmax",
+                                                             nbOutputs);
+        std::shared_ptr<ElemWiseCell_Frame_Test> elemWise = std::make_shared
+            <ElemWiseCell_Frame_Test>(dn, "elemwise", nbOutputs,
+                                      ElemWiseCell::Sum);
+        elemWise->setParameter("InPlace", (bool)inPlace);
+
+        Tensor<Float_T> diffOutputsA(inputsA.dims());
+        Tensor<Float_T> diffOutputsB(inputsB.dims());
+
+        softmax->addInput(inputsA, diffOutputsA);
+        dn.addCell(softmax, std::vector<std::shared_ptr<Cell> >(1));
+        elemWise->addInput(softmax.get());
+        elemWise->addInput(inputsB, diffOutputsB);
+        dn.addCell(elemWise, std::vector<std::shared_ptr<Cell> >(1, softmax));
+
+        softmax->initialize();
+        elemWise->initialize();
+
+        ASSERT_TRUE(!elemWise->isInPlace(false));
+
+        softmax->propagate(false);
+        elemWise->propagate(false);
+
+        Tensor<Float_T> elemWiseDiffInputs = tensor_cast_nocopy<Float_T>(
+            elemWise->getDiffInputs());
+
+        for (unsigned int index = 0; index < diffInputs.size(); ++index)
+            elemWiseDiffInputs(index) = diffInputs(index);
+
+        elemWiseDiffInputs.setValid();
+
+        elemWise->backPropagate();
+        softmax->backPropagate();
+
+        diffOutputsSoftmax.push_back(diffOutputsA.clone());
+    }
+
+    for (unsigned int index = 0; index < inputsA.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputsSoftmax[1](index),
+                            diffOutputsSoftmax[0](index), 1.0e-6);
+    }
+}
+
+TEST(ElemWiseCell_Frame,
+     propagate_sum2_half)
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    const unsigned int nbOutputs = 4;
+
+    ElemWiseCell_Frame<half_float::half> elemWise(dn, "elemwise",
+                                                  nbOutputs,
+                                                  ElemWiseCell::Sum,
+                                                  std::vector<Float_T>(),
+                                                  std::vector<Float_T>(
+                                                    {0.5, 0.0}));
+
+    Tensor<half_float::half> inputsA({8, 8, nbOutputs, 2});
+    Tensor<half_float::half> inputsB({8, 8, nbOutputs, 2});
+    Tensor<half_float::half> diffOutputsA({8, 8, nbOutputs, 2});
+    Tensor<half_float::half> diffOutputsB({8, 8, nbOutputs, 2});
+
+    for (unsigned int index = 0; index < inputsA.size(); ++index) {
+        inputsA(index) = half_float::half(Random::randUniform(-1.0, 1.0));
+        inputsB(index) = half_float::half(Random::randUniform(-1.0, 1.0));
+    }
+
+    elemWise.addInput(inputsA, diffOutputsA);
+    elemWise.addInput(inputsB, diffOutputsB);
+    elemWise.initialize();
+
+    elemWise.propagate();
+    const Tensor<half_float::half>& outputs
+        = tensor_cast<half_float::half>(elemWise.getOutputs());
+
+    for (unsigned int o = 0; o < outputs.size(); ++o) {
+        ASSERT_EQUALS_DELTA((float)outputs(o),
+                            (float)inputsA(o) + (float)inputsB(o) + 0.5f,
+                            1.0e-2);
+    }
+}
+
 RUN_TESTS()
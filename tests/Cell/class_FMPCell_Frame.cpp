@@ -0,0 +1,332 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/FMPCell_Frame.hpp"
+#include "containers/Tensor.hpp"
+#include "DeepNet.hpp"
+#include "Network.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Random.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace N2D2;
+
+class FMPCell_Frame_Test : public FMPCell_Frame {
+public:
+    FMPCell_Frame_Test(const DeepNet& deepNet,
+                       const std::string& name,
+                       double scalingRatio,
+                       unsigned int nbOutputs)
+        : Cell(deepNet, name, nbOutputs),
+          FMPCell(deepNet, name, scalingRatio, nbOutputs),
+          FMPCell_Frame(deepNet, name, scalingRatio, nbOutputs)
+    {
+    }
+
+    void setOneToOneMapping()
+    {
+        for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+            for (unsigned int channel = 0; channel < getNbChannels();
+                ++channel)
+            {
+                mMapping(output, channel) = (output == channel);
+            }
+        }
+    }
+
+    void lockRandom(bool lock)
+    {
+        mLockRandom = lock;
+    }
+
+    /// Reference implementation (list of outputs to backpropagate from, for
+    /// each input, filled in a critical section)
+    void propagateReference(Tensor<Float_T>& outputs,
+                            Tensor<std::vector<unsigned int> >& inputsBackProp)
+    {
+        const Tensor<Float_T>& input0 = tensor_cast<Float_T>(mInputs[0]);
+
+        outputs.resize(mOutputs.dims());
+        inputsBackProp.assign({mInputs[0].dimX(),
+                               mInputs[0].dimY(),
+                               mInputs.dimZ(),
+                               mInputs.dimB()},
+                               std::vector<unsigned int>());
+
+#pragma omp parallel for collapse(2)
+        for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
+            for (unsigned int output = 0; output < getNbOutputs(); ++output) {
+                for (unsigned int oy = 0; oy < mOutputs.dimY(); ++oy) {
+                    for (unsigned int ox = 0; ox < mOutputs.dimX(); ++ox) {
+                        if (mPoolNbChannels[output] == 0)
+                            continue;
+
+                        Float_T poolValue =
+                            -std::numeric_limits<Float_T>::infinity();
+                        unsigned int channelMax = 0;
+                        unsigned int ixMax = 0;
+                        unsigned int iyMax = 0;
+
+                        for (unsigned int channel = 0;
+                            channel < getNbChannels(); ++channel)
+                        {
+                            if (!isConnection(channel, output))
+                                continue;
+
+                            const unsigned int ixStart
+                                = (ox > 0) ? mGridX[ox - 1] : 0;
+                            const unsigned int iyStart
+                                = (oy > 0) ? mGridY[oy - 1] : 0;
+                            unsigned int ixStop = mGridX[ox];
+                            unsigned int iyStop = mGridY[oy];
+
+                            if (!mOverlapping) {
+                                --ixStop;
+                                --iyStop;
+                            }
+
+                            if (ox == mOutputs.dimX() - 1)
+                                ixStop = input0.dimX() - 1;
+
+                            if (oy == mOutputs.dimY() - 1)
+                                iyStop = input0.dimY() - 1;
+
+                            for (unsigned int iy = iyStart; iy <= iyStop;
+                                ++iy)
+                            {
+                                for (unsigned int ix = ixStart; ix <= ixStop;
+                                    ++ix)
+                                {
+                                    if (input0(ix, iy, channel, batchPos)
+                                        > poolValue)
+                                    {
+                                        poolValue = input0(ix, iy, channel,
+                                                           batchPos);
+                                        channelMax = channel;
+                                        ixMax = ix;
+                                        iyMax = iy;
+                                    }
+                                }
+                            }
+                        }
+
+#pragma omp critical(FMPCell_Frame_Test__propagateReference)
+                        inputsBackProp(ixMax, iyMax, channelMax, batchPos)
+                            .push_back(ox + oy * mOutputs.dimX()
+                                       + output * mOutputs.dimX()
+                                         * mOutputs.dimY());
+
+                        outputs(ox, oy, output, batchPos) = poolValue;
+                    }
+                }
+            }
+        }
+    }
+
+    void backPropagateReference(
+        const Tensor<std::vector<unsigned int> >& inputsBackProp,
+        Tensor<Float_T>& diffOutputs)
+    {
+        diffOutputs.resize(mInputs[0].dims());
+
+#pragma omp parallel for collapse(2)
+        for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
+            for (unsigned int channel = 0; channel < getNbChannels();
+                ++channel)
+            {
+                for (unsigned int iy = 0; iy < mInputs[0].dimY(); ++iy) {
+                    for (unsigned int ix = 0; ix < mInputs[0].dimX(); ++ix) {
+                        Float_T gradient = 0.0;
+
+                        for (std::vector<unsigned int>::const_iterator it
+                            = inputsBackProp(ix, iy, channel, batchPos)
+                                .begin(),
+                            itEnd = inputsBackProp(ix, iy, channel, batchPos)
+                                .end(); it != itEnd; ++it)
+                        {
+                            gradient += mDiffInputs(*it, batchPos);
+                        }
+
+                        diffOutputs(ix, iy, channel, batchPos) = gradient;
+                    }
+                }
+            }
+        }
+    }
+
+    Tensor<Float_T>& getDiffInputsRef()
+    {
+        return mDiffInputs;
+    }
+};
+
+TEST_DATASET(FMPCell_Frame,
+             propagate_backPropagate,
+             (double scalingRatio,
+              bool overlapping,
+              bool oneToOne,
+              unsigned int inputSize,
+              unsigned int nbChannels,
+              unsigned int batchSize),
+             std::make_tuple(1.414, true, true, 32U, 4U, 2U),
+             std::make_tuple(1.414, false, true, 32U, 4U, 2U),
+             std::make_tuple(1.5, true, false, 25U, 3U, 5U),
+             std::make_tuple(1.5, false, false, 25U, 3U, 5U),
+             std::make_tuple(2.0, true, true, 64U, 16U, 8U))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    FMPCell_Frame_Test fmp(dn, "fmp", scalingRatio, nbChannels);
+    fmp.setParameter("Overlapping", overlapping);
+
+    Tensor<Float_T> inputs({inputSize, inputSize, nbChannels, batchSize});
+    Tensor<Float_T> diffOutputs({inputSize, inputSize, nbChannels,
+                                 batchSize});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    fmp.addInput(inputs, diffOutputs);
+
+    if (oneToOne)
+        fmp.setOneToOneMapping();
+
+    fmp.initialize();
+    fmp.propagate();
+
+    const Tensor<Float_T>& outputs
+        = tensor_cast_nocopy<Float_T>(fmp.getOutputs());
+
+    Tensor<Float_T>& diffInputs = fmp.getDiffInputsRef();
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = Random::randUniform(-1.0, 1.0);
+
+    diffInputs.setValid();
+    fmp.backPropagate();
+
+    // Same regions for the reference implementation
+    Tensor<Float_T> outputsRef;
+    Tensor<std::vector<unsigned int> > inputsBackProp;
+    fmp.propagateReference(outputsRef, inputsBackProp);
+
+    Tensor<Float_T> diffOutputsRef;
+    fmp.backPropagateReference(inputsBackProp, diffOutputsRef);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS(outputs(index), outputsRef(index));
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputs(index), diffOutputsRef(index),
+                            1.0e-6);
+    }
+}
+
+TEST_DATASET(FMPCell_Frame,
+             propagate_backPropagate_threads,
+             (double scalingRatio,
+              bool overlapping,
+              unsigned int inputSize,
+              unsigned int nbChannels,
+              unsigned int batchSize),
+             std::make_tuple(1.414, true, 32U, 8U, 4U),
+             std::make_tuple(1.5, false, 25U, 3U, 9U))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    FMPCell_Frame_Test fmp(dn, "fmp", scalingRatio, nbChannels);
+    fmp.setParameter("Overlapping", overlapping);
+
+    Tensor<Float_T> inputs({inputSize, inputSize, nbChannels, batchSize});
+    Tensor<Float_T> diffOutputs({inputSize, inputSize, nbChannels,
+                                 batchSize});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    fmp.addInput(inputs, diffOutputs);
+    fmp.setOneToOneMapping();
+    fmp.initialize();
+
+    Tensor<Float_T>& diffInputs = fmp.getDiffInputsRef();
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = Random::randUniform(-1.0, 1.0);
+
+    // Same regions for every run
+    fmp.lockRandom(true);
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+
+    fmp.propagate();
+    diffInputs.setValid();
+    fmp.backPropagate();
+
+    const Tensor<Float_T>& outputs
+        = tensor_cast_nocopy<Float_T>(fmp.getOutputs());
+    const Tensor<Float_T> outputs1(outputs.dims(), outputs.begin(),
+                                   outputs.end());
+    const Tensor<Float_T> diffOutputs1(diffOutputs.dims(),
+                                       diffOutputs.begin(),
+                                       diffOutputs.end());
+
+#ifdef _OPENMP
+    // Oversubscribe if needed, so that the parallel paths are always taken
+    omp_set_num_threads(std::max(maxThreads, 4));
+#endif
+
+    diffOutputs.fill(0.0);
+    fmp.propagate();
+    diffInputs.setValid();
+    fmp.backPropagate();
+
+#ifdef _OPENMP
+    omp_set_num_threads(maxThreads);
+#endif
+
+    // Results must not depend on the number of threads
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS(outputs(index), outputs1(index));
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index)
+        ASSERT_EQUALS(diffOutputs(index), diffOutputs1(index));
+}
+
+RUN_TESTS()
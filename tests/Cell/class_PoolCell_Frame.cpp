@@ -28,6 +28,7 @@
 #include "third_party/half.hpp"
 #include "Transformation/ColorSpaceTransformation.hpp"
 #include "Transformation/RescaleTransformation.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 
 using namespace N2D2;
@@ -1474,4 +1475,272 @@ TEST_DATASET(PoolCell_Frame,
 }
 
 
+/// Reference implementation of the pooling kernels (direct loops over the
+/// windows and the maps, for every output)
+template <class T>
+void poolForwardReference(const Tensor<T>& inputs,
+                          const PoolCell_Frame_Kernels::Descriptor& desc,
+                          Tensor<T>& outputs,
+                          Tensor<PoolCell_Frame_Kernels::ArgMax>& argMax,
+                          bool max,
+                          const Tensor<bool>& maps)
+{
+    for (unsigned int batchPos = 0; batchPos < inputs.dimB(); ++batchPos) {
+        for (unsigned int output = 0; output < outputs.dimZ(); ++output) {
+            for (unsigned int oy = 0; oy < outputs.dimY(); ++oy) {
+                for (unsigned int ox = 0; ox < outputs.dimX(); ++ox) {
+                    const int ix = (int)(ox * desc.stride[0]) - desc.padding[0];
+                    const int iy = (int)(oy * desc.stride[1]) - desc.padding[1];
+
+                    T poolValue(0.0);
+                    unsigned int poolCount = 0;
+                    PoolCell_Frame_Kernels::ArgMax inputMax;
+
+                    for (unsigned int channel = 0; channel < inputs.dimZ();
+                         ++channel)
+                    {
+                        if (!maps.empty() && !maps(output, channel))
+                            continue;
+
+                        for (unsigned int sy = 0; sy < desc.pool[1]; ++sy) {
+                            for (unsigned int sx = 0; sx < desc.pool[0]; ++sx)
+                            {
+                                if (ix + (int)sx < 0 || iy + (int)sy < 0
+                                    || ix + sx >= inputs.dimX()
+                                    || iy + sy >= inputs.dimY())
+                                {
+                                    continue;
+                                }
+
+                                const T value = inputs(ix + sx, iy + sy,
+                                                       channel, batchPos);
+
+                                if (!max)
+                                    poolValue += value;
+                                else if (!inputMax.valid || value > poolValue)
+                                {
+                                    poolValue = value;
+                                    inputMax = PoolCell_Frame_Kernels::ArgMax(
+                                        ix + sx, iy + sy, channel, true);
+                                }
+                            }
+                        }
+
+                        poolCount += desc.pool[0] * desc.pool[1];
+                    }
+
+                    if (max)
+                        argMax(ox, oy, output, batchPos) = inputMax;
+                    else if (poolCount > 0)
+                        poolValue /= poolCount;
+
+                    outputs(ox, oy, output, batchPos) = poolValue;
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+void poolBackwardReference(const Tensor<T>& diffInputs,
+                           const PoolCell_Frame_Kernels::Descriptor& desc,
+                           Tensor<T>& diffOutputs,
+                           const Tensor<PoolCell_Frame_Kernels::ArgMax>&
+                                argMax,
+                           bool max,
+                           const Tensor<bool>& maps)
+{
+    diffOutputs.fill(T(0.0));
+
+    for (unsigned int batchPos = 0; batchPos < diffInputs.dimB(); ++batchPos)
+    {
+        for (unsigned int output = 0; output < diffInputs.dimZ(); ++output) {
+            unsigned int nbChannels = 0;
+
+            for (unsigned int channel = 0; channel < diffOutputs.dimZ();
+                 ++channel)
+            {
+                nbChannels += (maps.empty() || maps(output, channel));
+            }
+
+            for (unsigned int oy = 0; oy < diffInputs.dimY(); ++oy) {
+                for (unsigned int ox = 0; ox < diffInputs.dimX(); ++ox) {
+                    const T diffInput = diffInputs(ox, oy, output, batchPos);
+
+                    if (max) {
+                        const PoolCell_Frame_Kernels::ArgMax inputMax
+                            = argMax(ox, oy, output, batchPos);
+
+                        if (inputMax.valid) {
+                            diffOutputs(inputMax.ix, inputMax.iy,
+                                        inputMax.channel, batchPos)
+                                += diffInput;
+                        }
+
+                        continue;
+                    }
+
+                    const int ix = (int)(ox * desc.stride[0]) - desc.padding[0];
+                    const int iy = (int)(oy * desc.stride[1]) - desc.padding[1];
+
+                    for (unsigned int channel = 0;
+                         channel < diffOutputs.dimZ(); ++channel)
+                    {
+                        if (!maps.empty() && !maps(output, channel))
+                            continue;
+
+                        for (unsigned int sy = 0; sy < desc.pool[1]; ++sy) {
+                            for (unsigned int sx = 0; sx < desc.pool[0]; ++sx)
+                            {
+                                if (ix + (int)sx < 0 || iy + (int)sy < 0
+                                    || ix + sx >= diffOutputs.dimX()
+                                    || iy + sy >= diffOutputs.dimY())
+                                {
+                                    continue;
+                                }
+
+                                diffOutputs(ix + sx, iy + sy, channel,
+                                            batchPos)
+                                    += diffInput / (T)(nbChannels
+                                        * desc.pool[0] * desc.pool[1]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+void fillRandom(Tensor<T>& tensor)
+{
+    for (unsigned int index = 0; index < tensor.size(); ++index)
+        tensor(index) = T(Random::randUniform(-1.0, 1.0));
+}
+
+TEST_DATASET(PoolCell_Frame_Kernels,
+             forward_backward,
+             (unsigned int poolWidth,
+              unsigned int poolHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              unsigned int paddingX,
+              unsigned int paddingY,
+              unsigned int mapping),
+             // One-to-one mapping
+             std::make_tuple(2U, 2U, 2U, 2U, 0U, 0U, 0U),
+             std::make_tuple(3U, 3U, 2U, 2U, 0U, 0U, 0U),
+             std::make_tuple(3U, 3U, 2U, 2U, 1U, 1U, 0U),
+             std::make_tuple(3U, 3U, 1U, 1U, 1U, 1U, 0U),
+             std::make_tuple(2U, 5U, 1U, 3U, 1U, 2U, 0U),
+             // Outputs connected to one channel, not one-to-one
+             std::make_tuple(2U, 2U, 2U, 2U, 0U, 0U, 1U),
+             std::make_tuple(3U, 3U, 2U, 2U, 1U, 1U, 1U),
+             // Full mapping
+             std::make_tuple(2U, 2U, 2U, 2U, 0U, 0U, 2U),
+             std::make_tuple(3U, 3U, 2U, 2U, 1U, 1U, 2U),
+             std::make_tuple(2U, 5U, 1U, 3U, 1U, 2U, 2U))
+{
+    Random::mtSeed(0);
+
+    const unsigned int nbChannels = 4;
+    const unsigned int inputsWidth = 13;
+    const unsigned int inputsHeight = 11;
+    const unsigned int batchSize = 3;
+
+    Tensor<bool> maps;
+
+    if (mapping == 0) {
+        maps.resize({nbChannels, nbChannels});
+
+        for (unsigned int output = 0; output < nbChannels; ++output) {
+            for (unsigned int channel = 0; channel < nbChannels; ++channel)
+                maps(output, channel) = (output == channel);
+        }
+    }
+    else if (mapping == 1) {
+        // Channel 1 connected to outputs 1 and 2, output 3 not connected
+        maps << "1 0 0 0\n"
+                "0 1 1 0\n"
+                "0 0 0 0\n"
+                "0 0 0 0";
+    }
+
+    const PoolCell_Frame_Kernels::Descriptor desc(2,
+        std::vector<unsigned int>({poolWidth, poolHeight}).data(),
+        std::vector<unsigned int>({strideX, strideY}).data(),
+        std::vector<unsigned int>({paddingX, paddingY}).data());
+
+    const unsigned int outputsWidth
+        = (inputsWidth + 2 * paddingX - poolWidth) / strideX + 1;
+    const unsigned int outputsHeight
+        = (inputsHeight + 2 * paddingY - poolHeight) / strideY + 1;
+
+    Tensor<double> inputs({inputsWidth, inputsHeight, nbChannels, batchSize});
+    Tensor<double> diffInputs({outputsWidth, outputsHeight, nbChannels,
+                               batchSize});
+    fillRandom(inputs);
+    fillRandom(diffInputs);
+
+    const double alpha = 1.0;
+    const double beta = 0.0;
+
+    for (unsigned int max = 0; max < 2; ++max) {
+        Tensor<double> outputs({outputsWidth, outputsHeight, nbChannels,
+                                batchSize});
+        Tensor<double> outputsRef(outputs.dims());
+        Tensor<PoolCell_Frame_Kernels::ArgMax> argMax(outputs.dims());
+        Tensor<PoolCell_Frame_Kernels::ArgMax> argMaxRef(outputs.dims());
+
+        if (max) {
+            PoolCell_Frame_Kernels::forwardMax(&alpha, inputs, desc, &beta,
+                                               outputs, argMax, false, maps);
+        }
+        else {
+            PoolCell_Frame_Kernels::forwardAverage(&alpha, inputs, desc,
+                                                   &beta, outputs, true,
+                                                   maps);
+        }
+
+        poolForwardReference(inputs, desc, outputsRef, argMaxRef, max, maps);
+
+        for (unsigned int index = 0; index < outputs.size(); ++index) {
+            ASSERT_EQUALS_DELTA(outputs(index), outputsRef(index), 1.0e-12);
+
+            if (max)
+                ASSERT_TRUE(argMax(index) == argMaxRef(index));
+        }
+
+        // Backward, accumulated (beta = 1) on a non-zero gradient
+        Tensor<double> diffOutputs(inputs.dims());
+        Tensor<double> diffOutputsRef(inputs.dims());
+        fillRandom(diffOutputs);
+        const Tensor<double> diffOutputsPrev(diffOutputs.dims(),
+                                             diffOutputs.begin(),
+                                             diffOutputs.end());
+        const double betaAcc = 1.0;
+
+        if (max) {
+            PoolCell_Frame_Kernels::backwardMax(&alpha, diffInputs, desc,
+                                                &betaAcc, diffOutputs, argMax,
+                                                maps);
+        }
+        else {
+            PoolCell_Frame_Kernels::backwardAverage(&alpha, diffInputs, desc,
+                                                    &betaAcc, diffOutputs,
+                                                    true, maps);
+        }
+
+        poolBackwardReference(diffInputs, desc, diffOutputsRef, argMaxRef,
+                              max, maps);
+
+        for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+            ASSERT_EQUALS_DELTA(diffOutputs(index),
+                                diffOutputsPrev(index)
+                                    + diffOutputsRef(index), 1.0e-12);
+        }
+    }
+}
+
 RUN_TESTS()
@@ -24,6 +24,7 @@
 #include "DeepNet.hpp"
 #include "Network.hpp"
 #include "third_party/half.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 
 using namespace N2D2;
@@ -163,6 +164,133 @@ TEST_DATASET(SoftmaxCell_Frame_float,
     }
 }
 
+TEST_DATASET(SoftmaxCell_Frame_float,
+             setOutputTargets_fusedLoss,
+             (unsigned int outputSize, unsigned int nbOutputs,
+              unsigned int batchSize),
+             std::make_tuple(1U, 10U, 1U),
+             std::make_tuple(1U, 1000U, 9U),
+             std::make_tuple(3U, 10U, 9U),
+             std::make_tuple(4U, 100U, 2U))
+{
+    Network net;
+    DeepNet dn(net);
+
+    Random::mtSeed(0);
+
+    SoftmaxCell_Frame<float> softmax1(dn, "softmax1", nbOutputs, true);
+    SoftmaxCell_Frame<float> softmax2(dn, "softmax2", nbOutputs, true);
+    softmax2.setParameter("FusedLoss", true);
+
+    Tensor<float> inputs({outputSize, outputSize, nbOutputs, batchSize});
+    Tensor<float> diffOutputs1(inputs.dims());
+    Tensor<float> diffOutputs2(inputs.dims());
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-10.0, 10.0);
+
+    Tensor<int> targets({outputSize, outputSize, 1, batchSize});
+
+    for (unsigned int index = 0; index < targets.size(); ++index)
+        targets(index) = Random::randUniform(-1, nbOutputs - 1);
+
+    softmax1.addInput(inputs, diffOutputs1);
+    softmax2.addInput(inputs, diffOutputs2);
+    softmax1.initialize();
+    softmax2.initialize();
+    softmax1.propagate();
+    softmax2.propagate();
+
+    const double loss1 = (outputSize == 1)
+        ? softmax1.setOutputTarget(targets, 1.0, 0.0)
+        : softmax1.setOutputTargets(targets, 1.0, 0.0);
+    const double loss2 = (outputSize == 1)
+        ? softmax2.setOutputTarget(targets, 1.0, 0.0)
+        : softmax2.setOutputTargets(targets, 1.0, 0.0);
+
+    ASSERT_TRUE(loss1 >= 0.0);
+
+    // Same gradient as the unfused path
+    const Tensor<float> diffInputs1
+        = tensor_cast_nocopy<float>(softmax1.getDiffInputs());
+    const Tensor<float> diffInputs2
+        = tensor_cast_nocopy<float>(softmax2.getDiffInputs());
+
+    for (unsigned int index = 0; index < diffInputs1.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffInputs2(index), diffInputs1(index),
+                            1.0e-6);
+    }
+
+    // Reference cross-entropy loss
+    double lossRef = 0.0;
+
+    for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        for (unsigned int oy = 0; oy < outputSize; ++oy) {
+            for (unsigned int ox = 0; ox < outputSize; ++ox) {
+                const int target = targets(ox, oy, 0, batchPos);
+
+                if (target < 0)
+                    continue;
+
+                double sum = 0.0;
+
+                for (unsigned int output = 0; output < nbOutputs; ++output)
+                    sum += std::exp((double)inputs(ox, oy, output, batchPos));
+
+                lossRef += std::log(sum)
+                    - inputs(ox, oy, target, batchPos);
+            }
+        }
+    }
+
+    lossRef /= batchSize;
+
+    ASSERT_EQUALS_DELTA(loss2, lossRef, 1.0e-4 * (1.0 + lossRef));
+}
+
+TEST(SoftmaxCell_Frame_float, setOutputTarget_fusedLoss_stability)
+{
+    Network net;
+    DeepNet dn(net);
+
+    SoftmaxCell_Frame<float> softmax1(dn, "softmax1", 10, true);
+    softmax1.setParameter("FusedLoss", true);
+
+    Tensor<float> inputs({1, 1, 10, 1});
+    Tensor<float> diffOutputs(inputs.dims());
+    softmax1.addInput(inputs, diffOutputs);
+    softmax1.initialize();
+
+    // The probability of the target underflows to 0
+    inputs.fill(0.0);
+    inputs(0) = 200.0;
+    softmax1.propagate();
+
+    Tensor<int> targets({1, 1, 1, 1}, 1);
+    const double loss = softmax1.setOutputTarget(targets, 1.0, 0.0);
+
+    ASSERT_EQUALS_DELTA(loss, 200.0, 1.0e-3);
+
+    targets(0) = 10;
+    ASSERT_THROW(softmax1.setOutputTarget(targets, 1.0, 0.0),
+                 std::domain_error);
+}
+
+TEST(SoftmaxCell_Frame_float, initialize_fusedLoss)
+{
+    Network net;
+    DeepNet dn(net);
+
+    SoftmaxCell_Frame<float> softmax1(dn, "softmax1", 10);
+    softmax1.setParameter("FusedLoss", true);
+
+    Tensor<float> inputs({1, 1, 10, 1});
+    Tensor<float> diffOutputs(inputs.dims());
+    softmax1.addInput(inputs, diffOutputs);
+
+    ASSERT_THROW(softmax1.initialize(), std::domain_error);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // double
 ////////////////////////////////////////////////////////////////////////////////
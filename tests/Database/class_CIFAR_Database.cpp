@@ -73,4 +73,53 @@ TEST_DATASET(CIFAR100_Database,
     ASSERT_EQUALS(db.getNbLabels(), 100U);
 }
 
+TEST(CIFAR_Database, loadCIFAR)
+{
+    const unsigned int nbImages = 3;
+    const unsigned int size = 32 * 32;
+
+    UnitTest::FileWriteContent("CIFAR_Database_labels.txt",
+                               "cat\ndog\nbird\n");
+
+    std::ofstream data("CIFAR_Database_data.bin", std::fstream::binary);
+
+    for (unsigned int i = 0; i < nbImages; ++i) {
+        data.put((char)(i % 3));
+
+        // Planar RGB
+        for (unsigned int c = 0; c < 3; ++c) {
+            for (unsigned int index = 0; index < size; ++index)
+                data.put((char)((index + 10 * c + i) % 256));
+        }
+    }
+
+    data.close();
+
+    CIFAR10_Database db;
+    db.loadCIFAR("CIFAR_Database_data.bin", "CIFAR_Database_labels.txt");
+
+    ASSERT_EQUALS(db.getNbStimuli(), nbImages);
+    ASSERT_EQUALS(db.getNbLabels(), 3U);
+
+    for (unsigned int i = 0; i < nbImages; ++i) {
+        ASSERT_EQUALS(db.getStimulusLabel(i), db.getLabelID(
+            (i % 3 == 0) ? "cat" : (i % 3 == 1) ? "dog" : "bird"));
+
+        const cv::Mat mat = db.getStimulusData(i);
+
+        ASSERT_EQUALS(mat.rows, 32);
+        ASSERT_EQUALS(mat.cols, 32);
+        ASSERT_EQUALS(mat.type(), CV_8UC3);
+
+        for (unsigned int index = 0; index < size; ++index) {
+            const cv::Vec3b& pixel = mat.at<cv::Vec3b>(index / 32, index % 32);
+
+            // Vec3b color order: blue, green, red
+            ASSERT_EQUALS(pixel[2], (unsigned char)((index + i) % 256));
+            ASSERT_EQUALS(pixel[1], (unsigned char)((index + 10 + i) % 256));
+            ASSERT_EQUALS(pixel[0], (unsigned char)((index + 20 + i) % 256));
+        }
+    }
+}
+
 RUN_TESTS()
@@ -0,0 +1,173 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Database/DIR_Database.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+#include <cstdio>
+
+using namespace N2D2;
+
+namespace {
+void createTree(const std::string& dirPath)
+{
+    Utils::createDirectories(dirPath + "/b/b1");
+    Utils::createDirectories(dirPath + "/a");
+    Utils::createDirectories(dirPath + "/c");
+
+    UnitTest::FileWriteContent(dirPath + "/root.csv", "0");
+    UnitTest::FileWriteContent(dirPath + "/a/a2.csv", "0");
+    UnitTest::FileWriteContent(dirPath + "/a/a1.csv", "0");
+    UnitTest::FileWriteContent(dirPath + "/a/ignored.xyz", "0");
+    UnitTest::FileWriteContent(dirPath + "/b/b1.csv", "0");
+    UnitTest::FileWriteContent(dirPath + "/b/b1/b11.csv", "0");
+    UnitTest::FileWriteContent(dirPath + "/c/c1.csv", "0");
+}
+}
+
+TEST_DATASET(DIR_Database,
+             loadDir,
+             (int depth, int labelDepth, bool manifest),
+             std::make_tuple(0, 0, false),
+             std::make_tuple(1, 1, false),
+             std::make_tuple(-1, 1, false),
+             std::make_tuple(-1, 2, false),
+             std::make_tuple(-1, -1, false),
+             std::make_tuple(-1, 1, true),
+             std::make_tuple(-1, 2, true))
+{
+    const std::string dirPath = "DIR_Database_loadDir";
+    const std::string manifestFile = "DIR_Database_loadDir.manifest";
+    createTree(dirPath);
+    std::remove(manifestFile.c_str());
+
+    // Two loads: the second one may use the manifest
+    for (unsigned int n = 0; n < 2; ++n) {
+        DIR_Database db;
+
+        if (manifest)
+            db.setParameter("ManifestFile", manifestFile);
+
+        db.setIgnoreMasks(std::vector<std::string>(1, "*/c"));
+        db.loadDir(dirPath, depth, "root", labelDepth);
+
+        // Stimuli are sorted, files first, then sub-directories
+        std::vector<std::string> expected;
+        std::vector<std::string> expectedLabels;
+        expected.push_back(dirPath + "/root.csv");
+        expectedLabels.push_back("root");
+
+        if (depth != 0) {
+            expected.push_back(dirPath + "/a/a1.csv");
+            expected.push_back(dirPath + "/a/a2.csv");
+            expected.push_back(dirPath + "/b/b1.csv");
+            expectedLabels.push_back("root/a");
+            expectedLabels.push_back("root/a");
+            expectedLabels.push_back("root/b");
+
+            if (depth < 0) {
+                expected.push_back(dirPath + "/b/b1/b11.csv");
+                expectedLabels.push_back((labelDepth > 1) ? "root/b/b1"
+                                                          : "root/b");
+            }
+        }
+
+        ASSERT_EQUALS(db.getNbStimuli(), expected.size());
+
+        for (unsigned int id = 0; id < expected.size(); ++id) {
+            ASSERT_EQUALS(db.getStimulusName(id), expected[id]);
+
+            if (labelDepth < 0) {
+                ASSERT_EQUALS(db.getStimulusLabel(id), -1);
+            }
+            else {
+                ASSERT_EQUALS(db.getLabelName(db.getStimulusLabel(id)),
+                              expectedLabels[id]);
+            }
+        }
+
+        if (manifest)
+            ASSERT_TRUE(UnitTest::FileExists(manifestFile));
+    }
+}
+
+TEST(DIR_Database, loadDir_manifestUpdate)
+{
+    const std::string dirPath = "DIR_Database_loadDir_manifestUpdate";
+    const std::string manifestFile = dirPath + ".manifest";
+    createTree(dirPath);
+    std::remove((dirPath + "/a/a3.csv").c_str());
+    std::remove(manifestFile.c_str());
+
+    {
+        DIR_Database db;
+        db.setParameter("ManifestFile", manifestFile);
+        db.loadDir(dirPath, -1, "", 1);
+
+        ASSERT_EQUALS(db.getNbStimuli(), 6U);
+    }
+
+    // Directories modified less than a second before the scan are never
+    // trusted: new files must be found
+    UnitTest::FileWriteContent(dirPath + "/a/a3.csv", "0");
+
+    DIR_Database db;
+    db.setParameter("ManifestFile", manifestFile);
+    db.loadDir(dirPath, -1, "", 1);
+
+    ASSERT_EQUALS(db.getNbStimuli(), 7U);
+    ASSERT_EQUALS(db.getStimulusName(3), dirPath + "/a/a3.csv");
+}
+
+TEST(DIR_Database, loadDir_manifestPrune)
+{
+    const std::string dirPath = "DIR_Database_loadDir_manifestPrune";
+    const std::string manifestFile = dirPath + ".manifest";
+    createTree(dirPath);
+    std::remove(manifestFile.c_str());
+
+    {
+        DIR_Database db;
+        db.setParameter("ManifestFile", manifestFile);
+        db.loadDir(dirPath, -1, "", 1);
+
+        ASSERT_EQUALS(db.getNbStimuli(), 6U);
+    }
+
+    ASSERT_TRUE(UnitTest::FileReadContent(manifestFile)
+                    .find(dirPath + "/b/b1\n") != std::string::npos);
+
+    // Remove a directory: its entry must be pruned from the manifest
+    std::remove((dirPath + "/b/b1/b11.csv").c_str());
+    std::remove((dirPath + "/b/b1").c_str());
+
+    DIR_Database db;
+    db.setParameter("ManifestFile", manifestFile);
+    db.loadDir(dirPath, -1, "", 1);
+
+    ASSERT_EQUALS(db.getNbStimuli(), 5U);
+    ASSERT_TRUE(UnitTest::FileReadContent(manifestFile)
+                    .find(dirPath + "/b/b1") == std::string::npos);
+}
+
+RUN_TESTS()
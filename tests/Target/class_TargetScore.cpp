@@ -0,0 +1,95 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Target/TargetScore.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+TEST_DATASET(TargetScore,
+             labelPairHistogram,
+             (unsigned int size, unsigned int nbTargets),
+             std::make_tuple(1U, 2U),
+             std::make_tuple(255U, 3U),
+             std::make_tuple(256U, 10U),
+             std::make_tuple(1000U, 19U),
+             std::make_tuple(2048U * 1024U, 19U))
+{
+    Random::mtSeed(0);
+
+    std::vector<int> target(size);
+    std::vector<int> estimated(size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        target[i] = Random::randUniform(-1, nbTargets - 1);
+        estimated[i] = (Random::randUniform() > 0.5)
+            ? target[i] : Random::randUniform(0, nbTargets - 1);
+
+        if (estimated[i] < 0)
+            estimated[i] = 0;
+    }
+
+    std::vector<unsigned long long int> histogram(nbTargets * nbTargets + 1,
+                                                  0ULL);
+    std::vector<unsigned int> nbLabels(nbTargets + 1, 0U);
+    std::vector<unsigned int> nbHits(nbTargets + 1, 0U);
+
+    TargetScore::labelPairHistogram(&target[0],
+                                    &estimated[0],
+                                    size,
+                                    nbTargets,
+                                    &histogram[0],
+                                    &nbLabels[0],
+                                    &nbHits[0]);
+
+    // Reference
+    ConfusionMatrix<unsigned long long int> confusion(nbTargets, nbTargets, 0);
+    std::vector<unsigned int> nbLabelsRef(nbTargets, 0U);
+    std::vector<unsigned int> nbHitsRef(nbTargets, 0U);
+    unsigned int nbIgnored = 0;
+
+    for (unsigned int i = 0; i < size; ++i) {
+        if (target[i] >= 0) {
+            confusion(target[i], estimated[i]) += 1;
+            ++nbLabelsRef[target[i]];
+
+            if (target[i] == estimated[i])
+                ++nbHitsRef[target[i]];
+        }
+        else
+            ++nbIgnored;
+    }
+
+    for (unsigned int t = 0; t < nbTargets; ++t) {
+        ASSERT_EQUALS(nbLabels[t], nbLabelsRef[t]);
+        ASSERT_EQUALS(nbHits[t], nbHitsRef[t]);
+
+        for (unsigned int e = 0; e < nbTargets; ++e)
+            ASSERT_EQUALS(histogram[t * nbTargets + e], confusion(t, e));
+    }
+
+    ASSERT_EQUALS(histogram[nbTargets * nbTargets], nbIgnored);
+    ASSERT_EQUALS(nbLabels[nbTargets], nbIgnored);
+}
+
+RUN_TESTS()
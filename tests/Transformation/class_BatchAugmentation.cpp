@@ -0,0 +1,197 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Transformation/BatchAugmentation.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+TEST_DATASET(BatchAugmentation,
+             apply__geometric,
+             (unsigned int randomShift,
+              bool horizontalFlip,
+              bool verticalFlip),
+             std::make_tuple(0U, true, false),
+             std::make_tuple(0U, false, true),
+             std::make_tuple(3U, false, false),
+             std::make_tuple(3U, true, true))
+{
+    const unsigned int dimX = 9;
+    const unsigned int dimY = 7;
+    const unsigned int nbChannels = 3;
+    const unsigned int batchSize = 16;
+
+    Tensor<Float_T> data({dimX, dimY, nbChannels, batchSize});
+    Tensor<int> labels({dimX, dimY, 1, batchSize});
+
+    for (unsigned int index = 0; index < data.size(); ++index)
+        data(index) = index;
+
+    for (unsigned int index = 0; index < labels.size(); ++index)
+        labels(index) = index;
+
+    const Tensor<Float_T> dataRef = data.clone();
+    const Tensor<int> labelsRef = labels.clone();
+
+    BatchAugmentation augmentation;
+    augmentation.setParameter("RandomHorizontalFlip", horizontalFlip);
+    augmentation.setParameter("RandomVerticalFlip", verticalFlip);
+    augmentation.setParameter("RandomShift", randomShift);
+
+    Random::mtSeed(0);
+    augmentation.apply(data, labels);
+
+    // Same random draws as BatchAugmentation::apply()
+    Random::mtSeed(0);
+
+    for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        const bool hFlip = (horizontalFlip) ? Random::randBernoulli() : false;
+        const bool vFlip = (verticalFlip) ? Random::randBernoulli() : false;
+        const int shiftX = (randomShift > 0)
+            ? Random::randUniform(-(int)randomShift, (int)randomShift) : 0;
+        const int shiftY = (randomShift > 0)
+            ? Random::randUniform(-(int)randomShift, (int)randomShift) : 0;
+
+        for (unsigned int y = 0; y < dimY; ++y) {
+            for (unsigned int x = 0; x < dimX; ++x) {
+                int srcX = (int)x - shiftX;
+                int srcY = (int)y - shiftY;
+                const bool valid = (srcX >= 0 && srcX < (int)dimX
+                                    && srcY >= 0 && srcY < (int)dimY);
+
+                if (hFlip)
+                    srcX = dimX - 1 - srcX;
+
+                if (vFlip)
+                    srcY = dimY - 1 - srcY;
+
+                for (unsigned int ch = 0; ch < nbChannels; ++ch) {
+                    ASSERT_EQUALS(data(x, y, ch, batchPos),
+                        (valid) ? dataRef(srcX, srcY, ch, batchPos) : 0.0);
+                }
+
+                ASSERT_EQUALS(labels(x, y, 0, batchPos),
+                    (valid) ? labelsRef(srcX, srcY, 0, batchPos) : -1);
+            }
+        }
+    }
+}
+
+TEST(BatchAugmentation, apply__contrast_brightness)
+{
+    const unsigned int batchSize = 8;
+
+    Tensor<Float_T> data({16, 16, 2, batchSize});
+    Tensor<int> labels({1, 1, 1, batchSize}, 0);
+
+    Random::mtSeed(0);
+
+    for (unsigned int index = 0; index < data.size(); ++index)
+        data(index) = Random::randUniform(0.0, 1.0);
+
+    const Tensor<Float_T> dataRef = data.clone();
+
+    BatchAugmentation augmentation;
+    augmentation.setParameter("Brightness", 0.2);
+    augmentation.setParameter("Contrast", 0.5);
+    augmentation.apply(data, labels, batchSize / 2);
+
+    for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        for (unsigned int ch = 0; ch < 2; ++ch) {
+            double mean = 0.0;
+            double meanRef = 0.0;
+
+            for (unsigned int y = 0; y < 16; ++y) {
+                for (unsigned int x = 0; x < 16; ++x) {
+                    mean += data(x, y, ch, batchPos) / 256.0;
+                    meanRef += dataRef(x, y, ch, batchPos) / 256.0;
+                }
+            }
+
+            if (batchPos >= batchSize / 2) {
+                // Outside of the batch size: unchanged
+                for (unsigned int y = 0; y < 16; ++y) {
+                    for (unsigned int x = 0; x < 16; ++x) {
+                        ASSERT_EQUALS(data(x, y, ch, batchPos),
+                                      dataRef(x, y, ch, batchPos));
+                    }
+                }
+
+                continue;
+            }
+
+            // The transformation is affine: find the contrast from the mean
+            // and the first pixel
+            const double contrast = (data(0, 0, ch, batchPos) - mean)
+                / (dataRef(0, 0, ch, batchPos) - meanRef);
+
+            ASSERT_TRUE(contrast >= 0.5 - 1.0e-4 && contrast <= 1.5 + 1.0e-4);
+            ASSERT_TRUE(std::fabs(mean - meanRef) <= 0.2 + 1.0e-4);
+
+            for (unsigned int y = 0; y < 16; ++y) {
+                for (unsigned int x = 0; x < 16; ++x) {
+                    ASSERT_EQUALS_DELTA(data(x, y, ch, batchPos),
+                        contrast * (dataRef(x, y, ch, batchPos) - meanRef)
+                            + mean,
+                        1.0e-4);
+                }
+            }
+        }
+    }
+}
+
+TEST(BatchAugmentation, apply__cutout)
+{
+    const unsigned int batchSize = 32;
+    const unsigned int cutoutSize = 5;
+
+    Tensor<Float_T> data({20, 20, 3, batchSize}, 1.0);
+    Tensor<int> labels({1, 1, 1, batchSize}, 0);
+
+    BatchAugmentation augmentation;
+    augmentation.setParameter("CutoutSize", cutoutSize);
+
+    Random::mtSeed(0);
+    augmentation.apply(data, labels);
+
+    for (unsigned int batchPos = 0; batchPos < batchSize; ++batchPos) {
+        unsigned int nbZeros[3] = {0, 0, 0};
+
+        for (unsigned int ch = 0; ch < 3; ++ch) {
+            for (unsigned int y = 0; y < 20; ++y) {
+                for (unsigned int x = 0; x < 20; ++x) {
+                    if (data(x, y, ch, batchPos) == 0.0)
+                        ++nbZeros[ch];
+                }
+            }
+        }
+
+        // Same cutout for every channel, clipped at the border
+        ASSERT_TRUE(nbZeros[0] > 0);
+        ASSERT_TRUE(nbZeros[0] <= cutoutSize * cutoutSize);
+        ASSERT_EQUALS(nbZeros[1], nbZeros[0]);
+        ASSERT_EQUALS(nbZeros[2], nbZeros[0]);
+    }
+}
+
+RUN_TESTS()
@@ -18,10 +18,12 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include "FloatT.hpp"
 #include "ROI/RectangularROI.hpp"
 #include "Transformation/ChannelExtractionTransformation.hpp"
 #include "Transformation/CompositeTransformation.hpp"
 #include "Transformation/FlipTransformation.hpp"
+#include "Transformation/RangeAffineTransformation.hpp"
 #include "Transformation/RescaleTransformation.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Utils.hpp"
@@ -126,4 +128,131 @@ TEST(CompositeTransformation, apply__random)
                                  + fileName.str());
 }
 
+TEST_DATASET(CompositeTransformation,
+             apply__rangeAffine,
+             (bool color, bool perChannel),
+             std::make_tuple(false, false),
+             std::make_tuple(true, false),
+             std::make_tuple(true, true))
+{
+    std::vector<double> mean(1, 128.0);
+    std::vector<double> std(1, 64.0);
+
+    if (perChannel) {
+        mean = std::vector<double>{104.0, 117.0, 123.0};
+        std = std::vector<double>{57.0, 58.0, 59.0};
+    }
+
+    // Consecutive RangeAffineTransformation are fused, but not across the
+    // FlipTransformation
+    CompositeTransformation trans;
+    trans.push_back(RangeAffineTransformation(
+        RangeAffineTransformation::Minus, mean,
+        RangeAffineTransformation::Divides, std));
+    trans.push_back(RangeAffineTransformation(
+        RangeAffineTransformation::Multiplies, 2.0,
+        RangeAffineTransformation::Plus, 0.5));
+    trans.push_back(FlipTransformation(true, false));
+    trans.push_back(RangeAffineTransformation(
+        RangeAffineTransformation::Divides, 4.0));
+
+    ASSERT_EQUALS(trans.size(), 4U);
+
+    cv::Mat img = cv::imread("tests_data/Lenna.png",
+#if CV_MAJOR_VERSION >= 3
+        (color) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
+#else
+        (color) ? CV_LOAD_IMAGE_COLOR : CV_LOAD_IMAGE_GRAYSCALE);
+#endif
+
+    if (!img.data)
+        throw std::runtime_error(
+            "Could not open or find image: tests_data/Lenna.png");
+
+    cv::Mat imgRef = img.clone();
+
+    for (unsigned int i = 0; i < trans.size(); ++i)
+        trans[i]->apply(imgRef);
+
+    trans.apply(img);
+
+    ASSERT_EQUALS(img.type(), imgRef.type());
+    ASSERT_EQUALS(img.cols, imgRef.cols);
+    ASSERT_EQUALS(img.rows, imgRef.rows);
+
+    cv::Mat diff;
+    cv::absdiff(img, imgRef, diff);
+
+    double maxDiff;
+    cv::minMaxLoc(diff.reshape(1), NULL, &maxDiff);
+    ASSERT_TRUE(maxDiff < 1.0e-5);
+}
+
+TEST_DATASET(CompositeTransformation,
+             apply__channelExtraction,
+             (bool color, int channel, bool perChannel),
+             std::make_tuple(true, 0, false),
+             std::make_tuple(true, 1, false),
+             std::make_tuple(true, 2, false),
+             std::make_tuple(false, 2, false),
+             std::make_tuple(true, 2, true))
+{
+    CompositeTransformation trans;
+
+    if (channel == 0)
+        trans.push_back(BlueChannelExtractionTransformation());
+    else if (channel == 1)
+        trans.push_back(GreenChannelExtractionTransformation());
+    else
+        trans.push_back(RedChannelExtractionTransformation());
+
+    // The extraction is fused with the following RangeAffineTransformation,
+    // unless it has one value per channel (which is not valid after the
+    // extraction of a channel from a color image)
+    trans.push_back(RangeAffineTransformation(
+        RangeAffineTransformation::Minus,
+        (perChannel) ? std::vector<double>{104.0, 117.0, 123.0}
+                     : std::vector<double>(1, 128.0),
+        RangeAffineTransformation::Divides,
+        (perChannel) ? std::vector<double>{57.0, 58.0, 59.0}
+                     : std::vector<double>(1, 64.0)));
+    trans.push_back(RangeAffineTransformation(
+        RangeAffineTransformation::Multiplies, 2.0));
+
+    cv::Mat img = cv::imread("tests_data/Lenna.png",
+#if CV_MAJOR_VERSION >= 3
+        (color) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE);
+#else
+        (color) ? CV_LOAD_IMAGE_COLOR : CV_LOAD_IMAGE_GRAYSCALE);
+#endif
+
+    if (!img.data)
+        throw std::runtime_error(
+            "Could not open or find image: tests_data/Lenna.png");
+
+    cv::Mat imgRef = img.clone();
+
+    if (color && perChannel) {
+        ASSERT_THROW_ANY(trans.apply(img));
+        return;
+    }
+
+    for (unsigned int i = 0; i < trans.size(); ++i)
+        trans[i]->apply(imgRef);
+
+    trans.apply(img);
+
+    ASSERT_EQUALS(img.type(), imgRef.type());
+    ASSERT_EQUALS(img.channels(), 1);
+    ASSERT_EQUALS(img.cols, imgRef.cols);
+    ASSERT_EQUALS(img.rows, imgRef.rows);
+
+    cv::Mat diff;
+    cv::absdiff(img, imgRef, diff);
+
+    double maxDiff;
+    cv::minMaxLoc(diff, NULL, &maxDiff);
+    ASSERT_TRUE(maxDiff < 1.0e-5);
+}
+
 RUN_TESTS()
@@ -0,0 +1,197 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "AerEvent.hpp"
+#include "Cochlea.hpp"
+#include "Sound.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+/// Reference implementation: whole signal, one channel at a time, same as
+/// Cochlea::load()
+Aer::AerData_T processReference(const std::vector<double>& samples,
+                                unsigned int samplingFrequency,
+                                unsigned int nbChannels,
+                                unsigned int order,
+                                double lowFreq,
+                                double upFreq,
+                                double threshold,
+                                Time_T leak,
+                                Time_T refractory)
+{
+    const double earQ = 9.26449;
+    const double minBw = 24.7;
+
+    Sound audio(samples, samplingFrequency);
+
+    const Time_T dt = (Time_T)(TimeS / samplingFrequency);
+    const double expLeak = std::exp(-((double)dt) / ((double)leak));
+    const Sound::Filter_T filterLowPass
+        = audio.newFilter(Sound::Butterworth, Sound::LowPass, 1, 65);
+
+    Aer::AerData_T events;
+
+    for (unsigned int i = 0; i < nbChannels; ++i) {
+        const double centerFreq
+            = -earQ * minBw
+              + (lowFreq + earQ * minBw)
+                * std::exp((std::log(upFreq + earQ * minBw)
+                            - std::log(lowFreq + earQ * minBw)) * i
+                           / (double)nbChannels);
+        const double freqBand = centerFreq / earQ + minBw;
+
+        Sound filteredAudio(audio);
+
+        if (order > 0) {
+            const Sound::Filter_T filter
+                = filteredAudio.newFilter(Sound::Butterworth,
+                                          Sound::BandPass,
+                                          2,
+                                          centerFreq - freqBand / 2.0,
+                                          centerFreq + freqBand / 2.0);
+
+            for (unsigned int f = 0; f < order / 2; ++f)
+                filteredAudio.applyFilter(filter);
+
+            if (order % 2 == 1) {
+                filteredAudio.applyFilter(
+                    filteredAudio.newFilter(Sound::Butterworth,
+                                            Sound::BandPass,
+                                            1,
+                                            centerFreq - freqBand / 2.0,
+                                            centerFreq + freqBand / 2.0));
+            }
+        } else {
+            Sound::Filter_T filter1, filter2, filter3, filter4;
+            std::tie(filter1, filter2, filter3, filter4)
+                = filteredAudio.newGammatoneFilter(centerFreq, freqBand);
+
+            filteredAudio.applyFilter(filter1);
+            filteredAudio.applyFilter(filter2);
+            filteredAudio.applyFilter(filter3);
+            filteredAudio.applyFilter(filter4);
+        }
+
+        filteredAudio.halfWaveRectify();
+        filteredAudio.applyFilter(filterLowPass);
+
+        const double freqThres
+            = threshold
+              * std::pow(freqBand / (lowFreq / earQ + minBw), 1.0 / 3.0);
+
+        Time_T refractoryEnd = 0;
+        double integration = 0.0;
+        Time_T timestamp = 0;
+
+        for (unsigned int s = 0; s < filteredAudio(0).size(); ++s) {
+            if (timestamp >= refractoryEnd)
+                integration = integration * expLeak
+                              + filteredAudio(0)[s] / samplingFrequency;
+
+            if (integration >= freqThres) {
+                integration = 0.0;
+                refractoryEnd = timestamp + refractory;
+                events.push_back(
+                    std::make_pair(timestamp, AerEvent::unmaps(0, 0, i)));
+            }
+
+            timestamp += dt;
+        }
+    }
+
+    std::sort(events.begin(), events.end());
+    return events;
+}
+
+TEST_DATASET(Cochlea,
+             processBlock,
+             (unsigned int nbChannels,
+              unsigned int order,
+              unsigned int blockSize),
+             std::make_tuple(16U, 0U, 8000U),
+             std::make_tuple(16U, 0U, 1U),
+             std::make_tuple(16U, 3U, 100U),
+             std::make_tuple(100U, 0U, 777U),
+             std::make_tuple(100U, 4U, 4096U))
+{
+    const unsigned int samplingFrequency = 8000;
+    const double threshold = 1.0e-4;
+
+    Random::mtSeed(0);
+
+    // Chirp with some noise
+    std::vector<double> samples(samplingFrequency);
+
+    for (unsigned int s = 0; s < samples.size(); ++s) {
+        const double t = s / (double)samplingFrequency;
+        samples[s] = std::sin(2.0 * M_PI * (100.0 + 1500.0 * t) * t)
+                     + Random::randUniform(-0.1, 0.1);
+    }
+
+    const Aer::AerData_T eventsRef = processReference(samples,
+                                                      samplingFrequency,
+                                                      nbChannels,
+                                                      order,
+                                                      50.0,
+                                                      3000.0,
+                                                      threshold,
+                                                      1 * TimeMs,
+                                                      5 * TimeMs);
+
+    Cochlea cochlea(nbChannels);
+    cochlea.initializeStream(samplingFrequency,
+                             order,
+                             50.0,
+                             3000.0,
+                             threshold,
+                             1 * TimeMs,
+                             5 * TimeMs);
+
+    Aer::AerData_T events;
+
+    for (unsigned int s = 0; s < samples.size(); s += blockSize) {
+        const std::vector<double> block(
+            samples.begin() + s,
+            samples.begin() + std::min<size_t>(s + blockSize, samples.size()));
+        cochlea.processBlock(block, events);
+    }
+
+    ASSERT_TRUE(!eventsRef.empty());
+    ASSERT_EQUALS(events.size(), eventsRef.size());
+
+    for (unsigned int e = 0; e < events.size(); ++e) {
+        ASSERT_EQUALS(events[e].first, eventsRef[e].first);
+        ASSERT_EQUALS(events[e].second, eventsRef[e].second);
+    }
+
+    // Same events after a reset
+    cochlea.resetStream();
+
+    Aer::AerData_T eventsReset;
+    cochlea.processBlock(samples, eventsReset);
+
+    ASSERT_TRUE(eventsReset == events);
+}
+
+RUN_TESTS()
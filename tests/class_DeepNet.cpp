@@ -238,4 +238,147 @@ TEST(DeepNet, fuseBatchNormWithConv)
     }
 }
 
+template <class T_CONV>
+void buildCheckpointNet(DeepNet& deepNet,
+                        Tensor<Float_T>& inputs,
+                        Tensor<Float_T>& diffOutputs,
+                        std::shared_ptr<ConvCell_Frame<T_CONV> >& conv1,
+                        std::shared_ptr<FcCell_Frame<float> >& fc1)
+{
+    conv1 = std::make_shared<ConvCell_Frame<T_CONV> >(deepNet, "conv1",
+        std::vector<unsigned int>({3, 3}),
+        4,
+        std::vector<unsigned int>({1, 1}),
+        std::vector<unsigned int>({1, 1}),
+        std::vector<int>({(int)0, (int)0}),
+        std::vector<unsigned int>({1U, 1U}),
+        std::shared_ptr<Activation>());
+    fc1 = std::make_shared<FcCell_Frame<float> >(deepNet, "fc1", 10,
+        std::shared_ptr<Activation>());
+
+    deepNet.addCell(conv1, std::vector<std::shared_ptr<Cell> >(1));
+    deepNet.addCell(fc1, std::vector<std::shared_ptr<Cell> >(1, conv1));
+
+    conv1->addInput(inputs, diffOutputs);
+    fc1->addInput(conv1.get());
+
+    conv1->initialize();
+    fc1->initialize();
+}
+
+TEST(DeepNet, saveNetworkCheckpoint)
+{
+    Network net;
+    Tensor<Float_T> inputs({8, 8, 2, 1});
+    Tensor<Float_T> diffOutputs({8, 8, 2, 1});
+
+    Random::mtSeed(1);
+    DeepNet deepNet(net);
+    std::shared_ptr<ConvCell_Frame<double> > conv1;
+    std::shared_ptr<FcCell_Frame<float> > fc1;
+    buildCheckpointNet(deepNet, inputs, diffOutputs, conv1, fc1);
+
+    Random::mtSeed(2);
+    DeepNet deepNetLoad(net);
+    std::shared_ptr<ConvCell_Frame<double> > conv1Load;
+    std::shared_ptr<FcCell_Frame<float> > fc1Load;
+    buildCheckpointNet(deepNetLoad, inputs, diffOutputs, conv1Load, fc1Load);
+
+    deepNet.saveNetworkCheckpoint("DeepNet_saveNetworkCheckpoint.ckpt");
+    deepNetLoad.loadNetworkCheckpoint("DeepNet_saveNetworkCheckpoint.ckpt");
+
+    Tensor<double> weight;
+    Tensor<double> weightLoad;
+
+    for (unsigned int output = 0; output < conv1->getNbOutputs(); ++output) {
+        for (unsigned int channel = 0; channel < conv1->getNbChannels();
+            ++channel)
+        {
+            conv1->getWeight(output, channel, weight);
+            conv1Load->getWeight(output, channel, weightLoad);
+
+            for (unsigned int index = 0; index < weight.size(); ++index)
+                ASSERT_EQUALS(weightLoad(index), weight(index));
+        }
+
+        conv1->getBias(output, weight);
+        conv1Load->getBias(output, weightLoad);
+        ASSERT_EQUALS(weightLoad(0), weight(0));
+    }
+
+    Tensor<float> fcWeight;
+    Tensor<float> fcWeightLoad;
+
+    for (unsigned int output = 0; output < fc1->getNbOutputs(); ++output) {
+        for (unsigned int channel = 0; channel < fc1->getNbChannels();
+            ++channel)
+        {
+            fc1->getWeight(output, channel, fcWeight);
+            fc1Load->getWeight(output, channel, fcWeightLoad);
+            ASSERT_EQUALS(fcWeightLoad(0), fcWeight(0));
+        }
+    }
+}
+
+TEST(DeepNet, loadNetworkCheckpoint_conversion)
+{
+    Network net;
+    Tensor<Float_T> inputs({8, 8, 2, 1});
+    Tensor<Float_T> diffOutputs({8, 8, 2, 1});
+
+    Random::mtSeed(1);
+    DeepNet deepNet(net);
+    std::shared_ptr<ConvCell_Frame<double> > conv1;
+    std::shared_ptr<FcCell_Frame<float> > fc1;
+    buildCheckpointNet(deepNet, inputs, diffOutputs, conv1, fc1);
+
+    Random::mtSeed(2);
+    DeepNet deepNetLoad(net);
+    std::shared_ptr<ConvCell_Frame<float> > conv1Load;
+    std::shared_ptr<FcCell_Frame<float> > fc1Load;
+    buildCheckpointNet(deepNetLoad, inputs, diffOutputs, conv1Load, fc1Load);
+
+    deepNet.saveNetworkCheckpoint("DeepNet_loadNetworkCheckpoint.ckpt");
+    deepNetLoad.loadNetworkCheckpoint("DeepNet_loadNetworkCheckpoint.ckpt");
+
+    Tensor<double> weight;
+    Tensor<float> weightLoad;
+
+    for (unsigned int output = 0; output < conv1->getNbOutputs(); ++output) {
+        for (unsigned int channel = 0; channel < conv1->getNbChannels();
+            ++channel)
+        {
+            conv1->getWeight(output, channel, weight);
+            conv1Load->getWeight(output, channel, weightLoad);
+
+            for (unsigned int index = 0; index < weight.size(); ++index)
+                ASSERT_EQUALS(weightLoad(index), (float)weight(index));
+        }
+    }
+
+    // Missing tensors
+    Random::mtSeed(3);
+    DeepNet deepNetOther(net);
+    std::shared_ptr<ConvCell_Frame<float> > conv1Other;
+    std::shared_ptr<FcCell_Frame<float> > fc1Other;
+    buildCheckpointNet(deepNetOther, inputs, diffOutputs, conv1Other,
+                       fc1Other);
+    deepNetOther.removeCell(fc1Other);
+
+    deepNetOther.saveNetworkCheckpoint("DeepNet_loadNetworkCheckpoint.ckpt");
+    ASSERT_THROW(deepNetLoad.loadNetworkCheckpoint(
+                    "DeepNet_loadNetworkCheckpoint.ckpt"), std::runtime_error);
+    ASSERT_NOTHROW_ANY(deepNetLoad.loadNetworkCheckpoint(
+                    "DeepNet_loadNetworkCheckpoint.ckpt", true));
+
+    // Not a checkpoint file
+    {
+        std::ofstream data("DeepNet_loadNetworkCheckpoint.ckpt");
+        data << "N2D2 weights";
+    }
+
+    ASSERT_THROW(deepNetLoad.loadNetworkCheckpoint(
+                    "DeepNet_loadNetworkCheckpoint.ckpt"), std::runtime_error);
+}
+
 RUN_TESTS()
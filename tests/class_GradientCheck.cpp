@@ -0,0 +1,249 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "GradientCheck.hpp"
+#include "containers/Tensor.hpp"
+#include "controler/Interface.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+#include <cmath>
+
+using namespace N2D2;
+
+/// Fully connected tanh layer, optionally normalized over the batch (mean of
+/// the pre-activations subtracted), which couples the batch samples
+class GradientCheck_Layer {
+public:
+    GradientCheck_Layer(unsigned int nbInputs,
+                        unsigned int nbOutputs,
+                        unsigned int batchSize,
+                        bool batchNorm)
+        : mInputs({nbInputs, batchSize}),
+          mDiffOutputs({nbInputs, batchSize}),
+          mWeights({nbInputs, nbOutputs}),
+          mDiffWeights({nbInputs, nbOutputs}),
+          mOutputs({nbOutputs, batchSize}),
+          mDiffInputs({nbOutputs, batchSize}),
+          mBatchNorm(batchNorm),
+          mWrongGradient(false),
+          mNbPropagates(0)
+    {
+        for (unsigned int index = 0; index < mWeights.size(); ++index)
+            mWeights(index) = Random::randUniform(-0.5, 0.5);
+    }
+
+    void propagate(bool /*inference*/)
+    {
+        ++mNbPropagates;
+
+        for (unsigned int o = 0; o < mOutputs.dimX(); ++o) {
+            double mean = 0.0;
+
+            for (unsigned int b = 0; b < mOutputs.dimB(); ++b) {
+                double z = 0.0;
+
+                for (unsigned int i = 0; i < mInputs.dimX(); ++i)
+                    z += mWeights(i, o) * mInputs(i, b);
+
+                mOutputs(o, b) = z;
+                mean += z;
+            }
+
+            mean = (mBatchNorm) ? mean / mOutputs.dimB() : 0.0;
+
+            for (unsigned int b = 0; b < mOutputs.dimB(); ++b)
+                mOutputs(o, b) = std::tanh(mOutputs(o, b) - mean);
+        }
+    }
+
+    void backPropagate()
+    {
+        Tensor<double> delta(mOutputs.dims());
+
+        for (unsigned int o = 0; o < mOutputs.dimX(); ++o) {
+            double mean = 0.0;
+
+            for (unsigned int b = 0; b < mOutputs.dimB(); ++b) {
+                delta(o, b) = mDiffInputs(o, b)
+                    * (1.0 - mOutputs(o, b) * mOutputs(o, b));
+                mean += delta(o, b);
+            }
+
+            mean = (mBatchNorm) ? mean / mOutputs.dimB() : 0.0;
+
+            for (unsigned int b = 0; b < mOutputs.dimB(); ++b)
+                delta(o, b) -= mean;
+        }
+
+        for (unsigned int o = 0; o < mWeights.dimB(); ++o) {
+            for (unsigned int i = 0; i < mWeights.dimX(); ++i) {
+                mDiffWeights(i, o) = 0.0;
+
+                for (unsigned int b = 0; b < mInputs.dimB(); ++b)
+                    mDiffWeights(i, o) += delta(o, b) * mInputs(i, b);
+            }
+        }
+
+        for (unsigned int b = 0; b < mInputs.dimB(); ++b) {
+            for (unsigned int i = 0; i < mInputs.dimX(); ++i) {
+                mDiffOutputs(i, b) = 0.0;
+
+                for (unsigned int o = 0; o < mOutputs.dimX(); ++o)
+                    mDiffOutputs(i, b) += delta(o, b) * mWeights(i, o);
+            }
+        }
+
+        if (mWrongGradient)
+            mDiffOutputs(mDiffOutputs.size() - 1) *= 1.5;
+    }
+
+    void initialize(GradientCheck<double>& gc)
+    {
+        mInputsInterface.push_back(&mInputs);
+
+        gc.initialize(mInputsInterface,
+                      mOutputs,
+                      mDiffInputs,
+                      std::bind(&GradientCheck_Layer::propagate, this,
+                                std::placeholders::_1),
+                      std::bind(&GradientCheck_Layer::backPropagate, this));
+        mNbPropagates = 0;
+    }
+
+    Interface<> mInputsInterface;
+    Tensor<double> mInputs;
+    Tensor<double> mDiffOutputs;
+    Tensor<double> mWeights;
+    Tensor<double> mDiffWeights;
+    Tensor<double> mOutputs;
+    Tensor<double> mDiffInputs;
+    bool mBatchNorm;
+    bool mWrongGradient;
+    unsigned int mNbPropagates;
+};
+
+TEST_DATASET(GradientCheck,
+             check,
+             (bool batchNorm),
+             std::make_tuple(false),
+             std::make_tuple(true))
+{
+    Random::mtSeed(0);
+    GradientCheckBase::setSampling(0.0);
+
+    const unsigned int nbInputs = 12;
+    const unsigned int batchSize = 8;
+
+    GradientCheck_Layer layer(nbInputs, 5, batchSize, batchNorm);
+    GradientCheck<double> gc(1.0e-4, 1.0e-6);
+    layer.initialize(gc);
+
+    ASSERT_NOTHROW_ANY(gc.check("weights", layer.mWeights,
+                                layer.mDiffWeights));
+    ASSERT_EQUALS(layer.mNbPropagates, 2 * layer.mWeights.size());
+
+    layer.mNbPropagates = 0;
+    ASSERT_NOTHROW_ANY(gc.check("inputs", layer.mInputs,
+                                layer.mDiffOutputs, true));
+
+    if (batchNorm) {
+        // Samples coupled: one perturbation per forward pass
+        ASSERT_TRUE(layer.mNbPropagates >= 2 * nbInputs * batchSize);
+    }
+    else {
+        // One perturbation per batch sample per forward pass (+ the batch
+        // independence test)
+        ASSERT_TRUE(layer.mNbPropagates <= 2 * nbInputs + 2);
+    }
+}
+
+TEST_DATASET(GradientCheck,
+             check_sampled,
+             (double errorRate, unsigned int nbSamples),
+             std::make_tuple(0.05, 90U),
+             std::make_tuple(0.01, 459U),
+             std::make_tuple(0.001, 1024U))
+{
+    Random::mtSeed(0);
+    GradientCheckBase::setSampling(errorRate, 0.99);
+
+    ASSERT_EQUALS(GradientCheckBase::getNbSamples(1024), nbSamples);
+
+    GradientCheck_Layer layer(64, 16, 4, false);
+    GradientCheck<double> gc(1.0e-4, 1.0e-6);
+    layer.initialize(gc);
+
+    ASSERT_NOTHROW_ANY(gc.check("weights", layer.mWeights,
+                                layer.mDiffWeights));
+    ASSERT_EQUALS(layer.mNbPropagates, 2 * nbSamples);
+
+    GradientCheckBase::setSampling(0.0);
+}
+
+TEST_DATASET(GradientCheck,
+             check_wrong_gradient,
+             (bool batchNorm),
+             std::make_tuple(false),
+             std::make_tuple(true))
+{
+    Random::mtSeed(0);
+    GradientCheckBase::setSampling(0.0);
+
+    GradientCheck_Layer layer(12, 5, 8, batchNorm);
+    layer.mWrongGradient = true;
+
+    GradientCheck<double> gc(1.0e-4, 1.0e-6);
+    layer.initialize(gc);
+
+    ASSERT_NOTHROW_ANY(gc.check("weights", layer.mWeights,
+                                layer.mDiffWeights));
+    ASSERT_THROW_ANY(gc.check("inputs", layer.mInputs, layer.mDiffOutputs,
+                              true));
+}
+
+TEST(GradientCheck, check_notCellInput)
+{
+    Random::mtSeed(0);
+    GradientCheckBase::setSampling(0.0);
+
+    // Weights {nbInputs, nbOutputs} with nbOutputs = batchSize: the last
+    // dimension is not the batch, they must not be perturbed per sample
+    const unsigned int batchSize = 8;
+
+    GradientCheck_Layer layer(12, batchSize, batchSize, false);
+    GradientCheck<double> gc(1.0e-4, 1.0e-6);
+    layer.initialize(gc);
+
+    ASSERT_NOTHROW_ANY(gc.check("weights", layer.mWeights,
+                                layer.mDiffWeights));
+    ASSERT_EQUALS(layer.mNbPropagates, 2 * layer.mWeights.size());
+
+    // Not a cell input: one perturbation per forward pass, no batch
+    // independence test
+    layer.mNbPropagates = 0;
+    ASSERT_NOTHROW_ANY(gc.check("inputs", layer.mInputs,
+                                layer.mDiffOutputs));
+    ASSERT_EQUALS(layer.mNbPropagates, 2 * layer.mInputs.size());
+}
+
+RUN_TESTS()
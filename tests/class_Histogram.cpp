@@ -19,13 +19,117 @@
 */
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 #include "Histogram.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
 
 
 using namespace N2D2;
 
+namespace {
+// Reference serial threshold search, with a re-quantized histogram for
+// each candidate threshold
+double referenceMSE(const Histogram& hist, double threshold, std::size_t nbBits) {
+    const bool isUnsigned = hist.getMinVal() >= 0.0;
+
+    const double minVal = isUnsigned?0:-(1 << (nbBits - 1));
+    const double maxVal = isUnsigned?((1 << nbBits) - 1):((1 << (nbBits - 1)) - 1);
+    const double scaling = maxVal/threshold;
+
+    std::size_t nbValues = 0;
+    for(std::size_t bin = 0; bin < hist.getNbBins(); bin++) {
+        nbValues += hist.getBins()[bin];
+    }
+
+    double mse = 0.0;
+    for(std::size_t bin = 0; bin < hist.getNbBins(); bin++) {
+        const double approx = Utils::clamp(std::round(hist.getBinValue(bin)*scaling), minVal, maxVal)/scaling;
+        const double normalizedValue = 1.0*hist.getBins()[bin]/nbValues;
+
+        mse += std::pow(hist.getBinValue(bin) - approx, 2) * normalizedValue;
+    }
+
+    return mse;
+}
+
+double referenceKLDivergence(const Histogram& hist, double threshold, std::size_t nbBits) {
+    const bool isUnsigned = hist.getMinVal() >= 0.0;
+
+    Histogram quant(isUnsigned?0:-threshold, threshold, 1 << nbBits);
+    std::size_t nbValues = 0;
+
+    for (std::size_t bin = 0; bin < hist.getNbBins(); ++bin) {
+        quant(Utils::clamp(hist.getBinValue(bin), quant.getMinVal(), quant.getMaxVal()),
+              hist.getBins()[bin]);
+        nbValues += hist.getBins()[bin];
+    }
+
+    double qNorm = 0.0;
+
+    for (std::size_t bin = 0; bin < hist.getNbBins(); ++bin) {
+        qNorm += quant.getBins()[quant.getBinIdx(hist.getBinValue(bin))];
+    }
+
+    double divergence = 0.0;
+
+    for (std::size_t bin = 0; bin < hist.getNbBins(); ++bin) {
+        const double p = (hist.getBins()[bin] / (double)nbValues);
+        const double q = (quant.getBins()[quant.getBinIdx(hist.getBinValue(bin))] / qNorm);
+
+        if (p != 0) {
+            divergence += p * std::log(p / q);
+        }
+    }
+
+    return divergence;
+}
+
+double referenceCalibrate(const Histogram& hist, std::size_t nbBits,
+                          ClippingMode clippingMode)
+{
+    double threshold = Utils::max_abs(hist.getMinVal(), hist.getMaxVal());
+    double bestThreshold = threshold;
+    double best = std::numeric_limits<double>::max();
+
+    const double threshold_decr_step = threshold/1000.0;
+    while(threshold > 0.0) {
+        const double criterion = (clippingMode == ClippingMode::MSE)
+            ? referenceMSE(hist, threshold, nbBits)
+            : referenceKLDivergence(hist, threshold, nbBits);
+
+        if(criterion < best) {
+            best = criterion;
+            bestThreshold = threshold;
+        }
+
+        threshold -= threshold_decr_step;
+    }
+
+    return bestThreshold;
+}
+
+Histogram randomHistogram(bool isUnsigned, std::size_t nbBins,
+                          std::size_t nbValues)
+{
+    Histogram hist(isUnsigned?0.0:-4.0, 4.0, nbBins);
+
+    for (std::size_t i = 0; i < nbValues; ++i) {
+        // ReLU-like or Gaussian distribution, with a long tail
+        const double value = (isUnsigned)
+            ? Random::randExponential(0.5)
+            : Random::randNormal(0.0, (i % 10 == 0) ? 1.5 : 0.5);
+
+        hist(Utils::clamp(value, hist.getMinVal(), hist.getMaxVal()));
+    }
+
+    return hist;
+}
+}
+
 
 TEST(Histogram, test_out_of_range) {
     const std::size_t nbBins = 3;
@@ -174,4 +278,62 @@ TEST(Histogram, test_enlarge_asymetric_max) {
                 std::vector<std::size_t>({2, 0, 2, 1, 3, 1, 0, 4, 0, 0, 1, 0, 0}));
 }
 
+TEST_DATASET(Histogram,
+             calibrate,
+             (bool isUnsigned, std::size_t nbBins, std::size_t nbBits),
+             std::make_tuple(true, 512U, 4U),
+             std::make_tuple(false, 512U, 4U),
+             std::make_tuple(true, 4096U, 8U),
+             std::make_tuple(false, 4096U, 8U),
+             std::make_tuple(false, 16384U, 8U))
+{
+    Random::mtSeed(0);
+
+    const Histogram hist = randomHistogram(isUnsigned, nbBins, 100000);
+
+    ASSERT_EQUALS(hist.calibrateMSE(nbBits),
+                  referenceCalibrate(hist, nbBits, ClippingMode::MSE));
+    ASSERT_EQUALS(hist.calibrateKLDivergence(nbBits),
+                  referenceCalibrate(hist, nbBits, ClippingMode::KL_DIVERGENCE));
+}
+
+TEST(Histogram, calibrate_empty) {
+    const Histogram hist(-1.0, 1.0, 128);
+
+    ASSERT_EQUALS(hist.calibrateMSE(8), 0.0);
+    ASSERT_EQUALS(hist.calibrateKLDivergence(8), 0.0);
+}
+
+TEST_DATASET(Histogram,
+             calibrateOutputsHistogram,
+             (ClippingMode clippingMode),
+             std::make_tuple(ClippingMode::MSE),
+             std::make_tuple(ClippingMode::KL_DIVERGENCE))
+{
+    Random::mtSeed(0);
+
+    const std::size_t nbBits = 8;
+    std::unordered_map<std::string, Histogram> outputsHistogram;
+
+    for (unsigned int i = 0; i < 8; ++i) {
+        outputsHistogram.insert(std::make_pair("cell" + std::to_string(i),
+            randomHistogram(i % 2 == 0, 1024 * (i + 1), 10000)));
+    }
+
+    outputsHistogram.insert(std::make_pair("empty", Histogram(0.0, 1.0, 16)));
+
+    const std::unordered_map<std::string, double> outputsThreshold
+        = Histogram::calibrateOutputsHistogram(outputsHistogram, nbBits,
+                                               clippingMode);
+
+    ASSERT_EQUALS(outputsThreshold.size(), outputsHistogram.size());
+
+    for (auto it = outputsHistogram.begin(); it != outputsHistogram.end(); ++it) {
+        const double threshold = ((*it).first == "empty") ? 0.0
+            : referenceCalibrate((*it).second, nbBits, clippingMode);
+
+        ASSERT_EQUALS(outputsThreshold.at((*it).first), threshold);
+    }
+}
+
 RUN_TESTS()
\ No newline at end of file
@@ -0,0 +1,230 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Cell/FcCell_Frame.hpp"
+#include "DeepNet.hpp"
+#include "Environment.hpp"
+#include "InferenceServer.hpp"
+#include "Network.hpp"
+#include "StimuliProvider.hpp"
+#include "Target/Target.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+#include <cstring>
+#include <thread>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace N2D2;
+
+std::shared_ptr<DeepNet> createInferenceNet(Network& net,
+                                            unsigned int batchSize)
+{
+    std::shared_ptr<DeepNet> deepNet = std::make_shared<DeepNet>(net);
+
+    std::shared_ptr<StimuliProvider> sp(new StimuliProvider(EmptyDatabase,
+                                                            {8, 8, 1},
+                                                            batchSize));
+    deepNet->setStimuliProvider(sp);
+
+    std::shared_ptr<FcCell_Frame<Float_T> > fc(
+        new FcCell_Frame<Float_T>(*deepNet, "fc", 5));
+    fc->addInput(*sp);
+    deepNet->addCell(fc, std::vector<std::shared_ptr<Cell> >(1));
+
+    std::shared_ptr<Target> target(new Target("target", fc, sp));
+    deepNet->addTarget(target);
+
+    fc->initialize();
+    return deepNet;
+}
+
+cv::Mat createInferenceStimulus(unsigned int index)
+{
+    cv::Mat mat(8, 8, CV_32FC1);
+
+    for (int y = 0; y < mat.rows; ++y) {
+        for (int x = 0; x < mat.cols; ++x)
+            mat.at<float>(y, x) = std::sin(0.1f * (x + 8 * y) + index);
+    }
+
+    return mat;
+}
+
+TEST_DATASET(InferenceServer,
+             submit,
+             (unsigned int batchSize, unsigned int nbRequests),
+             std::make_tuple(1U, 5U),
+             std::make_tuple(4U, 10U),
+             std::make_tuple(8U, 3U))
+{
+    Random::mtSeed(0);
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet = createInferenceNet(net, batchSize);
+    std::shared_ptr<Target> target = deepNet->getTarget();
+
+    // Reference: one stimulus at a time, in batch position 0
+    std::vector<Tensor<int> > labelsRef;
+    std::vector<Tensor<Float_T> > valuesRef;
+
+    for (unsigned int i = 0; i < nbRequests; ++i) {
+        deepNet->getStimuliProvider()->streamStimulus(
+            createInferenceStimulus(i), Database::Test);
+        deepNet->test(Database::Test);
+
+        const Tensor<int> labels = target->getEstimatedLabels()[0];
+        const Tensor<Float_T> values = target->getEstimatedLabelsValue()[0];
+        labelsRef.push_back(Tensor<int>(labels.dims(),
+                                        labels.begin(), labels.end()));
+        valuesRef.push_back(Tensor<Float_T>(values.dims(),
+                                            values.begin(), values.end()));
+    }
+
+    // Large latency: batches are only run when full, or at stop()
+    InferenceServer server(deepNet, 1.0);
+    std::vector<std::future<InferenceServer::Result> > results;
+
+    for (unsigned int i = 0; i < nbRequests; ++i)
+        results.push_back(server.submit(createInferenceStimulus(i)));
+
+    server.stop();
+
+    for (unsigned int i = 0; i < nbRequests; ++i) {
+        const InferenceServer::Result result = results[i].get();
+
+        ASSERT_EQUALS(result.estimatedLabels.dims(), labelsRef[i].dims());
+
+        for (unsigned int index = 0; index < labelsRef[i].size(); ++index) {
+            ASSERT_EQUALS(result.estimatedLabels(index),
+                          labelsRef[i](index));
+            ASSERT_EQUALS_DELTA(result.estimatedLabelsValue(index),
+                                valuesRef[i](index), 1.0e-6);
+        }
+    }
+
+    const InferenceServer::Metrics metrics = server.getMetrics();
+
+    ASSERT_EQUALS(metrics.nbRequests, nbRequests);
+    ASSERT_EQUALS(metrics.nbBatches,
+                  (nbRequests + batchSize - 1) / batchSize);
+    ASSERT_TRUE(metrics.maxQueueLatency >= metrics.queueLatency);
+    ASSERT_THROW(server.submit(createInferenceStimulus(0)),
+                 std::runtime_error);
+}
+
+TEST(InferenceServer, maxLatency)
+{
+    Random::mtSeed(0);
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet = createInferenceNet(net, 16);
+    InferenceServer server(deepNet, 0.005);
+
+    // A single request must not wait for the batch to fill up
+    std::future<InferenceServer::Result> result
+        = server.submit(createInferenceStimulus(0));
+
+    ASSERT_TRUE(result.wait_for(std::chrono::seconds(10))
+                == std::future_status::ready);
+    ASSERT_EQUALS(server.getMetrics().nbBatches, 1U);
+}
+
+#ifndef WIN32
+TEST(InferenceServer, listen_maxRequestSize)
+{
+    Random::mtSeed(0);
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet = createInferenceNet(net, 1);
+    InferenceServer server(deepNet, 0.005, 0, 1024);
+
+    const std::string socketPath = "InferenceServer_listen.sock";
+    std::thread listener(&InferenceServer::listen, &server, socketPath);
+
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socketPath.c_str());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_TRUE(fd >= 0);
+
+    bool connected = false;
+
+    for (unsigned int retry = 0; retry < 100 && !connected; ++retry) {
+        connected = (::connect(fd, reinterpret_cast<sockaddr*>(&addr),
+                               sizeof(addr)) == 0);
+
+        if (!connected)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ASSERT_TRUE(connected);
+
+    // Oversized request: the payload is discarded by the server
+    uint32_t size = 10000;
+    const std::vector<char> payload(size, 0);
+    ASSERT_EQUALS(::write(fd, &size, sizeof(size)), (ssize_t)sizeof(size));
+    ASSERT_EQUALS(::write(fd, &payload[0], size), (ssize_t)size);
+
+    int32_t status = 0;
+    ASSERT_EQUALS(::read(fd, &status, sizeof(status)),
+                  (ssize_t)sizeof(status));
+    ASSERT_EQUALS(status, -1);
+    ASSERT_EQUALS(::read(fd, &size, sizeof(size)), (ssize_t)sizeof(size));
+
+    std::string error(size, '\0');
+    ASSERT_EQUALS(::recv(fd, &error[0], size, MSG_WAITALL), (ssize_t)size);
+    ASSERT_TRUE(error.find("maximum request size") != std::string::npos);
+
+    // The connection is still open: the next (undecodable) request is
+    // answered
+    size = 4;
+    ASSERT_EQUALS(::write(fd, &size, sizeof(size)), (ssize_t)sizeof(size));
+    ASSERT_EQUALS(::write(fd, &payload[0], size), (ssize_t)size);
+
+    status = 0;
+    ASSERT_EQUALS(::recv(fd, &status, sizeof(status), MSG_WAITALL),
+                  (ssize_t)sizeof(status));
+    ASSERT_EQUALS(status, -1);
+    ASSERT_EQUALS(::recv(fd, &size, sizeof(size), MSG_WAITALL),
+                  (ssize_t)sizeof(size));
+
+    error.assign(size, '\0');
+    ASSERT_EQUALS(::recv(fd, &error[0], size, MSG_WAITALL), (ssize_t)size);
+    ASSERT_TRUE(error.find("maximum request size") == std::string::npos);
+
+    ::close(fd);
+    server.stop();
+    listener.join();
+
+    ASSERT_EQUALS(server.getMetrics().nbRequests, 0U);
+}
+#endif
+
+RUN_TESTS()
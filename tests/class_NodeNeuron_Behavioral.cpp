@@ -0,0 +1,187 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Environment.hpp"
+#include "Network.hpp"
+#include "NodeEnv.hpp"
+#include "NodeNeuron_Behavioral.hpp"
+#include "Synapse_Behavioral.hpp"
+#include "Xcell.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+class NodeNeuron_Behavioral_Test : public NodeNeuron_Behavioral {
+public:
+    NodeNeuron_Behavioral_Test(Network& net) : NodeNeuron_Behavioral(net)
+    {
+    }
+
+    Synapse_Behavioral* getSynapse(Node* origin) const
+    {
+        return static_cast<Synapse_Behavioral*>(getLink(origin));
+    }
+};
+
+struct StdpResult {
+    std::vector<Weight_T> weights;
+    std::vector<unsigned long long int> statsIncEvents;
+    std::vector<unsigned long long int> statsDecEvents;
+    unsigned long long int nbLtp;
+    unsigned long long int nbLtd;
+};
+
+StdpResult runStdp(bool traceStdp,
+                   unsigned int orderStdp,
+                   bool biologicalStdp,
+                   unsigned int size,
+                   unsigned int nbNeurons,
+                   const std::vector<std::pair<unsigned int, Time_T> >& spikes)
+{
+    // Same seed for both simulations
+    Network net(1);
+    Environment env(net, EmptyDatabase, {size, size, 2});
+
+    Xcell xcell(net);
+    xcell.populate<NodeNeuron_Behavioral_Test>(nbNeurons);
+    // No spread, Random::randNormal() keeps a deviate between calls
+    xcell.setNeuronsParameterSpread<Time_T>("IncomingDelay", 0.0);
+    xcell.setNeuronsParameterSpread<Time_T>("EmitDelay", 0.0);
+    xcell.setNeuronsParameterSpread<Weight_T>("WeightsMin", 0.0);
+    xcell.setNeuronsParameterSpread<Weight_T>("WeightsMax", 0.0);
+    xcell.setNeuronsParameterSpread<Weight_T>("WeightsInit", 0.0);
+    xcell.setNeuronsParameterSpread<Weight_T>("WeightIncrement", 0.0);
+    xcell.setNeuronsParameterSpread<Weight_T>("WeightDecrement", 0.0);
+    xcell.setNeuronsParameter<Weight_T>("WeightIncrement", 5.0);
+    xcell.setNeuronsParameter<Weight_T>("WeightDecrement", 3.0);
+    xcell.setNeuronsParameter("Threshold", 40.0 * size);
+    xcell.setNeuronsParameter("StdpLtp", 2 * TimeMs);
+    xcell.setNeuronsParameter("Refractory", 1 * TimeMs);
+    xcell.setNeuronsParameter("InhibitRefractory", 1 * TimeMs);
+    xcell.setNeuronsParameter("OrderStdp", orderStdp);
+    xcell.setNeuronsParameter("BiologicalStdp", biologicalStdp);
+    xcell.setNeuronsParameter("StdpLtd", 2 * TimeMs);
+    xcell.setNeuronsParameter<Weight_T>("WeightBias", -0.5);
+    xcell.setNeuronsParameter("TraceStdp", traceStdp);
+    xcell.addInput(env, 0, 0, size, size);
+
+    const std::vector<NodeEnv*> nodes = env.getNodes();
+
+    for (unsigned int n = 0; n < nbNeurons; ++n) {
+        const NodeNeuron_Behavioral_Test* neuron
+            = static_cast<NodeNeuron_Behavioral_Test*>(xcell.getNeurons()[n]);
+
+        for (std::vector<NodeEnv*>::const_iterator it = nodes.begin(),
+             itEnd = nodes.end(); it != itEnd; ++it)
+        {
+            neuron->getSynapse(*it)->weight = Random::randUniform(1.0, 100.0);
+        }
+    }
+
+    // Two runs, to check that the state is kept between runs
+    const unsigned int half = spikes.size() / 2;
+
+    for (unsigned int i = 0; i < half; ++i)
+        nodes[spikes[i].first]->incomingSpike(NULL, spikes[i].second);
+
+    net.run(spikes[half].second);
+
+    for (unsigned int i = half; i < spikes.size(); ++i)
+        nodes[spikes[i].first]->incomingSpike(NULL, spikes[i].second);
+
+    net.run();
+
+    StdpResult result;
+    result.nbLtp = 0;
+    result.nbLtd = 0;
+
+    for (unsigned int n = 0; n < nbNeurons; ++n) {
+        const NodeNeuron_Behavioral_Test* neuron
+            = static_cast<NodeNeuron_Behavioral_Test*>(xcell.getNeurons()[n]);
+
+        for (std::vector<NodeEnv*>::const_iterator it = nodes.begin(),
+             itEnd = nodes.end(); it != itEnd; ++it)
+        {
+            const Synapse_Behavioral* synapse = neuron->getSynapse(*it);
+            result.weights.push_back(synapse->weight);
+            result.statsIncEvents.push_back(synapse->statsIncEvents);
+            result.statsDecEvents.push_back(synapse->statsDecEvents);
+            result.nbLtp += synapse->statsIncEvents;
+            result.nbLtd += synapse->statsDecEvents;
+        }
+    }
+
+    return result;
+}
+
+std::vector<std::pair<unsigned int, Time_T> >
+    randomSpikes(unsigned int nbNodes, unsigned int nbSpikes)
+{
+    Random::mtSeed(1);
+
+    std::vector<std::pair<unsigned int, Time_T> > spikes(nbSpikes);
+    Time_T time = 0;
+
+    for (unsigned int i = 0; i < nbSpikes; ++i) {
+        time += (Time_T)Random::randExponential(10.0 * TimeUs);
+        spikes[i] = std::make_pair(Random::randUniform(0, nbNodes - 1),
+                                   time + 1);
+    }
+
+    return spikes;
+}
+
+TEST_DATASET(NodeNeuron_Behavioral,
+             traceStdp,
+             (unsigned int orderStdp,
+              bool biologicalStdp,
+              unsigned int size,
+              unsigned int nbNeurons),
+             std::make_tuple(0U, false, 8U, 1U),
+             std::make_tuple(0U, false, 16U, 10U),
+             std::make_tuple(0U, true, 8U, 1U),
+             std::make_tuple(0U, true, 16U, 10U),
+             std::make_tuple(5U, false, 8U, 1U),
+             std::make_tuple(20U, false, 16U, 10U))
+{
+    const std::vector<std::pair<unsigned int, Time_T> > spikes
+        = randomSpikes(size * size * 2, 50000);
+
+    const StdpResult ref
+        = runStdp(false, orderStdp, biologicalStdp, size, nbNeurons, spikes);
+    const StdpResult trace
+        = runStdp(true, orderStdp, biologicalStdp, size, nbNeurons, spikes);
+
+    ASSERT_TRUE(ref.nbLtp > 0);
+    ASSERT_TRUE(ref.nbLtd > 0);
+    ASSERT_EQUALS(trace.nbLtp, ref.nbLtp);
+    ASSERT_EQUALS(trace.nbLtd, ref.nbLtd);
+
+    for (unsigned int i = 0; i < ref.weights.size(); ++i) {
+        ASSERT_EQUALS_DELTA(trace.weights[i], ref.weights[i], 1.0e-9);
+        ASSERT_EQUALS(trace.statsIncEvents[i], ref.statsIncEvents[i]);
+        ASSERT_EQUALS(trace.statsDecEvents[i], ref.statsDecEvents[i]);
+    }
+}
+
+RUN_TESTS()
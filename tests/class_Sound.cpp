@@ -0,0 +1,115 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Sound.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+TEST_DATASET(Sound,
+             readBlock,
+             (double start,
+              double end,
+              unsigned int blockSize),
+             std::make_tuple(0.0, 0.0, 1000U),
+             std::make_tuple(0.0, 0.0, 1U),
+             std::make_tuple(0.0, 0.0, 999U),
+             std::make_tuple(0.1, 0.5, 4096U),
+             std::make_tuple(0.25, 0.0, 100000U))
+{
+    Random::mtSeed(0);
+
+    Sound sound(8000U);
+    sound(0).resize(8000);
+
+    for (unsigned int s = 0; s < 8000; ++s)
+        sound(0)[s] = Random::randUniform(-1.0, 1.0);
+
+    sound.save("Sound_readBlock.wav", true, 1.0);
+
+    Sound ref;
+    ref.load("Sound_readBlock.wav", start, end);
+
+    Sound stream;
+    stream.openStream("Sound_readBlock.wav", start, end);
+
+    ASSERT_EQUALS(stream.getNbChannels(), 1U);
+    ASSERT_EQUALS(stream.getSamplingFrequency(), 8000U);
+
+    unsigned int offset = 0;
+
+    while (unsigned int size = stream.readBlock(blockSize)) {
+        ASSERT_TRUE(size <= blockSize);
+
+        ASSERT_EQUALS(stream(0).size(), size);
+
+        for (unsigned int s = 0; s < size; ++s)
+            ASSERT_EQUALS(stream(0)[s], ref(0)[offset + s]);
+
+        offset += size;
+    }
+
+    ASSERT_EQUALS(offset, ref(0).size());
+}
+
+TEST_DATASET(Sound,
+             applyFilter_fir,
+             (unsigned int filterSize, bool appendTrailing),
+             std::make_tuple(5U, false),
+             std::make_tuple(5U, true),
+             std::make_tuple(201U, false),
+             std::make_tuple(201U, true))
+{
+    Random::mtSeed(0);
+
+    std::vector<double> data(5000);
+
+    for (unsigned int s = 0; s < data.size(); ++s)
+        data[s] = Random::randUniform(-1.0, 1.0);
+
+    Sound sound(data, 8000U);
+    const Sound::Filter_T filter = sound.newFirFilter(
+        Sound::LowPass, filterSize, Hann<Sound::Real_T>(), 1000.0);
+    sound.applyFilter(filter, 0, appendTrailing);
+
+    ASSERT_EQUALS(sound(0).size(),
+                  data.size() + ((appendTrailing) ? filterSize : 0));
+
+    const double gain = filter.second.back();
+
+    for (unsigned int s = 0; s < sound(0).size(); ++s) {
+        double ref = 0.0;
+
+        // b[k] is applied to x[s - filterSize + 1 + k]
+        for (unsigned int k = 0; k < filterSize; ++k) {
+            const int n = (int)s - (int)filterSize + 1 + (int)k;
+
+            if (n >= 0 && n < (int)data.size())
+                ref += filter.first[k] * data[n] / gain;
+        }
+
+        ASSERT_EQUALS_DELTA(sound(0)[s], ref, 1.0e-9);
+    }
+}
+
+RUN_TESTS()
@@ -0,0 +1,214 @@
+/*
+    (C) Copyright 2024 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Database/Database.hpp"
+#include "StimuliData.hpp"
+#include "StimuliProvider.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+using namespace N2D2;
+
+class StimuliData_Database : public Database {
+public:
+    StimuliData_Database(unsigned int nbStimuli) : Database(true)
+    {
+        for (unsigned int i = 0; i < nbStimuli; ++i) {
+            // Per-stimulus offset, for a between-stimuli variance
+            const float offset = Random::randUniform(-2.0, 2.0);
+            cv::Mat mat(8, 8, CV_32FC1);
+
+            for (int y = 0; y < mat.rows; ++y) {
+                for (int x = 0; x < mat.cols; ++x) {
+                    mat.at<float>(y, x) = offset
+                        + Random::randNormal(0.0, 1.0 + 0.1 * x);
+                }
+            }
+
+            std::ostringstream nameStr;
+            nameStr << "stimulus" << i;
+
+            mStimuli.push_back(Stimulus(nameStr.str(), 0));
+            mStimuliSets(Learn).push_back(mStimuli.size() - 1);
+            mStimuliData.push_back(mat.clone());
+        }
+    }
+
+    std::vector<Float_T> getValues()
+    {
+        std::vector<Float_T> values;
+
+        for (unsigned int i = 0; i < mStimuliData.size(); ++i) {
+            const Tensor<Float_T> data(mStimuliData[i]);
+            values.insert(values.end(), data.begin(), data.end());
+        }
+
+        return values;
+    }
+};
+
+TEST_DATASET(StimuliData,
+             Accumulator_merge,
+             (unsigned int size, unsigned int split),
+             std::make_tuple(10U, 0U),
+             std::make_tuple(10U, 3U),
+             std::make_tuple(1000U, 500U),
+             std::make_tuple(1000U, 999U))
+{
+    Random::mtSeed(0);
+
+    std::vector<double> values(size);
+
+    for (unsigned int i = 0; i < size; ++i)
+        values[i] = 100.0 + Random::randNormal(0.0, 1.0);
+
+    StimuliData::Accumulator acc;
+    StimuliData::Accumulator acc1;
+    StimuliData::Accumulator acc2;
+
+    for (unsigned int i = 0; i < size; ++i) {
+        acc.push(values[i]);
+
+        if (i < split)
+            acc1.push(values[i]);
+        else
+            acc2.push(values[i]);
+    }
+
+    acc1.merge(acc2);
+
+    const std::pair<double, double> meanStdDev = Utils::meanStdDev(values);
+
+    ASSERT_EQUALS(acc.count, size);
+    ASSERT_EQUALS(acc1.count, size);
+    ASSERT_EQUALS_DELTA(acc.mean, meanStdDev.first, 1.0e-9);
+    ASSERT_EQUALS_DELTA(acc1.mean, meanStdDev.first, 1.0e-9);
+    ASSERT_EQUALS_DELTA(std::sqrt(acc.variance()), meanStdDev.second, 1.0e-9);
+    ASSERT_EQUALS_DELTA(std::sqrt(acc1.variance()), meanStdDev.second,
+                        1.0e-9);
+    ASSERT_EQUALS(acc1.minVal, acc.minVal);
+    ASSERT_EQUALS(acc1.maxVal, acc.maxVal);
+}
+
+TEST_DATASET(StimuliData,
+             generate,
+             (unsigned int nbStimuli, unsigned int checkpointInterval),
+             std::make_tuple(20U, 0U),
+             std::make_tuple(20U, 3U),
+             std::make_tuple(100U, 7U))
+{
+    Random::mtSeed(0);
+
+    StimuliData_Database database(nbStimuli);
+    StimuliProvider sp(database, {8, 8, 1});
+
+    std::ostringstream nameStr;
+    nameStr << "StimuliData_generate_" << nbStimuli << "_"
+        << checkpointInterval;
+
+    std::remove((nameStr.str() + "/_cache").c_str());
+    std::remove((nameStr.str() + "/meanData.bin").c_str());
+
+    StimuliData stimuliData(nameStr.str(), sp);
+    stimuliData.setParameter("CheckpointInterval", checkpointInterval);
+    stimuliData.setParameter("MeanData", true);
+
+    ASSERT_EQUALS(stimuliData.generate(Database::LearnOnly), nbStimuli);
+    ASSERT_EQUALS(stimuliData.getNbStimuliPopulation(), nbStimuli);
+
+    const std::vector<Float_T> values = database.getValues();
+    const std::pair<double, double> meanStdDev = Utils::meanStdDev(values);
+
+    const StimuliData::Value& globalValue = stimuliData.getGlobalValue();
+    ASSERT_EQUALS_DELTA(globalValue.mean, meanStdDev.first, 1.0e-6);
+    ASSERT_EQUALS_DELTA(globalValue.stdDev, meanStdDev.second, 1.0e-6);
+    ASSERT_EQUALS(globalValue.minVal,
+                  *std::min_element(values.begin(), values.end()));
+    ASSERT_EQUALS(globalValue.maxVal,
+                  *std::max_element(values.begin(), values.end()));
+    ASSERT_EQUALS(stimuliData.getGlobalValueConfidence().mean, 0.0);
+    ASSERT_EQUALS(stimuliData.getMinSize().dimX, 8U);
+    ASSERT_EQUALS(stimuliData.getMaxSize().dimY, 8U);
+
+    // The partial file is removed once the statistics are complete
+    ASSERT_TRUE(!std::ifstream((nameStr.str() + "/_partial").c_str()).good());
+    ASSERT_TRUE(std::ifstream((nameStr.str() + "/meanData.bin").c_str())
+                .good());
+}
+
+TEST_DATASET(StimuliData,
+             generate_sampled,
+             (unsigned int nbStimuli, double sampleRatio),
+             std::make_tuple(200U, 0.5),
+             std::make_tuple(500U, 0.1))
+{
+    Random::mtSeed(0);
+
+    StimuliData_Database database(nbStimuli);
+    StimuliProvider sp(database, {8, 8, 1});
+
+    std::ostringstream nameStr;
+    nameStr << "StimuliData_generate_sampled_" << nbStimuli << "_"
+        << sampleRatio;
+
+    std::remove((nameStr.str() + "/_cache").c_str());
+    std::remove((nameStr.str() + "/meanData.bin").c_str());
+
+    StimuliData stimuliData(nameStr.str(), sp);
+    stimuliData.setParameter("SampleRatio", sampleRatio);
+
+    ASSERT_EQUALS(stimuliData.generate(Database::LearnOnly),
+                  (unsigned int)std::ceil(sampleRatio * nbStimuli));
+    ASSERT_EQUALS(stimuliData.getNbStimuliPopulation(), nbStimuli);
+
+    const std::vector<Float_T> values = database.getValues();
+    const std::pair<double, double> meanStdDev = Utils::meanStdDev(values);
+
+    const StimuliData::Value& globalValue = stimuliData.getGlobalValue();
+    const StimuliData::Confidence& confidence
+        = stimuliData.getGlobalValueConfidence();
+
+    ASSERT_TRUE(confidence.mean > 0.0);
+    ASSERT_TRUE(confidence.stdDev > 0.0);
+    // Allow some margin, as the true value is outside the 95% interval 5% of
+    // the time
+    ASSERT_EQUALS_DELTA(globalValue.mean, meanStdDev.first,
+                        2.0 * confidence.mean);
+    ASSERT_EQUALS_DELTA(globalValue.stdDev, meanStdDev.second,
+                        2.0 * confidence.stdDev);
+
+    // The sample does not depend on the global random generator state
+    std::remove((nameStr.str() + "/_cache").c_str());
+    Random::mtSeed(1);
+
+    StimuliData stimuliDataResampled(nameStr.str(), sp);
+    stimuliDataResampled.setParameter("SampleRatio", sampleRatio);
+    stimuliDataResampled.generate(Database::LearnOnly);
+
+    ASSERT_EQUALS(stimuliDataResampled.getGlobalValue().mean,
+                  globalValue.mean);
+    ASSERT_EQUALS(stimuliDataResampled.getGlobalValue().stdDev,
+                  globalValue.stdDev);
+}
+
+RUN_TESTS()
@@ -0,0 +1,170 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "VideoPipeline.hpp"
+#include "utils/UnitTest.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace N2D2;
+
+VideoPipeline::Source_T createSyntheticSource(unsigned int nbFrames,
+                                              unsigned int periodMs = 0)
+{
+    std::shared_ptr<unsigned int> index
+        = std::make_shared<unsigned int>(0);
+
+    return [nbFrames, periodMs, index](cv::Mat& mat) {
+        if ((*index) >= nbFrames)
+            return false;
+
+        if (periodMs > 0) {
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(periodMs));
+        }
+
+        mat = cv::Mat(4, 4, CV_32FC1);
+        mat.at<float>(0, 0) = (float)(*index);
+        ++(*index);
+        return true;
+    };
+}
+
+VideoPipeline::Stage_T createSleepStage(unsigned int durationMs)
+{
+    return [durationMs](VideoPipeline::Frame& /*frame*/) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    };
+}
+
+// Sleep stage recording the maximum number of stages running at once
+VideoPipeline::Stage_T createSleepStage(
+    unsigned int durationMs,
+    const std::shared_ptr<std::atomic<unsigned int> >& nbRunning,
+    const std::shared_ptr<std::atomic<unsigned int> >& maxRunning)
+{
+    return [durationMs, nbRunning, maxRunning](VideoPipeline::Frame& frame) {
+        const unsigned int running = ++(*nbRunning);
+        unsigned int maxPrev = maxRunning->load();
+
+        while (running > maxPrev
+               && !maxRunning->compare_exchange_weak(maxPrev, running)) {}
+
+        createSleepStage(durationMs)(frame);
+        --(*nbRunning);
+    };
+}
+
+TEST(VideoPipeline, run)
+{
+    const unsigned int nbFrames = 30;
+    const unsigned int stageMs = 10;
+
+    const std::shared_ptr<std::atomic<unsigned int> > nbRunning
+        = std::make_shared<std::atomic<unsigned int> >(0);
+    const std::shared_ptr<std::atomic<unsigned int> > maxRunning
+        = std::make_shared<std::atomic<unsigned int> >(0);
+
+    VideoPipeline pipeline(createSyntheticSource(nbFrames));
+    pipeline.addStage("preprocess",
+                      createSleepStage(stageMs, nbRunning, maxRunning));
+    pipeline.addStage("infer",
+                      createSleepStage(stageMs, nbRunning, maxRunning));
+
+    std::vector<unsigned long long> indexes;
+    const VideoPipeline::Stage_T postprocess
+        = createSleepStage(stageMs, nbRunning, maxRunning);
+
+    pipeline.addStage("postprocess",
+        [&indexes, postprocess](VideoPipeline::Frame& frame) {
+            postprocess(frame);
+
+            // The frame data must follow the frame through the stages
+            if (frame.image.at<float>(0, 0) == (float)frame.index)
+                indexes.push_back(frame.index);
+        });
+
+    pipeline.run();
+
+    // No frame dropped, in order
+    ASSERT_EQUALS(indexes.size(), nbFrames);
+
+    for (unsigned int i = 0; i < nbFrames; ++i)
+        ASSERT_EQUALS(indexes[i], i);
+
+    const std::vector<VideoPipeline::StageStats> stats = pipeline.getStats();
+    ASSERT_EQUALS(stats.size(), 3U);
+
+    for (unsigned int s = 0; s < stats.size(); ++s) {
+        ASSERT_EQUALS(stats[s].nbFrames, nbFrames);
+        ASSERT_EQUALS(stats[s].nbDropped, 0U);
+        ASSERT_TRUE(stats[s].getLatencyPercentile(0.5) >= 0.9e-3 * stageMs);
+    }
+
+    ASSERT_EQUALS(pipeline.getEndToEndStats().nbFrames, nbFrames);
+
+    // Stages run concurrently on successive frames
+    ASSERT_TRUE(maxRunning->load() > 1U);
+    ASSERT_TRUE(pipeline.getFps() > 0.0);
+
+    pipeline.logStats(std::cout);
+}
+
+TEST(VideoPipeline, run_dropOldest)
+{
+    const unsigned int nbFrames = 40;
+
+    // Source faster than the processing
+    VideoPipeline pipeline(createSyntheticSource(nbFrames, 1), 1,
+                           VideoPipeline::DropOldest);
+    pipeline.addStage("infer", createSleepStage(10));
+    pipeline.run();
+
+    const std::vector<VideoPipeline::StageStats> stats = pipeline.getStats();
+
+    ASSERT_TRUE(stats[0].nbDropped > 0U);
+    ASSERT_EQUALS(stats[0].nbFrames + stats[0].nbDropped, nbFrames);
+
+    pipeline.logStats(std::cout);
+}
+
+TEST(VideoPipeline, run_stageError)
+{
+    VideoPipeline pipeline(createSyntheticSource(10));
+    pipeline.addStage("fail", [](VideoPipeline::Frame& frame) {
+        if (frame.index % 2 == 0)
+            throw std::runtime_error("even frame");
+    });
+
+    unsigned int nbFrames = 0;
+    pipeline.addStage("count", [&nbFrames](VideoPipeline::Frame& /*frame*/) {
+        ++nbFrames;
+    });
+    pipeline.run();
+
+    ASSERT_EQUALS(nbFrames, 5U);
+}
+
+RUN_TESTS()
@@ -0,0 +1,123 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Environment.hpp"
+#include "Network.hpp"
+#include "NodeEnv.hpp"
+#include "NodeNeuron_Behavioral.hpp"
+#include "Xcell.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+class NodeNeuron_Behavioral_Test : public NodeNeuron_Behavioral {
+public:
+    NodeNeuron_Behavioral_Test(Network& net) : NodeNeuron_Behavioral(net)
+    {
+    }
+
+    Synapse* getLinkRef(Node* origin)
+    {
+        // Previous implementation
+        return mLinks[origin];
+    }
+
+    Synapse* getLinkCompiled(Node* origin) const
+    {
+        return getLink(origin);
+    }
+
+    bool isLinkIndexDense() const
+    {
+        return !mLinkIndex.empty();
+    }
+};
+
+TEST_DATASET(Xcell,
+             compileLinks,
+             (unsigned int size, unsigned int nbNeurons),
+             std::make_tuple(1U, 1U),
+             std::make_tuple(8U, 4U),
+             std::make_tuple(32U, 10U))
+{
+    Network net;
+    Environment env(net, EmptyDatabase, {size, size, 2});
+
+    Xcell xcell(net);
+    xcell.populate<NodeNeuron_Behavioral_Test>(nbNeurons);
+    xcell.addInput(env, 0, 0, size, size);
+
+    const std::vector<NodeEnv*> nodes = env.getNodes();
+
+    for (unsigned int n = 0; n < nbNeurons; ++n) {
+        NodeNeuron_Behavioral_Test* neuron
+            = static_cast<NodeNeuron_Behavioral_Test*>(xcell.getNeurons()[n]);
+        neuron->compileLinks();
+
+        ASSERT_TRUE(neuron->isLinkIndexDense());
+        ASSERT_EQUALS(neuron->getNbLinks(), nodes.size());
+
+        for (std::vector<NodeEnv*>::const_iterator it = nodes.begin(),
+             itEnd = nodes.end(); it != itEnd; ++it)
+        {
+            ASSERT_EQUALS(neuron->getLinkCompiled(*it),
+                          neuron->getLinkRef(*it));
+        }
+
+        // Not connected
+        ASSERT_THROW_ANY(neuron->getLinkCompiled(xcell.getNeurons()[0]));
+    }
+}
+
+TEST(Xcell, compileLinks_sparse)
+{
+    Network net;
+    Environment env1(net, EmptyDatabase, {4, 4, 1});
+    Environment env2(net, EmptyDatabase, {64, 64, 1});
+    Environment env3(net, EmptyDatabase, {4, 4, 1});
+
+    Xcell xcell(net);
+    xcell.populate<NodeNeuron_Behavioral_Test>(1);
+    xcell.addInput(env1, 0, 0, 4, 4);
+    xcell.addInput(env3, 0, 0, 4, 4);
+
+    NodeNeuron_Behavioral_Test* neuron
+        = static_cast<NodeNeuron_Behavioral_Test*>(xcell.getNeurons()[0]);
+    neuron->compileLinks();
+
+    // The IDs range is too large compared to the number of links: falls back
+    // to the hash map
+    ASSERT_TRUE(!neuron->isLinkIndexDense());
+
+    const std::vector<NodeEnv*> nodes3 = env3.getNodes();
+    ASSERT_EQUALS(neuron->getLinkCompiled(nodes3[5]),
+                  neuron->getLinkRef(nodes3[5]));
+    ASSERT_THROW_ANY(neuron->getLinkCompiled(env2.getNodes()[0]));
+
+    // Adding a link after compilation re-compiles
+    xcell.addInput(env2, 0, 0, 64, 64);
+    ASSERT_TRUE(neuron->isLinkIndexDense());
+    ASSERT_EQUALS(neuron->getLinkCompiled(env2.getNodes()[0]),
+                  neuron->getLinkRef(env2.getNodes()[0]));
+}
+
+RUN_TESTS()
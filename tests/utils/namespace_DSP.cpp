@@ -19,6 +19,7 @@
 */
 
 #include "utils/DSP.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Utils.hpp"
 
@@ -101,4 +102,159 @@ TEST_DATASET(DSP,
     }
 }
 
+namespace {
+std::vector<std::complex<double> >
+naiveDft(const std::vector<std::complex<double> >& x, bool inverse)
+{
+    const unsigned int size = x.size();
+    std::vector<std::complex<double> > y(size, 0.0);
+
+    for (unsigned int k = 0; k < size; ++k) {
+        for (unsigned int n = 0; n < size; ++n) {
+            const double phase = ((inverse) ? 2.0 : -2.0) * M_PI
+                                 * ((k * (unsigned long long int)n) % size)
+                                 / (double)size;
+            y[k] += x[n] * std::polar(1.0, phase);
+        }
+    }
+
+    return y;
+}
+}
+
+TEST_DATASET(DSP,
+             FftPlan,
+             (unsigned int size),
+             std::make_tuple(1U),
+             std::make_tuple(2U),
+             std::make_tuple(3U),
+             std::make_tuple(7U),
+             std::make_tuple(12U),
+             std::make_tuple(16U),
+             std::make_tuple(60U),
+             std::make_tuple(97U),
+             std::make_tuple(128U),
+             std::make_tuple(1000U))
+{
+    Random::mtSeed(0);
+
+    std::vector<std::complex<double> > x(size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        x[i] = std::complex<double>(Random::randUniform(-1.0, 1.0),
+                                    Random::randUniform(-1.0, 1.0));
+    }
+
+    const DSP::FftPlan<double>& plan = DSP::FftPlan<double>::get(size);
+
+    ASSERT_EQUALS(plan.size(), size);
+    ASSERT_TRUE(&DSP::FftPlan<double>::get(size) == &plan);
+
+    for (int inverse = 0; inverse < 2; ++inverse) {
+        std::vector<std::complex<double> > y(size);
+        plan.transform(&x[0], &y[0], (bool)inverse);
+
+        const std::vector<std::complex<double> > yRef
+            = naiveDft(x, (bool)inverse);
+
+        for (unsigned int i = 0; i < size; ++i) {
+            ASSERT_EQUALS_DELTA(y[i].real(), yRef[i].real(), 1.0e-9);
+            ASSERT_EQUALS_DELTA(y[i].imag(), yRef[i].imag(), 1.0e-9);
+        }
+    }
+
+    // Batch
+    const unsigned int batchSize = 5;
+    std::vector<std::complex<double> > xBatch(size * batchSize);
+
+    for (unsigned int i = 0; i < xBatch.size(); ++i)
+        xBatch[i] = x[i % size] * (double)(i / size + 1);
+
+    std::vector<std::complex<double> > yBatch(size * batchSize);
+    plan.transform(&xBatch[0], &yBatch[0], batchSize, false);
+
+    const std::vector<std::complex<double> > yRef = naiveDft(x, false);
+
+    for (unsigned int i = 0; i < yBatch.size(); ++i) {
+        const std::complex<double> yi = yRef[i % size] * (double)(i / size + 1);
+        ASSERT_EQUALS_DELTA(yBatch[i].real(), yi.real(), 1.0e-8);
+        ASSERT_EQUALS_DELTA(yBatch[i].imag(), yi.imag(), 1.0e-8);
+    }
+}
+
+TEST_DATASET(DSP,
+             RealFftPlan,
+             (unsigned int size),
+             std::make_tuple(1U),
+             std::make_tuple(2U),
+             std::make_tuple(6U),
+             std::make_tuple(7U),
+             std::make_tuple(16U),
+             std::make_tuple(18U),
+             std::make_tuple(100U),
+             std::make_tuple(1024U))
+{
+    Random::mtSeed(0);
+
+    std::vector<double> x(size);
+
+    for (unsigned int i = 0; i < size; ++i)
+        x[i] = Random::randUniform(-1.0, 1.0);
+
+    const DSP::RealFftPlan<double>& plan = DSP::RealFftPlan<double>::get(size);
+
+    std::vector<std::complex<double> > y(size / 2 + 1);
+    plan.forward(&x[0], &y[0]);
+
+    const std::vector<std::complex<double> > yRef
+        = naiveDft(DSP::toComplex(x), false);
+
+    for (unsigned int i = 0; i <= size / 2; ++i) {
+        ASSERT_EQUALS_DELTA(y[i].real(), yRef[i].real(), 1.0e-9);
+        ASSERT_EQUALS_DELTA(y[i].imag(), yRef[i].imag(), 1.0e-9);
+    }
+
+    std::vector<double> xInv(size);
+    plan.inverse(&y[0], &xInv[0]);
+
+    for (unsigned int i = 0; i < size; ++i)
+        ASSERT_EQUALS_DELTA(xInv[i] / size, x[i], 1.0e-9);
+}
+
+TEST_DATASET(DSP,
+             convolve,
+             (unsigned int xSize, unsigned int hSize),
+             std::make_tuple(1U, 1U),
+             std::make_tuple(10U, 3U),
+             std::make_tuple(3U, 10U),
+             std::make_tuple(1000U, 65U),
+             std::make_tuple(10000U, 257U))
+{
+    Random::mtSeed(0);
+
+    std::vector<double> x(xSize);
+    std::vector<double> h(hSize);
+
+    for (unsigned int i = 0; i < xSize; ++i)
+        x[i] = Random::randUniform(-1.0, 1.0);
+
+    for (unsigned int i = 0; i < hSize; ++i)
+        h[i] = Random::randUniform(-1.0, 1.0);
+
+    const std::vector<double> y = DSP::convolve(x, h);
+
+    ASSERT_EQUALS(y.size(), xSize + hSize - 1);
+
+    for (unsigned int n = 0; n < y.size(); ++n) {
+        double yRef = 0.0;
+
+        for (unsigned int k = 0; k < hSize; ++k) {
+            if (n >= k && n - k < xSize)
+                yRef += h[k] * x[n - k];
+        }
+
+        ASSERT_EQUALS_DELTA(y[n], yRef, 1.0e-9);
+    }
+}
+
 RUN_TESTS()
@@ -0,0 +1,134 @@
+/*
+    (C) Copyright 2019 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <cmath>
+
+#include "utils/Half.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+TEST_DATASET(Half,
+             toFloat,
+             (size_t size),
+             std::make_tuple(1U),
+             std::make_tuple(7U),
+             std::make_tuple(8U),
+             std::make_tuple(1023U),
+             std::make_tuple(100000U))
+{
+    std::vector<half_float::half> src(size);
+
+    for (size_t i = 0; i < size; ++i)
+        src[i] = half_float::half((float)(i % 2048) - 1024.0f);
+
+    std::vector<float> dst;
+    Half::toFloat(src, dst);
+
+    ASSERT_EQUALS(dst.size(), size);
+
+    for (size_t i = 0; i < size; ++i)
+        ASSERT_EQUALS(dst[i], (float)src[i]);
+}
+
+TEST_DATASET(Half,
+             fromFloat,
+             (size_t size),
+             std::make_tuple(1U),
+             std::make_tuple(7U),
+             std::make_tuple(8U),
+             std::make_tuple(1023U),
+             std::make_tuple(100000U))
+{
+    std::vector<float> src(size);
+
+    for (size_t i = 0; i < size; ++i)
+        src[i] = std::sin(0.01f * i) * 100.0f;
+
+    std::vector<half_float::half> dst;
+    Half::fromFloat(src, dst);
+
+    ASSERT_EQUALS(dst.size(), size);
+
+    for (size_t i = 0; i < size; ++i) {
+        // Round to nearest: error must be within half an ulp (11 bits)
+        ASSERT_EQUALS_DELTA((float)dst[i], src[i],
+                            std::fabs(src[i]) / 2048.0f + 1.0e-7f);
+    }
+
+    // Round-trip must be exact
+    std::vector<float> roundTrip;
+    Half::toFloat(dst, roundTrip);
+
+    std::vector<half_float::half> dst2;
+    Half::fromFloat(roundTrip, dst2);
+
+    for (size_t i = 0; i < size; ++i)
+        ASSERT_EQUALS((float)dst2[i], (float)dst[i]);
+}
+
+TEST_DATASET(bfloat16,
+             fromFloat,
+             (float value, float expected),
+             std::make_tuple(0.0f, 0.0f),
+             std::make_tuple(1.0f, 1.0f),
+             std::make_tuple(-2.5f, -2.5f),
+             std::make_tuple(1.00390625f, 1.0f),    // tie: round to even
+             std::make_tuple(1.01171875f, 1.015625f), // tie: round to even
+             std::make_tuple(3.0e38f, 3.00405527e38f))
+{
+    const bfloat16 bf(value);
+    ASSERT_EQUALS_DELTA((float)bf, expected, std::fabs(expected) * 1.0e-5f);
+}
+
+TEST(bfloat16, nan)
+{
+    const bfloat16 bf(std::numeric_limits<float>::quiet_NaN());
+    ASSERT_TRUE(std::isnan((float)bf));
+}
+
+TEST_DATASET(bfloat16,
+             toFloat,
+             (size_t size),
+             std::make_tuple(1U),
+             std::make_tuple(1023U),
+             std::make_tuple(100000U))
+{
+    std::vector<float> src(size);
+
+    for (size_t i = 0; i < size; ++i)
+        src[i] = std::sin(0.01f * i) * 1.0e3f;
+
+    std::vector<bfloat16> dst;
+    Half::fromFloat(src, dst);
+
+    std::vector<float> roundTrip;
+    Half::toFloat(dst, roundTrip);
+
+    ASSERT_EQUALS(roundTrip.size(), size);
+
+    for (size_t i = 0; i < size; ++i) {
+        // 8 bits of precision
+        ASSERT_EQUALS_DELTA(roundTrip[i], src[i],
+                            std::fabs(src[i]) / 256.0f + 1.0e-7f);
+    }
+}
+
+RUN_TESTS()